@@ -99,6 +99,16 @@ OB_EXPORT void ob_enable_device_clock_sync(ob_context *context, uint64_t repeat_
  */
 OB_EXPORT void ob_free_idle_memory(ob_context *context, ob_error **error);
 
+/**
+ * @brief Get the occupancy of each frame buffer manager in the internal frame memory pool
+ *
+ * @param[in] context Pointer to the context object
+ * @param[out] usage_list Pointer to an array to receive the occupancy of the frame buffer managers, can be NULL to query the count only
+ * @param[in,out] count Input: the capacity of usage_list; Output: the number of frame buffer managers in the pool, which may exceed the capacity
+ * @param[out] error Pointer to an error object that will be populated if an error occurs during execution
+ */
+OB_EXPORT void ob_get_frame_memory_pool_usage(ob_context *context, ob_frame_buffer_manager_usage *usage_list, uint32_t *count, ob_error **error);
+
 /**
  * @brief Set the global log level
  *
@@ -510,6 +510,60 @@ OB_EXPORT ob_gyro_value ob_gyro_frame_get_value(const ob_frame *frame, ob_error
  */
 OB_EXPORT float ob_gyro_frame_get_temperature(const ob_frame *frame, ob_error **error);
 
+/**
+ * @brief Check if the frame is an IMU batch frame.
+ * @brief IMU batch frames are output instead of one accelerometer or gyroscope frame per sample if ImuBatchFrameEnable is set in the configuration
+ * file. An IMU batch frame holds all samples of a stream that were received in one packet. Its frame type is OB_FRAME_ACCEL or OB_FRAME_GYRO, and its
+ * timestamp and index are those of the first sample.
+ * @attention Only the device timestamps are stored per sample, see @ref ob_imu_batch_frame_get_timestamps. The system timestamp and the global timestamp
+ * of the frame are those of the first sample, the other samples have none. The global timestamp of sample i can be estimated as the global timestamp
+ * of the frame plus the difference of the device timestamps of sample i and of the first sample.
+ *
+ * @param[in] frame Frame object.
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ * @return bool Return true if the frame is an IMU batch frame, otherwise return false.
+ */
+OB_EXPORT bool ob_frame_is_imu_batch(const ob_frame *frame, ob_error **error);
+
+/**
+ * @brief Get the number of samples of an IMU batch frame.
+ *
+ * @param[in] frame IMU batch frame.
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ * @return uint32_t Return the number of samples.
+ */
+OB_EXPORT uint32_t ob_imu_batch_frame_get_sample_count(const ob_frame *frame, ob_error **error);
+
+/**
+ * @brief Get the device timestamps of the samples of an IMU batch frame.
+ *
+ * @param[in] frame IMU batch frame.
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ * @return const uint64_t* Return the array of sample timestamps in microseconds, its size is the sample count. It is valid while the frame is alive.
+ * @attention These are device timestamps, they are not converted to the system or global time base, see @ref ob_frame_is_imu_batch.
+ */
+OB_EXPORT const uint64_t *ob_imu_batch_frame_get_timestamps(const ob_frame *frame, ob_error **error);
+
+/**
+ * @brief Get the values of one axis of the samples of an IMU batch frame.
+ *
+ * @param[in] frame IMU batch frame.
+ * @param[in] axis The axis, 0: x, 1: y, 2: z.
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ * @return const float* Return the array of values, in g for accelerometer frames and in dps for gyroscope frames. Its size is the sample count.
+ * It is valid while the frame is alive.
+ */
+OB_EXPORT const float *ob_imu_batch_frame_get_values(const ob_frame *frame, uint32_t axis, ob_error **error);
+
+/**
+ * @brief Get the temperatures of the samples of an IMU batch frame.
+ *
+ * @param[in] frame IMU batch frame.
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ * @return const float* Return the array of temperatures in Celsius, its size is the sample count. It is valid while the frame is alive.
+ */
+OB_EXPORT const float *ob_imu_batch_frame_get_temperatures(const ob_frame *frame, ob_error **error);
+
 /**
  * @brief Get the number of frames contained in the frameset
  *
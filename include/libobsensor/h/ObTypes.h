@@ -184,40 +184,44 @@ typedef enum {
  * @brief Enumeration value describing the pixel format
  */
 typedef enum {
-    OB_FORMAT_UNKNOWN    = -1, /*< unknown format */
-    OB_FORMAT_YUYV       = 0,  /**< YUYV format */
-    OB_FORMAT_YUY2       = 1,  /**< YUY2 format (the actual format is the same as YUYV) */
-    OB_FORMAT_UYVY       = 2,  /**< UYVY format */
-    OB_FORMAT_NV12       = 3,  /**< NV12 format */
-    OB_FORMAT_NV21       = 4,  /**< NV21 format */
-    OB_FORMAT_MJPG       = 5,  /**< MJPEG encoding format */
-    OB_FORMAT_H264       = 6,  /**< H.264 encoding format */
-    OB_FORMAT_H265       = 7,  /**< H.265 encoding format */
-    OB_FORMAT_Y16        = 8,  /**< Y16 format, 16-bit per pixel, single-channel*/
-    OB_FORMAT_Y8         = 9,  /**< Y8 format, 8-bit per pixel, single-channel */
-    OB_FORMAT_Y10        = 10, /**< Y10 format, 10-bit per pixel, single-channel(SDK will unpack into Y16 by default) */
-    OB_FORMAT_Y11        = 11, /**< Y11 format, 11-bit per pixel, single-channel (SDK will unpack into Y16 by default) */
-    OB_FORMAT_Y12        = 12, /**< Y12 format, 12-bit per pixel, single-channel(SDK will unpack into Y16 by default) */
-    OB_FORMAT_GRAY       = 13, /**< GRAY (the actual format is the same as YUYV) */
-    OB_FORMAT_HEVC       = 14, /**< HEVC encoding format (the actual format is the same as H265) */
-    OB_FORMAT_I420       = 15, /**< I420 format */
-    OB_FORMAT_ACCEL      = 16, /**< Acceleration data format */
-    OB_FORMAT_GYRO       = 17, /**< Gyroscope data format */
-    OB_FORMAT_POINT      = 19, /**< XYZ 3D coordinate point format, @ref OBPoint */
-    OB_FORMAT_RGB_POINT  = 20, /**< XYZ 3D coordinate point format with RGB information, @ref OBColorPoint */
-    OB_FORMAT_RLE        = 21, /**< RLE pressure test format (SDK will be unpacked into Y16 by default) */
-    OB_FORMAT_RGB        = 22, /**< RGB format (actual RGB888)  */
-    OB_FORMAT_BGR        = 23, /**< BGR format (actual BGR888) */
-    OB_FORMAT_Y14        = 24, /**< Y14 format, 14-bit per pixel, single-channel (SDK will unpack into Y16 by default) */
-    OB_FORMAT_BGRA       = 25, /**< BGRA format */
-    OB_FORMAT_COMPRESSED = 26, /**< Compression format */
-    OB_FORMAT_RVL        = 27, /**< RVL pressure test format (SDK will be unpacked into Y16 by default) */
-    OB_FORMAT_Z16        = 28, /**< Is same as Y16*/
-    OB_FORMAT_YV12       = 29, /**< Is same as Y12, using for right ir stream*/
-    OB_FORMAT_BA81       = 30, /**< Is same as Y8, using for right ir stream*/
-    OB_FORMAT_RGBA       = 31, /**< RGBA format */
-    OB_FORMAT_BYR2       = 32, /**< byr2 format */
-    OB_FORMAT_RW16       = 33, /**< RAW16 format */
+    OB_FORMAT_UNKNOWN         = -1, /*< unknown format */
+    OB_FORMAT_YUYV            = 0,  /**< YUYV format */
+    OB_FORMAT_YUY2            = 1,  /**< YUY2 format (the actual format is the same as YUYV) */
+    OB_FORMAT_UYVY            = 2,  /**< UYVY format */
+    OB_FORMAT_NV12            = 3,  /**< NV12 format */
+    OB_FORMAT_NV21            = 4,  /**< NV21 format */
+    OB_FORMAT_MJPG            = 5,  /**< MJPEG encoding format */
+    OB_FORMAT_H264            = 6,  /**< H.264 encoding format */
+    OB_FORMAT_H265            = 7,  /**< H.265 encoding format */
+    OB_FORMAT_Y16             = 8,  /**< Y16 format, 16-bit per pixel, single-channel*/
+    OB_FORMAT_Y8              = 9,  /**< Y8 format, 8-bit per pixel, single-channel */
+    OB_FORMAT_Y10             = 10, /**< Y10 format, 10-bit per pixel, single-channel(SDK will unpack into Y16 by default) */
+    OB_FORMAT_Y11             = 11, /**< Y11 format, 11-bit per pixel, single-channel (SDK will unpack into Y16 by default) */
+    OB_FORMAT_Y12             = 12, /**< Y12 format, 12-bit per pixel, single-channel(SDK will unpack into Y16 by default) */
+    OB_FORMAT_GRAY            = 13, /**< GRAY (the actual format is the same as YUYV) */
+    OB_FORMAT_HEVC            = 14, /**< HEVC encoding format (the actual format is the same as H265) */
+    OB_FORMAT_I420            = 15, /**< I420 format */
+    OB_FORMAT_ACCEL           = 16, /**< Acceleration data format */
+    OB_FORMAT_GYRO            = 17, /**< Gyroscope data format */
+    OB_FORMAT_POINT           = 19, /**< XYZ 3D coordinate point format, @ref OBPoint */
+    OB_FORMAT_RGB_POINT       = 20, /**< XYZ 3D coordinate point format with RGB information, @ref OBColorPoint */
+    OB_FORMAT_RLE             = 21, /**< RLE pressure test format (SDK will be unpacked into Y16 by default) */
+    OB_FORMAT_RGB             = 22, /**< RGB format (actual RGB888)  */
+    OB_FORMAT_BGR             = 23, /**< BGR format (actual BGR888) */
+    OB_FORMAT_Y14             = 24, /**< Y14 format, 14-bit per pixel, single-channel (SDK will unpack into Y16 by default) */
+    OB_FORMAT_BGRA            = 25, /**< BGRA format */
+    OB_FORMAT_COMPRESSED      = 26, /**< Compression format */
+    OB_FORMAT_RVL             = 27, /**< RVL pressure test format (SDK will be unpacked into Y16 by default) */
+    OB_FORMAT_Z16             = 28, /**< Is same as Y16*/
+    OB_FORMAT_YV12            = 29, /**< Is same as Y12, using for right ir stream*/
+    OB_FORMAT_BA81            = 30, /**< Is same as Y8, using for right ir stream*/
+    OB_FORMAT_RGBA            = 31, /**< RGBA format */
+    OB_FORMAT_BYR2            = 32, /**< byr2 format */
+    OB_FORMAT_RW16            = 33, /**< RAW16 format */
+    OB_FORMAT_POINT_INT16     = 34, /**< XYZ 3D coordinate point format with 16-bit integer coordinates, @ref OBPointInt16 */
+    OB_FORMAT_POINT_HALF      = 35, /**< XYZ 3D coordinate point format with 16-bit half float coordinates, @ref OBPointHalf */
+    OB_FORMAT_RGB_POINT_INT16 = 36, /**< XYZ 3D coordinate point format with 16-bit integer coordinates and RGB information, @ref OBColorPointInt16 */
+    OB_FORMAT_RGB_POINT_HALF  = 37, /**< XYZ 3D coordinate point format with 16-bit half float coordinates and RGB information, @ref OBColorPointHalf */
 } OBFormat,
     ob_format;
 
@@ -752,6 +756,48 @@ typedef struct {
     float b;  ///< Blue channel component
 } OBColorPoint, ob_color_point;
 
+/**
+ * @brief 3D point structure with 16-bit integer coordinates, rounded to the nearest integer and saturated to the int16_t range
+ */
+typedef struct {
+    int16_t x;  ///< X coordinate
+    int16_t y;  ///< Y coordinate
+    int16_t z;  ///< Z coordinate
+} OBPointInt16, ob_point_int16;
+
+/**
+ * @brief 3D point structure with IEEE 754 half precision (binary16) float coordinates
+ */
+typedef struct {
+    uint16_t x;  ///< X coordinate
+    uint16_t y;  ///< Y coordinate
+    uint16_t z;  ///< Z coordinate
+} OBPointHalf, ob_point_half;
+
+/**
+ * @brief 3D point structure with 16-bit integer coordinates and 8-bit color information
+ */
+typedef struct {
+    int16_t x;  ///< X coordinate
+    int16_t y;  ///< Y coordinate
+    int16_t z;  ///< Z coordinate
+    uint8_t r;  ///< Red channel component
+    uint8_t g;  ///< Green channel component
+    uint8_t b;  ///< Blue channel component
+} OBColorPointInt16, ob_color_point_int16;
+
+/**
+ * @brief 3D point structure with half precision float coordinates and 8-bit color information
+ */
+typedef struct {
+    uint16_t x;  ///< X coordinate
+    uint16_t y;  ///< Y coordinate
+    uint16_t z;  ///< Z coordinate
+    uint8_t  r;  ///< Red channel component
+    uint8_t  g;  ///< Green channel component
+    uint8_t  b;  ///< Blue channel component
+} OBColorPointHalf, ob_color_point_half;
+
 /**
  * @brief Compression mode
  */
@@ -1123,6 +1169,44 @@ typedef enum {
     OBFrameAggregateOutputMode, ob_frame_aggregate_output_mode;
 #define OB_FRAME_AGGREGATE_OUTPUT_FULL_FRAME_REQUIRE OB_FRAME_AGGREGATE_OUTPUT_ALL_TYPE_FRAME_REQUIRE
 
+/**
+ * @brief The timestamp used by the pipeline to synchronize the frames of different streams
+ */
+typedef enum {
+    /**
+     * @brief Device timestamp if all sensors of the device use the same clock, otherwise system timestamp (default)
+     */
+    OB_FRAME_SYNC_TIMESTAMP_AUTO = 0,
+
+    /**
+     * @brief Device timestamp (see @ref ob_frame_get_timestamp_us)
+     */
+    OB_FRAME_SYNC_TIMESTAMP_DEVICE = 1,
+
+    /**
+     * @brief Global timestamp (see @ref ob_frame_get_global_timestamp_us)
+     *
+     * @attention The global timestamp must be enabled on the device by @ref ob_device_enable_global_timestamp
+     */
+    OB_FRAME_SYNC_TIMESTAMP_GLOBAL = 2,
+
+    /**
+     * @brief System timestamp (see @ref ob_frame_get_system_timestamp_us)
+     */
+    OB_FRAME_SYNC_TIMESTAMP_SYSTEM = 3,
+} ob_frame_sync_timestamp_type,
+    OBFrameSyncTimestampType;
+
+/**
+ * @brief Frame synchronization statistics of a stream in the pipeline
+ */
+typedef struct {
+    uint64_t matchedFrameCount;      ///< Frames output in a frameset together with frames of other streams
+    uint64_t unmatchedFrameCount;    ///< Frames output in a frameset without frames of other streams
+    uint64_t droppedFrameCount;      ///< Frames dropped because the frameset did not meet the frame aggregate output mode, or because the queue was full
+    uint64_t maxMatchedTspDiffUsec;  ///< Max timestamp difference of the matched frames to the oldest frame of their frameset, in microseconds
+} ob_frame_sync_stats, OBFrameSyncStats;
+
 /**
  * @brief Enumeration of point cloud coordinate system types
  */
@@ -1396,6 +1480,19 @@ typedef struct {
     char numberStr[16];
 } OBDeviceSerialNumber, ob_device_serial_number, OBSerialNumber, ob_serial_number;
 
+/**
+ * @brief Occupancy of a frame buffer manager in the internal frame memory pool
+ * @brief Each frame buffer manager caches the buffers of one frame type and frame data size.
+ */
+typedef struct {
+    ob_frame_type frame_type;         ///< Frame type of the buffers
+    uint32_t      frame_buffer_size;  ///< Frame data size of each buffer, unit: byte
+    uint32_t      allocated_count;    ///< Number of buffers currently allocated, in use or idle
+    uint32_t      idle_count;         ///< Number of idle buffers cached for reuse
+    uint64_t      hit_count;          ///< Number of frames created from an idle buffer
+    uint64_t      miss_count;         ///< Number of frames created from a newly allocated buffer
+} ob_frame_buffer_manager_usage, OBFrameBufferManagerUsage;
+
 /**
  * @brief Frame metadata types
  * @brief The frame metadata is a set of meta info generated by the device for current individual frame.
@@ -143,6 +143,16 @@ OB_EXPORT void ob_pipeline_enable_frame_sync(ob_pipeline *pipeline, ob_error **e
  */
 OB_EXPORT void ob_pipeline_disable_frame_sync(ob_pipeline *pipeline, ob_error **error);
 
+/**
+ * @brief Get the frame synchronization statistics of a stream since the pipeline was started
+ *
+ * @param[in] pipeline The pipeline object
+ * @param[in] stream_type The stream type, which must be enabled in the configuration of the started pipeline
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ * @return ob_frame_sync_stats The frame synchronization statistics of the stream
+ */
+OB_EXPORT ob_frame_sync_stats ob_pipeline_get_frame_sync_stats(const ob_pipeline *pipeline, ob_stream_type stream_type, ob_error **error);
+
 /**
  * @brief Return a list of D2C-enabled depth sensor resolutions corresponding to the input color sensor resolution
  *
@@ -289,6 +299,28 @@ OB_EXPORT void ob_config_set_depth_scale_after_align_require(ob_config *config,
  */
 OB_EXPORT void ob_config_set_frame_aggregate_output_mode(ob_config *config, ob_frame_aggregate_output_mode mode, ob_error **error);
 
+/**
+ * @brief Set the timestamp used to synchronize the frames of different streams when frame synchronization is enabled
+ *
+ * @param[in] config The pipeline configuration object
+ * @param[in] type The timestamp type (default type is @ref OB_FRAME_SYNC_TIMESTAMP_AUTO)
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ */
+OB_EXPORT void ob_config_set_frame_sync_timestamp_type(ob_config *config, ob_frame_sync_timestamp_type type, ob_error **error);
+
+/**
+ * @brief Set the max timestamp difference of the frames of two streams to be synchronized into the same frameset
+ * @brief By default, the tolerance is half of the frame interval of the stream with the higher frame rate.
+ *
+ * @param[in] config The pipeline configuration object
+ * @param[in] stream_type_1 The first stream type
+ * @param[in] stream_type_2 The second stream type
+ * @param[in] tolerance_us The tolerance in microseconds, 0 to restore the default tolerance
+ * @param[out] error Pointer to an error object that will be set if an error occurs.
+ */
+OB_EXPORT void ob_config_set_frame_sync_tolerance(ob_config *config, ob_stream_type stream_type_1, ob_stream_type stream_type_2, uint32_t tolerance_us,
+                                                  ob_error **error);
+
 /**
  * @brief Get current camera parameters
  * @attention If D2C is enabled, it will return the camera parameters after D2C, if not, it will return to the default parameters
@@ -10,8 +10,10 @@
 #include "Types.hpp"
 #include "Error.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace ob {
 
@@ -141,6 +143,27 @@ public:
         Error::handle(&error);
     }
 
+    /**
+     * @brief Get the occupancy of each frame buffer manager in the internal frame memory pool.
+     * @brief Each frame buffer manager caches the buffers of one frame type and frame data size.
+     *
+     * @return std::vector<OBFrameBufferManagerUsage> The occupancy of the frame buffer managers.
+     */
+    std::vector<OBFrameBufferManagerUsage> getFrameMemoryPoolUsage() const {
+        ob_error *error = nullptr;
+        uint32_t  count = 0;
+        ob_get_frame_memory_pool_usage(impl_, nullptr, &count, &error);
+        Error::handle(&error);
+
+        std::vector<OBFrameBufferManagerUsage> usageList(count);
+        if(count > 0) {
+            ob_get_frame_memory_pool_usage(impl_, usageList.data(), &count, &error);
+            Error::handle(&error);
+            usageList.resize(std::min(count, static_cast<uint32_t>(usageList.size())));
+        }
+        return usageList;
+    }
+
     /**
      * @brief Set the level of the global log, which affects both the log level output to the console, output to the file and output the user defined callback.
      *
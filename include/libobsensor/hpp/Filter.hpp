@@ -334,6 +334,9 @@ public:
 
 /**
  * @brief The PointCloudFilter class is a subclass of Filter that generates point clouds.
+ *
+ * @brief For the formats with colors, the color frame of the frameset does not need to be aligned to the depth frame by an Align filter first: the
+ * depth pixels are mapped to the color frame as the points are computed, as the alignment to the depth stream would do.
  */
 class PointCloudFilter : public Filter {
 public:
@@ -349,7 +352,11 @@ public:
     /**
      * @brief Set the output pointcloud frame format.
      *
-     * @param type The point cloud frame format: OB_FORMAT_POINT or OB_FORMAT_RGB_POINT
+     * @brief The 16-bit formats (OB_FORMAT_POINT_INT16, OB_FORMAT_POINT_HALF, OB_FORMAT_RGB_POINT_INT16 and OB_FORMAT_RGB_POINT_HALF) take half or less
+     * of the memory of the float formats. Their coordinates are scaled by the coordinate data scale as for the float formats, and their colors are not
+     * normalized.
+     *
+     * @param type The point cloud frame format: OB_FORMAT_POINT, OB_FORMAT_RGB_POINT or one of their 16-bit variants
      */
     void setCreatePointFormat(OBFormat format) {
         setConfigValue("pointFormat", static_cast<double>(format));
@@ -379,6 +386,17 @@ public:
         setConfigValue("colorDataNormalization", state);
     }
 
+    /**
+     * @brief Set whether the output point cloud frame only contains the valid points.
+     * @brief By default the point cloud is organized: one point per depth pixel, with the invalid ones set to zero. If only the valid points are
+     * output, the points of zero and invalid depth are left out and the number of points is the data size of the frame divided by the point size.
+     *
+     * @param state Whether only the valid points are output.
+     */
+    void setValidPointsOnly(bool state) {
+        setConfigValue("validPointsOnly", state);
+    }
+
     /**
      * @brief Set the point cloud coordinate system.
      *
@@ -18,9 +18,9 @@
  *  Frame classis inheritance hierarchy：
  *         Frame
  *          |
- *      +-----------+----------+----------+-----------+
- *      |           |          |          |           |
- *   VideoFrame PointsFrame AccelFrame GyroFrame   FrameSet
+ *      +-----------+----------+----------+-----------+-------------+
+ *      |           |          |          |           |             |
+ *   VideoFrame PointsFrame AccelFrame GyroFrame   FrameSet   ImuBatchFrame
  *        |
  *   +----+----------+-------------------+
  *   |               |                   |
@@ -287,6 +287,19 @@ public:
         return std::make_shared<Device>(device);
     }
 
+    /**
+     * @brief Check if the frame is an IMU batch frame holding several accelerometer or gyroscope samples, see @ref ImuBatchFrame.
+     *
+     * @return bool The result.
+     */
+    bool isImuBatch() const {
+        ob_error *error   = nullptr;
+        auto      isBatch = ob_frame_is_imu_batch(impl_, &error);
+        Error::handle(&error);
+
+        return isBatch;
+    }
+
     /**
      * @brief Check if the runtime type of the frame object is compatible with a given type.
      *
@@ -557,6 +570,10 @@ public:
  * @note The pointcloud data format can be obtained from the @ref Frame::getFormat() function. Witch can be one of the following formats:
  * - @ref OB_FORMAT_POINT: 32-bit float format with 3D point coordinates (x, y, z), @ref OBPoint
  * - @ref OB_FORMAT_RGB_POINT: 32-bit float format with 3D point coordinates (x, y, z) and point colors (r, g, b) @ref, OBColorPoint
+ * - @ref OB_FORMAT_POINT_INT16: 16-bit integer format with 3D point coordinates (x, y, z), @ref OBPointInt16
+ * - @ref OB_FORMAT_POINT_HALF: 16-bit half float format with 3D point coordinates (x, y, z), @ref OBPointHalf
+ * - @ref OB_FORMAT_RGB_POINT_INT16: 16-bit integer format with 3D point coordinates (x, y, z) and 8-bit point colors (r, g, b), @ref OBColorPointInt16
+ * - @ref OB_FORMAT_RGB_POINT_HALF: 16-bit half float format with 3D point coordinates (x, y, z) and 8-bit point colors (r, g, b), @ref OBColorPointHalf
  */
 class PointsFrame : public Frame {
 
@@ -690,6 +707,73 @@ public:
     }
 };
 
+/**
+ * @brief Define the ImuBatchFrame class, which inherits from the Frame class
+ * @brief It holds all samples of an accelerometer or gyroscope stream that were received in one packet, see @ref ob_frame_is_imu_batch. The values
+ * of each axis, the timestamps and the temperatures of the samples are stored in separate contiguous arrays.
+ */
+class ImuBatchFrame : public Frame {
+
+public:
+    explicit ImuBatchFrame(const ob_frame *impl) : Frame(impl) {};
+
+    ~ImuBatchFrame() noexcept override = default;
+
+    /**
+     * @brief Get the number of samples
+     *
+     * @return uint32_t The number of samples
+     */
+    uint32_t getSampleCount() const {
+        ob_error *error = nullptr;
+        auto      count = ob_imu_batch_frame_get_sample_count(impl_, &error);
+        Error::handle(&error);
+
+        return count;
+    }
+
+    /**
+     * @brief Get the device timestamps of the samples
+     *
+     * @return const uint64_t * The timestamps in microseconds, the array size is the sample count
+     * @attention These are device timestamps, only the first sample has a system and a global timestamp, see @ref ob_frame_is_imu_batch
+     */
+    const uint64_t *getTimestamps() const {
+        ob_error *error      = nullptr;
+        auto      timestamps = ob_imu_batch_frame_get_timestamps(impl_, &error);
+        Error::handle(&error);
+
+        return timestamps;
+    }
+
+    /**
+     * @brief Get the values of one axis of the samples
+     *
+     * @param axis The axis, 0: x, 1: y, 2: z
+     * @return const float * The values in g for accelerometer frames and in dps for gyroscope frames, the array size is the sample count
+     */
+    const float *getValues(uint32_t axis) const {
+        ob_error *error  = nullptr;
+        auto      values = ob_imu_batch_frame_get_values(impl_, axis, &error);
+        Error::handle(&error);
+
+        return values;
+    }
+
+    /**
+     * @brief Get the temperatures of the samples
+     *
+     * @return const float * The temperatures in celsius, the array size is the sample count
+     */
+    const float *getTemperatures() const {
+        ob_error *error        = nullptr;
+        auto      temperatures = ob_imu_batch_frame_get_temperatures(impl_, &error);
+        Error::handle(&error);
+
+        return temperatures;
+    }
+};
+
 /**
  * @brief Define the FrameSet class, which inherits from the Frame class
  * @brief A FrameSet is a container for multiple frames of different types.
@@ -1005,8 +1089,14 @@ template <typename T> bool Frame::is() const {
     case OB_FRAME_COLOR:
         return (typeid(T) == typeid(ColorFrame) || typeid(T) == typeid(VideoFrame));
     case OB_FRAME_GYRO:
+        if(isImuBatch()) {
+            return (typeid(T) == typeid(ImuBatchFrame));
+        }
         return (typeid(T) == typeid(GyroFrame));
     case OB_FRAME_ACCEL:
+        if(isImuBatch()) {
+            return (typeid(T) == typeid(ImuBatchFrame));
+        }
         return (typeid(T) == typeid(AccelFrame));
     case OB_FRAME_POINTS:
         return (typeid(T) == typeid(PointsFrame));
@@ -241,6 +241,31 @@ public:
         ob_config_set_frame_aggregate_output_mode(impl_, mode, &error);
         Error::handle(&error);
     }
+
+    /**
+     * @brief Set the timestamp used to synchronize the frames of different streams when frame synchronization is enabled
+     *
+     * @param type The timestamp type (default type is @ref OB_FRAME_SYNC_TIMESTAMP_AUTO)
+     */
+    void setFrameSyncTimestampType(OBFrameSyncTimestampType type) const {
+        ob_error *error = nullptr;
+        ob_config_set_frame_sync_timestamp_type(impl_, type, &error);
+        Error::handle(&error);
+    }
+
+    /**
+     * @brief Set the max timestamp difference of the frames of two streams to be synchronized into the same frameset
+     * @brief By default, the tolerance is half of the frame interval of the stream with the higher frame rate.
+     *
+     * @param streamType1 The first stream type
+     * @param streamType2 The second stream type
+     * @param toleranceUsec The tolerance in microseconds, 0 to restore the default tolerance
+     */
+    void setFrameSyncTolerance(OBStreamType streamType1, OBStreamType streamType2, uint32_t toleranceUsec) const {
+        ob_error *error = nullptr;
+        ob_config_set_frame_sync_tolerance(impl_, streamType1, streamType2, toleranceUsec, &error);
+        Error::handle(&error);
+    }
 };
 
 class Pipeline {
@@ -416,6 +441,19 @@ public:
         Error::handle(&error);
     }
 
+    /**
+     * @brief Get the frame synchronization statistics of a stream since the pipeline was started
+     *
+     * @param streamType The stream type, which must be enabled in the configuration of the started pipeline
+     * @return OBFrameSyncStats The frame synchronization statistics of the stream
+     */
+    OBFrameSyncStats getFrameSyncStats(OBStreamType streamType) const {
+        ob_error *error = nullptr;
+        auto      stats = ob_pipeline_get_frame_sync_stats(impl_, streamType, &error);
+        Error::handle(&error);
+        return stats;
+    }
+
 public:
     // The following interfaces are deprecated and are retained here for compatibility purposes.
 
@@ -2,19 +2,10 @@
 #include "logger/Logger.hpp"
 #include "utils/Utils.hpp"
 #include "stream/StreamProfile.hpp"
-#include "frame/FrameMemoryPool.hpp"
-#include "frame/FrameBufferManager.hpp"
 
-namespace libobsensor {
-
-FrameBackendLifeSpan::FrameBackendLifeSpan()
-    : logger_(Logger::getInstance()), memoryPool_(FrameMemoryPool::getInstance()), memoryAllocator_(FrameMemoryAllocator::getInstance()) {}
+#include <cstring>
 
-FrameBackendLifeSpan::~FrameBackendLifeSpan() {
-    memoryAllocator_.reset();
-    memoryPool_.reset();
-    logger_.reset();
-}
+namespace libobsensor {
 
 Frame::Frame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferReclaimFunc bufferReclaimFunc)
     : dataSize_(dataBufSize),
@@ -26,6 +17,7 @@ Frame::Frame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferRec
       metadataPhasers_(nullptr),
       streamProfile_(nullptr),
       type_(type),
+      kind_(KIND),
       frameData_(data),
       dataBufSize_(dataBufSize),
       bufferReclaimFunc_(bufferReclaimFunc) {}
@@ -242,7 +234,9 @@ size_t Frame::getDataBufSize() const {
 }
 
 VideoFrame::VideoFrame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferReclaimFunc bufferReclaimFunc)
-    : Frame(data, dataBufSize, type, bufferReclaimFunc), pixelType_(OB_PIXEL_UNKNOWN), availablePixelBitSize_(0) {}
+    : Frame(data, dataBufSize, type, bufferReclaimFunc), pixelType_(OB_PIXEL_UNKNOWN), availablePixelBitSize_(0) {
+    kind_ |= KIND;
+}
 
 void VideoFrame::setPixelType(OBPixelType pixelType) {
     pixelType_ = pixelType;
@@ -253,7 +247,9 @@ OBPixelType VideoFrame::getPixelType() const {
 }
 
 VideoFrame::VideoFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : Frame(data, dataBufSize, OB_FRAME_VIDEO, bufferReclaimFunc), pixelType_(OB_PIXEL_UNKNOWN), availablePixelBitSize_(0) {}
+    : Frame(data, dataBufSize, OB_FRAME_VIDEO, bufferReclaimFunc), pixelType_(OB_PIXEL_UNKNOWN), availablePixelBitSize_(0) {
+    kind_ |= KIND;
+}
 
 uint8_t VideoFrame::getPixelAvailableBitSize() const {
     if(availablePixelBitSize_ == 0) {
@@ -278,10 +274,13 @@ void VideoFrame::copyInfoFromOther(std::shared_ptr<const Frame> sourceFrame) {
 }
 
 ColorFrame::ColorFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : VideoFrame(data, dataBufSize, OB_FRAME_COLOR, bufferReclaimFunc) {}
+    : VideoFrame(data, dataBufSize, OB_FRAME_COLOR, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
 
 DepthFrame::DepthFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
     : VideoFrame(data, dataBufSize, OB_FRAME_DEPTH, bufferReclaimFunc), valueScale_(1.0f) {
+    kind_ |= KIND;
     setPixelType(OB_PIXEL_DEPTH);  // set default pixel type to OB_PIXEL_DEPTH
 }
 
@@ -302,16 +301,24 @@ void DepthFrame::copyInfoFromOther(std::shared_ptr<const Frame> sourceFrame) {
 }
 
 IRFrame::IRFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc, OBFrameType frameType)
-    : VideoFrame(data, dataBufSize, frameType, bufferReclaimFunc) {}
+    : VideoFrame(data, dataBufSize, frameType, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
 
 IRLeftFrame::IRLeftFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : IRFrame(data, dataBufSize, bufferReclaimFunc, OB_FRAME_IR_LEFT) {}
+    : IRFrame(data, dataBufSize, bufferReclaimFunc, OB_FRAME_IR_LEFT) {
+    kind_ |= KIND;
+}
 
 IRRightFrame::IRRightFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : IRFrame(data, dataBufSize, bufferReclaimFunc, OB_FRAME_IR_RIGHT) {}
+    : IRFrame(data, dataBufSize, bufferReclaimFunc, OB_FRAME_IR_RIGHT) {
+    kind_ |= KIND;
+}
 
 PointsFrame::PointsFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : Frame(data, dataBufSize, OB_FRAME_POINTS, bufferReclaimFunc) {}
+    : Frame(data, dataBufSize, OB_FRAME_POINTS, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
 
 void PointsFrame::setCoordinateValueScale(float valueScale) {
     coordValueScale_ = valueScale;
@@ -322,7 +329,9 @@ float PointsFrame::getCoordinateValueScale() const {
 }
 
 AccelFrame::AccelFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : Frame(data, dataBufSize, OB_FRAME_ACCEL, bufferReclaimFunc) {}
+    : Frame(data, dataBufSize, OB_FRAME_ACCEL, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
 
 OBAccelValue AccelFrame::value() {
     return *(OBAccelValue *)getData();
@@ -333,7 +342,9 @@ float AccelFrame::temperature() {
 }
 
 GyroFrame::GyroFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
-    : Frame(data, dataBufSize, OB_FRAME_GYRO, bufferReclaimFunc) {}
+    : Frame(data, dataBufSize, OB_FRAME_GYRO, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
 
 OBGyroValue GyroFrame ::value() {
     return *(OBGyroValue *)getData();
@@ -343,7 +354,83 @@ float GyroFrame ::temperature() {
     return ((GyroFrame::Data *)getData())->temp;
 }
 
-FrameSet::FrameSet(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc) : Frame(data, dataBufSize, OB_FRAME_SET, bufferReclaimFunc) {}
+// Data layout: Header | uint64_t timestamps[capacity] | float x[capacity] | float y[capacity] | float z[capacity] | float temperatures[capacity]
+static const size_t IMU_BATCH_SAMPLE_SIZE = sizeof(uint64_t) + 4 * sizeof(float);
+
+size_t ImuBatchFrame::calcDataSize(uint32_t capacity) {
+    return sizeof(Header) + capacity * IMU_BATCH_SAMPLE_SIZE;
+}
+
+ImuBatchFrame::ImuBatchFrame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferReclaimFunc bufferReclaimFunc)
+    : Frame(data, dataBufSize, type, bufferReclaimFunc), capacity_(0) {
+    kind_ |= KIND;
+    if(dataBufSize >= sizeof(Header)) {
+        capacity_ = static_cast<uint32_t>((dataBufSize - sizeof(Header)) / IMU_BATCH_SAMPLE_SIZE);
+        // The data buffer is not zero-filled by the frame memory allocator
+        memset(getDataMutable(), 0, sizeof(Header));
+    }
+}
+
+uint32_t ImuBatchFrame::getCapacity() const {
+    return capacity_;
+}
+
+uint32_t ImuBatchFrame::getSampleCount() const {
+    return capacity_ > 0 ? ((const Header *)getData())->sampleCount : 0;
+}
+
+void ImuBatchFrame::setSampleCount(uint32_t sampleCount) {
+    if(sampleCount > capacity_) {
+        throw invalid_value_exception("sample count exceeds the capacity of the imu batch frame");
+    }
+    ((Header *)getDataMutable())->sampleCount = sampleCount;
+}
+
+const uint64_t *ImuBatchFrame::getTimestamps() const {
+    return getTimestampsMutable();
+}
+
+uint64_t *ImuBatchFrame::getTimestampsMutable() const {
+    return (uint64_t *)(getDataMutable() + sizeof(Header));
+}
+
+const float *ImuBatchFrame::getValues(uint32_t axis) const {
+    return getValuesMutable(axis);
+}
+
+float *ImuBatchFrame::getValuesMutable(uint32_t axis) const {
+    if(axis > 2) {
+        throw invalid_value_exception("invalid imu axis: " + std::to_string(axis));
+    }
+    return (float *)(getTimestampsMutable() + capacity_) + axis * capacity_;
+}
+
+const float *ImuBatchFrame::getTemperatures() const {
+    return getTemperaturesMutable();
+}
+
+float *ImuBatchFrame::getTemperaturesMutable() const {
+    return (float *)(getTimestampsMutable() + capacity_) + 3 * capacity_;
+}
+
+AccelBatchFrame::AccelBatchFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
+    : ImuBatchFrame(data, dataBufSize, OB_FRAME_ACCEL, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
+
+GyroBatchFrame::GyroBatchFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc)
+    : ImuBatchFrame(data, dataBufSize, OB_FRAME_GYRO, bufferReclaimFunc) {
+    kind_ |= KIND;
+}
+
+FrameSet::FrameSet(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc) : Frame(data, dataBufSize, OB_FRAME_SET, bufferReclaimFunc) {
+    kind_ |= KIND;
+    // The frame slots live in the data buffer, which is not zero-filled by the frame memory allocator, so they must be constructed here
+    foreachFrame([](void *item) {
+        new(item) std::shared_ptr<const Frame>();
+        return false;
+    });
+}
 
 FrameSet::~FrameSet() noexcept {
     clearAllFrame();
@@ -12,23 +12,10 @@
 #include <mutex>
 #include <vector>
 #include <typeinfo>
+#include <type_traits>
 
 namespace libobsensor {
 
-class logger;
-class FrameMemoryPool;
-class FrameMemoryAllocator;
-class FrameBackendLifeSpan {
-public:
-    FrameBackendLifeSpan();
-    ~FrameBackendLifeSpan();
-
-private:
-    std::shared_ptr<Logger>               logger_;
-    std::shared_ptr<FrameMemoryPool>      memoryPool_;
-    std::shared_ptr<FrameMemoryAllocator> memoryAllocator_;
-};
-
 class FrameSet;
 class PointsFrame;
 class VideoFrame;
@@ -41,8 +28,13 @@ class GyroFrame;
 
 using FrameBufferReclaimFunc = std::function<void(void)>;
 
-class Frame : public std::enable_shared_from_this<Frame>, private FrameBackendLifeSpan {
+// The lifetime of the logger and frame memory backend is pinned by FrameBufferManager (which owns the memory of pool frames), not per frame.
+class Frame : public std::enable_shared_from_this<Frame> {
 public:
+    // Class kind bit; the kind mask of an object holds the bits of its class and all of its base classes, so is()/as() are constant-time
+    // bit tests instead of RTTI casts. Each subclass must define its own KIND (including its base class's KIND) and add it in its constructor.
+    static constexpr uint32_t KIND = 0x0001;
+
     Frame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
     Frame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
     virtual ~Frame() noexcept;
@@ -82,26 +74,37 @@ public:
     virtual void copyInfoFromOther(std::shared_ptr<const Frame> otherFrame);
 
     template <typename T> bool is() const {
-        return std::dynamic_pointer_cast<const T>(shared_from_this()) != nullptr;
+        return (kind_ & std::remove_const<T>::type::KIND) == std::remove_const<T>::type::KIND;
     }
 
-    // template <typename T> bool               is(){
-    //     return std::dynamic_pointer_cast<T>(shared_from_this()) != nullptr;
-    // }
-
     template <typename T> std::shared_ptr<T> as() {
         if(!is<T>()) {
             throw unsupported_operation_exception("unsupported operation, object's type is not require type");
         }
 
-        return std::dynamic_pointer_cast<T>(shared_from_this());
+        return std::static_pointer_cast<T>(shared_from_this());
     }
 
     template <typename T> std::shared_ptr<const T> as() const {
         if(!is<const T>())
             throw unsupported_operation_exception("unsupported operation, object's type is not require type");
 
-        return std::dynamic_pointer_cast<const T>(shared_from_this());
+        return std::static_pointer_cast<const T>(shared_from_this());
+    }
+
+    // Same as as(), but does not touch the reference count; use it when the caller does not need to share the ownership of the frame
+    template <typename T> T &asRef() {
+        if(!is<T>()) {
+            throw unsupported_operation_exception("unsupported operation, object's type is not require type");
+        }
+        return static_cast<T &>(*this);
+    }
+
+    template <typename T> const T &asRef() const {
+        if(!is<const T>()) {
+            throw unsupported_operation_exception("unsupported operation, object's type is not require type");
+        }
+        return static_cast<const T &>(*this);
     }
 
 protected:
@@ -119,6 +122,7 @@ protected:
     std::shared_ptr<const StreamProfile>           streamProfile_;
 
     const OBFrameType type_;  // Determined during construction, it is an inherent property of the object and cannot be changed.
+    uint32_t          kind_;  // KIND bits of the object's class hierarchy, set during construction
 
 private:
     uint8_t const         *frameData_;
@@ -128,6 +132,8 @@ private:
 
 class VideoFrame : public Frame {
 public:
+    static constexpr uint32_t KIND = Frame::KIND | 0x0002;
+
     VideoFrame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
     VideoFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 
@@ -153,11 +159,15 @@ protected:
 
 class ColorFrame : public VideoFrame {
 public:
+    static constexpr uint32_t KIND = VideoFrame::KIND | 0x0004;
+
     ColorFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 };
 
 class DepthFrame : public VideoFrame {
 public:
+    static constexpr uint32_t KIND = VideoFrame::KIND | 0x0008;
+
     DepthFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 
     void  setValueScale(float valueScale);
@@ -171,21 +181,29 @@ private:
 
 class IRFrame : public VideoFrame {
 public:
+    static constexpr uint32_t KIND = VideoFrame::KIND | 0x0010;
+
     IRFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr, OBFrameType frameType = OB_FRAME_IR);
 };
 
 class IRLeftFrame : public IRFrame {
 public:
+    static constexpr uint32_t KIND = IRFrame::KIND | 0x0020;
+
     IRLeftFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 };
 
 class IRRightFrame : public IRFrame {
 public:
+    static constexpr uint32_t KIND = IRFrame::KIND | 0x0040;
+
     IRRightFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 };
 
 class PointsFrame : public Frame {
 public:
+    static constexpr uint32_t KIND = Frame::KIND | 0x0080;
+
     PointsFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 
     void  setCoordinateValueScale(float valueScale);
@@ -205,6 +223,8 @@ public:
 #pragma pack(pop)
 
 public:
+    static constexpr uint32_t KIND = Frame::KIND | 0x0100;
+
     AccelFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 
     OBAccelValue value();
@@ -221,16 +241,74 @@ public:
 #pragma pack(pop)
 
 public:
+    static constexpr uint32_t KIND = Frame::KIND | 0x0200;
+
     GyroFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
 
     OBGyroValue value();
     float       temperature();
 };
 
+// The IMU samples of one stream that arrived in one packet, stored as structure of arrays: the timestamps, the x, y and z values and the
+// temperatures of all samples are each contiguous, so that they can be processed in one pass. The frame type is OB_FRAME_ACCEL or OB_FRAME_GYRO,
+// the frame timestamp and number are those of the first sample. Only the device timestamps are stored per sample, the system and global timestamps
+// of the frame are those of the first sample.
+class ImuBatchFrame : public Frame {
+public:
+#pragma pack(push, 1)
+    typedef struct {
+        uint32_t sampleCount;
+        uint32_t reserved;
+    } Header;
+#pragma pack(pop)
+
+public:
+    static constexpr uint32_t KIND = Frame::KIND | 0x0800;
+
+    static size_t calcDataSize(uint32_t capacity);
+
+    ImuBatchFrame(uint8_t *data, size_t dataBufSize, OBFrameType type, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
+
+    uint32_t getCapacity() const;
+    uint32_t getSampleCount() const;
+    void     setSampleCount(uint32_t sampleCount);
+
+    // Device timestamps of the samples, unit: microseconds
+    const uint64_t *getTimestamps() const;
+    uint64_t       *getTimestampsMutable() const;
+
+    // axis: 0-x, 1-y, 2-z; unit: g for accel frames (9.80665 m/s^2), dps for gyro frames
+    const float *getValues(uint32_t axis) const;
+    float       *getValuesMutable(uint32_t axis) const;
+
+    // Temperatures in Celsius
+    const float *getTemperatures() const;
+    float       *getTemperaturesMutable() const;
+
+private:
+    uint32_t capacity_;
+};
+
+class AccelBatchFrame : public ImuBatchFrame {
+public:
+    static constexpr uint32_t KIND = ImuBatchFrame::KIND | 0x1000;
+
+    AccelBatchFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
+};
+
+class GyroBatchFrame : public ImuBatchFrame {
+public:
+    static constexpr uint32_t KIND = ImuBatchFrame::KIND | 0x2000;
+
+    GyroBatchFrame(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
+};
+
 class FrameSet : public Frame {
     typedef std::function<bool(void *)> ForeachBack;
 
 public:
+    static constexpr uint32_t KIND = Frame::KIND | 0x0400;
+
     FrameSet(uint8_t *data, size_t dataBufSize, FrameBufferReclaimFunc bufferReclaimFunc = nullptr);
     ~FrameSet() noexcept;
 
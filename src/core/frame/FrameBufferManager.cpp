@@ -5,11 +5,15 @@
 #include "exception/ObException.hpp"
 #include "logger/Logger.hpp"
 
+#include <cstring>
+
 namespace libobsensor {
 
 #define DEFAULT_MAX_FRAME_MEMORY_SIZE ((uint64_t)2 * 1024 * 1024 * 1024)  // 2GB
+#define DEFAULT_HUGE_PAGE_ARENA_SIZE_MB 64
 
-FrameMemoryAllocator::FrameMemoryAllocator() : maxSizeInByte_(DEFAULT_MAX_FRAME_MEMORY_SIZE), usedSize_(0), logger_(Logger::getInstance()) {
+FrameMemoryAllocator::FrameMemoryAllocator()
+    : maxSizeInByte_(DEFAULT_MAX_FRAME_MEMORY_SIZE), usedSize_(0), prefaultedSize_(0), logger_(Logger::getInstance()) {
     auto envConfig = EnvConfig::getInstance();
 
     if(envConfig->isNodeContained("Memory.MaxFrameBufferSize")) {
@@ -21,10 +25,32 @@ FrameMemoryAllocator::FrameMemoryAllocator() : maxSizeInByte_(DEFAULT_MAX_FRAME_
         }
         maxSizeInByte_ = static_cast<uint64_t>(frameBufferSize) * 1024 * 1024;  // MB to Byte
     }
-    LOG_DEBUG("FrameMemoryAllocator created! The max frame memory size has been set to {:.3f}MB", byteToMB(maxSizeInByte_));
+
+    std::string backend;
+    if(envConfig->getStringValue("Memory.FrameBufferBackend", backend) && backend == "HugePage") {
+        if(HugePageArenaPool::isSupported()) {
+            int arenaSize = DEFAULT_HUGE_PAGE_ARENA_SIZE_MB;
+            if(envConfig->getIntValue("Memory.HugePageArenaSize", arenaSize) && arenaSize < 2) {
+                LOG_WARN("The huge page arena size you set is too small, will set to 2MB instead");
+                arenaSize = 2;
+            }
+            int numaNode = -1;
+            envConfig->getIntValue("Memory.NumaNode", numaNode);
+            // the arenas count against the max frame memory size as a whole, the buffers carved out of them are not counted again
+            hugePageArenaPool_.reset(new HugePageArenaPool(
+                static_cast<size_t>(arenaSize) * 1024 * 1024, numaNode, [this](size_t size) { return reserveMemory(size); },
+                [this](size_t size) { usedSize_ -= size; }));
+        }
+        else {
+            LOG_WARN("Huge page frame buffer backend is not supported on this platform, will use heap instead");
+        }
+    }
+    LOG_DEBUG("FrameMemoryAllocator created! The max frame memory size has been set to {:.3f}MB, backend={}", byteToMB(maxSizeInByte_),
+              hugePageArenaPool_ ? "HugePage" : "Heap");
 }
 
 FrameMemoryAllocator::~FrameMemoryAllocator() noexcept {
+    hugePageArenaPool_.reset();  // releases the arenas
     if(usedSize_ > 0) {
         LOG_WARN("FrameMemoryAllocator destroyed while still has memory used! usedSize={0:.3f}MB", byteToMB(usedSize_));
     }
@@ -43,111 +69,260 @@ std::shared_ptr<FrameMemoryAllocator> FrameMemoryAllocator::getInstance() {
 }
 
 void FrameMemoryAllocator::setMaxFrameMemorySize(uint64_t sizeInMb) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    maxSizeInByte_ = sizeInMb * 1024 * 1024;
-    if(maxSizeInByte_ < usedSize_) {
-        LOG_WARN("The max frame memory size you set is {:.3f}MB,  less than the current used size, will set to {:.3f}MB instead", byteToMB(maxSizeInByte_),
-                 byteToMB(usedSize_));
+    uint64_t maxSizeInByte = sizeInMb * 1024 * 1024;
+    uint64_t usedSize      = usedSize_;
+    if(maxSizeInByte < usedSize) {
+        LOG_WARN("The max frame memory size you set is {:.3f}MB,  less than the current used size, will set to {:.3f}MB instead", byteToMB(maxSizeInByte),
+                 byteToMB(usedSize));
     }
     if(sizeInMb < 100) {  // 100 MB
         LOG_WARN("The size you is less than 100MB, size={:.3f}MB, will set to 100MB instead", (double)sizeInMb);
-        maxSizeInByte_ = 100 * 1024 * 1024;
+        maxSizeInByte = 100 * 1024 * 1024;
     }
-    LOG_DEBUG("FrameMemoryAllocator max frame memory size has been set to {:.3f}MB", byteToMB(maxSizeInByte_));
+    maxSizeInByte_ = maxSizeInByte;
+    LOG_DEBUG("FrameMemoryAllocator max frame memory size has been set to {:.3f}MB", byteToMB(maxSizeInByte));
+}
+
+bool FrameMemoryAllocator::reserveMemory(uint64_t size) {
+    uint64_t usedSize = usedSize_.load();
+    do {
+        if(usedSize + size > maxSizeInByte_) {
+            LOG_WARN("FrameMemoryAllocator out of memory! require={0:.3f}MB, total usage: allocated={1:.3f}MB, max limit={2:.3f}MB", byteToMB(size),
+                     byteToMB(usedSize), byteToMB(maxSizeInByte_));
+            return false;
+        }
+    } while(!usedSize_.compare_exchange_weak(usedSize, usedSize + size));
+    return true;
 }
 
 uint8_t *FrameMemoryAllocator::allocate(size_t size) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if(usedSize_ + size > maxSizeInByte_) {
-        LOG_WARN("FrameMemoryAllocator out of memory! require={0:.3f}MB, total usage: allocated={1:.3f}MB, max limit={2:.3f}MB", byteToMB(size),
-                 byteToMB(usedSize_), byteToMB(maxSizeInByte_));
-        return nullptr;
+    // The buffer is not zero-filled: frame data is always written by the producer before use, and buffers recycled by FrameBufferManager are
+    // not cleared either.
+    void *ptr = nullptr;
+    if(hugePageArenaPool_) {
+        ptr = hugePageArenaPool_->allocate(size);  // counted with its arena
     }
-
-    void *ptr = malloc(size);
-    if(ptr == nullptr && reinterpret_cast<uintptr_t>(ptr) == 0xdddddddd) {
-        LOG_ERROR("FrameMemoryAllocator malloc failed! ptr={0:x}", (uintptr_t)ptr);
+    if(ptr == nullptr) {
+        if(!reserveMemory(size)) {
+            return nullptr;
+        }
+        ptr = malloc(size);
+        if(ptr == nullptr) {
+            usedSize_ -= size;
+            LOG_ERROR("FrameMemoryAllocator malloc failed! size={0:.3f}MB", byteToMB(size));
+            return nullptr;
+        }
     }
 
-    memset(ptr, 0, size);
-    usedSize_ += size;
     LOG_DEBUG("New frame buffer allocated={0:.3f}MB, total usage: allocated={1:.3f}MB, max limit={2:.3f}MB", byteToMB(size), byteToMB(usedSize_),
               byteToMB(maxSizeInByte_));
     return (uint8_t *)ptr;
 }
 
 void FrameMemoryAllocator::deallocate(uint8_t *ptr, size_t size) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    usedSize_ -= size;
-    free(ptr);
+    if(!hugePageArenaPool_ || !hugePageArenaPool_->deallocate(ptr, size)) {
+        free(ptr);
+        usedSize_ -= size;
+    }
     LOG_DEBUG("Frame buffer released={0:.3f}MB, total usage: allocated={1:.3f}MB, max limit={2:.3f}MB", byteToMB(size), byteToMB(usedSize_),
               byteToMB(maxSizeInByte_));
 }
 
-FrameBufferManagerBase::FrameBufferManagerBase(size_t frameDataBufferSize, size_t frameObjSize)
-    : frameDataBufferSize_(frameDataBufferSize), frameObjSize_(frameObjSize), frameMemoryAllocator_(FrameMemoryAllocator::getInstance()) {
+void FrameMemoryAllocator::prefault(size_t size) {
+    if(!hugePageArenaPool_) {
+        return;
+    }
+    prefaultedSize_ = size;
+    auto freeSize   = hugePageArenaPool_->reserve(size);
+    LOG_DEBUG("Frame buffer memory pre-faulted! required={0:.3f}MB, free={1:.3f}MB, reserved={2:.3f}MB", byteToMB(size), byteToMB(freeSize),
+              byteToMB(hugePageArenaPool_->getReservedSize()));
+}
+
+void FrameMemoryAllocator::releaseIdleMemory(bool keepPrefaulted) {
+    if(hugePageArenaPool_) {
+        hugePageArenaPool_->releaseEmptyArenas(keepPrefaulted ? prefaultedSize_.load() : 0);
+    }
+}
+
+static const uint32_t FREE_LIST_NIL_INDEX = 0xFFFFFFFF;
+
+static inline uint32_t freeListHeadIndex(uint64_t head) {
+    return static_cast<uint32_t>(head & 0xFFFFFFFF);
+}
+
+static inline uint64_t freeListMakeHead(uint64_t oldHead, uint32_t index) {
+    uint64_t tag = (oldHead >> 32) + 1;  // bumped on every update to defeat ABA
+    return (tag << 32) | index;
+}
+
+FrameBufferFreeList::FrameBufferFreeList(uint32_t capacity)
+    : nodes_(new Node[capacity]), bufferHead_(FREE_LIST_NIL_INDEX), emptyHead_(FREE_LIST_NIL_INDEX), size_(0), contentionCount_(0) {
+    for(uint32_t i = 0; i < capacity; i++) {
+        nodes_[i].next   = (i + 1 < capacity) ? i + 1 : FREE_LIST_NIL_INDEX;
+        nodes_[i].buffer = nullptr;
+    }
+    if(capacity > 0) {
+        emptyHead_ = 0;
+    }
+}
+
+uint32_t FrameBufferFreeList::popNode(std::atomic<uint64_t> &head) {
+    uint64_t oldHead = head.load(std::memory_order_acquire);
+    while(true) {
+        uint32_t index = freeListHeadIndex(oldHead);
+        if(index == FREE_LIST_NIL_INDEX) {
+            return FREE_LIST_NIL_INDEX;
+        }
+        // The node may be popped by another thread meanwhile, the stale next value is then rejected by the tagged CAS below.
+        uint32_t next = nodes_[index].next.load(std::memory_order_relaxed);
+        if(head.compare_exchange_weak(oldHead, freeListMakeHead(oldHead, next), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return index;
+        }
+        contentionCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameBufferFreeList::pushNode(std::atomic<uint64_t> &head, uint32_t index) {
+    uint64_t oldHead = head.load(std::memory_order_relaxed);
+    while(true) {
+        nodes_[index].next.store(freeListHeadIndex(oldHead), std::memory_order_relaxed);
+        if(head.compare_exchange_weak(oldHead, freeListMakeHead(oldHead, index), std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+        contentionCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool FrameBufferFreeList::push(uint8_t *buffer) {
+    uint32_t index = popNode(emptyHead_);
+    if(index == FREE_LIST_NIL_INDEX) {
+        return false;
+    }
+    nodes_[index].buffer = buffer;
+    pushNode(bufferHead_, index);
+    size_++;
+    return true;
+}
+
+uint8_t *FrameBufferFreeList::pop() {
+    uint32_t index = popNode(bufferHead_);
+    if(index == FREE_LIST_NIL_INDEX) {
+        return nullptr;
+    }
+    uint8_t *buffer = nodes_[index].buffer;
+    pushNode(emptyHead_, index);
+    size_--;
+    return buffer;
+}
+
+FrameBufferManagerBase::FrameBufferManagerBase(size_t frameDataBufferSize, size_t frameObjSize, size_t maxCachedCount,
+                                               std::weak_ptr<FrameMemoryPool> memoryPool)
+    : frameDataBufferSize_(frameDataBufferSize),
+      frameObjSize_(frameObjSize),
+      memoryPool_(memoryPool),
+      freeList_(static_cast<uint32_t>(maxCachedCount)),
+      hitCount_(0),
+      missCount_(0),
+      overflowCount_(0),
+      allocatedCount_(0),
+      frameMemoryAllocator_(FrameMemoryAllocator::getInstance()),
+      logger_(Logger::getInstance()) {
     frameTotalSize_ = frameDataBufferSize_ + frameObjSize_ + FRAME_DATA_ALIGN_IN_BYTE
                       - 1;  // Apply for more FRAME_DATA_ALIGN_IN_BYTE-1 to facilitate offset part of the data address and achieve alignment
 }
 
 FrameBufferManagerBase::~FrameBufferManagerBase() noexcept {
-    std::unique_lock<std::recursive_mutex> lock_(mutex_);
-    while(!availableFrameBuffers_.empty()) {
-        frameMemoryAllocator_->deallocate(availableFrameBuffers_.front(), frameTotalSize_);
-        availableFrameBuffers_.erase(availableFrameBuffers_.begin());
-    }
-    LOG_DEBUG("FrameBufferManagerBase destroyed! manager type:{0},  obj addr:0x{1:x}", typeid(*this).name(), uint64_t(this));
+    releaseIdleBuffer();
+    frameMemoryAllocator_->releaseIdleMemory(true);  // the arenas prefaulted for the streams are kept for their next start
+    auto stat = getStatistics();
+    LOG_DEBUG("FrameBufferManagerBase destroyed! manager type:{0},  obj addr:0x{1:x}, hit={2}, miss={3}, contention={4}, overflow={5}", typeid(*this).name(),
+              uint64_t(this), stat.hitCount, stat.missCount, stat.contentionCount, stat.overflowCount);
 }
 
 uint8_t *FrameBufferManagerBase::acquireBuffer() {
-    std::unique_lock<std::recursive_mutex> lock_(mutex_);
-    uint8_t                               *bufferPtr = nullptr;
-    if(!availableFrameBuffers_.empty()) {
-        bufferPtr = *availableFrameBuffers_.begin();
-        availableFrameBuffers_.erase(availableFrameBuffers_.begin());
-    }
-    else {
-        bufferPtr = frameMemoryAllocator_->allocate(frameTotalSize_);
-        if(bufferPtr == nullptr) {
-            LOG_WARN("allocBuffer failed! Will retry after release idle memory on FrameMemoryPool");
-            auto memoryPool = FrameMemoryPool::getInstance();
+    uint8_t *bufferPtr = freeList_.pop();  // LIFO: the most recently used buffer is most likely still in cache
+    if(bufferPtr != nullptr) {
+        hitCount_.fetch_add(1, std::memory_order_relaxed);
+        return bufferPtr;
+    }
+
+    missCount_.fetch_add(1, std::memory_order_relaxed);
+    bufferPtr = allocateBuffer();
+    if(bufferPtr == nullptr) {
+        LOG_WARN("allocBuffer failed! Will retry after release idle memory on FrameMemoryPool");
+        auto memoryPool = memoryPool_.lock();
+        if(memoryPool) {
             memoryPool->freeIdleMemory();
-            bufferPtr = frameMemoryAllocator_->allocate(frameTotalSize_);
-            if(bufferPtr == nullptr) {
-                auto msg = std::string("Alloc frame buffer failed! size=") + std::to_string(frameTotalSize_);
-                LOG_FATAL(msg);
-                throw memory_exception(msg);
-            }
         }
+        bufferPtr = allocateBuffer();
+        if(bufferPtr == nullptr) {
+            auto msg = std::string("Alloc frame buffer failed! size=") + std::to_string(frameTotalSize_);
+            LOG_FATAL(msg);
+            throw memory_exception(msg);
+        }
+    }
+    return bufferPtr;
+}
+
+uint8_t *FrameBufferManagerBase::allocateBuffer() {
+    auto bufferPtr = frameMemoryAllocator_->allocate(frameTotalSize_);
+    if(bufferPtr != nullptr) {
+        allocatedCount_++;
     }
     return bufferPtr;
 }
 
-std::unique_lock<std::recursive_mutex> FrameBufferManagerBase::lockBuffers() {
-    std::unique_lock<std::recursive_mutex> lock_(mutex_);
-    return lock_;
+void FrameBufferManagerBase::deallocateBuffer(uint8_t *buffer) {
+    frameMemoryAllocator_->deallocate(buffer, frameTotalSize_);
+    allocatedCount_--;
 }
 
 void FrameBufferManagerBase::reclaimBuffer(void *buffer) {
-    std::unique_lock<std::recursive_mutex> lock_(mutex_);
-    availableFrameBuffers_.push_back((uint8_t *)buffer);
-
-    if(availableFrameBuffers_.size() > 100) {
-        // Release the memory in time when there are enough availableFrameBuffers_
-        // The current buffer cannot be deleted directly, which will cause frame destruction and crash.
-        frameMemoryAllocator_->deallocate(availableFrameBuffers_.front(), frameTotalSize_);
-        availableFrameBuffers_.erase(availableFrameBuffers_.begin());
+    if(!freeList_.push((uint8_t *)buffer)) {
+        // Release the memory in time when there are enough idle buffers
+        overflowCount_.fetch_add(1, std::memory_order_relaxed);
+        deallocateBuffer((uint8_t *)buffer);
     }
 }
 
 void FrameBufferManagerBase::releaseIdleBuffer() {
-    std::unique_lock<std::recursive_mutex> lock_(mutex_);
-    while(!availableFrameBuffers_.empty()) {
-        // Release the memory in time when there are enough availableFrameBuffers_
-        // The current buffer cannot be deleted directly, which will cause frame destruction and crash.
-        frameMemoryAllocator_->deallocate(availableFrameBuffers_.front(), frameTotalSize_);
-        availableFrameBuffers_.erase(availableFrameBuffers_.begin());
+    uint8_t *bufferPtr = nullptr;
+    while((bufferPtr = freeList_.pop()) != nullptr) {
+        deallocateBuffer(bufferPtr);
+    }
+}
+
+void FrameBufferManagerBase::reserveBuffer(size_t count) {
+    size_t reservedCount = 0;
+    while(allocatedCount_ < count) {
+        auto bufferPtr = allocateBuffer();
+        if(bufferPtr == nullptr) {
+            LOG_WARN("Reserve frame buffer failed! size={0:.3f}MB, reserved={1}, required={2}", byteToMB(frameTotalSize_), allocatedCount_.load(), count);
+            break;
+        }
+        // Touch the whole buffer, so the page faults are taken now instead of on the first frames
+        memset(bufferPtr, 0, frameTotalSize_);
+        if(!freeList_.push(bufferPtr)) {
+            deallocateBuffer(bufferPtr);
+            break;
+        }
+        reservedCount++;
+    }
+    if(reservedCount > 0) {
+        LOG_DEBUG("Frame buffers reserved! manager obj addr:0x{0:x}, count={1}, total allocated={2}, buffer size={3:.3f}MB", uint64_t(this), reservedCount,
+                  allocatedCount_.load(), byteToMB(frameTotalSize_));
     }
 }
 
+FrameBufferManagerStatistics FrameBufferManagerBase::getStatistics() const {
+    FrameBufferManagerStatistics stat;
+    stat.hitCount        = hitCount_;
+    stat.missCount       = missCount_;
+    stat.contentionCount = freeList_.getContentionCount();
+    stat.overflowCount   = overflowCount_;
+    stat.cachedCount     = freeList_.size();
+    stat.allocatedCount  = allocatedCount_;
+    return stat;
+}
+
 }  // namespace libobsensor
\ No newline at end of file
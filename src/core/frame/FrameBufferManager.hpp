@@ -2,16 +2,20 @@
 // Copyright(c) 2020 Orbbec Corporation. All Rights Reserved.
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include "frame/Frame.hpp"
+#include "frame/FrameMemoryArena.hpp"
 #include "logger/Logger.hpp"
 
 #define FRAME_DATA_ALIGN_IN_BYTE 16  // 16-byte alignment
 
 namespace libobsensor {
 
+class FrameMemoryPool;
+
 class FrameMemoryAllocator {
 private:
     FrameMemoryAllocator();
@@ -27,20 +31,44 @@ public:
     uint8_t *allocate(size_t size);
     void     deallocate(uint8_t *ptr, size_t size);
 
+    // Reserves and pre-faults backing memory for at least size bytes of frame buffers, so the first frames do not pay page-fault latency.
+    // The size is kept as the watermark of releaseIdleMemory(). Only effective with the huge-page backend.
+    void prefault(size_t size);
+
+    // Returns the backing memory no frame buffer uses to the OS, down to the size of the last prefault() if keepPrefaulted, so a stream restart
+    // finds it reserved and pre-faulted again. Only effective with the huge-page backend, heap buffers are freed on release.
+    void releaseIdleMemory(bool keepPrefaulted);
+
+private:
+    bool reserveMemory(uint64_t size);  // counts size bytes as used, returns false if the max frame memory size would be exceeded
+
 private:
-    uint64_t   maxSizeInByte_;
-    uint64_t   usedSize_;
-    std::mutex mutex_;
+    std::atomic<uint64_t> maxSizeInByte_;
+    std::atomic<uint64_t> usedSize_;  // reserved with CAS, so allocate/deallocate do not serialize on a global lock; whole huge-page arenas included
+
+    std::unique_ptr<HugePageArenaPool> hugePageArenaPool_;  // nullptr if the heap backend is used
+    std::atomic<size_t>                prefaultedSize_;
 
     std::shared_ptr<Logger> logger_;  // Manages the lifecycle of the logger object.
 };
 
+struct FrameBufferManagerStatistics {
+    uint64_t hitCount;         // buffers acquired from the freelist
+    uint64_t missCount;        // buffers newly allocated from FrameMemoryAllocator
+    uint64_t contentionCount;  // freelist CAS retries caused by concurrent acquire/reclaim
+    uint64_t overflowCount;    // reclaimed buffers released because the freelist was full
+    size_t   cachedCount;      // buffers currently in the freelist
+    size_t   allocatedCount;   // buffers currently allocated from FrameMemoryAllocator, in use or cached
+};
+
 class IFrameBufferManager {
 public:
     virtual ~IFrameBufferManager() noexcept {};
-    virtual void   reclaimBuffer(void *buffer) = 0;
-    virtual void   releaseIdleBuffer()         = 0;
-    virtual size_t getFrameDataBufferSize()    = 0;
+    virtual void                         reclaimBuffer(void *buffer) = 0;
+    virtual void                         releaseIdleBuffer()         = 0;
+    virtual void                         reserveBuffer(size_t count) = 0;  // pre-allocates and warms buffers until count buffers are allocated
+    virtual size_t                       getFrameDataBufferSize()    = 0;
+    virtual FrameBufferManagerStatistics getStatistics() const       = 0;
 
 private:
     virtual std::shared_ptr<Frame> acquireFrame() = 0;
@@ -51,38 +79,81 @@ inline double byteToMB(uint64_t sizeInByte) {
     return (double)sizeInByte / 1024.0 / 1024.0;
 }
 
+// Bounded lock-free LIFO stack of frame buffers.
+// The list nodes are owned by the freelist and live as long as it does, and both stack heads carry a version tag next to the node index,
+// so a pop racing with a pop/push of the same node fails its CAS instead of corrupting the list (ABA problem).
+class FrameBufferFreeList {
+public:
+    explicit FrameBufferFreeList(uint32_t capacity);
+
+    bool     push(uint8_t *buffer);  // returns false if the freelist is full
+    uint8_t *pop();                  // returns nullptr if the freelist is empty
+
+    size_t size() const {
+        return size_;
+    }
+    uint64_t getContentionCount() const {
+        return contentionCount_;
+    }
+
+private:
+    struct Node {
+        std::atomic<uint32_t> next;
+        uint8_t              *buffer;
+    };
+
+    uint32_t popNode(std::atomic<uint64_t> &head);
+    void     pushNode(std::atomic<uint64_t> &head, uint32_t index);
+
+private:
+    std::unique_ptr<Node[]> nodes_;
+    std::atomic<uint64_t>   bufferHead_;  // stack of nodes holding a buffer
+    std::atomic<uint64_t>   emptyHead_;   // stack of unused nodes
+    std::atomic<size_t>     size_;
+    std::atomic<uint64_t>   contentionCount_;
+};
+
 class FrameBufferManagerBase : public IFrameBufferManager {
 public:
-    FrameBufferManagerBase(size_t frameDataBufferSize, size_t frameObjSize);
+    FrameBufferManagerBase(size_t frameDataBufferSize, size_t frameObjSize, size_t maxCachedCount, std::weak_ptr<FrameMemoryPool> memoryPool);
 
     virtual ~FrameBufferManagerBase() noexcept;
     void   reclaimBuffer(void *buffer) override;
     void   releaseIdleBuffer() override;
+    void   reserveBuffer(size_t count) override;
     size_t getFrameDataBufferSize() override {
         return frameDataBufferSize_;
     }
-
-    std::unique_lock<std::recursive_mutex> lockBuffers();
+    FrameBufferManagerStatistics getStatistics() const override;
 
 protected:
     uint8_t *acquireBuffer();
+    uint8_t *allocateBuffer();
+    void     deallocateBuffer(uint8_t *buffer);
 
 protected:
-    std::recursive_mutex mutex_;
-    size_t               frameDataBufferSize_;
-    size_t               frameObjSize_;
-    size_t               frameTotalSize_;
+    size_t frameDataBufferSize_;
+    size_t frameObjSize_;
+    size_t frameTotalSize_;
+
+    // Not owned, the pool owns its managers. Frames in use pin the pool through the deletion function instead.
+    std::weak_ptr<FrameMemoryPool> memoryPool_;
 
 private:
-    std::vector<uint8_t *>                availableFrameBuffers_;
+    FrameBufferFreeList                   freeList_;
+    std::atomic<uint64_t>                 hitCount_;
+    std::atomic<uint64_t>                 missCount_;
+    std::atomic<uint64_t>                 overflowCount_;
+    std::atomic<size_t>                   allocatedCount_;
     std::shared_ptr<FrameMemoryAllocator> frameMemoryAllocator_;
+    std::shared_ptr<Logger>               logger_;  // Manages the lifecycle of the logger object, frames in use keep their manager alive.
 };
 
-class FrameMemoryPool;
 template <typename T> class FrameBufferManager : public FrameBufferManagerBase, public std::enable_shared_from_this<FrameBufferManager<T>> {
 private:
     // Must be created through FrameMemoryPool to ensure that all FrameBufferManager objects are managed by FrameMemoryPool
-    FrameBufferManager(size_t frameDataBufferSize) : FrameBufferManagerBase(frameDataBufferSize, sizeof(T)) {
+    FrameBufferManager(size_t frameDataBufferSize, size_t maxCachedCount, std::weak_ptr<FrameMemoryPool> memoryPool)
+        : FrameBufferManagerBase(frameDataBufferSize, sizeof(T), maxCachedCount, memoryPool) {
         LOG_DEBUG("FrameBufferManager created! frame type:{0}, obj addr:0x{1:x}, frame obj total size:{2:.3f}MB", typeid(T).name(), uint64_t(this),
                   byteToMB(frameTotalSize_));
     }
@@ -105,19 +176,18 @@ private:
             // 2. Custom deletion function construction of shared_ptr
             // 3. You need to pass bufMgr into the smart pointer custom deletion function lambda to add a reference, otherwise bufMgr may be destructed first
             // when frame->~T(), the memory will be recycled in advance, and the frame destructor will crash.
-            auto bufMgr = this->shared_from_this();
+            // 4. The pool is pinned the same way, so the frame keeps the pool (and its cached buffers) alive like the frame buffer manager.
+            // 5. The buffer also holds the frame object itself, so it is reclaimed by the deletion function only after ~T() has completed. Reclaiming it
+            // from the frame's buffer reclaim function would let another thread reuse the buffer while the rest of the frame is still being destroyed.
+            auto bufMgr     = this->shared_from_this();
+            auto memoryPool = memoryPool_.lock();
             return std::shared_ptr<T>(new(bufferPtr) T(bufferPtr + frameObjSize_ + alignOffset, frameDataBufferSize_,
-                                                       [bufMgr, bufferPtr]() {  // Customized frame buffer release function
-                                                           bufMgr->reclaimBuffer(bufferPtr);
-                                                       }),
-                                      [bufMgr](T *frame) mutable {  // Custom shared_pt delete function
-                                          // Purpose of locking: To solve the problem of the buffer being used to create a new frame just after it is returned,
-                                          // causing the subsequent destruction operation of the original frame to modify the new frame and causing the program
-                                          // to crash.
-                                          auto lk = bufMgr->lockBuffers();
+                                                       []() {}),  // Buffer is reclaimed by the deletion function below
+                                      [bufMgr, memoryPool, bufferPtr](T *frame) mutable {  // Custom shared_pt delete function
                                           frame->~T();
-                                          lk.unlock();
+                                          bufMgr->reclaimBuffer(bufferPtr);
                                           bufMgr.reset();
+                                          memoryPool.reset();
                                       });
         }
         return nullptr;
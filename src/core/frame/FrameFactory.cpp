@@ -7,6 +7,14 @@
 
 namespace libobsensor {
 
+// Create a frame of the same class and buffer size as the given frame
+static std::shared_ptr<Frame> createFrameLike(const std::shared_ptr<const Frame> &frame) {
+    if(frame->is<ImuBatchFrame>()) {
+        return FrameFactory::createImuBatchFrame(frame->getStreamProfile(), frame->as<ImuBatchFrame>()->getCapacity());
+    }
+    return FrameFactory::createFrameFromStreamProfile(frame->getStreamProfile());
+}
+
 std::shared_ptr<Frame> FrameFactory::createFrame(OBFrameType frameType, OBFormat frameFormat, size_t datasize) {
 
     auto                                 memoryPool    = FrameMemoryPool::getInstance();
@@ -31,7 +39,7 @@ std::shared_ptr<Frame> FrameFactory::createFrameFromOtherFrame(std::shared_ptr<c
         for(uint32_t i = 0; i < frameCount; i++) {
             std::shared_ptr<const Frame> oldFrame = frameSet->getFrame(i);
             if(shouldCopyData) {
-                auto newFrame = createFrameFromStreamProfile(oldFrame->getStreamProfile());
+                auto newFrame = createFrameLike(oldFrame);
                 newFrame->updateData(oldFrame->getData(), oldFrame->getDataSize());
                 newFrame->copyInfoFromOther(oldFrame);
                 newFrameSet->pushFrame(std::move(newFrame));
@@ -43,7 +51,7 @@ std::shared_ptr<Frame> FrameFactory::createFrameFromOtherFrame(std::shared_ptr<c
         return newFrameSet;
     }
     else {
-        auto newFrame = createFrameFromStreamProfile(frame->getStreamProfile());
+        auto newFrame = createFrameLike(frame);
         if(shouldCopyData) {
             newFrame->updateData(frame->getData(), frame->getDataSize());
         }
@@ -164,6 +172,20 @@ std::shared_ptr<Frame> FrameFactory::createFrameFromStreamProfile(std::shared_pt
     return frame;
 }
 
+std::shared_ptr<ImuBatchFrame> FrameFactory::createImuBatchFrame(std::shared_ptr<const StreamProfile> sp, uint32_t capacity) {
+    auto memoryPool    = libobsensor::FrameMemoryPool::getInstance();
+    auto frameType     = utils::mapStreamTypeToFrameType(sp->getType());
+    auto bufferManager = memoryPool->createImuBatchFrameBufferManager(frameType, capacity);
+
+    auto frame = bufferManager->acquireFrame();
+    if(frame == nullptr) {
+        throw libobsensor::memory_exception("Failed to create frame, out of memory or other memory allocation error.");
+    }
+
+    frame->setStreamProfile(sp);
+    return frame->as<ImuBatchFrame>();
+}
+
 std::shared_ptr<FrameSet> FrameFactory::createFrameSet() {
     auto memoryPool            = libobsensor::FrameMemoryPool::getInstance();
     auto frameSetBufferManager = memoryPool->createFrameBufferManager(OB_FRAME_SET, OB_FRAME_TYPE_COUNT * sizeof(std::shared_ptr<Frame>));
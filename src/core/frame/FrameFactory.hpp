@@ -17,6 +17,7 @@ public:
                                                                  uint8_t *buffer, size_t bufferSize, FrameBufferReclaimFunc bufferReclaimFunc);
 
     static std::shared_ptr<Frame> createFrameFromStreamProfile(std::shared_ptr<const StreamProfile> sp);
+    static std::shared_ptr<ImuBatchFrame> createImuBatchFrame(std::shared_ptr<const StreamProfile> sp, uint32_t capacity);
 
     static std::shared_ptr<FrameSet> createFrameSet();
 };
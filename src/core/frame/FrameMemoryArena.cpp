@@ -0,0 +1,269 @@
+#include "FrameMemoryArena.hpp"
+#include "logger/Logger.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+#endif
+
+namespace libobsensor {
+
+#define ARENA_BLOCK_ALIGN 64  // cache line
+#define ARENA_PREFAULT_STRIDE 4096
+
+static inline size_t alignUp(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+HugePageArenaPool::HugePageArenaPool(size_t arenaSize, int numaNode, std::function<bool(size_t)> reserveMemory, std::function<void(size_t)> releaseMemory)
+    : arenaSize_(alignUp(arenaSize, HUGE_PAGE_SIZE)), numaNode_(numaNode), reserveMemory_(reserveMemory), releaseMemory_(releaseMemory) {
+    if(arenaSize_ == 0) {
+        arenaSize_ = HUGE_PAGE_SIZE;
+    }
+    LOG_DEBUG("HugePageArenaPool created! arena size={}MB, numa node={}", arenaSize_ / 1024 / 1024, numaNode_);
+}
+
+HugePageArenaPool::~HugePageArenaPool() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(auto &arena: arenas_) {
+        destroyArena(arena.get());
+    }
+    arenas_.clear();
+}
+
+bool HugePageArenaPool::isSupported() {
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+HugePageArenaPool::Arena *HugePageArenaPool::createArena(size_t size) {
+#if defined(__linux__)
+    if(reserveMemory_ && !reserveMemory_(size)) {
+        return nullptr;
+    }
+
+    bool  hugeTlb = true;
+    void *base    = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+    if(base == MAP_FAILED) {
+        // No (or not enough) pages reserved in the hugetlbfs pool, fall back to transparent huge pages
+        hugeTlb = false;
+        base    = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(base == MAP_FAILED) {
+            LOG_WARN("HugePageArenaPool: failed to map arena! size={}MB, {}", size / 1024 / 1024, strerror(errno));
+            if(releaseMemory_) {
+                releaseMemory_(size);
+            }
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(base, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    if(numaNode_ >= 0) {
+        // Bind before the pages are touched, so they are faulted in on the target node directly
+        const size_t  bitsPerLong         = 8 * sizeof(unsigned long);
+        unsigned long nodeMask[1024 / 64] = { 0 };
+        if(static_cast<size_t>(numaNode_) < sizeof(nodeMask) * 8) {
+            nodeMask[numaNode_ / bitsPerLong] |= 1UL << (numaNode_ % bitsPerLong);
+            if(syscall(SYS_mbind, base, size, MPOL_BIND, nodeMask, sizeof(nodeMask) * 8 + 1, 0) != 0) {
+                LOG_WARN("HugePageArenaPool: failed to bind arena to numa node {}, {}", numaNode_, strerror(errno));
+            }
+        }
+        else {
+            LOG_WARN("HugePageArenaPool: invalid numa node {}", numaNode_);
+        }
+    }
+
+    // Pre-fault the whole arena
+    auto ptr = static_cast<volatile uint8_t *>(base);
+    for(size_t offset = 0; offset < size; offset += ARENA_PREFAULT_STRIDE) {
+        ptr[offset] = 0;
+    }
+
+    auto arena     = new Arena();
+    arena->base    = static_cast<uint8_t *>(base);
+    arena->size    = size;
+    arena->hugeTlb = hugeTlb;
+    arena->freeBlocks.insert({ 0, size });
+    LOG_DEBUG("HugePageArenaPool: new arena reserved! size={}MB, hugetlb={}, numa node={}", size / 1024 / 1024, hugeTlb, numaNode_);
+    return arena;
+#else
+    (void)size;
+    return nullptr;
+#endif
+}
+
+void HugePageArenaPool::destroyArena(Arena *arena) {
+#if defined(__linux__)
+    munmap(arena->base, arena->size);
+    if(releaseMemory_) {
+        releaseMemory_(arena->size);
+    }
+#else
+    (void)arena;
+#endif
+}
+
+uint8_t *HugePageArenaPool::allocateFromArena(Arena *arena, size_t size) {
+    // first fit
+    for(auto iter = arena->freeBlocks.begin(); iter != arena->freeBlocks.end(); iter++) {
+        if(iter->second < size) {
+            continue;
+        }
+        auto offset    = iter->first;
+        auto blockSize = iter->second;
+        arena->freeBlocks.erase(iter);
+        if(blockSize > size) {
+            arena->freeBlocks.insert({ offset + size, blockSize - size });
+        }
+        return arena->base + offset;
+    }
+    return nullptr;
+}
+
+uint8_t *HugePageArenaPool::allocate(size_t size) {
+    if(!isSupported() || size == 0) {
+        return nullptr;
+    }
+    size = alignUp(size, ARENA_BLOCK_ALIGN);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(auto &arena: arenas_) {
+        auto ptr = allocateFromArena(arena.get(), size);
+        if(ptr) {
+            return ptr;
+        }
+    }
+
+    auto arena = createArena(std::max(arenaSize_, alignUp(size, HUGE_PAGE_SIZE)));
+    if(!arena) {
+        return nullptr;
+    }
+    arenas_.emplace_back(arena);
+    return allocateFromArena(arena, size);
+}
+
+bool HugePageArenaPool::deallocate(uint8_t *ptr, size_t size) {
+    size = alignUp(size, ARENA_BLOCK_ALIGN);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for(auto arenaIter = arenas_.begin(); arenaIter != arenas_.end(); arenaIter++) {
+        auto arena = arenaIter->get();
+        if(ptr < arena->base || ptr >= arena->base + arena->size) {
+            continue;
+        }
+
+        size_t offset = ptr - arena->base;
+        auto   next   = arena->freeBlocks.lower_bound(offset);
+        // coalesce with the following free block
+        if(next != arena->freeBlocks.end() && next->first == offset + size) {
+            size += next->second;
+            next = arena->freeBlocks.erase(next);
+        }
+        // coalesce with the preceding free block
+        if(next != arena->freeBlocks.begin()) {
+            auto prev = std::prev(next);
+            if(prev->first + prev->second == offset) {
+                prev->second += size;
+                size   = 0;
+                offset = prev->first;
+            }
+        }
+        if(size > 0) {
+            arena->freeBlocks.insert({ offset, size });
+        }
+
+        // Arenas larger than the configured arena size were reserved for a single oversized buffer, release them once unused
+        if(arena->size > arenaSize_ && arena->freeBlocks.size() == 1 && arena->freeBlocks.begin()->second == arena->size) {
+            destroyArena(arena);
+            arenas_.erase(arenaIter);
+        }
+        return true;
+    }
+    return false;
+}
+
+size_t HugePageArenaPool::reserve(size_t freeSize) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto                         curFreeSize = getFreeSizeLocked();
+    while(curFreeSize < freeSize) {
+        auto arena = createArena(arenaSize_);
+        if(!arena) {
+            break;
+        }
+        arenas_.emplace_back(arena);
+        curFreeSize += arena->size;
+    }
+    return curFreeSize;
+}
+
+size_t HugePageArenaPool::releaseEmptyArenas(size_t keepSize) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t                       reservedSize = 0;
+    for(auto &arena: arenas_) {
+        reservedSize += arena->size;
+    }
+
+    // the newest arenas first, so the ones kept are the oldest
+    size_t releasedSize = 0;
+    auto   arenaIter    = arenas_.end();
+    while(arenaIter != arenas_.begin()) {
+        --arenaIter;
+        auto arena = arenaIter->get();
+        if(arena->freeBlocks.size() == 1 && arena->freeBlocks.begin()->second == arena->size && reservedSize - releasedSize - arena->size >= keepSize) {
+            releasedSize += arena->size;
+            destroyArena(arena);
+            arenaIter = arenas_.erase(arenaIter);
+        }
+    }
+    if(releasedSize > 0) {
+        LOG_DEBUG("HugePageArenaPool: empty arenas released! size={}MB", releasedSize / 1024 / 1024);
+    }
+    return releasedSize;
+}
+
+size_t HugePageArenaPool::getReservedSize() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t                       size = 0;
+    for(auto &arena: arenas_) {
+        size += arena->size;
+    }
+    return size;
+}
+
+size_t HugePageArenaPool::getFreeSize() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return getFreeSizeLocked();
+}
+
+size_t HugePageArenaPool::getFreeSizeLocked() const {
+    size_t size = 0;
+    for(auto &arena: arenas_) {
+        for(auto &block: arena->freeBlocks) {
+            size += block.second;
+        }
+    }
+    return size;
+}
+
+}  // namespace libobsensor
@@ -0,0 +1,60 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Orbbec Corporation. All Rights Reserved.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace libobsensor {
+
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)  // 2MB huge page
+
+// Frame buffer memory carved out of large pre-reserved regions (arenas) backed by 2MB huge pages, optionally bound to a NUMA node.
+// Arena memory is pre-faulted when it is reserved, so buffers carved out of it never take a page fault on first use.
+// Only supported on Linux; on other platforms allocate() always returns nullptr and the caller falls back to the heap.
+// The whole arena counts as used memory from its reservation to its release, through the reserveMemory and releaseMemory functions of the owner:
+// an arena is not reserved if reserveMemory returns false.
+class HugePageArenaPool {
+public:
+    HugePageArenaPool(size_t arenaSize, int numaNode, std::function<bool(size_t)> reserveMemory, std::function<void(size_t)> releaseMemory);
+    ~HugePageArenaPool() noexcept;
+
+    static bool isSupported();
+
+    uint8_t *allocate(size_t size);                  // returns nullptr if no arena can be reserved for the request
+    bool     deallocate(uint8_t *ptr, size_t size);  // returns false if ptr was not allocated from this pool
+    size_t   reserve(size_t freeSize);               // reserves and pre-faults arenas until at least freeSize bytes are free, returns the free size
+    size_t   releaseEmptyArenas(size_t keepSize);    // returns the arenas no buffer is allocated from to the OS, as long as at least keepSize bytes
+                                                     // stay reserved; returns the released size
+
+    size_t getReservedSize();
+    size_t getFreeSize();
+
+private:
+    struct Arena {
+        uint8_t                 *base;
+        size_t                   size;
+        bool                     hugeTlb;     // backed by explicit hugetlbfs pages, otherwise by transparent huge pages
+        std::map<size_t, size_t> freeBlocks;  // offset -> size, adjacent free blocks are always coalesced
+    };
+
+    Arena   *createArena(size_t size);
+    void     destroyArena(Arena *arena);
+    uint8_t *allocateFromArena(Arena *arena, size_t size);
+    size_t   getFreeSizeLocked() const;
+
+private:
+    std::mutex                          mutex_;
+    std::vector<std::unique_ptr<Arena>> arenas_;
+    size_t                              arenaSize_;
+    int                                 numaNode_;
+    std::function<bool(size_t)>         reserveMemory_;
+    std::function<void(size_t)>         releaseMemory_;
+};
+
+}  // namespace libobsensor
@@ -1,7 +1,9 @@
 #include "FrameMemoryPool.hpp"
 #include "utils/PublicTypeHelper.hpp"
 #include "stream/StreamProfile.hpp"
+#include "environment/EnvConfig.hpp"
 #include <sstream>
+#include <algorithm>
 
 namespace libobsensor {
 
@@ -22,8 +24,27 @@ void FrameMemoryPool::setMaxFrameMemorySize(uint64_t sizeInMB) {
     FrameMemoryAllocator::getInstance()->setMaxFrameMemorySize(sizeInMB);
 }
 
-FrameMemoryPool::FrameMemoryPool() : logger_(Logger::getInstance()) {
-    LOG_DEBUG("FrameMemoryPool created!");
+FrameMemoryPool::FrameMemoryPool()
+    : lowWatermark_(DEFAULT_FRAME_BUFFER_LOW_WATERMARK),
+      highWatermark_(DEFAULT_FRAME_BUFFER_HIGH_WATERMARK),
+      frameMemoryAllocator_(FrameMemoryAllocator::getInstance()),
+      logger_(Logger::getInstance()) {
+    auto envConfig     = EnvConfig::getInstance();
+    int  lowWatermark  = static_cast<int>(lowWatermark_);
+    int  highWatermark = static_cast<int>(highWatermark_);
+    envConfig->getIntValue("Memory.FrameBufferLowWatermark", lowWatermark);
+    envConfig->getIntValue("Memory.FrameBufferHighWatermark", highWatermark);
+    if(highWatermark < 1) {
+        LOG_WARN("The frame buffer high watermark you set is too small, will set to 1 instead");
+        highWatermark = 1;
+    }
+    if(lowWatermark < 0 || lowWatermark > highWatermark) {
+        LOG_WARN("The frame buffer low watermark you set is out of range [0, {}], will set to {} instead", highWatermark, std::min(2, highWatermark));
+        lowWatermark = std::min(2, highWatermark);
+    }
+    lowWatermark_  = static_cast<size_t>(lowWatermark);
+    highWatermark_ = static_cast<size_t>(highWatermark);
+    LOG_DEBUG("FrameMemoryPool created! frame buffer watermarks: low={}, high={}", lowWatermark_, highWatermark_);
 }
 
 FrameMemoryPool::~FrameMemoryPool() noexcept {
@@ -32,7 +53,7 @@ FrameMemoryPool::~FrameMemoryPool() noexcept {
 
 std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(OBFrameType type, size_t frameBufferSize) {
     std::unique_lock<std::mutex> lock(bufMgrMapMutex_);
-    FrameBufferManagerInfo       info = { type, frameBufferSize };
+    FrameBufferManagerInfo       info = { type, frameBufferSize, false };
 
     auto iter = bufMgrMap_.find(info);
     if(iter != bufMgrMap_.end()) {
@@ -43,48 +64,48 @@ std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(O
     switch(type) {
     case OB_FRAME_VIDEO:
 
-        frameBufMgr = std::shared_ptr<FrameBufferManager<VideoFrame>>(new FrameBufferManager<VideoFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<VideoFrame>>(new FrameBufferManager<VideoFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("VideoFrame bufferManager created!");
         break;
     case OB_FRAME_DEPTH:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<DepthFrame>>(new FrameBufferManager<DepthFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<DepthFrame>>(new FrameBufferManager<DepthFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("DepthFrame bufferManager created!");
         break;
     case OB_FRAME_IR_LEFT:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<IRLeftFrame>>(new FrameBufferManager<IRLeftFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<IRLeftFrame>>(new FrameBufferManager<IRLeftFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("IRFrame bufferManager created!");
         break;
     case OB_FRAME_IR_RIGHT:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<IRRightFrame>>(new FrameBufferManager<IRRightFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<IRRightFrame>>(new FrameBufferManager<IRRightFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("IRFrame bufferManager created!");
         break;
     case OB_FRAME_IR:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<IRFrame>>(new FrameBufferManager<IRFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<IRFrame>>(new FrameBufferManager<IRFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("IRFrame bufferManager created!");
         break;
     case OB_FRAME_COLOR:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<ColorFrame>>(new FrameBufferManager<ColorFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<ColorFrame>>(new FrameBufferManager<ColorFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("ColorFrame bufferManager created!");
         break;
     case OB_FRAME_GYRO:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<GyroFrame>>(new FrameBufferManager<GyroFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<GyroFrame>>(new FrameBufferManager<GyroFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("GyroFrame bufferManager created!");
         break;
     case OB_FRAME_ACCEL:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<AccelFrame>>(new FrameBufferManager<AccelFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<AccelFrame>>(new FrameBufferManager<AccelFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("AccelFrame bufferManager created!");
         break;
     case OB_FRAME_POINTS:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<PointsFrame>>(new FrameBufferManager<PointsFrame>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<PointsFrame>>(new FrameBufferManager<PointsFrame>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("PointsFrame bufferManager created!");
         break;
     case OB_FRAME_SET:
-        frameBufMgr = std::shared_ptr<FrameBufferManager<FrameSet>>(new FrameBufferManager<FrameSet>(frameBufferSize));
+        frameBufMgr = std::shared_ptr<FrameBufferManager<FrameSet>>(new FrameBufferManager<FrameSet>(frameBufferSize, highWatermark_, shared_from_this()));
         LOG_DEBUG("Frameset bufferManager created!");
         break;
     default:
         if(frameBufferSize != 0) {
-            frameBufMgr = std::shared_ptr<FrameBufferManager<Frame>>(new FrameBufferManager<Frame>(frameBufferSize));
+            frameBufMgr = std::shared_ptr<FrameBufferManager<Frame>>(new FrameBufferManager<Frame>(frameBufferSize, highWatermark_, shared_from_this()));
             LOG_DEBUG("Frame bufferManager created!");
         }
         else {
@@ -100,19 +121,29 @@ std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(O
     return frameBufMgr;
 }
 
-std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(OBFrameType type, std::shared_ptr<const StreamProfile> streamProfile) {
+std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(OBFrameType type, std::shared_ptr<const StreamProfile> streamProfile,
+                                                                               size_t reserveCount) {
+    std::shared_ptr<IFrameBufferManager> frameBufMgr;
     if(streamProfile->is<VideoStreamProfile>()) {
-        auto sp = streamProfile->as<VideoStreamProfile>();
-        return createFrameBufferManager(type, sp->getFormat(), sp->getWidth(), sp->getHeight());
+        auto sp     = streamProfile->as<VideoStreamProfile>();
+        frameBufMgr = createFrameBufferManager(type, sp->getFormat(), sp->getWidth(), sp->getHeight());
     }
     else if(streamProfile->is<AccelStreamProfile>()) {
-        return createFrameBufferManager(type, sizeof(AccelFrame::Data));
+        frameBufMgr = createFrameBufferManager(type, sizeof(AccelFrame::Data));
     }
     else if(streamProfile->is<GyroStreamProfile>()) {
-        return createFrameBufferManager(type, sizeof(GyroFrame::Data));
+        frameBufMgr = createFrameBufferManager(type, sizeof(GyroFrame::Data));
+    }
+    else {
+        LOG_WARN("unsupported streamProfile type");
+        return nullptr;
     }
-    LOG_WARN("unsupported streamProfile type");
-    return nullptr;
+
+    if(reserveCount > 0) {
+        reserveCount = std::max(lowWatermark_, std::min(reserveCount, highWatermark_));
+        frameBufMgr->reserveBuffer(reserveCount);
+    }
+    return frameBufMgr;
 }
 
 std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(OBFrameType type, OBFormat format, uint32_t width, uint32_t height) {
@@ -120,6 +151,39 @@ std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createFrameBufferManager(O
     return createFrameBufferManager(type, frameBufferSize);
 }
 
+std::shared_ptr<IFrameBufferManager> FrameMemoryPool::createImuBatchFrameBufferManager(OBFrameType type, uint32_t capacity) {
+    std::unique_lock<std::mutex> lock(bufMgrMapMutex_);
+    auto                         frameBufferSize = ImuBatchFrame::calcDataSize(capacity);
+    FrameBufferManagerInfo       info            = { type, frameBufferSize, true };
+
+    auto iter = bufMgrMap_.find(info);
+    if(iter != bufMgrMap_.end()) {
+        return iter->second;
+    }
+
+    std::shared_ptr<IFrameBufferManager> frameBufMgr;
+    switch(type) {
+    case OB_FRAME_ACCEL:
+        frameBufMgr =
+            std::shared_ptr<FrameBufferManager<AccelBatchFrame>>(new FrameBufferManager<AccelBatchFrame>(frameBufferSize, highWatermark_, shared_from_this()));
+        LOG_DEBUG("AccelBatchFrame bufferManager created!");
+        break;
+    case OB_FRAME_GYRO:
+        frameBufMgr =
+            std::shared_ptr<FrameBufferManager<GyroBatchFrame>>(new FrameBufferManager<GyroBatchFrame>(frameBufferSize, highWatermark_, shared_from_this()));
+        LOG_DEBUG("GyroBatchFrame bufferManager created!");
+        break;
+    default: {
+        std::ostringstream oss_msg;
+        oss_msg << "Unsupported Frame Type to create imu batch buffer manager! frameType: " << type;
+        throw unsupported_operation_exception(oss_msg.str());
+    }
+    }
+
+    bufMgrMap_.insert({ info, frameBufMgr });
+    return frameBufMgr;
+}
+
 void FrameMemoryPool::freeIdleMemory() {
     std::unique_lock<std::mutex> lock(bufMgrMapMutex_);
     auto                         iter = bufMgrMap_.begin();
@@ -144,6 +208,22 @@ void FrameMemoryPool::freeIdleMemory() {
         }
         vecIter++;
     }
+
+    // the arenas emptied by the buffers released above, including the ones prefaulted for the streams: the memory is asked back
+    frameMemoryAllocator_->releaseIdleMemory(false);
+}
+
+std::vector<FrameBufferManagerUsage> FrameMemoryPool::getFrameBufferManagerUsageList() {
+    std::unique_lock<std::mutex>         lock(bufMgrMapMutex_);
+    std::vector<FrameBufferManagerUsage> usageList;
+    for(auto &item: bufMgrMap_) {
+        FrameBufferManagerUsage usage;
+        usage.frameType           = item.first.frameType;
+        usage.frameDataBufferSize = item.first.maxFrameDataSize;
+        usage.statistics          = item.second->getStatistics();
+        usageList.push_back(usage);
+    }
+    return usageList;
 }
 
 }  // namespace libobsensor
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <functional>
 #include <string>
 #include <map>
+#include <vector>
 
 #include "FrameBufferManager.hpp"
 #include "logger/Logger.hpp"
@@ -13,17 +14,30 @@ namespace libobsensor {
 struct FrameBufferManagerInfo {
     OBFrameType frameType;
     size_t      maxFrameDataSize;
+    bool        imuBatch;  // the buffers hold ImuBatchFrame objects instead of the frame class of frameType
 };
 
 struct FrameBufferManagerInfoCompare {
     bool operator()(const FrameBufferManagerInfo &l, const FrameBufferManagerInfo &r) const {
-        if(l.frameType == r.frameType) {
-            return l.maxFrameDataSize < r.maxFrameDataSize;
+        if(l.frameType != r.frameType) {
+            return l.frameType < r.frameType;
         }
-        return l.frameType < r.frameType;
+        if(l.imuBatch != r.imuBatch) {
+            return l.imuBatch < r.imuBatch;
+        }
+        return l.maxFrameDataSize < r.maxFrameDataSize;
     }
 };
 
+struct FrameBufferManagerUsage {
+    OBFrameType                  frameType;
+    size_t                       frameDataBufferSize;
+    FrameBufferManagerStatistics statistics;
+};
+
+#define DEFAULT_FRAME_BUFFER_LOW_WATERMARK 2     // min number of buffers reserved for a stream on start
+#define DEFAULT_FRAME_BUFFER_HIGH_WATERMARK 100  // max number of idle buffers kept by each FrameBufferManager
+
 class FrameMemoryPool : public std::enable_shared_from_this<FrameMemoryPool> {
 private:
     FrameMemoryPool();
@@ -37,17 +51,27 @@ public:
     static void                             setMaxFrameMemorySize(uint64_t sizeInMB);
 
     std::shared_ptr<IFrameBufferManager> createFrameBufferManager(OBFrameType type, size_t frameBufferSize);
-    std::shared_ptr<IFrameBufferManager> createFrameBufferManager(OBFrameType type, std::shared_ptr<const StreamProfile> streamProfile);
+    // reserveCount: number of buffers to pre-allocate for the stream, clamped to the [low, high] watermarks; 0 to reserve nothing
+    std::shared_ptr<IFrameBufferManager> createFrameBufferManager(OBFrameType type, std::shared_ptr<const StreamProfile> streamProfile,
+                                                                  size_t reserveCount = 0);
     std::shared_ptr<IFrameBufferManager> createFrameBufferManager(OBFrameType type, OBFormat format, uint32_t width, uint32_t height);
+    // Buffer manager of the ImuBatchFrame of an accel (OB_FRAME_ACCEL) or gyro (OB_FRAME_GYRO) stream holding up to capacity samples
+    std::shared_ptr<IFrameBufferManager> createImuBatchFrameBufferManager(OBFrameType type, uint32_t capacity);
 
     void freeIdleMemory();
 
+    std::vector<FrameBufferManagerUsage> getFrameBufferManagerUsageList();
+
 private:
+    size_t lowWatermark_;
+    size_t highWatermark_;
+
     std::map<FrameBufferManagerInfo, std::shared_ptr<IFrameBufferManager>, FrameBufferManagerInfoCompare> bufMgrMap_;
     std::mutex                                                                                            bufMgrMapMutex_;
     std::vector<std::weak_ptr<IFrameBufferManager>>                                                       bufMgrWeakList_;
 
-    std::shared_ptr<Logger> logger_;  // Manages the lifecycle of the logger object.
+    std::shared_ptr<FrameMemoryAllocator> frameMemoryAllocator_;  // Keeps the allocator and its settings alive while no buffer is allocated.
+    std::shared_ptr<Logger>               logger_;                // Manages the lifecycle of the logger object.
 };
 
 }  // namespace libobsensor
@@ -2,13 +2,35 @@
 
 #include "frame/Frame.hpp"
 
-#include <queue>
+#include <vector>
+#include <thread>
+#include <condition_variable>
 
 namespace libobsensor {
 
+// Behavior of enqueue() when the queue is full
+typedef enum {
+    FRAME_QUEUE_DROP_NEWEST,  // reject the incoming frame (default)
+    FRAME_QUEUE_DROP_OLDEST,  // drop the oldest frame in queue to make room for the incoming frame
+    FRAME_QUEUE_BLOCK,        // block the producer until there is room or the block timeout is reached, then reject the incoming frame
+} FrameQueueDropPolicy;
+
+// Bounded frame queue backed by a fixed-size ring buffer. The lock only guards the ring buffer; the async dequeue thread releases it before
+// invoking the callback, so the producer is never blocked by the consumer's processing.
 template <typename T = Frame> class FrameQueue {
 public:
-    explicit FrameQueue(size_t capacity) : capacity_(capacity), stoped_(true), stopping_(false), callback_(nullptr), flushing_(false) {}
+    explicit FrameQueue(size_t capacity, FrameQueueDropPolicy dropPolicy = FRAME_QUEUE_DROP_NEWEST, uint64_t blockTimeoutMsec = 0)
+        : ring_(capacity),
+          head_(0),
+          count_(0),
+          capacity_(capacity),
+          dropPolicy_(dropPolicy),
+          blockTimeoutMsec_(blockTimeoutMsec),
+          droppedCount_(0),
+          stoped_(true),
+          stopping_(false),
+          callback_(nullptr),
+          flushing_(false) {}
 
     ~FrameQueue() noexcept {
         reset();
@@ -19,27 +41,83 @@ public:
     }
 
     void resize(size_t capacity) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::vector<std::shared_ptr<T>> ring(capacity);
+        // keep the newest frames if the queue shrinks
+        while(count_ > capacity) {
+            popFront();
+            droppedCount_++;
+        }
+        for(size_t i = 0; i < count_; i++) {
+            ring[i] = std::move(ring_[(head_ + i) % capacity_]);
+        }
+        ring_     = std::move(ring);
+        head_     = 0;
         capacity_ = capacity;
+        notFullCondition_.notify_all();
+    }
+
+    void setDropPolicy(FrameQueueDropPolicy dropPolicy, uint64_t blockTimeoutMsec = 0) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        dropPolicy_       = dropPolicy;
+        blockTimeoutMsec_ = blockTimeoutMsec;
+    }
+
+    FrameQueueDropPolicy getDropPolicy() const {
+        return dropPolicy_;
     }
 
     size_t size() const {
-        return queue_.size();
+        std::unique_lock<std::mutex> lock(mutex_);
+        return count_;
     }
 
     bool empty() const {
-        return queue_.empty();
+        std::unique_lock<std::mutex> lock(mutex_);
+        return count_ == 0;
     }
 
     bool fulled() const {
-        return queue_.size() >= capacity_;
+        std::unique_lock<std::mutex> lock(mutex_);
+        return count_ >= capacity_;
     }
 
-    bool enqueue(std::shared_ptr<T> frame) {  // returns false if queue is full
+    // number of frames dropped since the queue was created or reset, according to the drop policy
+    uint64_t droppedCount() const {
+        return droppedCount_;
+    }
+
+    // returns false if the incoming frame is not queued (queue is full and the drop policy rejects it, or queue is flushing)
+    bool enqueue(std::shared_ptr<T> frame) {
+        std::shared_ptr<T>           droppedFrame;  // released after unlocking, its destruction may recycle a frame buffer
         std::unique_lock<std::mutex> lock(mutex_);
-        if(queue_.size() >= capacity_ || flushing_) {
+        if(flushing_ || capacity_ == 0) {
+            droppedCount_++;
             return false;
         }
-        queue_.push(frame);
+
+        if(count_ >= capacity_) {
+            if(dropPolicy_ == FRAME_QUEUE_DROP_OLDEST) {
+                droppedFrame = popFront();
+                droppedCount_++;
+            }
+            else if(dropPolicy_ == FRAME_QUEUE_BLOCK && blockTimeoutMsec_ > 0) {
+                notFullCondition_.wait_for(lock, std::chrono::milliseconds(blockTimeoutMsec_),
+                                           [this] { return count_ < capacity_ || stopping_ || flushing_; });
+                if(count_ >= capacity_ || stopping_ || flushing_) {
+                    droppedCount_++;
+                    return false;
+                }
+            }
+            else {
+                droppedCount_++;
+                return false;
+            }
+        }
+
+        ring_[(head_ + count_) % capacity_] = std::move(frame);
+        count_++;
+        lock.unlock();
         condition_.notify_one();
         return true;
     }
@@ -47,22 +125,18 @@ public:
     // blocking methods
     std::shared_ptr<T> dequeue(uint64_t timeoutMsec = 0) {  // returns nullptr if timeout is reached
         std::unique_lock<std::mutex> lock(mutex_);
-        if(!queue_.empty()) {
-            auto result = queue_.front();
-            queue_.pop();
-            return result;
-        }
-
-        if(timeoutMsec == 0) {
-            return nullptr;
-        }
-
-        condition_.wait_for(lock, std::chrono::milliseconds(timeoutMsec), [this] { return !queue_.empty(); });
-        if(queue_.empty()) {
-            return nullptr;
+        if(count_ == 0) {
+            if(timeoutMsec == 0) {
+                return nullptr;
+            }
+            condition_.wait_for(lock, std::chrono::milliseconds(timeoutMsec), [this] { return count_ > 0; });
+            if(count_ == 0) {
+                return nullptr;
+            }
         }
-        auto result = queue_.front();
-        queue_.pop();
+        auto result = popFront();
+        lock.unlock();
+        notFullCondition_.notify_one();
         return result;
     }
 
@@ -75,18 +149,23 @@ public:
         stoped_        = false;
         stopping_      = false;
         flushing_      = false;
-        dequeueThread_ = std::thread([&] {
-            std::unique_lock<std::mutex> lock(mutex_);
+        dequeueThread_ = std::thread([this] {
             while(true) {
-                condition_.wait(lock, [this] { return !queue_.empty() || stopping_ || flushing_; });
-                if(stopping_) {
-                    break;
+                std::shared_ptr<T> frame;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    condition_.wait(lock, [this] { return count_ > 0 || stopping_ || flushing_; });
+                    if(stopping_) {
+                        break;
+                    }
+                    if(flushing_ && count_ == 0) {
+                        break;
+                    }
+                    frame = popFront();
                 }
-                if(flushing_ && queue_.empty()) {
-                    break;
-                }
-                std::shared_ptr<T> frame = queue_.front();
-                queue_.pop();
+                notFullCondition_.notify_one();
+
+                // dispatch without holding the lock, so enqueue() never waits for the callback
                 if(frame) {
                     callback_(frame);
                 }
@@ -100,40 +179,66 @@ public:
     }
 
     void flush() {  // stop until all frames are called back
-        flushing_ = true;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            flushing_ = true;
+        }
         condition_.notify_one();
+        notFullCondition_.notify_all();
         if(dequeueThread_.joinable()) {
             dequeueThread_.join();
         }
     }
 
     void stop() {  // stop immediately
-        stopping_ = true;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
         condition_.notify_one();
+        notFullCondition_.notify_all();
         if(dequeueThread_.joinable()) {
             dequeueThread_.join();
         }
 
-        std::unique_lock<std::mutex> lock(mutex_);
-        while(!queue_.empty()) {
-            queue_.pop();
+        std::vector<std::shared_ptr<T>> frames;  // destroy frames after unlocking
+        std::unique_lock<std::mutex>    lock(mutex_);
+        while(count_ > 0) {
+            frames.push_back(popFront());
         }
     }
 
     // clear all frames in queue, flags, and callback. Stop dequeue thread. reset to initial state.
     void reset() {
         stop();  // try stop if it's running, clear all frames on queue
-        callback_ = nullptr;
-        stopping_ = false;
-        flushing_ = false;
-        stoped_   = true;
+        callback_     = nullptr;
+        stopping_     = false;
+        flushing_     = false;
+        stoped_       = true;
+        droppedCount_ = 0;
+    }
+
+private:
+    // must be called with mutex_ held and count_ > 0
+    std::shared_ptr<T> popFront() {
+        auto result = std::move(ring_[head_]);
+        head_       = (head_ + 1) % capacity_;
+        count_--;
+        return result;
     }
 
 private:
-    std::mutex                     mutex_;
-    std::condition_variable        condition_;
-    std::queue<std::shared_ptr<T>> queue_;
-    size_t                         capacity_;
+    mutable std::mutex              mutex_;
+    std::condition_variable         condition_;         // signaled when a frame is queued
+    std::condition_variable         notFullCondition_;  // signaled when a frame is dequeued, used by FRAME_QUEUE_BLOCK policy
+    std::vector<std::shared_ptr<T>> ring_;
+    size_t                          head_;
+    size_t                          count_;
+    size_t                          capacity_;
+
+    FrameQueueDropPolicy  dropPolicy_;
+    uint64_t              blockTimeoutMsec_;
+    std::atomic<uint64_t> droppedCount_;
 
     std::thread                             dequeueThread_;
     std::atomic<bool>                       stoped_;
@@ -142,4 +247,4 @@ private:
     std::atomic<bool>                       flushing_;
 };
 
-}  // namespace libobsensor
\ No newline at end of file
+}  // namespace libobsensor
@@ -16,7 +16,8 @@ StreamProfileBackendLifeSpan::~StreamProfileBackendLifeSpan() {
     logger_.reset();
 }
 
-StreamProfile::StreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format) : owner_(owner), type_(type), format_(format), index_(0) {}
+StreamProfile::StreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format)
+    : owner_(owner), type_(type), format_(format), index_(0), kind_(KIND) {}
 
 std::shared_ptr<LazySensor> StreamProfile::getOwner() const {
     return owner_.lock();
@@ -83,7 +84,9 @@ std::ostream &StreamProfile::operator<<(std::ostream &os) const {
 }
 
 VideoStreamProfile::VideoStreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format, uint32_t width, uint32_t height, uint32_t fps)
-    : StreamProfile(owner, type, format), width_(width), height_(height), fps_(fps) {}
+    : StreamProfile(owner, type, format), width_(width), height_(height), fps_(fps) {
+    kind_ |= KIND;
+}
 
 void VideoStreamProfile::setWidth(uint32_t width) {
     width_ = width;
@@ -146,7 +149,9 @@ std::shared_ptr<StreamProfile> VideoStreamProfile::clone() const {
 
 DisparityBasedStreamProfile::DisparityBasedStreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format, uint32_t width, uint32_t height,
                                                          uint32_t fps)
-    : VideoStreamProfile(owner, type, format, width, height, fps) {}
+    : VideoStreamProfile(owner, type, format, width, height, fps) {
+    kind_ |= KIND;
+}
 
 OBDisparityParam DisparityBasedStreamProfile::getDisparityParam() const {
     auto intrinsicsMgr = StreamIntrinsicsManager::getInstance();
@@ -178,7 +183,9 @@ std::shared_ptr<StreamProfile> DisparityBasedStreamProfile::clone() const {
 }
 
 AccelStreamProfile::AccelStreamProfile(std::shared_ptr<LazySensor> owner, OBAccelFullScaleRange fullScaleRange, OBAccelSampleRate sampleRate)
-    : StreamProfile{ owner, OB_STREAM_ACCEL, OB_FORMAT_ACCEL }, fullScaleRange_(fullScaleRange), sampleRate_(sampleRate) {}
+    : StreamProfile{ owner, OB_STREAM_ACCEL, OB_FORMAT_ACCEL }, fullScaleRange_(fullScaleRange), sampleRate_(sampleRate) {
+    kind_ |= KIND;
+}
 bool VideoStreamProfile::operator==(const VideoStreamProfile &other) const {
     return (type_ == other.type_) && (format_ == other.format_) && (width_ == other.width_) && (height_ == other.height_) && (fps_ == other.fps_);
 }
@@ -221,7 +228,9 @@ std::ostream &AccelStreamProfile::operator<<(std::ostream &os) const {
 }
 
 GyroStreamProfile::GyroStreamProfile(std::shared_ptr<LazySensor> owner, OBGyroFullScaleRange fullScaleRange, OBGyroSampleRate sampleRate)
-    : StreamProfile{ owner, OB_STREAM_GYRO, OB_FORMAT_GYRO }, fullScaleRange_(fullScaleRange), sampleRate_(sampleRate) {}
+    : StreamProfile{ owner, OB_STREAM_GYRO, OB_FORMAT_GYRO }, fullScaleRange_(fullScaleRange), sampleRate_(sampleRate) {
+    kind_ |= KIND;
+}
 
 OBGyroFullScaleRange GyroStreamProfile::getFullScaleRange() const {
     return fullScaleRange_;
@@ -4,6 +4,7 @@
 #include "exception/ObException.hpp"
 #include <memory>
 #include <vector>
+#include <type_traits>
 
 namespace libobsensor {
 
@@ -25,6 +26,9 @@ private:
 
 class StreamProfile : public std::enable_shared_from_this<StreamProfile>, private StreamProfileBackendLifeSpan {
 public:
+    // Class kind bit, see Frame::KIND
+    static constexpr uint32_t KIND = 0x0001;
+
     StreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format);
 
     virtual ~StreamProfile() noexcept = default;
@@ -46,12 +50,8 @@ public:
     virtual std::shared_ptr<StreamProfile> clone() const;
     virtual std::shared_ptr<StreamProfile> clone(OBFormat newFormat) const;
 
-    template <typename T> bool               is() const {
-        return std::dynamic_pointer_cast<const T>(shared_from_this()) != nullptr;
-    }
-
-    template <typename T> bool               is() {
-        return std::dynamic_pointer_cast<T>(shared_from_this()) != nullptr;
+    template <typename T> bool is() const {
+        return (kind_ & std::remove_const<T>::type::KIND) == std::remove_const<T>::type::KIND;
     }
 
     template <typename T> std::shared_ptr<T> as() {
@@ -59,7 +59,7 @@ public:
             throw unsupported_operation_exception("unsupported operation, object's type is not require type");
         }
 
-        return std::dynamic_pointer_cast<T>(shared_from_this());
+        return std::static_pointer_cast<T>(shared_from_this());
     }
 
     template <typename T> std::shared_ptr<const T> as() const {
@@ -67,7 +67,22 @@ public:
             throw unsupported_operation_exception("unsupported operation, object's type is not require type");
         }
 
-        return std::dynamic_pointer_cast<const T>(shared_from_this());
+        return std::static_pointer_cast<const T>(shared_from_this());
+    }
+
+    // Same as as(), but does not touch the reference count; use it when the caller does not need to share the ownership of the profile
+    template <typename T> T &asRef() {
+        if(!is<T>()) {
+            throw unsupported_operation_exception("unsupported operation, object's type is not require type");
+        }
+        return static_cast<T &>(*this);
+    }
+
+    template <typename T> const T &asRef() const {
+        if(!is<const T>()) {
+            throw unsupported_operation_exception("unsupported operation, object's type is not require type");
+        }
+        return static_cast<const T &>(*this);
     }
 
     virtual std::ostream &operator<<(std::ostream &os) const;
@@ -77,10 +92,13 @@ protected:
     OBStreamType              type_;
     OBFormat                  format_;
     uint8_t                   index_;  // for multi-stream sensor (multi pin uvc device)
+    uint32_t                  kind_;   // KIND bits of the object's class hierarchy, set during construction
 };
 
 class VideoStreamProfile : public StreamProfile {
 public:
+    static constexpr uint32_t KIND = StreamProfile::KIND | 0x0002;
+
     VideoStreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format, uint32_t width, uint32_t height, uint32_t fps);
     VideoStreamProfile(std::shared_ptr<const VideoStreamProfile> other) = delete;
 
@@ -109,6 +127,8 @@ protected:
 
 class DisparityBasedStreamProfile : public VideoStreamProfile {
 public:
+    static constexpr uint32_t KIND = VideoStreamProfile::KIND | 0x0004;
+
     DisparityBasedStreamProfile(std::shared_ptr<LazySensor> owner, OBStreamType type, OBFormat format, uint32_t width, uint32_t height, uint32_t fps);
     ~DisparityBasedStreamProfile() noexcept override = default;
 
@@ -120,6 +140,8 @@ public:
 
 class AccelStreamProfile : public StreamProfile {
 public:
+    static constexpr uint32_t KIND = StreamProfile::KIND | 0x0008;
+
     AccelStreamProfile(std::shared_ptr<LazySensor> owner, OBAccelFullScaleRange fullScaleRange, OBAccelSampleRate sampleRate);
     ~AccelStreamProfile() noexcept override = default;
 
@@ -137,6 +159,8 @@ protected:
 
 class GyroStreamProfile : public StreamProfile {
 public:
+    static constexpr uint32_t KIND = StreamProfile::KIND | 0x0010;
+
     GyroStreamProfile(std::shared_ptr<LazySensor> owner, OBGyroFullScaleRange fullScaleRange, OBGyroSampleRate sampleRate);
     ~GyroStreamProfile() noexcept override = default;
 
@@ -343,7 +343,7 @@ std::shared_ptr<IFilter> DeviceBase::getSensorFrameFilter(const std::string &nam
     auto filterFactory = FilterFactory::getInstance();
     TRY_EXECUTE({
         auto filter               = filterFactory->createFilter(name);
-        sensorFrameFilters_[type] = filter;
+        sensorFrameFilters_.insert({ type, filter });
         return filter;
     });
 
@@ -79,7 +79,7 @@ private:
     std::atomic<bool> isDeactivated_;
 
     std::map<OBSensorType, std::shared_ptr<const SourcePortInfo>> sensorPortInfos_;
-    std::map<OBSensorType, std::shared_ptr<IFilter>>              sensorFrameFilters_;
+    std::multimap<OBSensorType, std::shared_ptr<IFilter>>         sensorFrameFilters_;  // a sensor may use several filters, e.g. a decoder and a format converter
 };
 
 }  // namespace libobsensor
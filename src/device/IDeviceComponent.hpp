@@ -95,6 +95,7 @@ typedef enum {
     OB_DEV_COMPONENT_GLOBAL_TIMESTAMP_FILTER,
     OB_DEV_COMPONENT_DEVICE_SYNC_CONFIGURATOR,
     OB_DEV_COMPONENT_DEVICE_CLOCK_SYNCHRONIZER,
+    OB_DEV_COMPONENT_DEVICE_TIME_TRACKER,
     OB_DEV_COMPONENT_DEVICE_MONITOR,
 
     OB_DEV_COMPONENT_RAW_PHASE_STREAMER,
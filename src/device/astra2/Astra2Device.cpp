@@ -19,6 +19,7 @@
 #include "sensor/imu/AccelSensor.hpp"
 #include "sensor/imu/GyroSensor.hpp"
 #include "timestamp/GlobalTimestampFitter.hpp"
+#include "timestamp/DeviceTimeTracker.hpp"
 #include "timestamp/DeviceClockSynchronizer.hpp"
 #include "property/VendorPropertyAccessor.hpp"
 #include "property/UvcPropertyAccessor.hpp"
@@ -62,6 +63,8 @@ void Astra2Device::init() {
     auto globalTimestampFilter = std::make_shared<GlobalTimestampFitter>(this);
     registerComponent(OB_DEV_COMPONENT_GLOBAL_TIMESTAMP_FILTER, globalTimestampFilter);
 
+    registerComponent(OB_DEV_COMPONENT_DEVICE_TIME_TRACKER, [this]() { return std::make_shared<DeviceTimeTracker>(this); });
+
     auto algParamManager = std::make_shared<Astra2AlgParamManager>(this);
     registerComponent(OB_DEV_COMPONENT_ALG_PARAM_MANAGER, algParamManager);
 
@@ -4,6 +4,10 @@
 #include "frame/Frame.hpp"
 #include "stream/StreamProfile.hpp"
 #include "logger/LoggerHelper.hpp"
+#include "frame/FrameMemoryPool.hpp"
+#include "environment/EnvConfig.hpp"
+
+#include <algorithm>
 
 namespace libobsensor {
 SensorBase::SensorBase(IDevice *owner, OBSensorType sensorType, const std::shared_ptr<ISourcePort> &backend)
@@ -245,6 +249,37 @@ void SensorBase::setGlobalTimestampCalculator(std::shared_ptr<IFrameTimestampCal
     globalTimestampCalculator_ = calculator;
 }
 
+#define FRAME_BUFFER_RESERVE_DURATION_MS 100  // frames produced within this duration are expected to be in flight at the same time
+#define FRAME_BUFFER_RESERVE_EXTRA_COUNT 2     // the frame being captured and the frame being processed
+
+void SensorBase::reserveFrameBuffers(std::shared_ptr<const StreamProfile> sp) {
+    float fps = 0;
+    if(sp->is<VideoStreamProfile>()) {
+        fps = static_cast<float>(sp->as<VideoStreamProfile>()->getFps());
+    }
+    else if(sp->is<AccelStreamProfile>()) {
+        fps = utils::mapIMUSampleRateToValue(sp->as<AccelStreamProfile>()->getSampleRate());
+    }
+    else if(sp->is<GyroStreamProfile>()) {
+        fps = utils::mapIMUSampleRateToValue(sp->as<GyroStreamProfile>()->getSampleRate());
+    }
+
+    // Frames can not be in flight more than the queues between the sensor and the user can hold
+    int  pipelineQueueSize   = 10;
+    int  processingQueueSize = 10;
+    auto envConfig           = EnvConfig::getInstance();
+    envConfig->getIntValue("Memory.PipelineFrameQueueSize", pipelineQueueSize);
+    envConfig->getIntValue("Memory.FrameProcessingBlockQueueSize", processingQueueSize);
+    auto maxInFlightCount = static_cast<size_t>(std::max(pipelineQueueSize, 0) + std::max(processingQueueSize, 0));
+
+    auto reserveCount = static_cast<size_t>(fps * FRAME_BUFFER_RESERVE_DURATION_MS / 1000.0f + 0.999f);
+    reserveCount      = std::min(reserveCount, maxInFlightCount) + FRAME_BUFFER_RESERVE_EXTRA_COUNT;
+
+    auto memoryPool = FrameMemoryPool::getInstance();
+    auto frameType  = utils::mapStreamTypeToFrameType(sp->getType());
+    TRY_EXECUTE(memoryPool->createFrameBufferManager(frameType, sp, reserveCount));
+}
+
 void SensorBase::outputFrame(std::shared_ptr<Frame> frame) {
     if(frameMetadataParserContainer_) {
         TRY_EXECUTE(frame->registerMetadataParsers(frameMetadataParserContainer_));
@@ -53,6 +53,9 @@ protected:
 
     virtual void outputFrame(std::shared_ptr<Frame> frame);
 
+    // pre-allocate and warm the frame buffers of the stream profile before the stream starts, to avoid allocations on the first frames
+    void reserveFrameBuffers(std::shared_ptr<const StreamProfile> sp);
+
 protected:
     IDevice                     *owner_;
     const OBSensorType           sensorType_;
@@ -51,6 +51,7 @@ void AccelSensor::start(std::shared_ptr<const StreamProfile> sp, FrameCallback c
     activatedStreamProfile_ = sp;
     frameCallback_          = callback;
     updateStreamState(STREAM_STATE_STARTING);
+    reserveFrameBuffers(sp);
 
     auto owner      = getOwner();
     auto propServer = owner->getPropertyServer();
@@ -51,6 +51,7 @@ void GyroSensor::start(std::shared_ptr<const StreamProfile> sp, FrameCallback ca
     activatedStreamProfile_ = sp;
     frameCallback_          = callback;
     updateStreamState(STREAM_STATE_STARTING);
+    reserveFrameBuffers(sp);
 
     auto owner        = getOwner();
     auto propServer   = owner->getPropertyServer();
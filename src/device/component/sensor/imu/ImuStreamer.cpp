@@ -6,16 +6,20 @@
 #include "logger/LoggerInterval.hpp"
 #include "utils/Utils.hpp"
 #include "publicfilters/IMUCorrector.hpp"
+#include "environment/EnvConfig.hpp"
 
 namespace libobsensor {
 
-const size_t IMU_FILTER_FRAME_QUEUE_SIZE = 100;
+const size_t   IMU_FILTER_FRAME_QUEUE_SIZE = 100;
+const uint32_t IMU_BATCH_FRAME_CAPACITY    = 255;  // OBImuHeader::groupCount is 8 bits
 
 ImuStreamer::ImuStreamer(IDevice *owner, const std::shared_ptr<IDataStreamPort> &backend, const std::shared_ptr<IFilter> &filter)
     : ImuStreamer(owner, backend, std::vector<std::shared_ptr<IFilter>>({ filter })) {}
 
 ImuStreamer::ImuStreamer(IDevice *owner, const std::shared_ptr<IDataStreamPort> &backend, std::vector<std::shared_ptr<IFilter>> filters)
-    : owner_(owner), backend_(backend), filters_(std::move(filters)), running_(false) {
+    : owner_(owner), backend_(backend), filters_(std::move(filters)), running_(false), frameIndex_(0), batchOutput_(false) {
+    EnvConfig::getInstance()->getBooleanValue("Misc.ImuBatchFrameEnable", batchOutput_);
+
     auto iter = filters_.begin();
     while(iter != filters_.end()) {
         (*iter)->resizeFrameQueue(IMU_FILTER_FRAME_QUEUE_SIZE);
@@ -30,7 +34,7 @@ ImuStreamer::ImuStreamer(IDevice *owner, const std::shared_ptr<IDataStreamPort>
         iter++;
     }
 
-    LOG_DEBUG("ImuStreamer created");
+    LOG_DEBUG("ImuStreamer created, batchOutput_={}", batchOutput_);
 }
 
 ImuStreamer::~ImuStreamer() noexcept {
@@ -118,6 +122,21 @@ void ImuStreamer::parseIMUData(std::shared_ptr<Frame> frame) {
     }
 
     uint8_t *imuOrgData = (uint8_t *)data + sizeof(OBImuHeader);
+    if(batchOutput_) {
+        if(header->groupCount == 0) {
+            return;
+        }
+        auto frameSet = createImuBatchFrameSet(header, (const OBImuOriginData *)imuOrgData, frame->getSystemTimeStampUsec(), accelStreamProfile,
+                                               gyroStreamProfile);
+        if(!filters_.empty()) {
+            filters_.front()->pushFrame(frameSet);
+        }
+        else {
+            outputFrame(frameSet);
+        }
+        return;
+    }
+
     for(int groupIndex = 0; groupIndex < header->groupCount; groupIndex++) {
         auto frameSet = FrameFactory::createFrameSet();
 
@@ -165,6 +184,47 @@ void ImuStreamer::parseIMUData(std::shared_ptr<Frame> frame) {
     }
 }
 
+std::shared_ptr<Frame> ImuStreamer::createImuBatchFrameSet(const OBImuHeader *header, const OBImuOriginData *imuData, uint64_t sysTspUs,
+                                                           const std::shared_ptr<const AccelStreamProfile> &accelStreamProfile,
+                                                           const std::shared_ptr<const GyroStreamProfile>  &gyroStreamProfile) {
+    const uint32_t count      = header->groupCount;
+    auto           frameSet   = FrameFactory::createFrameSet();
+    auto           frameIndex = frameIndex_;
+    frameIndex_ += count;
+
+    // Same conversion as the per-sample frames, one stream at a time so that each output array is written contiguously
+    auto fillBatchFrame = [&](std::shared_ptr<ImuBatchFrame> batchFrame, float sensitivity, bool isAccel) {
+        auto timestamps   = batchFrame->getTimestampsMutable();
+        auto x            = batchFrame->getValuesMutable(0);
+        auto y            = batchFrame->getValuesMutable(1);
+        auto z            = batchFrame->getValuesMutable(2);
+        auto temperatures = batchFrame->getTemperaturesMutable();
+        for(uint32_t i = 0; i < count; i++) {
+            auto &sample    = imuData[i];
+            timestamps[i]   = ((uint64_t)sample.timestamp[0] | ((uint64_t)sample.timestamp[1] << 32));
+            x[i]            = (isAccel ? sample.accelX : sample.gyroX) / sensitivity;
+            y[i]            = (isAccel ? sample.accelY : sample.gyroY) / sensitivity;
+            z[i]            = (isAccel ? sample.accelZ : sample.gyroZ) / sensitivity;
+            temperatures[i] = IMUCorrector::calculateRegisterTemperature(sample.temperature);
+        }
+        batchFrame->setSampleCount(count);
+        batchFrame->setNumber(frameIndex);
+        batchFrame->setTimeStampUsec(timestamps[0]);
+        batchFrame->setSystemTimeStampUsec(sysTspUs);
+        frameSet->pushFrame(std::move(batchFrame));
+    };
+
+    if(accelStreamProfile) {
+        auto fs = static_cast<uint8_t>(accelStreamProfile->getFullScaleRange());
+        fillBatchFrame(FrameFactory::createImuBatchFrame(accelStreamProfile, IMU_BATCH_FRAME_CAPACITY), IMUCorrector::calculateAccelSensitivity(fs), true);
+    }
+    if(gyroStreamProfile) {
+        auto fs = static_cast<uint8_t>(gyroStreamProfile->getFullScaleRange());
+        fillBatchFrame(FrameFactory::createImuBatchFrame(gyroStreamProfile, IMU_BATCH_FRAME_CAPACITY), IMUCorrector::calculateGyroSensitivity(fs), false);
+    }
+    return frameSet;
+}
+
 void ImuStreamer::outputFrame(std::shared_ptr<Frame> frame) {
     if(!frame) {
         return;
@@ -10,6 +10,9 @@
 
 namespace libobsensor {
 
+class AccelStreamProfile;
+class GyroStreamProfile;
+
 // Original imu data, software packaging method, needs to be calculated on the sdk side
 typedef struct {
     uint8_t  reportId;    // Firmware fixed transmission 1
@@ -46,6 +49,11 @@ private:
     virtual void parseIMUData(std::shared_ptr<Frame> frame);
     virtual void outputFrame(std::shared_ptr<Frame> frame);
 
+    // Output all samples of a packet as one ImuBatchFrame per stream
+    std::shared_ptr<Frame> createImuBatchFrameSet(const OBImuHeader *header, const OBImuOriginData *imuData, uint64_t sysTspUs,
+                                                  const std::shared_ptr<const AccelStreamProfile> &accelStreamProfile,
+                                                  const std::shared_ptr<const GyroStreamProfile>  &gyroStreamProfile);
+
 private:
     IDevice                         *owner_;
     std::shared_ptr<IDataStreamPort> backend_;
@@ -57,5 +65,6 @@ private:
     std::atomic_bool running_;
 
     uint64_t frameIndex_;
+    bool     batchOutput_;  // Misc.ImuBatchFrameEnable
 };
 }  // namespace libobsensor
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "FrameDecodeWorkerPool.hpp"
+#include "publicfilters/FormatConverterProcess.hpp"
+#include "logger/LoggerInterval.hpp"
+#include "exception/ObException.hpp"
+
+#include <algorithm>
+
+namespace libobsensor {
+
+FrameDecodeWorkerPool::FrameDecodeWorkerPool(size_t threadCount, OBFormat srcFormat, OBFormat dstFormat, std::function<void(std::shared_ptr<Frame>)> callback)
+    : callback_(callback),
+      nextInputSeq_(0),
+      nextOutputSeq_(0),
+      inFlightCount_(0),
+      maxInFlightCount_(0),
+      delivering_(false),
+      stopped_(false),
+      droppedCount_(0) {
+    threadCount       = std::max<size_t>(1, std::min<size_t>(threadCount, MAX_FRAME_DECODE_THREAD_COUNT));
+    maxInFlightCount_ = threadCount * 2;  // every worker may have one frame queued while decoding another one
+    for(size_t i = 0; i < threadCount; i++) {
+        auto converter = std::make_shared<FormatConverter>();
+        converter->setConversion(srcFormat, dstFormat);
+        workers_.emplace_back([this, converter] { workerLoop(converter); });
+    }
+    LOG_DEBUG("FrameDecodeWorkerPool created! thread count={}, {} -> {}", threadCount, srcFormat, dstFormat);
+}
+
+FrameDecodeWorkerPool::~FrameDecodeWorkerPool() noexcept {
+    stop();
+}
+
+bool FrameDecodeWorkerPool::submit(std::shared_ptr<const Frame> frame) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(stopped_) {
+            return false;
+        }
+        if(inFlightCount_ >= maxInFlightCount_) {
+            droppedCount_++;
+            return false;
+        }
+        tasks_.push_back({ nextInputSeq_++, frame });
+        inFlightCount_++;
+    }
+    condition_.notify_one();
+    return true;
+}
+
+void FrameDecodeWorkerPool::stop() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    condition_.notify_all();
+    for(auto &worker: workers_) {
+        if(worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+
+    std::deque<Task>                            tasks;  // destroy frames after unlocking
+    std::map<uint64_t, std::shared_ptr<Frame>> decodedFrames;
+    std::unique_lock<std::mutex>                lock(mutex_);
+    tasks.swap(tasks_);
+    decodedFrames.swap(decodedFrames_);
+    inFlightCount_ = 0;
+}
+
+void FrameDecodeWorkerPool::workerLoop(std::shared_ptr<FormatConverter> converter) {
+    while(true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return !tasks_.empty() || stopped_; });
+            if(stopped_) {
+                break;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        std::shared_ptr<Frame> decodedFrame;
+        try {
+            decodedFrame = converter->process(task.frame);
+        }
+        catch(const std::exception &e) {
+            LOG_WARN_INTVL("Failed to decode frame on worker thread! {}", e.what());
+        }
+        task.frame.reset();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        decodedFrames_[task.seq] = decodedFrame;
+        decodedFrame.reset();
+        if(delivering_) {
+            continue;  // the delivering worker will pick up this frame when its turn comes
+        }
+
+        // Deliver the frames that are next in input order. Only one worker delivers at a time, so the order is kept while the callback runs
+        // without holding the lock.
+        delivering_ = true;
+        while(!stopped_) {
+            auto iter = decodedFrames_.find(nextOutputSeq_);
+            if(iter == decodedFrames_.end()) {
+                break;
+            }
+            auto frame = std::move(iter->second);
+            decodedFrames_.erase(iter);
+            nextOutputSeq_++;
+            inFlightCount_--;
+            lock.unlock();
+            if(frame) {
+                TRY_EXECUTE(callback_(frame));
+            }
+            else {
+                LOG_WARN_INTVL("This frame will be dropped because it failed to decode on worker thread!");
+            }
+            frame.reset();
+            lock.lock();
+        }
+        delivering_ = false;
+    }
+}
+
+}  // namespace libobsensor
@@ -0,0 +1,65 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Orbbec Corporation. All Rights Reserved.
+
+#pragma once
+#include "IFrame.hpp"
+#include "frame/Frame.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libobsensor {
+
+#define MAX_FRAME_DECODE_THREAD_COUNT 8
+
+class FormatConverter;
+
+// Converts (decodes) frames on several worker threads, so that consecutive frames are decoded in parallel and the capture thread is not blocked
+// by the decoding. Each worker owns its own FormatConverter. Output frames are reordered and delivered in their input order, one at a time.
+class FrameDecodeWorkerPool {
+public:
+    FrameDecodeWorkerPool(size_t threadCount, OBFormat srcFormat, OBFormat dstFormat, std::function<void(std::shared_ptr<Frame>)> callback);
+    ~FrameDecodeWorkerPool() noexcept;
+
+    // returns false if the frame is dropped because all workers are busy and the reorder buffer is full
+    bool submit(std::shared_ptr<const Frame> frame);
+
+    // stop all workers, frames not delivered yet are discarded
+    void stop();
+
+    uint64_t droppedCount() const {
+        return droppedCount_;
+    }
+
+private:
+    void workerLoop(std::shared_ptr<FormatConverter> converter);
+
+private:
+    struct Task {
+        uint64_t                     seq;
+        std::shared_ptr<const Frame> frame;
+    };
+
+    std::function<void(std::shared_ptr<Frame>)> callback_;
+    std::vector<std::thread>                    workers_;
+
+    std::mutex                                  mutex_;
+    std::condition_variable                     condition_;
+    std::deque<Task>                            tasks_;
+    std::map<uint64_t, std::shared_ptr<Frame>> decodedFrames_;  // seq -> decoded frame (nullptr if decoding failed), waiting to be delivered in order
+    uint64_t                                    nextInputSeq_;
+    uint64_t                                    nextOutputSeq_;
+    size_t                                      inFlightCount_;  // submitted but not delivered yet
+    size_t                                      maxInFlightCount_;
+    bool                                        delivering_;
+    bool                                        stopped_;
+    std::atomic<uint64_t>                       droppedCount_;
+};
+
+}  // namespace libobsensor
@@ -7,9 +7,13 @@
 #include "frame/Frame.hpp"
 #include "FilterDecorator.hpp"
 #include "publicfilters/FormatConverterProcess.hpp"
+#include "publicfilters/VideoDecoderProcess.hpp"
 #include "ISensorStreamStrategy.hpp"
 #include "IDevice.hpp"
 #include "component/property/InternalProperty.hpp"
+#include "environment/EnvConfig.hpp"
+
+#include <algorithm>
 
 namespace libobsensor {
 
@@ -67,6 +71,8 @@ void VideoSensor::start(std::shared_ptr<const StreamProfile> sp, FrameCallback c
     currentBackendStreamProfile_ = backendIter->second.first;
     currentFormatFilterConfig_   = backendIter->second.second;
 
+    videoDecoder_.reset();
+    resizedStreamProfile_.reset();
     if(currentFormatFilterConfig_ && currentFormatFilterConfig_->converter) {
         auto filter          = std::dynamic_pointer_cast<FilterDecorator>(currentFormatFilterConfig_->converter);
         auto baseFilter      = filter->getBaseFilter();
@@ -74,17 +80,53 @@ void VideoSensor::start(std::shared_ptr<const StreamProfile> sp, FrameCallback c
         if(formatConverter) {
             formatConverter->setConversion(currentFormatFilterConfig_->srcFormat, currentFormatFilterConfig_->dstFormat);
         }
+        videoDecoder_ = std::dynamic_pointer_cast<VideoDecoder>(baseFilter);
+        if(videoDecoder_) {
+            videoDecoder_->reset();  // the new stream starts with a key frame, do not hold the frames of the previous one
+            videoDecoder_->setOutputFormat(currentFormatFilterConfig_->dstFormat);
+        }
         currentFormatFilterConfig_->converter->setCallback(callback);
     }
 
+    reserveFrameBuffers(currentBackendStreamProfile_);
+    if(currentBackendStreamProfile_ != sp) {
+        reserveFrameBuffers(sp);  // output frames of the format converter
+    }
+
+    auto envConfig = EnvConfig::getInstance();
+    decodeWorkerPool_.reset();
+    if(currentFormatFilterConfig_ && currentFormatFilterConfig_->converter && currentFormatFilterConfig_->srcFormat == OB_FORMAT_MJPG) {
+        int decodeThreadCount = 0;
+        envConfig->getIntValue("Misc.MjpegDecodeThreadCount", decodeThreadCount);
+        if(decodeThreadCount > 0) {
+            decodeWorkerPool_.reset(new FrameDecodeWorkerPool(decodeThreadCount, currentFormatFilterConfig_->srcFormat, currentFormatFilterConfig_->dstFormat,
+                                                              [this](std::shared_ptr<Frame> frame) {
+                                                                  frame->setStreamProfile(activatedStreamProfile_);
+                                                                  outputFrame(frame);
+                                                              }));
+        }
+    }
+
+    // The decode workers already run the frame processing off the capture thread
+    processingQueue_.reset();
+    reportedDroppedCount_ = 0;
+    bool asyncProcessing  = false;
+    envConfig->getBooleanValue("Misc.AsyncFrameProcessing", asyncProcessing);
+    if(asyncProcessing && !decodeWorkerPool_ && ((currentFormatFilterConfig_ && currentFormatFilterConfig_->converter) || frameProcessor_)) {
+        int queueSize = 10;
+        envConfig->getIntValue("Memory.FrameProcessingBlockQueueSize", queueSize);
+        processingQueue_.reset(new FrameQueue<Frame>(static_cast<size_t>(std::max(queueSize, 1)), FRAME_QUEUE_DROP_OLDEST));
+        processingQueue_->start([this](std::shared_ptr<Frame> frame) { TRY_EXECUTE(processFrame(frame)); });
+        LOG_DEBUG("Async frame processing enabled, queue size={} @{}", processingQueue_->capacity(), sensorType_);
+    }
+
     auto vsPort = std::dynamic_pointer_cast<IVideoStreamPort>(backend_);
     LOG_INFO("Start backend stream: {}", currentBackendStreamProfile_);
     vsPort->startStream(currentBackendStreamProfile_, [this](std::shared_ptr<Frame> frame) { onBackendFrameCallback(frame); });
 }
 
 void VideoSensor::onBackendFrameCallback(std::shared_ptr<Frame> frame) {
-    auto vsp              = currentBackendStreamProfile_->as<VideoStreamProfile>();
-    auto maxFrameDataSize = vsp->getMaxFrameDataSize();
+    auto maxFrameDataSize = currentBackendStreamProfile_->asRef<VideoStreamProfile>().getMaxFrameDataSize();
 
     auto dataSize = frame->getDataSize();
     auto format   = frame->getFormat();
@@ -121,15 +163,67 @@ void VideoSensor::onBackendFrameCallback(std::shared_ptr<Frame> frame) {
 
     updateStreamState(STREAM_STATE_STREAMING);
 
+    if(decodeWorkerPool_) {
+        if(!decodeWorkerPool_->submit(frame)) {
+            LOG_WARN_INTVL("This frame will be dropped because all decode workers are busy! dropped={} @{}", decodeWorkerPool_->droppedCount(), sensorType_);
+        }
+        return;
+    }
+
+    if(processingQueue_) {
+        processingQueue_->enqueue(frame);
+        auto droppedCount = processingQueue_->droppedCount();
+        if(droppedCount != reportedDroppedCount_) {
+            reportedDroppedCount_ = droppedCount;
+            LOG_WARN_INTVL("Frame processing lags behind capture, the oldest queued frame is dropped! dropped={} @{}", droppedCount, sensorType_);
+        }
+        return;
+    }
+
+    processFrame(frame);
+}
+
+void VideoSensor::processFrame(std::shared_ptr<Frame> frame) {
     if(currentFormatFilterConfig_ && currentFormatFilterConfig_->converter) {
         frame = currentFormatFilterConfig_->converter->process(frame);
         if(!frame) {
-            LOG_WARN_INTVL("This frame will be dropped because format converter process failure! @{}", sensorType_);
+            // A frame threaded decoder returns the picture of a frame with one of the next frames
+            if(!videoDecoder_ || !videoDecoder_->isBuffering()) {
+                LOG_WARN_INTVL("This frame will be dropped because format converter process failure! @{}", sensorType_);
+            }
             return;
         }
     }
-    frame->setStreamProfile(activatedStreamProfile_);
+    setOutputStreamProfile(frame);
     outputFrame(frame);
+
+    // The other pictures the decoder completed with this frame
+    if(videoDecoder_) {
+        while((frame = videoDecoder_->popDecodedFrame()) != nullptr) {
+            setOutputStreamProfile(frame);
+            outputFrame(frame);
+        }
+    }
+}
+
+void VideoSensor::setOutputStreamProfile(std::shared_ptr<Frame> frame) {
+    // The decoder gives the frames the size of the decoded picture when it differs from the stream profile the device was asked for
+    if(videoDecoder_) {
+        auto &decodedProfile   = frame->getStreamProfile()->asRef<VideoStreamProfile>();
+        auto &activatedProfile = activatedStreamProfile_->asRef<VideoStreamProfile>();
+        if(decodedProfile.getWidth() != activatedProfile.getWidth() || decodedProfile.getHeight() != activatedProfile.getHeight()) {
+            if(!resizedStreamProfile_ || resizedStreamProfile_->getWidth() != decodedProfile.getWidth()
+               || resizedStreamProfile_->getHeight() != decodedProfile.getHeight()) {
+                auto resizedProfile = activatedStreamProfile_->clone()->as<VideoStreamProfile>();
+                resizedProfile->setWidth(decodedProfile.getWidth());
+                resizedProfile->setHeight(decodedProfile.getHeight());
+                resizedStreamProfile_ = resizedProfile;
+            }
+            frame->setStreamProfile(resizedStreamProfile_);
+            return;
+        }
+    }
+    frame->setStreamProfile(activatedStreamProfile_);
 }
 
 void VideoSensor::outputFrame(std::shared_ptr<Frame> frame) {
@@ -159,6 +253,14 @@ void VideoSensor::stop() {
 
     auto vsPort = std::dynamic_pointer_cast<IVideoStreamPort>(backend_);
     vsPort->stopStream(currentBackendStreamProfile_);
+    if(decodeWorkerPool_) {
+        LOG_DEBUG("Frames dropped by decode workers: {} @{}", decodeWorkerPool_->droppedCount(), sensorType_);
+        decodeWorkerPool_.reset();
+    }
+    if(processingQueue_) {
+        LOG_DEBUG("Frames dropped by frame processing queue: {} @{}", processingQueue_->droppedCount(), sensorType_);
+        processingQueue_.reset();
+    }
 
     trySendStopStreamVendorCmd();
 
@@ -6,11 +6,16 @@
 #include "IFrame.hpp"
 #include "IFilter.hpp"
 #include "frameprocessor/FrameProcessor.hpp"
+#include "FrameDecodeWorkerPool.hpp"
+#include "frame/FrameQueue.hpp"
 
 #include <map>
 
 namespace libobsensor {
 
+class VideoDecoder;
+class VideoStreamProfile;
+
 enum class FormatFilterPolicy {
     REMOVE,   // Directly remove the stream profile if the format matches the src format
     REPLACE,  // Replace the stream profile with a new format stream profile. If there is a frame format converter available, use it to convert the frame to the
@@ -41,7 +46,9 @@ public:
 protected:
     virtual void trySendStopStreamVendorCmd();
     void         onBackendFrameCallback(std::shared_ptr<Frame> frame);
+    void         processFrame(std::shared_ptr<Frame> frame);  // format conversion and frame processing, then output
     void         outputFrame(std::shared_ptr<Frame> frame) override;
+    void         setOutputStreamProfile(std::shared_ptr<Frame> frame);
 
 protected:
     typedef std::pair<std::shared_ptr<const StreamProfile>, const FormatFilterConfig *> StreamProfileBackendMapValue;
@@ -53,6 +60,20 @@ protected:
     StreamProfileList                    backendStreamProfileList_;
 
     std::shared_ptr<FrameProcessor> frameProcessor_;
+
+    // The base filter of the converter when it is a video decoder, set on start
+    std::shared_ptr<VideoDecoder> videoDecoder_;
+
+    // The activated stream profile with the size of the decoded pictures, when the bitstream does not have the size of the activated one
+    std::shared_ptr<VideoStreamProfile> resizedStreamProfile_;
+
+    // Decodes mjpeg frames off the capture thread if enabled by Misc.MjpegDecodeThreadCount, otherwise frames are converted on the capture thread
+    std::unique_ptr<FrameDecodeWorkerPool> decodeWorkerPool_;
+
+    // Runs processFrame() on its own thread if enabled by Misc.AsyncFrameProcessing, so the capture thread only validates and queues frames.
+    // The oldest queued frame is dropped when processing lags behind capture.
+    std::unique_ptr<FrameQueue<Frame>> processingQueue_;
+    uint64_t                           reportedDroppedCount_ = 0;
 };
 
 }  // namespace libobsensor
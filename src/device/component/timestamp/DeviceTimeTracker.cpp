@@ -0,0 +1,183 @@
+#include "DeviceTimeTracker.hpp"
+#include "utils/Utils.hpp"
+#include "logger/Logger.hpp"
+#include "logger/LoggerInterval.hpp"
+#include "InternalTypes.hpp"
+#include "property/InternalProperty.hpp"
+#include "environment/EnvConfig.hpp"
+
+#include <cmath>
+
+namespace libobsensor {
+
+DeviceTimeTracker::DeviceTimeTracker(IDevice *owner)
+    : DeviceComponentBase(owner),
+      snapshotSeq_(0),
+      snapshotDeviceTime_(0),
+      snapshotHostTimeUsec_(0),
+      lastReadHostTimeUsec_(0),
+      refreshIntervalMsec_(1000),
+      sampleLoopExit_(false),
+      refreshRequested_(false),
+      sampleCount_(0),
+      resyncCount_(0),
+      syncQueryCount_(0) {
+    int value = 0;
+    if(EnvConfig::getInstance()->getIntValue("Misc.DeviceTimeTrackerInterval", value) && value >= 100) {
+        refreshIntervalMsec_ = value;
+    }
+
+    auto                  propServer = owner->getPropertyServer();
+    std::vector<uint32_t> supportedProps;
+    if(propServer->isPropertySupported(OB_PROP_TIMER_RESET_SIGNAL_BOOL, PROP_OP_WRITE, PROP_ACCESS_INTERNAL)) {
+        supportedProps.push_back(OB_PROP_TIMER_RESET_SIGNAL_BOOL);
+    }
+    if(propServer->isPropertySupported(OB_STRUCT_DEVICE_TIME, PROP_OP_WRITE, PROP_ACCESS_INTERNAL)) {
+        supportedProps.push_back(OB_STRUCT_DEVICE_TIME);
+    }
+    if(!supportedProps.empty()) {
+        propServer->registerAccessCallback(supportedProps, [&](uint32_t, const uint8_t *, size_t, PropertyOperationType operationType) {
+            if(operationType == PROP_OP_WRITE) {
+                // The device clock was changed, the snapshot must not be used until it is refreshed
+                invalidate();
+                requestResync();
+            }
+        });
+    }
+
+    // The first sample is taken here rather than on the capture thread
+    BEGIN_TRY_EXECUTE({ sampleDeviceTime(); })
+    CATCH_EXCEPTION_AND_EXECUTE({ LOG_DEBUG("DeviceTimeTracker failed to get device time, will retry on sampling thread"); })
+    sampleThread_ = std::thread(&DeviceTimeTracker::samplingLoop, this);
+
+    LOG_DEBUG("DeviceTimeTracker created: refreshIntervalMsec_={}", refreshIntervalMsec_);
+}
+
+DeviceTimeTracker::~DeviceTimeTracker() noexcept {
+    {
+        std::unique_lock<std::mutex> lock(sampleMutex_);
+        sampleLoopExit_ = true;
+    }
+    sampleCondVar_.notify_one();
+    if(sampleThread_.joinable()) {
+        sampleThread_.join();
+    }
+    LOG_DEBUG("DeviceTimeTracker destroyed: samples={}, resync requests={}, synchronous queries={}", sampleCount_.load(), resyncCount_.load(),
+              syncQueryCount_.load());
+}
+
+bool DeviceTimeTracker::estimateDeviceTime(uint64_t deviceTimeFreq, uint64_t &deviceTime) {
+    uint32_t seq;
+    uint64_t snapshotDeviceTime;
+    uint64_t snapshotHostTimeUsec;
+    do {
+        seq                  = snapshotSeq_.load(std::memory_order_acquire);
+        snapshotDeviceTime   = snapshotDeviceTime_.load(std::memory_order_relaxed);
+        snapshotHostTimeUsec = snapshotHostTimeUsec_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while((seq & 1) || seq != snapshotSeq_.load(std::memory_order_relaxed));
+
+    auto nowUsec = utils::getNowTimesUs();
+    lastReadHostTimeUsec_.store(nowUsec, std::memory_order_relaxed);
+    if(snapshotHostTimeUsec == 0) {
+        wakeSampler();
+        return false;
+    }
+    if(nowUsec - snapshotHostTimeUsec > 2000ull * refreshIntervalMsec_) {
+        wakeSampler();  // sampling was paused while no one read the snapshot
+    }
+
+    auto elapsedUsec = nowUsec > snapshotHostTimeUsec ? nowUsec - snapshotHostTimeUsec : 0;
+    deviceTime       = snapshotDeviceTime + elapsedUsec * deviceTimeFreq / 1000000;
+    return true;
+}
+
+uint64_t DeviceTimeTracker::queryDeviceTime() {
+    syncQueryCount_++;
+    LOG_DEBUG_INTVL("DeviceTimeTracker query device time on calling thread, synchronous queries={}", syncQueryCount_.load());
+    return sampleDeviceTime();
+}
+
+void DeviceTimeTracker::requestResync() {
+    resyncCount_++;
+    LOG_DEBUG_INTVL("DeviceTimeTracker resync requested, resync requests={}, samples={}", resyncCount_.load(), sampleCount_.load());
+    wakeSampler();
+}
+
+bool DeviceTimeTracker::isConsistent(uint64_t frameTimestamp, uint64_t frameTimeFreq, uint64_t deviceTime, uint64_t deviceTimeFreq) {
+    auto frameTimeSec  = static_cast<double>(frameTimestamp) / frameTimeFreq;
+    auto deviceTimeSec = static_cast<double>(deviceTime) / deviceTimeFreq;
+    return std::abs(frameTimeSec - deviceTimeSec) <= 1.0;
+}
+
+uint64_t DeviceTimeTracker::getSampleCount() const {
+    return sampleCount_.load();
+}
+
+uint64_t DeviceTimeTracker::getResyncCount() const {
+    return resyncCount_.load();
+}
+
+uint64_t DeviceTimeTracker::getSyncQueryCount() const {
+    return syncQueryCount_.load();
+}
+
+uint64_t DeviceTimeTracker::sampleDeviceTime() {
+    auto propertyServer = getOwner()->getPropertyServer();
+    auto hostTsp1Usec   = utils::getNowTimesUs();
+    auto devTime        = propertyServer->getStructureDataT<OBDeviceTime>(OB_STRUCT_DEVICE_TIME);
+    auto hostTsp2Usec   = utils::getNowTimesUs();
+    auto deviceTime     = devTime.time + devTime.rtt / 2;
+    publish(deviceTime, (hostTsp1Usec + hostTsp2Usec) / 2);
+    sampleCount_++;
+    return deviceTime;
+}
+
+void DeviceTimeTracker::publish(uint64_t deviceTime, uint64_t hostTimeUsec) {
+    std::unique_lock<std::mutex> lock(publishMutex_);
+    auto                         seq = snapshotSeq_.load(std::memory_order_relaxed);
+    snapshotSeq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    snapshotDeviceTime_.store(deviceTime, std::memory_order_relaxed);
+    snapshotHostTimeUsec_.store(hostTimeUsec, std::memory_order_relaxed);
+    snapshotSeq_.store(seq + 2, std::memory_order_release);
+}
+
+void DeviceTimeTracker::invalidate() {
+    publish(0, 0);
+}
+
+void DeviceTimeTracker::wakeSampler() {
+    if(refreshRequested_.exchange(true)) {
+        return;  // already requested
+    }
+    std::unique_lock<std::mutex> lock(sampleMutex_);
+    sampleCondVar_.notify_one();
+}
+
+void DeviceTimeTracker::samplingLoop() {
+    std::unique_lock<std::mutex> lock(sampleMutex_);
+    while(!sampleLoopExit_) {
+        // Keep refreshing while the snapshot is read, otherwise pause until a read or resync request wakes the thread
+        auto wakeUp = [this] { return sampleLoopExit_ || refreshRequested_.load(); };
+        auto idle   = utils::getNowTimesUs() - lastReadHostTimeUsec_.load(std::memory_order_relaxed) > 3000ull * refreshIntervalMsec_;
+        if(idle) {
+            sampleCondVar_.wait(lock, wakeUp);
+        }
+        else {
+            sampleCondVar_.wait_for(lock, std::chrono::milliseconds(refreshIntervalMsec_), wakeUp);
+        }
+        if(sampleLoopExit_) {
+            break;
+        }
+        refreshRequested_ = false;
+
+        lock.unlock();
+        BEGIN_TRY_EXECUTE({ sampleDeviceTime(); })
+        CATCH_EXCEPTION_AND_EXECUTE({ LOG_WARN_INTVL("DeviceTimeTracker failed to get device time!"); })
+        lock.lock();
+    }
+    LOG_DEBUG("DeviceTimeTracker samplingLoop exit");
+}
+
+}  // namespace libobsensor
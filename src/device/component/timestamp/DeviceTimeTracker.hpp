@@ -0,0 +1,67 @@
+#pragma once
+#include "IDevice.hpp"
+#include "DeviceComponentBase.hpp"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace libobsensor {
+
+// Keeps a snapshot of the device time, refreshed on a background thread while frames are streaming, so that the frame timestamp calculators can
+// get the current device time on the capture thread without a vendor command round trip.
+// The snapshot is published with a sequence lock, readers never block the sampling thread nor each other.
+class DeviceTimeTracker : public DeviceComponentBase {
+public:
+    DeviceTimeTracker(IDevice *owner);
+    ~DeviceTimeTracker() noexcept;
+
+    // Estimate the current device time (time + rtt/2 of OB_STRUCT_DEVICE_TIME, in device clock ticks) from the snapshot.
+    // Returns false if there is no valid snapshot yet.
+    bool estimateDeviceTime(uint64_t deviceTimeFreq, uint64_t &deviceTime);
+
+    // Query the device time on the calling thread and publish it as the new snapshot, for the rare cases the snapshot can not be trusted, e.g.
+    // the device clock was reset by a hardware signal after the last sample.
+    uint64_t queryDeviceTime();
+
+    // Ask the sampling thread to refresh the snapshot as soon as possible, does not block
+    void requestResync();
+
+    // Whether a frame timestamp calculated with an estimated device time is plausible, i.e. within 1s of the device time. If it is not, the
+    // device clock was reset after the snapshot was taken and the device time must be queried.
+    static bool isConsistent(uint64_t frameTimestamp, uint64_t frameTimeFreq, uint64_t deviceTime, uint64_t deviceTimeFreq);
+
+    uint64_t getSampleCount() const;
+    uint64_t getResyncCount() const;
+    uint64_t getSyncQueryCount() const;
+
+private:
+    uint64_t sampleDeviceTime();
+    void     publish(uint64_t deviceTime, uint64_t hostTimeUsec);
+    void     invalidate();
+    void     wakeSampler();
+    void     samplingLoop();
+
+private:
+    // Sequence lock protected snapshot, odd sequence means the writer is updating it
+    std::atomic<uint32_t> snapshotSeq_;
+    std::atomic<uint64_t> snapshotDeviceTime_;
+    std::atomic<uint64_t> snapshotHostTimeUsec_;  // 0 if the snapshot is invalid
+    std::mutex            publishMutex_;          // serializes the writers
+
+    std::atomic<uint64_t> lastReadHostTimeUsec_;
+    uint32_t              refreshIntervalMsec_;
+
+    std::thread             sampleThread_;
+    std::mutex              sampleMutex_;
+    std::condition_variable sampleCondVar_;
+    bool                    sampleLoopExit_;
+    std::atomic<bool>       refreshRequested_;
+
+    std::atomic<uint64_t> sampleCount_;
+    std::atomic<uint64_t> resyncCount_;
+    std::atomic<uint64_t> syncQueryCount_;
+};
+
+}  // namespace libobsensor
@@ -5,6 +5,8 @@
 #include "logger/LoggerInterval.hpp"
 #include "InternalTypes.hpp"
 
+#include <cmath>
+
 namespace libobsensor {
 
 #define BASE_DEV_TIME_MASK 0xffffffff00000000
@@ -24,25 +26,12 @@ void GlobalTimestampCalculator::calculate(std::shared_ptr<Frame> frame) {
     double   transformedTsp              = static_cast<double>(srcTimestamp) * deviceTimeFreq_ / 1000000.0;
     uint64_t transformedTspOverflowValue = static_cast<uint64_t>(static_cast<double>(TSP_OVERFLOW_32BIT) * deviceTimeFreq_ / 1000000.0);
 
-    // Calculate the approximate number of overflows based on the check data. The number of overflows of the current data frame should be within the range of
-    // this number plus or minus 1.
-    uint32_t numOfOverflows = static_cast<uint32_t>(linearFuncParam.checkDataX / transformedTspOverflowValue);
-    if(numOfOverflows > 0) {
-        numOfOverflows--;
-    }
-    while(true) {
-        double value1 = (double)numOfOverflows * transformedTspOverflowValue + transformedTsp;
-        double value2 = (double)(numOfOverflows + 1) * transformedTspOverflowValue + transformedTsp;
-        if(value1 >= linearFuncParam.checkDataX) {
-            break;
-        }
-        if(value1 <= linearFuncParam.checkDataX && value2 >= linearFuncParam.checkDataX) {
-            if(linearFuncParam.checkDataX - value1 > value2 - linearFuncParam.checkDataX) {
-                numOfOverflows++;
-            }
-            break;
-        }
-        numOfOverflows++;
+    // The number of overflows of the current data frame is the one that puts the frame timestamp closest to the check data (the device time of
+    // the latest fitting sample), ties are resolved to the smaller one.
+    double   overflowsToCheckData = (static_cast<double>(linearFuncParam.checkDataX) - transformedTsp) / transformedTspOverflowValue;
+    uint32_t numOfOverflows       = 0;
+    if(overflowsToCheckData > 0.5) {
+        numOfOverflows = static_cast<uint32_t>(std::ceil(overflowsToCheckData - 0.5));
     }
     transformedTsp = (static_cast<double>(TSP_OVERFLOW_32BIT) * numOfOverflows + srcTimestamp) * deviceTimeFreq_ / 1000000;
     auto globalTsp = static_cast<uint64_t>(linearFuncParam.coefficientA * transformedTsp + linearFuncParam.constantB);
@@ -60,7 +49,8 @@ void FrameTimestampCalculatorDirectly::calculate(std::shared_ptr<Frame> frame) {
 }
 
 FrameTimestampCalculatorBaseDeviceTime::FrameTimestampCalculatorBaseDeviceTime(IDevice *device, uint64_t deviceTimeFreq, uint64_t frameTimeFreq)
-    : DeviceComponentBase(device), deviceTimeFreq_(deviceTimeFreq), frameTimeFreq_(frameTimeFreq) {
+    : DeviceComponentBase(device), deviceTimeFreq_(deviceTimeFreq), frameTimeFreq_(frameTimeFreq), prevSrcTsp_(0), prevHostTsp_(0), baseDevTime_(0) {
+    deviceTimeTracker_ = device->getComponentT<DeviceTimeTracker>(OB_DEV_COMPONENT_DEVICE_TIME_TRACKER, false).get();
     auto                  propServer = device->getPropertyServer();
     std::vector<uint32_t> supportedProps;
     if(propServer->isPropertySupported(OB_PROP_TIMER_RESET_SIGNAL_BOOL, PROP_OP_WRITE, PROP_ACCESS_INTERNAL)) {
@@ -110,16 +100,23 @@ uint64_t FrameTimestampCalculatorBaseDeviceTime::calculate(uint64_t srcTimestamp
         LOG_DEBUG_INTVL_MS(1000, "\tsrcTimestamp={0}, prevSrcTsp_={1}, tspDecrease={2}", srcTimestamp, prevSrcTsp_, tspDecrease);
         LOG_DEBUG_INTVL_MS(1000, "\tsrcTspDiffMs={0}, hostTspDiffMs={1}, tspDiffAbnormal={2}", srcTspDiffMs, hostTspDiffMs, tspDiffAbnormal);
 
-        {
-            auto owner          = getOwner();
-            auto propertyServer = owner->getPropertyServer();
-            auto devTime        = propertyServer->getStructureDataT<OBDeviceTime>(OB_STRUCT_DEVICE_TIME);
-            baseDevTime_        = static_cast<uint64_t>((static_cast<double>(devTime.time) + devTime.rtt / 2) / deviceTimeFreq_ * frameTimeFreq_);
+        // The device time is estimated from the snapshot of the device time tracker, so no vendor command round trip is done on the capture
+        // thread. It is only queried here if the estimate does not fit the frame timestamp, e.g. the device clock was reset by a hardware signal.
+        uint64_t devTime   = 0;
+        bool     estimated = deviceTimeTracker_ && deviceTimeTracker_->estimateDeviceTime(deviceTimeFreq_, devTime);
+        if(estimated) {
+            updateBaseDevTime(devTime, srcTimestamp);
+            auto outputTsp = (baseDevTime_ & BASE_DEV_TIME_MASK) + (srcTimestamp & (~BASE_DEV_TIME_MASK));
+            estimated      = DeviceTimeTracker::isConsistent(outputTsp, frameTimeFreq_, devTime, deviceTimeFreq_);
         }
-
-        if((baseDevTime_ & ~BASE_DEV_TIME_MASK) <= srcTimestamp && baseDevTime_ > TSP_OVERFLOW_32BIT) {
-            // An overflow occurred between the timestamp of the data frame and updateBaseTimeStamp.
-            baseDevTime_ -= TSP_OVERFLOW_32BIT;
+        if(estimated) {
+            if(tspDecrease || tspDiffAbnormal) {
+                deviceTimeTracker_->requestResync();
+            }
+        }
+        else {
+            devTime = queryDeviceTime();
+            updateBaseDevTime(devTime, srcTimestamp);
         }
     }
 
@@ -130,6 +127,24 @@ uint64_t FrameTimestampCalculatorBaseDeviceTime::calculate(uint64_t srcTimestamp
     return static_cast<uint64_t>(timestampUsec);
 }
 
+uint64_t FrameTimestampCalculatorBaseDeviceTime::queryDeviceTime() {
+    if(deviceTimeTracker_) {
+        return deviceTimeTracker_->queryDeviceTime();
+    }
+    auto owner          = getOwner();
+    auto propertyServer = owner->getPropertyServer();
+    auto devTime        = propertyServer->getStructureDataT<OBDeviceTime>(OB_STRUCT_DEVICE_TIME);
+    return devTime.time + devTime.rtt / 2;
+}
+
+void FrameTimestampCalculatorBaseDeviceTime::updateBaseDevTime(uint64_t devTime, uint64_t srcTimestamp) {
+    baseDevTime_ = static_cast<uint64_t>(static_cast<double>(devTime) / deviceTimeFreq_ * frameTimeFreq_);
+    if((baseDevTime_ & ~BASE_DEV_TIME_MASK) <= srcTimestamp && baseDevTime_ > TSP_OVERFLOW_32BIT) {
+        // An overflow occurred between the timestamp of the data frame and updateBaseTimeStamp.
+        baseDevTime_ -= TSP_OVERFLOW_32BIT;
+    }
+}
+
 void FrameTimestampCalculatorBaseDeviceTime::clear() {
     prevSrcTsp_  = 0;
     prevHostTsp_ = 0;
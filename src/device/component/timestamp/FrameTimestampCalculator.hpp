@@ -3,6 +3,7 @@
 #include "IFrame.hpp"
 #include "DeviceComponentBase.hpp"
 #include "GlobalTimestampFitter.hpp"
+#include "DeviceTimeTracker.hpp"
 
 namespace libobsensor {
 class GlobalTimestampCalculator : public IFrameTimestampCalculator, public DeviceComponentBase {
@@ -44,6 +45,10 @@ public:
 
     uint64_t calculate(uint64_t srcTimestamp);
 
+private:
+    uint64_t queryDeviceTime();
+    void     updateBaseDevTime(uint64_t devTime, uint64_t srcTimestamp);
+
 private:
     uint64_t deviceTimeFreq_;
     uint64_t frameTimeFreq_;
@@ -51,6 +56,8 @@ private:
     uint64_t prevSrcTsp_;
     uint64_t prevHostTsp_;
     uint64_t baseDevTime_;
+
+    std::shared_ptr<DeviceTimeTracker> deviceTimeTracker_;  // nullptr if the device does not track the device time
 };
 
 class FrameTimestampCalculatorOverMetadata : public IFrameTimestampCalculator, public DeviceComponentBase {
@@ -6,9 +6,58 @@
 #include "property/InternalProperty.hpp"
 #include "environment/EnvConfig.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace libobsensor {
+
+namespace {
+const size_t   MIN_FIT_SAMPLES            = 4;
+const uint64_t RTT_TOLERANCE_USEC         = 100;  // samples with rtt <= 2 * minRtt + RTT_TOLERANCE_USEC are used for fitting
+const double   OUTLIER_MAD_FACTOR         = 3.0;  // samples with residual > OUTLIER_MAD_FACTOR * median residual are rejected
+const double   MIN_OUTLIER_THRESHOLD_USEC = 50.0;
+
+// Ordinary least squares over the selected samples, centered on their mean to keep the precision of the double sums
+bool fitLeastSquares(const std::vector<const TimestampPair *> &samples, double &coefficientA, double &constantB) {
+    // Use the first sample as offset to prevent overflow and precision loss during calculation
+    auto   offsetX = samples.front()->deviceTimestamp;
+    auto   offsetY = samples.front()->systemTimestamp;
+    double meanX   = 0;
+    double meanY   = 0;
+    for(auto sample: samples) {
+        meanX += static_cast<double>(sample->deviceTimestamp - offsetX);
+        meanY += static_cast<double>(static_cast<int64_t>(sample->systemTimestamp - offsetY));
+    }
+    meanX /= samples.size();
+    meanY /= samples.size();
+
+    double sxx = 0;
+    double sxy = 0;
+    for(auto sample: samples) {
+        auto dx = static_cast<double>(sample->deviceTimestamp - offsetX) - meanX;
+        auto dy = static_cast<double>(static_cast<int64_t>(sample->systemTimestamp - offsetY)) - meanY;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+    if(sxx <= 0) {
+        return false;
+    }
+    coefficientA = sxy / sxx;
+    constantB    = meanY - coefficientA * meanX + offsetY - coefficientA * offsetX;
+    return true;
+}
+}  // namespace
+
 GlobalTimestampFitter::GlobalTimestampFitter(IDevice *owner)
-    : DeviceComponentBase(owner), enable_(false), sampleLoopExit_(false), linearFuncParam_({ 0, 0, 0, 0 }) {
+    : DeviceComponentBase(owner),
+      enable_(false),
+      sampleLoopExit_(false),
+      linearFuncParamSeq_(0),
+      coefficientA_(0),
+      constantB_(0),
+      checkDataX_(0),
+      checkDataY_(0) {
     auto envConfig = EnvConfig::getInstance();
     int  value     = 0;
     if(envConfig->getIntValue("Misc.GlobalTimestampFitterQueueSize", value) && value >= 4) {
@@ -52,8 +101,86 @@ GlobalTimestampFitter::~GlobalTimestampFitter() {
 }
 
 LinearFuncParam GlobalTimestampFitter::getLinearFuncParam() {
-    std::unique_lock<std::mutex> lock(linearFuncParamMutex_);
-    return linearFuncParam_;
+    LinearFuncParam param;
+    uint32_t        seq;
+    do {
+        seq                = linearFuncParamSeq_.load(std::memory_order_acquire);
+        param.coefficientA = coefficientA_.load(std::memory_order_relaxed);
+        param.constantB    = constantB_.load(std::memory_order_relaxed);
+        param.checkDataX   = checkDataX_.load(std::memory_order_relaxed);
+        param.checkDataY   = checkDataY_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while((seq & 1) || seq != linearFuncParamSeq_.load(std::memory_order_relaxed));
+    return param;
+}
+
+void GlobalTimestampFitter::publishLinearFuncParam(const LinearFuncParam &param) {
+    // Only the fitting thread writes, readers retry if they overlap with the update
+    auto seq = linearFuncParamSeq_.load(std::memory_order_relaxed);
+    linearFuncParamSeq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    coefficientA_.store(param.coefficientA, std::memory_order_relaxed);
+    constantB_.store(param.constantB, std::memory_order_relaxed);
+    checkDataX_.store(param.checkDataX, std::memory_order_relaxed);
+    checkDataY_.store(param.checkDataY, std::memory_order_relaxed);
+    linearFuncParamSeq_.store(seq + 2, std::memory_order_release);
+}
+
+bool GlobalTimestampFitter::fitLinearFunc(const std::deque<TimestampPair> &samples, LinearFuncParam &param) {
+    if(samples.size() < MIN_FIT_SAMPLES) {
+        return false;
+    }
+
+    // Min-RTT filtering: the error of the host time of a sample is up to rtt/2, so only the samples close to the fastest round trip are used
+    uint64_t minRtt = samples.front().rtt;
+    for(auto &sample: samples) {
+        minRtt = std::min(minRtt, sample.rtt);
+    }
+    auto                               rttLimit = 2 * minRtt + RTT_TOLERANCE_USEC;
+    std::vector<const TimestampPair *> selected;
+    selected.reserve(samples.size());
+    for(auto &sample: samples) {
+        if(sample.rtt <= rttLimit) {
+            selected.push_back(&sample);
+        }
+    }
+    if(selected.size() < MIN_FIT_SAMPLES) {
+        selected.clear();
+        for(auto &sample: samples) {
+            selected.push_back(&sample);
+        }
+    }
+
+    double coefficientA = 0;
+    double constantB    = 0;
+    if(!fitLeastSquares(selected, coefficientA, constantB)) {
+        return false;
+    }
+
+    // Reject the samples whose residual is far from the median absolute residual, and fit again
+    std::vector<double> residuals;
+    residuals.reserve(selected.size());
+    for(auto sample: selected) {
+        residuals.push_back(std::abs(static_cast<double>(sample->systemTimestamp) - (coefficientA * sample->deviceTimestamp + constantB)));
+    }
+    auto sortedResiduals = residuals;
+    std::nth_element(sortedResiduals.begin(), sortedResiduals.begin() + sortedResiduals.size() / 2, sortedResiduals.end());
+    auto threshold = std::max(OUTLIER_MAD_FACTOR * sortedResiduals[sortedResiduals.size() / 2], MIN_OUTLIER_THRESHOLD_USEC);
+
+    std::vector<const TimestampPair *> inliers;
+    inliers.reserve(selected.size());
+    for(size_t i = 0; i < selected.size(); i++) {
+        if(residuals[i] <= threshold) {
+            inliers.push_back(selected[i]);
+        }
+    }
+    if(inliers.size() >= MIN_FIT_SAMPLES && inliers.size() < selected.size()) {
+        fitLeastSquares(inliers, coefficientA, constantB);
+    }
+
+    param.coefficientA = coefficientA;
+    param.constantB    = constantB;
+    return true;
 }
 
 void GlobalTimestampFitter::reFitting() {
@@ -136,6 +263,7 @@ void GlobalTimestampFitter::fittingLoop() {
 
         // Successfully obtain timestamp, the number of retries is reset to zero
         retryCount = 0;
+        std::deque<TimestampPair> samples;
         {
             std::unique_lock<std::mutex> lock(sampleMutex_);
             if(samplingQueue_.size() > maxQueueSize_) {
@@ -147,45 +275,22 @@ void GlobalTimestampFitter::fittingLoop() {
                 samplingQueue_.clear();
             }
 
-            samplingQueue_.push_back({ sysTspUsec, devTime.time });
+            samplingQueue_.push_back({ sysTspUsec, devTime.time, devTime.rtt });
 
-            if(samplingQueue_.size() < 4) {
+            if(samplingQueue_.size() < MIN_FIT_SAMPLES) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(50));
                 continue;
             }
+            samples = samplingQueue_;
         }
 
-        // Use the first set of data as offset to prevent overflow during calculation
-        uint64_t offset_x = samplingQueue_.front().deviceTimestamp;
-        uint64_t offset_y = samplingQueue_.front().systemTimestamp;
-        double   Ex       = 0;
-        double   Exx      = 0;
-        double   Ey       = 0;
-        double   Exy      = 0;
-        auto     it       = samplingQueue_.begin();
-        while(it != samplingQueue_.end()) {
-            auto systemTimestamp = it->systemTimestamp - offset_y;
-            auto deviceTimestamp = it->deviceTimestamp - offset_x;
-            Ex += deviceTimestamp;
-            Exx += deviceTimestamp * deviceTimestamp;
-            Ey += systemTimestamp;
-            Exy += deviceTimestamp * systemTimestamp;
-            it++;
-        }
-
-        {
+        LinearFuncParam param;
+        param.checkDataX = devTime.time;
+        param.checkDataY = sysTspUsec;
+        if(fitLinearFunc(samples, param)) {
             std::unique_lock<std::mutex> linearFuncParamLock(linearFuncParamMutex_);
-            // Linear regression to find a and b: y=ax+b
-            linearFuncParam_.coefficientA = (Exy * samplingQueue_.size() - Ex * Ey) / (samplingQueue_.size() * Exx - Ex * Ex);
-            linearFuncParam_.constantB  = (Exx * Ey - Exy * Ex) / (samplingQueue_.size() * Exx - Ex * Ex) + offset_y - linearFuncParam_.coefficientA * offset_x;
-            linearFuncParam_.checkDataX = devTime.time;
-            linearFuncParam_.checkDataY = sysTspUsec;
-
-            // auto fixDevTsp = (double)devTime *linearFuncParam_.coefficientA + linearFuncParam_.constantB;
-            // auto fixDiff   = fixDevTsp -sysTspUsec;
-            // LOG_TRACE("a = {}, b = {}, fix={}, diff={}", linearFuncParam_.coefficientA, linearFuncParam_.constantB, fixDevTsp, fixDiff);
-
-            LOG_DEBUG_INTVL("GlobalTimestampFitter update: coefficientA = {}, constantB = {}", linearFuncParam_.coefficientA, linearFuncParam_.constantB);
+            publishLinearFuncParam(param);
+            LOG_DEBUG_INTVL("GlobalTimestampFitter update: coefficientA = {}, constantB = {}", param.coefficientA, param.constantB);
             linearFuncParamCondVar_.notify_all();
         }
 
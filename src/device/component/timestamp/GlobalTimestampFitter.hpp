@@ -2,6 +2,7 @@
 #include "IDevice.hpp"
 #include "DeviceComponentBase.hpp"
 
+#include <atomic>
 #include <thread>
 #include <queue>
 #include <mutex>
@@ -17,10 +18,19 @@ typedef struct {
     uint64_t checkDataY;
 } LinearFuncParam;
 
+// A device time sample, systemTimestamp is the midpoint of the request (usec) and rtt its round trip time (usec)
+typedef struct {
+    uint64_t systemTimestamp;
+    uint64_t deviceTimestamp;
+    uint64_t rtt;
+} TimestampPair;
+
 class GlobalTimestampFitter : public DeviceComponentBase {
 public:
     GlobalTimestampFitter(IDevice *owner);
     ~GlobalTimestampFitter();
+
+    // Lock free, can be called for every frame
     LinearFuncParam getLinearFuncParam();
     void            reFitting();
     void            pause();
@@ -29,8 +39,15 @@ public:
     void enable(bool en);
     bool isEnabled() const;
 
+    // Fit systemTimestamp = a * deviceTimestamp + b to the samples, the checkData fields of param are left untouched.
+    // The host time of a sample is only known within +-rtt/2, so samples whose round trip took much longer than the fastest one are left out,
+    // then samples with outlying residuals are rejected and the remaining ones are fitted again.
+    // Returns false if there are not enough samples.
+    static bool fitLinearFunc(const std::deque<TimestampPair> &samples, LinearFuncParam &param);
+
 private:
     void fittingLoop();
+    void publishLinearFuncParam(const LinearFuncParam &param);
 
 private:
     bool enable_;
@@ -39,19 +56,20 @@ private:
     std::condition_variable sampleCondVar_;
     bool                    sampleLoopExit_;
 
-    typedef struct {
-        uint64_t systemTimestamp;
-        uint64_t deviceTimestamp;
-    } TimestampPair;
-
     std::deque<TimestampPair> samplingQueue_;
     uint32_t                  maxQueueSize_ = 100;
 
     // The refresh interval needs to be less than half the interval of the data frame, that is, it needs to be sampled at least twice within an overflow period.
     uint32_t refreshIntervalMsec_ = 1000;
 
+    // The fitted parameters are published with a sequence lock, odd sequence means the fitting thread is updating them
+    std::atomic<uint32_t> linearFuncParamSeq_;
+    std::atomic<double>   coefficientA_;
+    std::atomic<double>   constantB_;
+    std::atomic<uint64_t> checkDataX_;
+    std::atomic<uint64_t> checkDataY_;
+
     std::mutex              linearFuncParamMutex_;
     std::condition_variable linearFuncParamCondVar_;
-    LinearFuncParam         linearFuncParam_;
 };
 }  // namespace libobsensor
\ No newline at end of file
@@ -11,6 +11,7 @@
 
 #include "metadata/FrameMetadataParserContainer.hpp"
 #include "timestamp/GlobalTimestampFitter.hpp"
+#include "timestamp/DeviceTimeTracker.hpp"
 #include "timestamp/FrameTimestampCalculator.hpp"
 #include "timestamp/DeviceClockSynchronizer.hpp"
 #include "property/VendorPropertyAccessor.hpp"
@@ -24,6 +25,7 @@
 
 #include "FilterFactory.hpp"
 #include "publicfilters/FormatConverterProcess.hpp"
+#include "publicfilters/VideoDecoderProcess.hpp"
 #include "publicfilters/IMUCorrector.hpp"
 
 #include "utils/BufferParser.hpp"
@@ -438,6 +440,8 @@ void FemtoMegaNetDevice::init() {
     auto globalTimestampFilter = std::make_shared<GlobalTimestampFitter>(this);
     registerComponent(OB_DEV_COMPONENT_GLOBAL_TIMESTAMP_FILTER, globalTimestampFilter);
 
+    registerComponent(OB_DEV_COMPONENT_DEVICE_TIME_TRACKER, [this]() { return std::make_shared<DeviceTimeTracker>(this); });
+
     auto algParamManager = std::make_shared<TOFDeviceCommandAlgParamManager>(this);
     registerComponent(OB_DEV_COMPONENT_ALG_PARAM_MANAGER, algParamManager);
 
@@ -596,6 +600,17 @@ void FemtoMegaNetDevice::initSensorList() {
                     formatFilterConfigs.push_back({ FormatFilterPolicy::ADD, OB_FORMAT_MJPG, OB_FORMAT_BGR, formatConverter });
                     formatFilterConfigs.push_back({ FormatFilterPolicy::ADD, OB_FORMAT_MJPG, OB_FORMAT_BGRA, formatConverter });
                 }
+                if(VideoDecoder::isAvailable()) {
+                    auto videoDecoder = getSensorFrameFilter("VideoDecoder", OB_SENSOR_COLOR, false);
+                    if(videoDecoder) {
+                        for(auto codecFormat: { OB_FORMAT_H264, OB_FORMAT_H265 }) {
+                            formatFilterConfigs.push_back({ FormatFilterPolicy::ADD, codecFormat, OB_FORMAT_RGB, videoDecoder });
+                            formatFilterConfigs.push_back({ FormatFilterPolicy::ADD, codecFormat, OB_FORMAT_BGR, videoDecoder });
+                            formatFilterConfigs.push_back({ FormatFilterPolicy::ADD, codecFormat, OB_FORMAT_BGRA, videoDecoder });
+                            formatFilterConfigs.push_back({ FormatFilterPolicy::ADD, codecFormat, OB_FORMAT_NV12, videoDecoder });
+                        }
+                    }
+                }
 
                 sensor->updateFormatFilterConfig(formatFilterConfigs);
                 auto videoFrameTimestampCalculator_ = std::make_shared<FrameTimestampCalculatorBaseDeviceTime>(this, deviceTimeFreq_, colorFrameTimeFreq_);
@@ -5,7 +5,8 @@
 
 namespace libobsensor {
 G330FrameTimestampCalculatorBaseDeviceTime::G330FrameTimestampCalculatorBaseDeviceTime(IDevice *device, uint64_t deviceTimeFreq, uint64_t frameTimeFreq)
-    : device_(device), deviceTimeFreq_(deviceTimeFreq), frameTimeFreq_(frameTimeFreq) {
+    : device_(device), deviceTimeFreq_(deviceTimeFreq), frameTimeFreq_(frameTimeFreq), prevSrcTsp_(0), prevHostTsp_(0), baseDevTime_(0) {
+    deviceTimeTracker_ = device->getComponentT<DeviceTimeTracker>(OB_DEV_COMPONENT_DEVICE_TIME_TRACKER, false).get();
     auto                  propServer = device->getPropertyServer();
     std::vector<uint32_t> supportedProps;
     if(propServer->isPropertySupported(OB_PROP_TIMER_RESET_SIGNAL_BOOL, PROP_OP_WRITE, PROP_ACCESS_INTERNAL)) {
@@ -55,19 +56,22 @@ uint64_t G330FrameTimestampCalculatorBaseDeviceTime::calculate(uint64_t srcTimes
         LOG_DEBUG_INTVL_MS(1000, "\tsrcTimestamp={0}, prevSrcTsp_={1}, tspDecrease={2}", srcTimestamp, prevSrcTsp_, tspDecrease);
         LOG_DEBUG_INTVL_MS(1000, "\tsrcTspDiffMs={0}, hostTspDiffMs={1}, tspDiffAbnormal={2}", srcTspDiffMs, hostTspDiffMs, tspDiffAbnormal);
 
-        {
-            auto propertyServer = device_->getPropertyServer();
-            auto devTime        = propertyServer->getStructureDataT<OBDeviceTime>(OB_STRUCT_DEVICE_TIME);
-            baseDevTime_        = static_cast<uint64_t>((static_cast<double>(devTime.time) + devTime.rtt / 2) / deviceTimeFreq_ * frameTimeFreq_);
+        // Estimate the device time from the device time tracker snapshot, only query it on the capture thread if the estimate does not fit the
+        // frame timestamp (e.g. the device clock was reset by a hardware signal after the snapshot was taken)
+        uint64_t devTime   = 0;
+        bool     estimated = deviceTimeTracker_ && deviceTimeTracker_->estimateDeviceTime(deviceTimeFreq_, devTime);
+        if(estimated) {
+            updateBaseDevTime(devTime, srcTimestamp);
+            estimated = DeviceTimeTracker::isConsistent(baseDevTime_ + srcTimestamp, frameTimeFreq_, devTime, deviceTimeFreq_);
         }
-
-        uint64_t overFlowTimes              = baseDevTime_ / (256 * frameTimeFreq_);
-        uint64_t calculateLeftoverTimestamp = baseDevTime_ - overFlowTimes * (256 * frameTimeFreq_);
-        if(calculateLeftoverTimestamp < srcTimestamp) {
-            baseDevTime_ = (overFlowTimes - 1) * (256 * frameTimeFreq_);
+        if(estimated) {
+            if(tspDecrease || tspDiffAbnormal) {
+                deviceTimeTracker_->requestResync();
+            }
         }
         else {
-            baseDevTime_ -= calculateLeftoverTimestamp;
+            devTime = queryDeviceTime();
+            updateBaseDevTime(devTime, srcTimestamp);
         }
     }
 
@@ -78,6 +82,28 @@ uint64_t G330FrameTimestampCalculatorBaseDeviceTime::calculate(uint64_t srcTimes
     return static_cast<uint64_t>(timestampUsec);
 }
 
+uint64_t G330FrameTimestampCalculatorBaseDeviceTime::queryDeviceTime() {
+    if(deviceTimeTracker_) {
+        return deviceTimeTracker_->queryDeviceTime();
+    }
+    auto propertyServer = device_->getPropertyServer();
+    auto devTime        = propertyServer->getStructureDataT<OBDeviceTime>(OB_STRUCT_DEVICE_TIME);
+    return devTime.time + devTime.rtt / 2;
+}
+
+void G330FrameTimestampCalculatorBaseDeviceTime::updateBaseDevTime(uint64_t devTime, uint64_t srcTimestamp) {
+    baseDevTime_ = static_cast<uint64_t>(static_cast<double>(devTime) / deviceTimeFreq_ * frameTimeFreq_);
+
+    uint64_t overFlowTimes              = baseDevTime_ / (256 * frameTimeFreq_);
+    uint64_t calculateLeftoverTimestamp = baseDevTime_ - overFlowTimes * (256 * frameTimeFreq_);
+    if(calculateLeftoverTimestamp < srcTimestamp) {
+        baseDevTime_ = (overFlowTimes - 1) * (256 * frameTimeFreq_);
+    }
+    else {
+        baseDevTime_ -= calculateLeftoverTimestamp;
+    }
+}
+
 void G330FrameTimestampCalculatorBaseDeviceTime::clear() {
     prevSrcTsp_  = 0;
     prevHostTsp_ = 0;
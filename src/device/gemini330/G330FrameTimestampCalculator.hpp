@@ -1,6 +1,7 @@
 #pragma once
 #include "IFrame.hpp"
 #include "IDevice.hpp"
+#include "timestamp/DeviceTimeTracker.hpp"
 
 namespace libobsensor {
 
@@ -15,15 +16,21 @@ public:
 
     uint64_t calculate(uint64_t srcTimestamp);
 
+private:
+    uint64_t queryDeviceTime();
+    void     updateBaseDevTime(uint64_t devTime, uint64_t srcTimestamp);
+
 private:
     IDevice *device_;
-    
+
     uint64_t deviceTimeFreq_;
     uint64_t frameTimeFreq_;
 
     uint64_t prevSrcTsp_;
     uint64_t prevHostTsp_;
     uint64_t baseDevTime_;
+
+    std::shared_ptr<DeviceTimeTracker> deviceTimeTracker_;  // nullptr if the device does not track the device time
 };
 
 }  // namespace libobsensor
\ No newline at end of file
@@ -22,6 +22,7 @@ Align::Align() : align_to_stream_(OB_STREAM_COLOR) {
     depth_unit_mm_         = 1.f;
     add_target_distortion_ = true;
     gap_fill_copy_         = false;
+    thread_count_          = 0;
 }
 
 Align::~Align() noexcept {
@@ -33,9 +34,9 @@ Align::~Align() noexcept {
 }
 
 void Align::updateConfig(std::vector<std::string> &params) {
-    // AlignType, TargetDistortion, GapFillCopy
+    // AlignType, TargetDistortion, GapFillCopy[, ThreadCount]
     std::lock_guard<std::recursive_mutex> lock(alignMutex_);
-    if(params.size() != 3) {
+    if(params.size() != 3 && params.size() != 4) {
         throw invalid_value_exception("Align config error: params size not match");
     }
     try {
@@ -45,6 +46,14 @@ void Align::updateConfig(std::vector<std::string> &params) {
         }
         add_target_distortion_ = bool(std::stoi(params[1]));
         gap_fill_copy_         = bool(std::stoi(params[2]));
+        if(params.size() > 3) {
+            int thread_count = std::stoi(params[3]);
+            if(thread_count < 0) {
+                throw invalid_value_exception("ThreadCount must not be negative");
+            }
+            thread_count_ = thread_count;
+            pImpl->setThreadCount(thread_count_);
+        }
     }
     catch(const std::exception &e) {
         throw invalid_value_exception("Align config error: " + std::string(e.what()));
@@ -54,7 +63,8 @@ void Align::updateConfig(std::vector<std::string> &params) {
 const std::string &Align::getConfigSchema() const {
     static const std::string schema = "AlignType, integer, 1, 7, 1, 2, aligned to the type of data stream\n"
                                       "TargetDistortion, boolean, 0, 1, 1, 1, add distortion of the target stream\n"
-                                      "GapFillCopy, boolean, 0, 1, 1, 0, enable gap fill";
+                                      "GapFillCopy, boolean, 0, 1, 1, 0, enable gap fill\n"
+                                      "ThreadCount, integer, 0, 16, 1, 0, number of threads to align on (0 for one per cpu core)";
     return schema;
 }
 
@@ -89,7 +99,7 @@ std::shared_ptr<Frame> Align::process(std::shared_ptr<const Frame> frame) {
         return frames;
     }
 
-    depth_unit_mm_ = depth->as<DepthFrame>()->getValueScale();
+    depth_unit_mm_ = depth->asRef<DepthFrame>().getValueScale();
 
     // prepare "other" data buffer to vector of Frame
     std::vector<std::shared_ptr<const Frame>> other_frames;
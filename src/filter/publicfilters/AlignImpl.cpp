@@ -1,13 +1,25 @@
 ﻿#include "AlignImpl.hpp"
 #include "logger/Logger.hpp"
+#include "logger/LoggerInterval.hpp"
 #include "exception/ObException.hpp"
+#include "utils/CoordinateTablesCache.hpp"
 #include <fstream>
 #include <iostream>
 #include <chrono>
 #include <complex>
+#include <climits>
+#include <algorithm>
 
 namespace libobsensor {
 
+// target_v_ of a depth pixel not projected to the target frame
+static const int16_t INVALID_TARGET = INT16_MIN;
+
+// Target pixels are clamped to [-1, size], which keeps them out of the frame if they were, so they fit in int16_t
+static inline int16_t clampTarget(int value, int size) {
+    return static_cast<int16_t>(value < -1 ? -1 : (value > size ? size : value));
+}
+
 static inline void addDistortion(const OBCameraDistortion &distort_param, const float pt_ud[2], float pt_d[2]) {
     float k1 = distort_param.k1, k2 = distort_param.k2, k3 = distort_param.k3;
     float k4 = distort_param.k4, k5 = distort_param.k5, k6 = distort_param.k6;
@@ -70,14 +82,19 @@ static inline void removeDistortion(const OBCameraDistortion &distort_param, con
     pt_ud[1] = tmp_p_ud[1];
 }
 
-const __m128  AlignImpl::POINT_FIVE = _mm_set_ps1(0.5);
-const __m128  AlignImpl::TWO        = _mm_set_ps1(2);
-const __m128i AlignImpl::ZERO       = _mm_setzero_si128();
-const __m128  AlignImpl::ZERO_F     = _mm_set_ps1(0.0);
+static AlignProjectFunc getProjectFunc(AlignKernel kernel) {
+    static const AlignProjectFunc kernels[SIMD_ISA_COUNT] = { nullptr, projectDepthSSE, SIMD_KERNEL_AVX2(projectDepthAVX2),
+                                                              SIMD_KERNEL_AVX512(projectDepthAVX512), SIMD_KERNEL_NEON(projectDepthNEON) };
+    return getSimdKernel(kernels, kernel);
+}
 
-AlignImpl::AlignImpl() : initialized_(false) {
+AlignImpl::AlignImpl() : initialized_(false), thread_count_(0) {
     depth_unit_mm_ = 1.0;
     r2_max_loc_    = 0.0;
+    thread_pool_   = ThreadPool::getInstance();
+    memset(&projection_, 0, sizeof(AlignProjection));
+
+    setWidestSimdKernel<AlignKernel>([this](AlignKernel kernel) { return setKernel(kernel); });
     memset(&depth_intric_, 0, sizeof(OBCameraIntrinsic));
     memset(&depth_disto_, 0, sizeof(OBCameraDistortion));
     memset(&rgb_intric_, 0, sizeof(OBCameraIntrinsic));
@@ -89,6 +106,19 @@ AlignImpl::~AlignImpl() {
     initialized_ = false;
 }
 
+bool AlignImpl::isKernelAvailable(AlignKernel kernel) {
+    return kernel == ALIGN_KERNEL_SCALAR || getProjectFunc(kernel) != nullptr;
+}
+
+bool AlignImpl::setKernel(AlignKernel kernel) {
+    if(!isKernelAvailable(kernel)) {
+        return false;
+    }
+    kernel_       = kernel;
+    project_func_ = getProjectFunc(kernel);
+    return true;
+}
+
 void AlignImpl::initialize(OBCameraIntrinsic depth_intrin, OBCameraDistortion depth_disto, OBCameraIntrinsic rgb_intrin, OBCameraDistortion rgb_disto,
                            OBExtrinsic extrin, float depth_unit_mm, bool add_target_distortion, bool gap_fill_copy) {
     if(initialized_) {
@@ -110,21 +140,26 @@ void AlignImpl::initialize(OBCameraIntrinsic depth_intrin, OBCameraDistortion de
         scaled_trans_[i] = transform_.trans[i] / depth_unit_mm_;
     }
 
-    color_fx_       = _mm_set_ps1(rgb_intric_.fx);
-    color_cx_       = _mm_set_ps1(rgb_intric_.cx);
-    color_fy_       = _mm_set_ps1(rgb_intric_.fy);
-    color_cy_       = _mm_set_ps1(rgb_intric_.cy);
-    color_k1_       = _mm_set_ps1(rgb_disto_.k1);
-    color_k2_       = _mm_set_ps1(rgb_disto_.k2);
-    color_k3_       = _mm_set_ps1(rgb_disto_.k3);
-    color_k4_       = _mm_set_ps1(rgb_disto_.k4);
-    color_k5_       = _mm_set_ps1(rgb_disto_.k5);
-    color_k6_       = _mm_set_ps1(rgb_disto_.k6);
-    color_p1_       = _mm_set_ps1(rgb_disto_.p1);
-    color_p2_       = _mm_set_ps1(rgb_disto_.p2);
-    scaled_trans_1_ = _mm_set_ps1(scaled_trans_[0]);
-    scaled_trans_2_ = _mm_set_ps1(scaled_trans_[1]);
-    scaled_trans_3_ = _mm_set_ps1(scaled_trans_[2]);
+    projection_.channel = (gap_fill_copy_ ? 1 : 2);
+    memcpy(projection_.trans, scaled_trans_, sizeof(scaled_trans_));
+    projection_.fx             = rgb_intric_.fx;
+    projection_.fy             = rgb_intric_.fy;
+    projection_.cx             = rgb_intric_.cx;
+    projection_.cy             = rgb_intric_.cy;
+    projection_.add_distortion = add_target_distortion_;
+    projection_.model          = rgb_disto_.model;
+    projection_.k1             = rgb_disto_.k1;
+    projection_.k2             = rgb_disto_.k2;
+    projection_.k3             = rgb_disto_.k3;
+    projection_.k4             = rgb_disto_.k4;
+    projection_.k5             = rgb_disto_.k5;
+    projection_.k6             = rgb_disto_.k6;
+    projection_.p1             = rgb_disto_.p1;
+    projection_.p2             = rgb_disto_.p2;
+    if(add_target_distortion_ && rgb_disto_.model != OB_DISTORTION_BROWN_CONRADY && rgb_disto_.model != OB_DISTORTION_BROWN_CONRADY_K6
+       && rgb_disto_.model != OB_DISTORTION_KANNALA_BRANDT4) {
+        LOG_ERROR("Distortion model not supported yet");
+    }
 
     prepareDepthResolution();
     initialized_ = true;
@@ -199,115 +234,65 @@ void AlignImpl::prepareDepthResolution() {
 
     // There may be outliers due to possible inflection points of the calibrated K6 distortion curve;
     if(add_target_distortion_) {
-        r2_max_loc_     = estimateInflectionPoint(depth_intric_, rgb_intric_, rgb_disto_);
-        r2_max_loc_sse_ = _mm_set_ps1(r2_max_loc_);
+        r2_max_loc_            = estimateInflectionPoint(depth_intric_, rgb_intric_, rgb_disto_);
+        projection_.r2_max_loc = r2_max_loc_;
     }
 
-    // Prepare LUTs
+    // Prepare LUTs, shared with the other instances of the same depth camera and rotation
     {
-        int                channel   = (gap_fill_copy_ ? 1 : 2);
-        unsigned long long stride    = depth_intric_.width * channel;
-        unsigned long long coeff_num = depth_intric_.height * stride;
-
-        float *rot_coeff1 = new float[coeff_num];
-        float *rot_coeff2 = new float[coeff_num];
-        float *rot_coeff3 = new float[coeff_num];
-
-        for(int i = 0; i < channel; i++) {
-            int mutliplier = (gap_fill_copy_ ? 0 : (i ? 1 : -1));
-            for(int v = 0; v < depth_intric_.height; ++v) {
-                float *dst1 = rot_coeff1 + v * stride + i;
-                float *dst2 = rot_coeff2 + v * stride + i;
-                float *dst3 = rot_coeff3 + v * stride + i;
-                float  y    = (v + mutliplier * 0.5f - depth_intric_.cy) / depth_intric_.fy;
-                for(int u = 0; u < depth_intric_.width; ++u) {
-                    float x = (u + mutliplier * 0.5f - depth_intric_.cx) / depth_intric_.fx;
-
-                    float x_ud = x, y_ud = y;
-                    if(need_to_undistort_depth_) {
-                        float pt_d[2] = { x, y };
-                        float pt_ud[2];
-                        removeDistortion(depth_disto_, pt_d, pt_ud);
-                        x_ud = pt_ud[0];
-                        y_ud = pt_ud[1];
+        int    channel   = (gap_fill_copy_ ? 1 : 2);
+        size_t stride    = static_cast<size_t>(depth_intric_.width) * channel;
+        size_t coeff_num = depth_intric_.height * stride;
+
+        std::string params;
+        CoordinateTablesCache::appendParam(params, depth_intric_);
+        CoordinateTablesCache::appendParam(params, depth_disto_);
+        CoordinateTablesCache::appendParam(params, transform_.rot);
+        CoordinateTablesCache::appendParam(params, gap_fill_copy_);
+        rot_coeff_ = CoordinateTablesCache::getInstance()->getTables(COORDINATE_TABLES_ALIGN_ROTATION, params, 3 * coeff_num, [&](float *rot_coeff) {
+            float *rot_coeff1 = rot_coeff;
+            float *rot_coeff2 = rot_coeff + coeff_num;
+            float *rot_coeff3 = rot_coeff + 2 * coeff_num;
+
+            for(int i = 0; i < channel; i++) {
+                int mutliplier = (gap_fill_copy_ ? 0 : (i ? 1 : -1));
+                for(int v = 0; v < depth_intric_.height; ++v) {
+                    float *dst1 = rot_coeff1 + v * stride + i;
+                    float *dst2 = rot_coeff2 + v * stride + i;
+                    float *dst3 = rot_coeff3 + v * stride + i;
+                    float  y    = (v + mutliplier * 0.5f - depth_intric_.cy) / depth_intric_.fy;
+                    for(int u = 0; u < depth_intric_.width; ++u) {
+                        float x = (u + mutliplier * 0.5f - depth_intric_.cx) / depth_intric_.fx;
+
+                        float x_ud = x, y_ud = y;
+                        if(need_to_undistort_depth_) {
+                            float pt_d[2] = { x, y };
+                            float pt_ud[2];
+                            removeDistortion(depth_disto_, pt_d, pt_ud);
+                            x_ud = pt_ud[0];
+                            y_ud = pt_ud[1];
+                        }
+
+                        *dst1 = transform_.rot[0] * x_ud + transform_.rot[1] * y_ud + transform_.rot[2];
+                        *dst2 = transform_.rot[3] * x_ud + transform_.rot[4] * y_ud + transform_.rot[5];
+                        *dst3 = transform_.rot[6] * x_ud + transform_.rot[7] * y_ud + transform_.rot[8];
+                        dst1 += channel;
+                        dst2 += channel;
+                        dst3 += channel;
                     }
-
-                    *dst1 = transform_.rot[0] * x_ud + transform_.rot[1] * y_ud + transform_.rot[2];
-                    *dst2 = transform_.rot[3] * x_ud + transform_.rot[4] * y_ud + transform_.rot[5];
-                    *dst3 = transform_.rot[6] * x_ud + transform_.rot[7] * y_ud + transform_.rot[8];
-                    dst1 += channel;
-                    dst2 += channel;
-                    dst3 += channel;
                 }
             }
-        }
-
-        rot_coeff_ht_x[std::make_pair(depth_intric_.width, depth_intric_.height)] = rot_coeff1;
-        rot_coeff_ht_y[std::make_pair(depth_intric_.width, depth_intric_.height)] = rot_coeff2;
-        rot_coeff_ht_z[std::make_pair(depth_intric_.width, depth_intric_.height)] = rot_coeff3;
+            return true;
+        });
     }
 }
 
 void AlignImpl::clearMatrixCache() {
-    for(auto item: rot_coeff_ht_x) {
-        if(item.second) {
-            delete[] item.second;
-        }
-    }
-    for(auto item: rot_coeff_ht_y) {
-        if(item.second) {
-            delete[] item.second;
-        }
-    }
-    for(auto item: rot_coeff_ht_z) {
-        if(item.second) {
-            delete[] item.second;
-        }
-    }
-
-    rot_coeff_ht_x.clear();
-    rot_coeff_ht_y.clear();
-    rot_coeff_ht_z.clear();
+    rot_coeff_.reset();
 }
 
-template <typename T> void fillPixelGap(const int *u, const int *v, const int width, const int height, const T val, T *buffer, bool copy = true) {
-    // point index and output depth buffer should be checked outside
-
-    if(copy) {
-        if((u[0] >= 0) && (u[0] < width) && (v[0] >= 0) && (v[0] < height)) {
-            int pos          = v[0] * width + u[0];
-            buffer[pos]      = val;
-            bool right_valid = (u[0] + 1) < width, bottom_valid = (v[0] + 1) < height;
-            if(right_valid) {
-                if(buffer[pos + 1] > val)
-                    buffer[pos + 1] = val;
-            }
-            if(bottom_valid) {
-                if(buffer[pos + width] > val)
-                    buffer[pos + width] = val;
-            }
-            if(right_valid && bottom_valid) {
-                if(buffer[pos + width + 1] > val)
-                    buffer[pos + width + 1] = val;
-            }
-        }
-    }
-    else {
-        int v0 = v[0] < 0 ? 0 : v[0];
-        int u0 = u[0] < 0 ? 0 : u[0];
-        int v1 = v[1] < (height - 1) ? v[1] : (height - 1);
-        int u1 = u[1] < (width - 1) ? u[1] : (width - 1);
-        for(int vr = v0; vr <= v1; vr++) {
-            for(int ur = u0; ur <= u1; ur++) {
-                int pos = vr * width + ur;
-                if(buffer[pos] > val)
-                    buffer[pos] = val;
-            }
-        }
-    }
-}
-
-void AlignImpl::transferDepth(const float *x, const float *y, const float *z, const int npts, const int point_index, uint16_t *out_depth, int *map) {
+void AlignImpl::transferDepth(const float *x, const float *y, const float *z, const int npts, const int point_index, bool with_depth, int *map,
+                              int map_begin) {
     int nchannels = gap_fill_copy_ ? 1 : 2;
 
     for(int i = 0; i < npts; i++) {
@@ -335,238 +320,191 @@ void AlignImpl::transferDepth(const float *x, const float *y, const float *z, co
 
         if(map) {  // coordinates mapping for C2D
             if((u_rgb[0] >= 0) && (u_rgb[0] < rgb_intric_.width) && (v_rgb[0] >= 0) && (v_rgb[0] < rgb_intric_.height)) {
-                map[2 * (point_index + i)]     = u_rgb[0];
-                map[2 * (point_index + i) + 1] = v_rgb[0];
+                map[2 * (point_index + i - map_begin)]     = u_rgb[0];
+                map[2 * (point_index + i - map_begin) + 1] = v_rgb[0];
             }
         }
 
-        if(out_depth) {
-            fillPixelGap<uint16_t>(u_rgb, v_rgb, rgb_intric_.width, rgb_intric_.height, cur_depth, out_depth, gap_fill_copy_);
+        if(with_depth) {
+            int idx = point_index + i;
+            for(int chl = 0; chl < nchannels; chl++) {
+                target_u_[idx * nchannels + chl] = clampTarget(u_rgb[chl], rgb_intric_.width);
+                target_v_[idx * nchannels + chl] = clampTarget(v_rgb[chl], rgb_intric_.height);
+            }
+            target_depth_[idx] = cur_depth;
         }
     }
 }
 
-void AlignImpl::BMDistortedWithSSE(__m128 &tx, __m128 &ty, const __m128 x2, const __m128 y2, const __m128 r2) {
-    __m128 xy = _mm_mul_ps(tx, ty);
-    __m128 r4 = _mm_mul_ps(r2, r2);
-    __m128 r6 = _mm_mul_ps(r4, r2);
-
-    // float k_jx = k_diff = (1 + k1 * r2 + k2 * r4 + k3 * r6) / (1 + k4 * r2 + k5 * r4 + k6 * r6);
-    __m128 k_jx =
-        _mm_div_ps(_mm_add_ps(_mm_set_ps1(1), _mm_add_ps(_mm_add_ps(_mm_mul_ps(color_k1_, r2), _mm_mul_ps(color_k2_, r4)), _mm_mul_ps(color_k3_, r6))),
-                   _mm_add_ps(_mm_set_ps1(1), _mm_add_ps(_mm_add_ps(_mm_mul_ps(color_k4_, r2), _mm_mul_ps(color_k5_, r4)), _mm_mul_ps(color_k6_, r6))));
-
-    // float x_qx = p2 * (2 * x2 + r2) + 2 * p1 * xy;
-    __m128 x_qx = _mm_add_ps(_mm_mul_ps(color_p2_, _mm_add_ps(_mm_mul_ps(x2, TWO), r2)), _mm_mul_ps(_mm_mul_ps(color_p1_, xy), TWO));
-
-    // float y_qx = p1 * (2 * y2 + r2) + 2 * p2 * xy;
-    __m128 y_qx = _mm_add_ps(_mm_mul_ps(color_p1_, _mm_add_ps(_mm_mul_ps(y2, TWO), r2)), _mm_mul_ps(_mm_mul_ps(color_p2_, xy), TWO));
-
-    // float distx = tx * k_jx + x_qx;
-    tx = _mm_add_ps(_mm_mul_ps(tx, k_jx), x_qx);
-
-    // float disty = ty * k_jx + y_qx;
-    ty = _mm_add_ps(_mm_mul_ps(ty, k_jx), y_qx);
-}
-
-void AlignImpl::KBDistortedWithSSE(__m128 &tx, __m128 &ty, const __m128 r2) {
-    __m128 r = _mm_sqrt_ps(r2);
-
-    // float theta=atan(r)
-    float r_[4]     = { 0 };
-    float theta_[4] = { 0 };
-    _mm_storeu_ps(r_, r);
-
-    theta_[0] = atan(r_[0]);
-    theta_[1] = atan(r_[1]);
-    theta_[2] = atan(r_[2]);
-    theta_[3] = atan(r_[3]);
-
-    __m128 theta  = _mm_loadu_ps(theta_);
-    __m128 theta2 = _mm_mul_ps(theta, theta);
-    __m128 theta3 = _mm_mul_ps(theta, theta2);
-    __m128 theta5 = _mm_mul_ps(theta2, theta3);
-    __m128 theta7 = _mm_mul_ps(theta2, theta5);
-    __m128 theta9 = _mm_mul_ps(theta2, theta7);
-
-    // float theta_jx=theta+k1*theta2+k2*theta4+k3*theta6+k4*theta8
-    __m128 theta_jx =
-        _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(theta, _mm_mul_ps(color_k1_, theta3)), _mm_mul_ps(color_k2_, theta5)), _mm_mul_ps(color_k3_, theta7)),
-                   _mm_mul_ps(color_k4_, theta9));
-
-    // float tx=(theta_jx/r)*tx
-    tx = _mm_mul_ps(_mm_div_ps(theta_jx, r), tx);
-
-    // float ty=(theta_jx/r)*ty
-    ty = _mm_mul_ps(_mm_div_ps(theta_jx, r), ty);
+void AlignImpl::updateTargetRowRange(int row_begin, int row_end) {
+    int channel = (gap_fill_copy_ ? 1 : 2);
+    for(int v = row_begin; v < row_end; v++) {
+        int            row_min = INT_MAX, row_max = INT_MIN;
+        const int16_t *target  = target_v_.data() + static_cast<size_t>(v) * depth_intric_.width * channel;
+        for(int u = 0; u < depth_intric_.width; u++, target += channel) {
+            if(target[0] == INVALID_TARGET) {
+                continue;
+            }
+            // the pixel and the ones right and below it if gap filling with copy, the rectangle between the corners otherwise
+            int top    = gap_fill_copy_ ? target[0] : std::min(target[0], target[1]);
+            int bottom = gap_fill_copy_ ? target[0] + 1 : std::max(target[0], target[1]);
+            row_min    = std::min(row_min, top);
+            row_max    = std::max(row_max, bottom);
+        }
+        target_row_min_[v] = row_min;
+        target_row_max_[v] = row_max;
+    }
 }
 
-void AlignImpl::distortedWithSSE(__m128 &tx, __m128 &ty, const __m128 x2, const __m128 y2, const __m128 r2) {
-    __m128 xy = _mm_mul_ps(tx, ty);
-    __m128 r4 = _mm_mul_ps(r2, r2);
-    __m128 r6 = _mm_mul_ps(r4, r2);
-
-    // float k_jx = k1 * r2 + k2 * r4 + k3 * r6;
-    __m128 k_jx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(color_k1_, r2), _mm_mul_ps(color_k2_, r4)), _mm_mul_ps(color_k3_, r6));
-
-    // float x_qx = p2 * (2 * x2 + r2) + 2 * p1 * xy;
-    __m128 x_qx_1 = _mm_mul_ps(color_p2_, _mm_add_ps(_mm_mul_ps(x2, TWO), r2));
-    __m128 x_qx_2 = _mm_mul_ps(_mm_mul_ps(color_p1_, xy), TWO);
-    __m128 x_qx   = _mm_add_ps(x_qx_1, x_qx_2);
-
-    // float y_qx = p1 * (2 * y2 + r2) + 2 * p2 * xy;
-    __m128 y_qx_1 = _mm_mul_ps(color_p1_, _mm_add_ps(_mm_mul_ps(y2, TWO), r2));
-    __m128 y_qx_2 = _mm_mul_ps(_mm_mul_ps(color_p2_, xy), TWO);
-    __m128 y_qx   = _mm_add_ps(y_qx_1, y_qx_2);
-
-    // float distx = tx * k_jx + x_qx;
-    __m128 distx_lo = _mm_add_ps(_mm_mul_ps(tx, k_jx), x_qx);
-    // float disty = ty * k_jx + y_qx;
-    __m128 disty_lo = _mm_add_ps(_mm_mul_ps(ty, k_jx), y_qx);
-
-    // tx = tx + distx;
-    // ty = ty + disty;
-    tx = _mm_add_ps(tx, distx_lo);
-    ty = _mm_add_ps(ty, disty_lo);
-}
+void AlignImpl::scatterDepth(int row_begin, int row_end, uint16_t *out_depth) {
+    const int width   = rgb_intric_.width;
+    const int height  = rgb_intric_.height;
+    const int channel = (gap_fill_copy_ ? 1 : 2);
 
-void AlignImpl::D2CWithoutSSE(const uint16_t *depth_buffer, uint16_t *out_depth, const float *coeff_mat_x, const float *coeff_mat_y, const float *coeff_mat_z,
-                              int *map) {
+    // init to 1s (depth 0 may be used as other useful date)
+    uint16_t *band_begin = out_depth + static_cast<size_t>(row_begin) * width;
+    uint16_t *band_end   = out_depth + static_cast<size_t>(row_end) * width;
+    memset(band_begin, 0xff, (band_end - band_begin) * sizeof(uint16_t));
 
-    int       channel     = (gap_fill_copy_ ? 1 : 2);
-    float *   ptr_coeff_x = (float *)coeff_mat_x;
-    float *   ptr_coeff_y = (float *)coeff_mat_y;
-    float *   ptr_coeff_z = (float *)coeff_mat_z;
-    uint16_t *ptr_depth   = (uint16_t *)depth_buffer;
-
-    for(int v = 0; v < depth_intric_.height; v += 1) {
-        int depth_idx = v * depth_intric_.width;
-        for(int u = 0; u < depth_intric_.width; u += 1) {
-            uint16_t depth = *ptr_depth++;
-            depth_idx++;
-            if(depth < EPSILON) {
-                ptr_coeff_x += channel;
-                ptr_coeff_y += channel;
-                ptr_coeff_z += channel;
+    for(int v = 0; v < depth_intric_.height; v++) {
+        if(target_row_max_[v] < row_begin || target_row_min_[v] >= row_end) {
+            continue;
+        }
+        size_t idx = static_cast<size_t>(v) * depth_intric_.width;
+        for(int u = 0; u < depth_intric_.width; u++, idx++) {
+            const int16_t *u_rgb = target_u_.data() + idx * channel;
+            const int16_t *v_rgb = target_v_.data() + idx * channel;
+            if(v_rgb[0] == INVALID_TARGET) {
                 continue;
             }
-            // int   u_rgb[] = { -1, -1 };
-            // int   v_rgb[] = { -1, -1 };
-            float pixelx_f[2], pixely_f[2], dst[2];
-
-            bool skip_this_pixel = true;
-            for(int k = 0; k < channel; k++) {
-                float dst_x = depth * (*ptr_coeff_x++) + scaled_trans_[0];
-                float dst_y = depth * (*ptr_coeff_y++) + scaled_trans_[1];
-                dst[k]      = depth * (*ptr_coeff_z++) + scaled_trans_[2];
-
-                float tx = float(dst_x / dst[k]);
-                float ty = float(dst_y / dst[k]);
-
-                if(add_target_distortion_) {
-                    float pt_ud[2] = { tx, ty };
-                    float pt_d[2]  = { 0 };
-                    float r2_cur   = pt_ud[0] * pt_ud[0] + pt_ud[1] * pt_ud[1];
-                    if((OB_DISTORTION_BROWN_CONRADY_K6 == rgb_disto_.model) && (r2_max_loc_ != 0) && (r2_cur > r2_max_loc_)) {
-                        continue;  // break;
+            const uint16_t val = target_depth_[idx];
+
+            // Same as filling the whole frame, but only the rows of this band are written
+            if(gap_fill_copy_) {
+                if((u_rgb[0] >= 0) && (u_rgb[0] < width) && (v_rgb[0] >= 0) && (v_rgb[0] < height)) {
+                    int  pos         = v_rgb[0] * width + u_rgb[0];
+                    bool right_valid = (u_rgb[0] + 1) < width, bottom_valid = (v_rgb[0] + 1) < height;
+                    if(v_rgb[0] >= row_begin && v_rgb[0] < row_end) {
+                        out_depth[pos] = val;
+                        if(right_valid && out_depth[pos + 1] > val)
+                            out_depth[pos + 1] = val;
+                    }
+                    if(bottom_valid && v_rgb[0] + 1 >= row_begin && v_rgb[0] + 1 < row_end) {
+                        if(out_depth[pos + width] > val)
+                            out_depth[pos + width] = val;
+                        if(right_valid && out_depth[pos + width + 1] > val)
+                            out_depth[pos + width + 1] = val;
+                    }
+                }
+            }
+            else {
+                int v0 = std::max<int>(v_rgb[0], row_begin);
+                int u0 = std::max<int>(u_rgb[0], 0);
+                int v1 = std::min<int>(v_rgb[1], row_end - 1);
+                int u1 = std::min<int>(u_rgb[1], width - 1);
+                for(int vr = v0; vr <= v1; vr++) {
+                    for(int ur = u0; ur <= u1; ur++) {
+                        int pos = vr * width + ur;
+                        if(out_depth[pos] > val)
+                            out_depth[pos] = val;
                     }
-                    addDistortion(rgb_disto_, pt_ud, pt_d);
-                    tx = pt_d[0];
-                    ty = pt_d[1];
                 }
-
-                pixelx_f[k]     = tx * rgb_intric_.fx + rgb_intric_.cx;
-                pixely_f[k]     = ty * rgb_intric_.fy + rgb_intric_.cy;
-                skip_this_pixel = false;
             }
+        }
+    }
 
-            if(!skip_this_pixel)
-                transferDepth(pixelx_f, pixely_f, dst, 1, depth_idx - 1, out_depth, map);
+    for(uint16_t *p = band_begin; p < band_end; p++) {
+        if(65535 == *p) {
+            *p = 0;
         }
     }
 }
 
-void AlignImpl::D2CWithSSE(const uint16_t *depth_buffer, uint16_t *out_depth, const float *coeff_mat_x, const float *coeff_mat_y, const float *coeff_mat_z,
-                           int *map) {
+int AlignImpl::getRowGranularity(int width, int align_pixels) {
+    int granularity = 1;
+    while((granularity * width) % align_pixels != 0) {
+        granularity++;
+    }
+    return granularity;
+}
 
-    int channel = (gap_fill_copy_ ? 1 : 2);
-    for(int i = 0; i < depth_intric_.width * depth_intric_.height; i += 8) {
-        __m128i depth_i16 = _mm_loadu_si128((__m128i *)(depth_buffer + i));
-        __m128i depth_i[] = { _mm_unpacklo_epi16(depth_i16, ZERO), _mm_unpackhi_epi16(depth_i16, ZERO) };
-
-        // transform 8 points each group
-        // int group_idx = i * channel;
-
-        // lower half or higher half 4 points of that group
-        for(int k = 0; k < 2; k++) {
-
-            // int half_idx = group_idx + k * 4 * channel;
-            int half_idx = (i + k * 4) * channel;
-
-            __m128 depth_o, nx, ny;
-            __m128 depth_sse = _mm_cvtepi32_ps(depth_i[k]);
-            float  x[8]      = { 0 };
-            float  y[8]      = { 0 };
-            float  z[8]      = { 0 };
-
-            // center or top-left-and-bottom-right
-            for(int fold = 0; fold < channel; fold++) {
-                // int coeff_idx = half_idx + fold * 2 * channel;
-                int    coeff_idx  = half_idx;
-                float  coeff_x[4] = { coeff_mat_x[coeff_idx + fold], coeff_mat_x[coeff_idx + 1 * channel + fold], coeff_mat_x[coeff_idx + 2 * channel + fold],
-                                     coeff_mat_x[coeff_idx + 3 * channel + fold] };
-                float  coeff_y[4] = { coeff_mat_y[coeff_idx + fold], coeff_mat_y[coeff_idx + 1 * channel + fold], coeff_mat_y[coeff_idx + 2 * channel + fold],
-                                     coeff_mat_y[coeff_idx + 3 * channel + fold] };
-                float  coeff_z[4] = { coeff_mat_z[coeff_idx + fold], coeff_mat_z[coeff_idx + 1 * channel + fold], coeff_mat_z[coeff_idx + 2 * channel + fold],
-                                     coeff_mat_z[coeff_idx + 3 * channel + fold] };
-                __m128 coeff_sse1 = _mm_loadu_ps(coeff_x);
-                __m128 coeff_sse2 = _mm_loadu_ps(coeff_y);
-                __m128 coeff_sse3 = _mm_loadu_ps(coeff_z);
-
-                __m128 X = _mm_add_ps(_mm_mul_ps(depth_sse, coeff_sse1), scaled_trans_1_);
-                __m128 Y = _mm_add_ps(_mm_mul_ps(depth_sse, coeff_sse2), scaled_trans_2_);
-                depth_o  = _mm_add_ps(_mm_mul_ps(depth_sse, coeff_sse3), scaled_trans_3_);
-
-                nx = _mm_div_ps(X, depth_o);
-                ny = _mm_div_ps(Y, depth_o);
-
-                if(add_target_distortion_) {
-                    __m128 x2 = _mm_mul_ps(nx, nx);
-                    __m128 y2 = _mm_mul_ps(ny, ny);
-                    __m128 r2 = _mm_add_ps(x2, y2);
-
-                    __m128 flag = _mm_or_ps(_mm_cmpge_ps(ZERO_F, r2_max_loc_sse_), _mm_cmplt_ps(r2, r2_max_loc_sse_));
-                    switch(rgb_disto_.model) {
-                    case OB_DISTORTION_BROWN_CONRADY:
-                        distortedWithSSE(nx, ny, x2, y2, r2);
-                        break;
-                    case OB_DISTORTION_BROWN_CONRADY_K6:
-                        depth_o = _mm_and_ps(depth_o, flag);
-                        BMDistortedWithSSE(nx, ny, x2, y2, r2);
-                        break;
-                    case OB_DISTORTION_KANNALA_BRANDT4:
-                        KBDistortedWithSSE(nx, ny, r2);
-                        break;
-                    default:
-                        LOG_ERROR("Distortion model not supported yet");
-                        break;
-                    }
-                }
+void AlignImpl::D2CWithoutSSE(const uint16_t *depth_buffer, int pixel_begin, int pixel_end, bool with_depth, const float *coeff_mat_x,
+                              const float *coeff_mat_y, const float *coeff_mat_z, int *map, int map_begin) {
 
-                __m128 pixelx = _mm_add_ps(_mm_mul_ps(nx, color_fx_), color_cx_);
-                __m128 pixely = _mm_add_ps(_mm_mul_ps(ny, color_fy_), color_cy_);
-                _mm_storeu_ps(x + fold * 4, pixelx);
-                _mm_storeu_ps(y + fold * 4, pixely);
-                _mm_storeu_ps(z + fold * 4, depth_o);
+    int       channel     = (gap_fill_copy_ ? 1 : 2);
+    size_t    offset      = static_cast<size_t>(pixel_begin);
+    float *   ptr_coeff_x = (float *)coeff_mat_x + offset * channel;
+    float *   ptr_coeff_y = (float *)coeff_mat_y + offset * channel;
+    float *   ptr_coeff_z = (float *)coeff_mat_z + offset * channel;
+    uint16_t *ptr_depth   = (uint16_t *)depth_buffer + offset;
+
+    for(int depth_idx = pixel_begin; depth_idx < pixel_end; depth_idx++) {
+        uint16_t depth = *ptr_depth++;
+        if(depth < EPSILON) {
+            ptr_coeff_x += channel;
+            ptr_coeff_y += channel;
+            ptr_coeff_z += channel;
+            continue;
+        }
+        // int   u_rgb[] = { -1, -1 };
+        // int   v_rgb[] = { -1, -1 };
+        float pixelx_f[2], pixely_f[2], dst[2];
+
+        bool skip_this_pixel = true;
+        for(int k = 0; k < channel; k++) {
+            float dst_x = depth * (*ptr_coeff_x++) + scaled_trans_[0];
+            float dst_y = depth * (*ptr_coeff_y++) + scaled_trans_[1];
+            dst[k]      = depth * (*ptr_coeff_z++) + scaled_trans_[2];
+
+            float tx = float(dst_x / dst[k]);
+            float ty = float(dst_y / dst[k]);
+
+            if(add_target_distortion_) {
+                float pt_ud[2] = { tx, ty };
+                float pt_d[2]  = { 0 };
+                float r2_cur   = pt_ud[0] * pt_ud[0] + pt_ud[1] * pt_ud[1];
+                if((OB_DISTORTION_BROWN_CONRADY_K6 == rgb_disto_.model) && (r2_max_loc_ != 0) && (r2_cur > r2_max_loc_)) {
+                    continue;  // break;
+                }
+                addDistortion(rgb_disto_, pt_ud, pt_d);
+                tx = pt_d[0];
+                ty = pt_d[1];
             }
 
-            transferDepth(x, y, z, 4, i + k * 4, out_depth, map);
+            pixelx_f[k]     = tx * rgb_intric_.fx + rgb_intric_.cx;
+            pixely_f[k]     = ty * rgb_intric_.fy + rgb_intric_.cy;
+            skip_this_pixel = false;
         }
+
+        if(!skip_this_pixel)
+            transferDepth(pixelx_f, pixely_f, dst, 1, depth_idx, with_depth, map, map_begin);
+    }
+}
+
+void AlignImpl::D2CWithSIMD(const uint16_t *depth_buffer, int pixel_begin, int pixel_end, bool with_depth, const float *coeff_mat_x,
+                            const float *coeff_mat_y, const float *coeff_mat_z, int *map, int map_begin) {
+    // pixels projected at a time, small enough for the target coordinates to stay in the L1 cache until transferred
+    const int CHUNK_PIXELS = 4 * ALIGN_KERNEL_PIXELS;
+    float     x[2 * CHUNK_PIXELS], y[2 * CHUNK_PIXELS], z[2 * CHUNK_PIXELS];
+
+    AlignProjection proj = projection_;
+    proj.coeff_x         = coeff_mat_x;
+    proj.coeff_y         = coeff_mat_y;
+    proj.coeff_z         = coeff_mat_z;
+
+    int simd_end = pixel_begin + (pixel_end - pixel_begin) / ALIGN_KERNEL_PIXELS * ALIGN_KERNEL_PIXELS;
+    for(int i = pixel_begin; i < simd_end; i += CHUNK_PIXELS) {
+        int npts = std::min(CHUNK_PIXELS, simd_end - i);
+        project_func_(proj, depth_buffer, i, npts, x, y, z);
+        transferDepth(x, y, z, npts, i, with_depth, map, map_begin);
+    }
+    if(simd_end < pixel_end) {
+        D2CWithoutSSE(depth_buffer, simd_end, pixel_end, with_depth, coeff_mat_x, coeff_mat_y, coeff_mat_z, map, map_begin);
     }
 }
 
 int AlignImpl::D2C(const uint16_t *depth_buffer, int depth_width, int depth_height, uint16_t *out_depth, int color_width, int color_height, int *map,
-                   bool withSSE) {
+                   bool withSIMD) {
     int ret = 0;
     if(!initialized_ || depth_width != depth_intric_.width || depth_height != depth_intric_.height || color_width != rgb_intric_.width
        || color_height != rgb_intric_.height) {
@@ -574,10 +512,7 @@ int AlignImpl::D2C(const uint16_t *depth_buffer, int depth_width, int depth_heig
         return -1;
     }
 
-    auto finder_x = rot_coeff_ht_x.find(std::make_pair(depth_width, depth_height));
-    auto finder_y = rot_coeff_ht_y.find(std::make_pair(depth_width, depth_height));
-    auto finder_z = rot_coeff_ht_z.find(std::make_pair(depth_width, depth_height));
-    if((rot_coeff_ht_x.cend() == finder_x) || (rot_coeff_ht_y.cend() == finder_y) || (rot_coeff_ht_z.cend() == finder_z)) {
+    if(!rot_coeff_) {
         LOG_ERROR("Found a new resolution, but initialization failed!");
         return -1;
     }
@@ -587,32 +522,75 @@ int AlignImpl::D2C(const uint16_t *depth_buffer, int depth_width, int depth_heig
         return -1;
     }
 
-    int pixnum = color_width * color_height;
-    if(out_depth) {
-        // init to 1s (depth 0 may be used as other useful date)
-        memset(out_depth, 0xff, pixnum * sizeof(uint16_t));
+    bool with_depth = (out_depth != nullptr);
+    bool with_simd  = withSIMD && kernel_ != ALIGN_KERNEL_SCALAR;
+    int  channel    = (gap_fill_copy_ ? 1 : 2);
+
+    const float *coeff_mat_x, *coeff_mat_y, *coeff_mat_z;
+    getRotationCoeff(coeff_mat_x, coeff_mat_y, coeff_mat_z);
+    if(with_depth) {
+        size_t pixnum = static_cast<size_t>(depth_width) * depth_height;
+        target_u_.resize(pixnum * channel);
+        target_v_.resize(pixnum * channel);
+        target_depth_.resize(pixnum);
+        target_row_min_.resize(depth_height);
+        target_row_max_.resize(depth_height);
     }
 
-    const float *coeff_mat_x = finder_x->second;
-    const float *coeff_mat_y = finder_y->second;
-    const float *coeff_mat_z = finder_z->second;
+    int granularity = getRowGranularity(depth_width, with_simd ? ALIGN_KERNEL_PIXELS : 1);
+    thread_pool_->parallelForRows(depth_height, thread_count_, [&](size_t band_begin, size_t band_end) {
+        int row_begin = static_cast<int>(band_begin), row_end = static_cast<int>(band_end);
+        if(with_depth) {
+            std::fill(target_v_.begin() + static_cast<size_t>(row_begin) * depth_width * channel,
+                      target_v_.begin() + static_cast<size_t>(row_end) * depth_width * channel, INVALID_TARGET);
+        }
+        int pixel_begin = row_begin * depth_width, pixel_end = row_end * depth_width;
+        if(with_simd) {
+            D2CWithSIMD(depth_buffer, pixel_begin, pixel_end, with_depth, coeff_mat_x, coeff_mat_y, coeff_mat_z, map);
+        }
+        else {
+            D2CWithoutSSE(depth_buffer, pixel_begin, pixel_end, with_depth, coeff_mat_x, coeff_mat_y, coeff_mat_z, map);
+        }
+        if(with_depth) {
+            updateTargetRowRange(row_begin, row_end);
+        }
+    }, granularity);
 
-    if(withSSE) {
-        D2CWithSSE(depth_buffer, out_depth, coeff_mat_x, coeff_mat_y, coeff_mat_z, map);
-    }
-    else {
-        D2CWithoutSSE(depth_buffer, out_depth, coeff_mat_x, coeff_mat_y, coeff_mat_z, map);
+    if(with_depth) {
+        thread_pool_->parallelForRows(color_height, thread_count_, [&](size_t row_begin, size_t row_end) {
+            scatterDepth(static_cast<int>(row_begin), static_cast<int>(row_end), out_depth);
+        });
     }
 
-    if(out_depth) {
-        for(int idx = 0; idx < pixnum; idx++) {
-            if(65535 == out_depth[idx]) {
-                out_depth[idx] = 0;
-            }
-        }
+    return ret;
+}
+
+void AlignImpl::getRotationCoeff(const float *&coeff_x, const float *&coeff_y, const float *&coeff_z) const {
+    size_t coeff_num = static_cast<size_t>(depth_intric_.width) * depth_intric_.height * (gap_fill_copy_ ? 1 : 2);
+    coeff_x          = rot_coeff_.get();
+    coeff_y          = coeff_x + coeff_num;
+    coeff_z          = coeff_x + 2 * coeff_num;
+}
+
+int AlignImpl::mapDepthPixels(const uint16_t *depth_buffer, int pixel_begin, int pixel_end, int *map, bool withSIMD) {
+    // no pixel is mapped if it fails, so a caller ignoring the error does not read garbage
+    if(map && pixel_end > pixel_begin) {
+        std::fill(map, map + 2 * (pixel_end - pixel_begin), -1);
+    }
+    if(!initialized_ || !rot_coeff_ || !depth_buffer || !map || pixel_begin < 0 || pixel_end > depth_intric_.width * depth_intric_.height) {
+        LOG_ERROR_INTVL("Not initialized or input parameters don't match");
+        return -1;
     }
 
-    return ret;
+    const float *coeff_mat_x, *coeff_mat_y, *coeff_mat_z;
+    getRotationCoeff(coeff_mat_x, coeff_mat_y, coeff_mat_z);
+    if(withSIMD && kernel_ != ALIGN_KERNEL_SCALAR) {
+        D2CWithSIMD(depth_buffer, pixel_begin, pixel_end, false, coeff_mat_x, coeff_mat_y, coeff_mat_z, map, pixel_begin);
+    }
+    else {
+        D2CWithoutSSE(depth_buffer, pixel_begin, pixel_end, false, coeff_mat_x, coeff_mat_y, coeff_mat_z, map, pixel_begin);
+    }
+    return 0;
 }
 
 typedef struct {
@@ -620,7 +598,7 @@ typedef struct {
 } uint24_t;
 
 int AlignImpl::C2D(const uint16_t *depth_buffer, int depth_width, int depth_height, const void *rgb_buffer, void *out_rgb, int color_width, int color_height,
-                   OBFormat format, bool withSSE) {
+                   OBFormat format, bool withSIMD) {
 
     // rgb x-y coordinates for each depth pixel
     unsigned long long size     = static_cast<unsigned long long>(depth_width) * depth_height * 2;
@@ -628,7 +606,7 @@ int AlignImpl::C2D(const uint16_t *depth_buffer, int depth_width, int depth_heig
     memset(depth_xy, -1, size * sizeof(int));
 
     int ret = -1;
-    if(!D2C(depth_buffer, depth_width, depth_height, nullptr, color_width, color_height, depth_xy, withSSE)) {
+    if(!D2C(depth_buffer, depth_width, depth_height, nullptr, color_width, color_height, depth_xy, withSIMD)) {
 
         switch(format) {
         case OB_FORMAT_Y8:
@@ -663,16 +641,18 @@ int AlignImpl::C2D(const uint16_t *depth_buffer, int depth_width, int depth_heig
 
 template <typename T>
 void AlignImpl::mapPixel(const int *map, const T *src_buffer, int src_width, int src_height, T *dst_buffer, int dst_width, int dst_height) {
-    for(int v = 0; v < dst_height; v++) {
-        for(int u = 0; u < dst_width; u++) {
-            int id = v * dst_width + u;
-            int us = map[2 * id], vs = map[2 * id + 1];
-            if((us < 0) || (us > src_width - 1) || (vs < 0) || (vs > src_height - 1))
-                continue;
-            int is         = vs * src_width + us;
-            dst_buffer[id] = src_buffer[is];
+    thread_pool_->parallelForRows(dst_height, thread_count_, [&](size_t row_begin, size_t row_end) {
+        for(int v = static_cast<int>(row_begin); v < static_cast<int>(row_end); v++) {
+            for(int u = 0; u < dst_width; u++) {
+                int id = v * dst_width + u;
+                int us = map[2 * id], vs = map[2 * id + 1];
+                if((us < 0) || (us > src_width - 1) || (vs < 0) || (vs > src_height - 1))
+                    continue;
+                int is         = vs * src_width + us;
+                dst_buffer[id] = src_buffer[is];
+            }
         }
-    }
+    });
 }
 
 }  // namespace libobsensor
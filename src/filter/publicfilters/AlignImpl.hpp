@@ -5,14 +5,10 @@
 #include <utility>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include "libobsensor/h/ObTypes.h"
-
-#if(defined(__ARM_NEON__) || defined(__aarch64__) || defined(__arm__))
-#include "SSE2NEON.h"
-#else
-#include <xmmintrin.h>
-#include <smmintrin.h>
-#endif
+#include "utils/ThreadPool.hpp"
+#include "AlignImplKernel.hpp"
 
 namespace libobsensor {
 
@@ -63,6 +59,27 @@ public:
         return depth_unit_mm_;
     };
 
+    /**
+     * @brief Set the number of threads D2C and C2D run on
+     * @param[in] thread_count thread count, 0 for one thread per cpu core
+     */
+    void setThreadCount(int thread_count) {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * @brief Select the SIMD kernel D2C and C2D run with, the best one the cpu supports by default
+     * @param[in] kernel the kernel
+     * @retval false if the kernel is not built for this architecture or not supported by the cpu
+     */
+    bool setKernel(AlignKernel kernel);
+
+    AlignKernel getKernel() const {
+        return kernel_;
+    }
+
+    static bool isKernelAvailable(AlignKernel kernel);
+
     /**
      * @brief Prepare LUTs of depth undistortion and rotation
      */
@@ -82,12 +99,12 @@ public:
      * @param[in]       color_width   width of the color frame
      * @param[in]       color_height  height of the color frame
      * @param[in]       map    coordinate mapping for C2D
-     * @param[in]       withSSE switch to speed up with SSE
+     * @param[in]       withSIMD switch to speed up with the SIMD kernel, see setKernel
      * @retval  -1  fail
      * @retval  0   succeed
      */
     int D2C(const uint16_t *depth_buffer, int depth_width, int depth_height, uint16_t *out_depth, int color_width, int color_height, int *map = nullptr,
-            bool withSSE = true);
+            bool withSIMD = true);
 
     /**
      * @brief Align color to depth
@@ -99,23 +116,53 @@ public:
      * @param[in] color_width  width of the to-align color frame
      * @param[in] color_height height of the to-align color frame
      * @param[in] format       pixel format of the color fraem
+     * @param[in] withSIMD     switch to speed up with the SIMD kernel, see setKernel
      * @retval -1 fail
      * @retval 0 succeed
      */
     int C2D(const uint16_t *depth_buffer, int depth_width, int depth_height, const void *rgb_buffer, void *out_rgb, int color_width, int color_height,
-            OBFormat format, bool withSSE = true);
+            OBFormat format, bool withSIMD = true);
+
+    /**
+     * @brief Map depth pixels to the pixels of the target frame, as C2D does before copying the target pixels, but for a range of pixels and without
+     * the thread pool, so it can run on the threads of the caller at the same time
+     * @param[in] depth_buffer data buffer of the depth frame in row-major order
+     * @param[in] pixel_begin, pixel_end the depth pixels to map
+     * @param[out] map the target x and y of each pixel from pixel_begin, -1 for the pixels of invalid depth or out of the target frame, and for all
+     * pixels if it fails
+     * @param[in] withSIMD switch to speed up with the SIMD kernel, see setKernel
+     * @retval -1 fail
+     * @retval 0 succeed
+     */
+    int mapDepthPixels(const uint16_t *depth_buffer, int pixel_begin, int pixel_end, int *map, bool withSIMD = true);
 
 private:
     void clearMatrixCache();
 
-    void D2CWithoutSSE(const uint16_t *depth_buffer, uint16_t *out_depth, const float *coeff_x, const float *coeff_y, const float *coeff_z, int *map = nullptr);
-    void D2CWithSSE(const uint16_t *depth_buffer, uint16_t *out_depth, const float *coeff_x, const float *coeff_y, const float *coeff_z, int *map = nullptr);
-    /** SSE speed-ed depth to color alignment with different distortion model */
-    void distortedWithSSE(__m128 &nx, __m128 &ny, const __m128 x2, const __m128 y2, const __m128 r2);
-    void KBDistortedWithSSE(__m128 &nx, __m128 &ny, const __m128 r2);
-    void BMDistortedWithSSE(__m128 &nx, __m128 &ny, const __m128 x2, const __m128 y2, const __m128 r2);
+    void getRotationCoeff(const float *&coeff_x, const float *&coeff_y, const float *&coeff_z) const;
+
+    /** Project the depth pixels [pixel_begin, pixel_end) to the target frame, see transferDepth */
+    void D2CWithoutSSE(const uint16_t *depth_buffer, int pixel_begin, int pixel_end, bool with_depth, const float *coeff_x, const float *coeff_y,
+                       const float *coeff_z, int *map = nullptr, int map_begin = 0);
+    /** Same with the SIMD kernel, the pixels after the last whole group of ALIGN_KERNEL_PIXELS with D2CWithoutSSE */
+    void D2CWithSIMD(const uint16_t *depth_buffer, int pixel_begin, int pixel_end, bool with_depth, const float *coeff_x, const float *coeff_y,
+                     const float *coeff_z, int *map = nullptr, int map_begin = 0);
 
-    void transferDepth(const float *pixelx, const float *pixely, const float *depth, const int npts, const int point_index, uint16_t *out_depth, int *map);
+    /**
+     * @brief Store the target pixels and depth of projected depth pixels, to be scattered to the aligned depth frame by scatterDepth
+     * (if with_depth) and/or to the coordinate map of the pixels from map_begin
+     */
+    void transferDepth(const float *pixelx, const float *pixely, const float *depth, const int npts, const int point_index, bool with_depth, int *map,
+                       int map_begin);
+
+    /** Update the row range of the target frame touched by the projected pixels of depth rows [row_begin, row_end) */
+    void updateTargetRowRange(int row_begin, int row_end);
+
+    /** Scatter the projected depth pixels to rows [row_begin, row_end) of the aligned depth frame, in the order of the depth frame */
+    void scatterDepth(int row_begin, int row_end, uint16_t *out_depth);
+
+    /** The granularity of the row bands of rows of width pixels run on the thread pool, so that the bands start at a multiple of align_pixels pixels */
+    static int getRowGranularity(int width, int align_pixels);
 
     /**
      * @brief               Transfer pixels of the source image buffer to the target
@@ -132,10 +179,8 @@ private:
 private:
     bool initialized_;
 
-    /** Linear/Distortion Rotation Coeff hash table */
-    std::unordered_map<std::pair<int, int>, float *, ResHashFunc, ResComp> rot_coeff_ht_x;
-    std::unordered_map<std::pair<int, int>, float *, ResHashFunc, ResComp> rot_coeff_ht_y;
-    std::unordered_map<std::pair<int, int>, float *, ResHashFunc, ResComp> rot_coeff_ht_z;
+    /** Linear/Distortion Rotation Coeff of the x, y and z coordinates of the depth resolution one after another, from CoordinateTablesCache */
+    std::shared_ptr<const float> rot_coeff_;
 
     float              depth_unit_mm_;          // depth scale
     bool               add_target_distortion_;  // distort align frame with target coefficent
@@ -151,29 +196,23 @@ private:
     // possible inflection point of the calibrated K6 distortion curve
     float r2_max_loc_;
 
-    // members for SSE
-    __m128 color_cx_;
-    __m128 color_cy_;
-    __m128 color_fx_;
-    __m128 color_fy_;
-    __m128 color_k1_;
-    __m128 color_k2_;
-    __m128 color_k3_;
-    __m128 color_k4_;
-    __m128 color_k5_;
-    __m128 color_k6_;
-    __m128 color_p1_;
-    __m128 color_p2_;
-    __m128 scaled_trans_1_;
-    __m128 scaled_trans_2_;
-    __m128 scaled_trans_3_;
-    __m128 r2_max_loc_sse_;
-
-    const static __m128  POINT_FIVE;
-    const static __m128  TWO;
-    const static __m128i ZERO;
-    const static __m128  ZERO_F;
+    // D2C runs in two passes on row bands of the thread pool. The first projects the depth pixels and stores their target pixels and depth, the
+    // second scatters them to the aligned depth frame. Each band of the second pass owns its target rows and takes the depth pixels in the order
+    // of the depth frame, so the output is the same as scattering on a single thread, without locks or atomics.
+    std::shared_ptr<ThreadPool> thread_pool_;
+    int                         thread_count_;
+    std::vector<int16_t>        target_u_;  // per depth pixel and channel, clamped to [-1, color width]
+    std::vector<int16_t>        target_v_;  // per depth pixel and channel, clamped to [-1, color height], INVALID_TARGET if not projected
+    std::vector<uint16_t>       target_depth_;
+    std::vector<int>            target_row_min_;  // per depth row, the target rows its pixels touch
+    std::vector<int>            target_row_max_;
+
+    // parameters of the SIMD kernels, the rotation coefficients are set by D2C for the frame resolution
+    AlignProjection  projection_;
+    AlignKernel      kernel_;
+    AlignProjectFunc project_func_;
 };
 
+}  // namespace libobsensor
+
 #endif  // D2C_DEPTH_TO_COLOR_IMPL_H
-}  // namespace
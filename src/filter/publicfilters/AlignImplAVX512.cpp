@@ -0,0 +1,14 @@
+#include "AlignImplKernel.hpp"
+
+// Built with the AVX-512 flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX512_KERNELS
+#include "SimdVectorAVX512.hpp"
+
+namespace libobsensor {
+
+void projectDepthAVX512(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z) {
+    projectDepthKernel<Avx512FloatVector>(proj, depth, pixel_index, count, x, y, z);
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX512_KERNELS
@@ -0,0 +1,175 @@
+#pragma once
+#include "libobsensor/h/ObTypes.h"
+#include "SimdKernel.hpp"
+#include <stdint.h>
+
+// The SIMD kernels projecting depth pixels to the target frame for AlignImpl, written once for a float vector type V (SseFloatVector, ...) and built
+// for each instruction set in its own translation unit (AlignImplSSE.cpp, AlignImplAVX2.cpp, ...), see SimdKernel.hpp.
+
+namespace libobsensor {
+
+typedef enum {
+    ALIGN_KERNEL_SCALAR = SIMD_ISA_SCALAR,
+    ALIGN_KERNEL_SSE    = SIMD_ISA_SSE,
+    ALIGN_KERNEL_AVX2   = SIMD_ISA_AVX2,
+    ALIGN_KERNEL_AVX512 = SIMD_ISA_AVX512,
+    ALIGN_KERNEL_NEON   = SIMD_ISA_NEON,
+} AlignKernel;
+
+// The kernels take pixels in groups of ALIGN_KERNEL_PIXELS, a multiple of the vector width of every instruction set
+#define ALIGN_KERNEL_PIXELS 16
+
+struct AlignProjection {
+    // rotation coefficients per depth pixel, interleaved by channel, see AlignImpl::prepareDepthResolution
+    const float *coeff_x;
+    const float *coeff_y;
+    const float *coeff_z;
+    int          channel;  // 1 for the pixel center, 2 for its top-left and bottom-right corners
+
+    float trans[3];  // translation scaled by the depth unit
+    float fx, fy, cx, cy;
+
+    bool                    add_distortion;
+    OBCameraDistortionModel model;
+    float                   k1, k2, k3, k4, k5, k6, p1, p2;
+    float                   r2_max_loc;  // K6 model only: if not 0, the pixels beyond this inflection point of the distortion curve are dropped
+};
+
+/**
+ * @brief Project count depth pixels (a multiple of ALIGN_KERNEL_PIXELS) starting at pixel_index to the target frame
+ * @param[out] x, y target pixel coordinates, and z the depth in the target frame (0 if the pixel is dropped), in the layout of
+ * AlignImpl::transferDepth: x[channel * count + i]
+ */
+typedef void (*AlignProjectFunc)(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z);
+
+void projectDepthSSE(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z);
+void projectDepthAVX2(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z);
+void projectDepthAVX512(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z);
+void projectDepthNEON(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z);
+
+namespace {
+
+// atan(x) for x >= 0, by the range reduction and polynomial of the Cephes atanf (max error ~1e-7 rad)
+template <typename V> typename V::F atanKernel(typename V::F x) {
+    typedef typename V::F F;
+    const F one = V::set1(1.0f);
+    auto    big = V::gt(x, V::set1(2.414213562373095f));   // tan(3pi/8)
+    auto    mid = V::gt(x, V::set1(0.4142135623730950f));  // tan(pi/8)
+
+    F xr = V::select(big, V::div(V::set1(-1.0f), x), V::select(mid, V::div(V::sub(x, one), V::add(x, one)), x));
+    F y0 = V::select(big, V::set1(1.5707963267948966f), V::select(mid, V::set1(0.7853981633974483f), V::set1(0.0f)));
+    F z  = V::mul(xr, xr);
+    F p  = V::madd(V::madd(V::madd(V::set1(8.05374449538e-2f), z, V::set1(-1.38776856032e-1f)), z, V::set1(1.99777106478e-1f)), z,
+                   V::set1(-3.33329491539e-1f));
+    return V::add(y0, V::madd(V::mul(p, z), xr, xr));
+}
+
+// Distort the normalized coordinates nx, ny with the target distortion, see addDistortion; drops the pixels beyond r2_max_loc by setting z to 0
+template <typename V> void distortKernel(const AlignProjection &proj, typename V::F &nx, typename V::F &ny, typename V::F &z) {
+    typedef typename V::F F;
+    const F one = V::set1(1.0f);
+    const F two = V::set1(2.0f);
+    F       x2  = V::mul(nx, nx);
+    F       y2  = V::mul(ny, ny);
+    F       r2  = V::add(x2, y2);
+
+    switch(proj.model) {
+    case OB_DISTORTION_BROWN_CONRADY: {
+        F xy = V::mul(nx, ny);
+        F r4 = V::mul(r2, r2);
+        F r6 = V::mul(r4, r2);
+        // k_diff - 1 = k1 * r2 + k2 * r4 + k3 * r6
+        F k_jx = V::madd(V::set1(proj.k3), r6, V::madd(V::set1(proj.k2), r4, V::mul(V::set1(proj.k1), r2)));
+        // x_qx = p2 * (2 * x2 + r2) + 2 * p1 * xy, y_qx = p1 * (2 * y2 + r2) + 2 * p2 * xy
+        F x_qx = V::madd(V::set1(proj.p2), V::madd(x2, two, r2), V::mul(V::mul(V::set1(proj.p1), xy), two));
+        F y_qx = V::madd(V::set1(proj.p1), V::madd(y2, two, r2), V::mul(V::mul(V::set1(proj.p2), xy), two));
+        nx     = V::add(nx, V::madd(nx, k_jx, x_qx));
+        ny     = V::add(ny, V::madd(ny, k_jx, y_qx));
+        break;
+    }
+    case OB_DISTORTION_BROWN_CONRADY_K6: {
+        if(proj.r2_max_loc > 0) {
+            z = V::select(V::lt(r2, V::set1(proj.r2_max_loc)), z, V::set1(0.0f));
+        }
+        F xy = V::mul(nx, ny);
+        F r4 = V::mul(r2, r2);
+        F r6 = V::mul(r4, r2);
+        // k_diff = (1 + k1 * r2 + k2 * r4 + k3 * r6) / (1 + k4 * r2 + k5 * r4 + k6 * r6)
+        F num  = V::add(one, V::madd(V::set1(proj.k3), r6, V::madd(V::set1(proj.k2), r4, V::mul(V::set1(proj.k1), r2))));
+        F den  = V::add(one, V::madd(V::set1(proj.k6), r6, V::madd(V::set1(proj.k5), r4, V::mul(V::set1(proj.k4), r2))));
+        F k_jx = V::div(num, den);
+        F x_qx = V::madd(V::set1(proj.p2), V::madd(x2, two, r2), V::mul(V::mul(V::set1(proj.p1), xy), two));
+        F y_qx = V::madd(V::set1(proj.p1), V::madd(y2, two, r2), V::mul(V::mul(V::set1(proj.p2), xy), two));
+        nx     = V::madd(nx, k_jx, x_qx);
+        ny     = V::madd(ny, k_jx, y_qx);
+        break;
+    }
+    case OB_DISTORTION_KANNALA_BRANDT4: {
+        F r      = V::sqrt(r2);
+        F theta  = atanKernel<V>(r);
+        F theta2 = V::mul(theta, theta);
+        F theta3 = V::mul(theta, theta2);
+        F theta5 = V::mul(theta2, theta3);
+        F theta7 = V::mul(theta2, theta5);
+        F theta9 = V::mul(theta2, theta7);
+        // theta_d = theta + k1 * theta^3 + k2 * theta^5 + k3 * theta^7 + k4 * theta^9, scaled by theta_d / r (1 at the optical center)
+        F theta_jx = V::madd(V::set1(proj.k4), theta9,
+                             V::madd(V::set1(proj.k3), theta7, V::madd(V::set1(proj.k2), theta5, V::madd(V::set1(proj.k1), theta3, theta))));
+        F scale    = V::select(V::gt(r, V::set1(0.0f)), V::div(theta_jx, r), one);
+        nx         = V::mul(scale, nx);
+        ny         = V::mul(scale, ny);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+template <typename V>
+void projectDepthKernel(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z) {
+    typedef typename V::F F;
+    const int channel = proj.channel;
+    const F   zero    = V::set1(0.0f);
+    const F   trans_x = V::set1(proj.trans[0]);
+    const F   trans_y = V::set1(proj.trans[1]);
+    const F   trans_z = V::set1(proj.trans[2]);
+    const F   fx      = V::set1(proj.fx);
+    const F   fy      = V::set1(proj.fy);
+    const F   cx      = V::set1(proj.cx);
+    const F   cy      = V::set1(proj.cy);
+
+    for(int i = 0; i < count; i += V::WIDTH) {
+        int   idx   = pixel_index + i;
+        F     d     = V::loadDepth(depth + idx);
+        auto  valid = V::gt(d, zero);
+        F     coeff_x[2], coeff_y[2], coeff_z[2];
+        if(channel == 1) {
+            coeff_x[0] = V::load(proj.coeff_x + idx);
+            coeff_y[0] = V::load(proj.coeff_y + idx);
+            coeff_z[0] = V::load(proj.coeff_z + idx);
+        }
+        else {
+            V::loadDeinterleave(proj.coeff_x + 2 * idx, coeff_x[0], coeff_x[1]);
+            V::loadDeinterleave(proj.coeff_y + 2 * idx, coeff_y[0], coeff_y[1]);
+            V::loadDeinterleave(proj.coeff_z + 2 * idx, coeff_z[0], coeff_z[1]);
+        }
+
+        // center or top-left-and-bottom-right
+        for(int fold = 0; fold < channel; fold++) {
+            F X  = V::madd(d, coeff_x[fold], trans_x);
+            F Y  = V::madd(d, coeff_y[fold], trans_y);
+            F Z  = V::madd(d, coeff_z[fold], trans_z);
+            F nx = V::div(X, Z);
+            F ny = V::div(Y, Z);
+            if(proj.add_distortion) {
+                distortKernel<V>(proj, nx, ny, Z);
+            }
+            V::store(x + fold * count + i, V::madd(nx, fx, cx));
+            V::store(y + fold * count + i, V::madd(ny, fy, cy));
+            V::store(z + fold * count + i, V::select(valid, Z, zero));
+        }
+    }
+}
+
+}  // namespace
+}  // namespace libobsensor
@@ -0,0 +1,14 @@
+#include "AlignImplKernel.hpp"
+
+// NEON is part of the 64-bit ARM baseline; 32-bit ARM uses the SSE kernel through SSE2NEON
+#if defined(__aarch64__)
+#include "SimdVectorNEON.hpp"
+
+namespace libobsensor {
+
+void projectDepthNEON(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z) {
+    projectDepthKernel<NeonFloatVector>(proj, depth, pixel_index, count, x, y, z);
+}
+
+}  // namespace libobsensor
+#endif  // __aarch64__
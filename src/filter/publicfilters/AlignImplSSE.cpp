@@ -0,0 +1,10 @@
+#include "AlignImplKernel.hpp"
+#include "SimdVectorSSE.hpp"
+
+namespace libobsensor {
+
+void projectDepthSSE(const AlignProjection &proj, const uint16_t *depth, int pixel_index, int count, float *x, float *y, float *z) {
+    projectDepthKernel<SseFloatVector>(proj, depth, pixel_index, count, x, y, z);
+}
+
+}  // namespace libobsensor
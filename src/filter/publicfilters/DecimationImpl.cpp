@@ -0,0 +1,255 @@
+#include "DecimationImpl.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace libobsensor {
+
+// The largest scale of DecimationFilter
+static const int MAX_SCALE = 8;
+
+namespace {
+
+void decimateMedianScalar(const uint16_t *const *rows, int scale, int count, uint16_t *out) {
+    for(int i = 0; i < count; i++) {
+        out[i] = medianOfNonZero(rows, scale, i);
+    }
+}
+
+// The sums of the columns of the scale rows, in loops the compiler vectorizes; the sums of the patches are then the sums of scale columns
+template <typename T, typename S> void sumColumns(const T *const *rows, int scale, size_t count, S *sums) {
+    const T *row = rows[0];
+    for(size_t x = 0; x < count; x++) {
+        sums[x] = row[x];
+    }
+    for(int n = 1; n < scale; n++) {
+        row = rows[n];
+        for(size_t x = 0; x < count; x++) {
+            sums[x] += row[x];
+        }
+    }
+}
+
+void countNonZeroColumns(const uint16_t *const *rows, int scale, size_t count, uint32_t *counts) {
+    std::fill(counts, counts + count, 0);
+    for(int n = 0; n < scale; n++) {
+        const uint16_t *row = rows[n];
+        for(size_t x = 0; x < count; x++) {
+            counts[x] += row[x] != 0;
+        }
+    }
+}
+
+// The mean of each channel of count patches, from the sums of their columns
+template <typename T, typename S> void meanPatches(const S *sums, int scale, int channels, int count, uint32_t patch_size, T *out) {
+    for(int i = 0; i < count; i++) {
+        const S *patch = sums + static_cast<size_t>(i) * scale * channels;
+        for(int k = 0; k < channels; k++) {
+            uint32_t sum = 0;
+            for(int m = 0; m < scale; m++) {
+                sum += patch[m * channels + k];
+            }
+            *out++ = static_cast<T>(sum / patch_size);
+        }
+    }
+}
+
+// YUYV and UYVY: the luma of the scale pixels of a patch row, every other byte from the first luma byte
+inline uint32_t sumLuma(const uint16_t *sums, int scale) {
+    uint32_t sum = 0;
+    for(int m = 0; m < scale; m++) {
+        sum += sums[m * 2];
+    }
+    return sum;
+}
+
+// YUYV and UYVY: the chroma of the scale pixels of a patch row, every 4 bytes from the first chroma byte, shared by the 2 pixels of each pair; with
+// an odd scale, the patch has only one pixel of the last pair
+inline uint32_t sumChroma(const uint16_t *sums, int scale) {
+    int      s2  = scale >> 1;
+    uint32_t sum = 0;
+    for(int m = 0; m < s2; m++) {
+        sum += 2 * sums[m * 4];
+    }
+    if(scale & 1) {
+        sum += sums[s2 * 4];
+    }
+    return sum;
+}
+
+}  // namespace
+
+static DecimationMedianFunc getMedianFunc(DecimationKernel kernel) {
+    static const DecimationMedianFunc kernels[SIMD_ISA_COUNT] = { decimateMedianScalar, decimateMedianSSE, SIMD_KERNEL_AVX2(decimateMedianAVX2),
+                                                                  SIMD_KERNEL_AVX512(decimateMedianAVX512), SIMD_KERNEL_NEON(decimateMedianNEON) };
+    return getSimdKernel(kernels, kernel);
+}
+
+DecimationImpl::DecimationImpl() : thread_count_(0), kernel_(DECIMATION_KERNEL_SCALAR), median_func_(decimateMedianScalar) {
+    thread_pool_ = ThreadPool::getInstance();
+
+    setWidestSimdKernel<DecimationKernel>([this](DecimationKernel kernel) { return setKernel(kernel); });
+}
+
+bool DecimationImpl::isKernelAvailable(DecimationKernel kernel) {
+    return getMedianFunc(kernel) != nullptr;
+}
+
+bool DecimationImpl::setKernel(DecimationKernel kernel) {
+    auto func = getMedianFunc(kernel);
+    if(!func) {
+        return false;
+    }
+    kernel_      = kernel;
+    median_func_ = func;
+    return true;
+}
+
+void DecimationImpl::runRowBands(int rows, const std::function<void(int row_begin, int row_end)> &process_rows) const {
+    thread_pool_->parallelForRows(rows, thread_count_, [&](size_t row_begin, size_t row_end) {
+        process_rows(static_cast<int>(row_begin), static_cast<int>(row_end));
+    });
+}
+
+void DecimationImpl::decimateDepth(const uint16_t *in, size_t width_in, int scale, int real_width, int real_height, int padded_width, int padded_height,
+                                   uint16_t *out) const {
+    if(scale < 1 || scale > MAX_SCALE) {
+        return;
+    }
+
+    runRowBands(real_height, [&](int row_begin, int row_end) {
+        const uint16_t       *rows[MAX_SCALE];
+        std::vector<uint32_t> sums, counts;
+        for(int j = row_begin; j < row_end; j++) {
+            for(int n = 0; n < scale; n++) {
+                rows[n] = in + (static_cast<size_t>(j) * scale + n) * width_in;
+            }
+            uint16_t *dst = out + static_cast<size_t>(j) * padded_width;
+
+            if(scale == 2 || scale == 3) {
+                int kernel_count = real_width / DECIMATION_KERNEL_PIXELS * DECIMATION_KERNEL_PIXELS;
+                median_func_(rows, scale, kernel_count, dst);
+                for(int i = kernel_count; i < real_width; i++) {
+                    dst[i] = medianOfNonZero(rows, scale, i);
+                }
+            }
+            else {
+                // the mean of the non-zero pixels
+                size_t columns = static_cast<size_t>(real_width) * scale;
+                sums.resize(columns);
+                counts.resize(columns);
+                sumColumns(rows, scale, columns, sums.data());
+                countNonZeroColumns(rows, scale, columns, counts.data());
+                for(int i = 0; i < real_width; i++) {
+                    uint32_t sum = 0, count = 0;
+                    for(int m = 0; m < scale; m++) {
+                        sum += sums[i * scale + m];
+                        count += counts[i * scale + m];
+                    }
+                    dst[i] = static_cast<uint16_t>(count == 0 ? 0 : sum / count);
+                }
+            }
+
+            // filling right side blanks
+            std::fill(dst + real_width, dst + padded_width, static_cast<uint16_t>(0));
+        }
+    });
+    memset(out + static_cast<size_t>(real_height) * padded_width, 0, static_cast<size_t>(padded_height - real_height) * padded_width * sizeof(uint16_t));
+}
+
+void DecimationImpl::decimateOthers(OBFormat format, const void *in, size_t width_in, int scale, int real_width, int real_height, int padded_width,
+                                    int padded_height, void *out) const {
+    int bytes_per_pixel = 0;
+    switch(format) {
+    case OB_FORMAT_Y8:
+        bytes_per_pixel = 1;
+        break;
+    case OB_FORMAT_Y16:
+    case OB_FORMAT_YUYV:
+    case OB_FORMAT_UYVY:
+        bytes_per_pixel = 2;
+        break;
+    case OB_FORMAT_RGB:
+    case OB_FORMAT_BGR:
+        bytes_per_pixel = 3;
+        break;
+    case OB_FORMAT_RGBA:
+    case OB_FORMAT_BGRA:
+        bytes_per_pixel = 4;
+        break;
+    default:
+        return;
+    }
+    if(scale < 1 || scale > MAX_SCALE) {
+        return;
+    }
+
+    const uint8_t *src          = static_cast<const uint8_t *>(in);
+    uint8_t       *dst          = static_cast<uint8_t *>(out);
+    const size_t   row_size_in  = width_in * bytes_per_pixel;
+    const size_t   row_size_out = static_cast<size_t>(padded_width) * bytes_per_pixel;
+    const uint32_t patch_size   = static_cast<uint32_t>(scale * scale);
+
+    runRowBands(real_height, [&](int row_begin, int row_end) {
+        const uint8_t        *rows[MAX_SCALE];
+        const uint16_t       *rows16[MAX_SCALE];
+        std::vector<uint16_t> sums;
+        std::vector<uint32_t> sums16;
+        for(int j = row_begin; j < row_end; j++) {
+            for(int n = 0; n < scale; n++) {
+                rows[n]   = src + (static_cast<size_t>(j) * scale + n) * row_size_in;
+                rows16[n] = reinterpret_cast<const uint16_t *>(rows[n]);
+            }
+            uint8_t *q       = dst + static_cast<size_t>(j) * row_size_out;
+            size_t   written = 0;
+
+            switch(format) {
+            case OB_FORMAT_Y16: {
+                sums16.resize(static_cast<size_t>(real_width) * scale);
+                sumColumns(rows16, scale, sums16.size(), sums16.data());
+                meanPatches(sums16.data(), scale, 1, real_width, patch_size, reinterpret_cast<uint16_t *>(q));
+                written = static_cast<size_t>(real_width) * sizeof(uint16_t);
+            } break;
+            case OB_FORMAT_YUYV:
+            case OB_FORMAT_UYVY: {
+                // 4 bytes of a pixel pair per pair of patches
+                int rw_2 = real_width >> 1;
+                int s2   = scale >> 1;
+                int odd  = scale & 1;
+                sums.resize(static_cast<size_t>(rw_2) * scale * 4);
+                sumColumns(rows, scale, sums.size(), sums.data());
+                uint8_t *p = q;
+                for(int i = 0; i < rw_2; i++) {
+                    const uint16_t *patch = sums.data() + static_cast<size_t>(i) * scale * 4;
+                    if(format == OB_FORMAT_YUYV) {
+                        *p++ = static_cast<uint8_t>(sumLuma(patch, scale) / patch_size);
+                        *p++ = static_cast<uint8_t>(sumChroma(patch + 1, scale) / patch_size);
+                        *p++ = static_cast<uint8_t>(sumLuma(patch + s2 * 4 + (odd ? 2 : 0), scale) / patch_size);
+                        *p++ = static_cast<uint8_t>(sumChroma(patch + 3, scale) / patch_size);
+                    }
+                    else {
+                        *p++ = static_cast<uint8_t>(sumChroma(patch, scale) / patch_size);
+                        *p++ = static_cast<uint8_t>(sumLuma(patch + 1, scale) / patch_size);
+                        *p++ = static_cast<uint8_t>(sumChroma(patch + 2, scale) / patch_size);
+                        *p++ = static_cast<uint8_t>(sumLuma(patch + s2 * 4 + (odd ? 3 : 1), scale) / patch_size);
+                    }
+                }
+                written = static_cast<size_t>(rw_2) * 4;
+            } break;
+            default: {
+                // one byte per channel
+                sums.resize(static_cast<size_t>(real_width) * scale * bytes_per_pixel);
+                sumColumns(rows, scale, sums.size(), sums.data());
+                meanPatches(sums.data(), scale, bytes_per_pixel, real_width, patch_size, q);
+                written = static_cast<size_t>(real_width) * bytes_per_pixel;
+            } break;
+            }
+
+            // filling right side blanks
+            memset(q + written, 0, row_size_out - written);
+        }
+    });
+    memset(dst + real_height * row_size_out, 0, static_cast<size_t>(padded_height - real_height) * row_size_out);
+}
+
+}  // namespace libobsensor
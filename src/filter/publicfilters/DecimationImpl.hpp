@@ -0,0 +1,73 @@
+#pragma once
+#include "libobsensor/h/ObTypes.h"
+#include "utils/ThreadPool.hpp"
+#include "DecimationImplKernel.hpp"
+#include <functional>
+#include <memory>
+
+namespace libobsensor {
+
+/**
+ * @brief Implementation of the decimation of DecimationFilter: the median of the depth patches of scale 2 and 3 is computed by the SIMD kernels, and the
+ * means of the other patches from the sums of their columns; on row bands in parallel. The output is the same as the one of the scalar code.
+ */
+class DecimationImpl {
+public:
+    DecimationImpl();
+
+    ~DecimationImpl() = default;
+
+    /**
+     * @brief Set the number of threads the decimation runs on
+     * @param[in] thread_count thread count, 0 for one thread per cpu core
+     */
+    void setThreadCount(int thread_count) {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * @brief Select the SIMD kernel of the depth median, the best one the cpu supports by default
+     * @param[in] kernel the kernel
+     * @retval false if the kernel is not built for this architecture or not supported by the cpu
+     */
+    bool setKernel(DecimationKernel kernel);
+
+    DecimationKernel getKernel() const {
+        return kernel_;
+    }
+
+    static bool isKernelAvailable(DecimationKernel kernel);
+
+    /**
+     * @brief Decimate a depth frame: each scale x scale patch to the median of its non-zero pixels for the scales 2 and 3, to their mean for the others
+     * @param[in] in depth data
+     * @param[in] width_in width of the depth frame
+     * @param[in] scale size of the patches
+     * @param[in] real_width, real_height number of whole patches in a row and in a column
+     * @param[in] padded_width, padded_height size of the decimated frame, the pixels beyond the patches are 0
+     * @param[out] out the decimated frame
+     */
+    void decimateDepth(const uint16_t *in, size_t width_in, int scale, int real_width, int real_height, int padded_width, int padded_height,
+                       uint16_t *out) const;
+
+    /**
+     * @brief Decimate a color or IR frame: each scale x scale patch to the mean of its pixels, per channel
+     * @param[in] format frame format: OB_FORMAT_Y8, OB_FORMAT_Y16, OB_FORMAT_YUYV, OB_FORMAT_UYVY, OB_FORMAT_RGB, OB_FORMAT_BGR, OB_FORMAT_RGBA or
+     * OB_FORMAT_BGRA, the other formats are not decimated
+     * The other parameters are the ones of decimateDepth.
+     */
+    void decimateOthers(OBFormat format, const void *in, size_t width_in, int scale, int real_width, int real_height, int padded_width, int padded_height,
+                        void *out) const;
+
+private:
+    void runRowBands(int rows, const std::function<void(int row_begin, int row_end)> &process_rows) const;
+
+private:
+    std::shared_ptr<ThreadPool> thread_pool_;
+    int                         thread_count_;
+
+    DecimationKernel     kernel_;
+    DecimationMedianFunc median_func_;
+};
+
+}  // namespace libobsensor
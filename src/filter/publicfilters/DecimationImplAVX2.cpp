@@ -0,0 +1,14 @@
+#include "DecimationImplKernel.hpp"
+
+// Built with the AVX2 flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX2_KERNELS
+#include "SimdVectorAVX2.hpp"
+
+namespace libobsensor {
+
+void decimateMedianAVX2(const uint16_t *const *rows, int scale, int count, uint16_t *out) {
+    decimateMedianKernel<Avx2U16Vector>(rows, scale, count, out);
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX2_KERNELS
@@ -0,0 +1,14 @@
+#include "DecimationImplKernel.hpp"
+
+// Built with the AVX-512 flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX512_KERNELS
+#include "SimdVectorAVX512.hpp"
+
+namespace libobsensor {
+
+void decimateMedianAVX512(const uint16_t *const *rows, int scale, int count, uint16_t *out) {
+    decimateMedianKernel<Avx512U16Vector>(rows, scale, count, out);
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX512_KERNELS
@@ -0,0 +1,229 @@
+#pragma once
+#include "SimdKernel.hpp"
+#include <stdint.h>
+
+// The SIMD kernels of the median decimation of depth frames for DecimationImpl, written once for a uint16_t vector type V (SseU16Vector, ...) and
+// built for each instruction set in its own translation unit (DecimationImplSSE.cpp, DecimationImplAVX2.cpp, ...), see SimdKernel.hpp.
+
+namespace libobsensor {
+
+typedef enum {
+    DECIMATION_KERNEL_SCALAR = SIMD_ISA_SCALAR,
+    DECIMATION_KERNEL_SSE    = SIMD_ISA_SSE,
+    DECIMATION_KERNEL_AVX2   = SIMD_ISA_AVX2,
+    DECIMATION_KERNEL_AVX512 = SIMD_ISA_AVX512,
+    DECIMATION_KERNEL_NEON   = SIMD_ISA_NEON,
+} DecimationKernel;
+
+// The kernels take output pixels in groups of DECIMATION_KERNEL_PIXELS, a multiple of the vector width of every instruction set
+#define DECIMATION_KERNEL_PIXELS 32
+
+/**
+ * @brief Decimate count pixels (a multiple of DECIMATION_KERNEL_PIXELS) of a row by the median of the non-zero pixels of each scale x scale patch
+ * @param[in] rows the scale rows of the patches, from the first pixel of the first patch
+ * @param[in] scale 2 or 3
+ * @param[out] out the decimated pixels, 0 for the patches without non-zero pixels
+ */
+typedef void (*DecimationMedianFunc)(const uint16_t *const *rows, int scale, int count, uint16_t *out);
+
+void decimateMedianSSE(const uint16_t *const *rows, int scale, int count, uint16_t *out);
+void decimateMedianAVX2(const uint16_t *const *rows, int scale, int count, uint16_t *out);
+void decimateMedianAVX512(const uint16_t *const *rows, int scale, int count, uint16_t *out);
+void decimateMedianNEON(const uint16_t *const *rows, int scale, int count, uint16_t *out);
+
+namespace {
+
+// The median networks of the non-zero pixels of a patch, by their count. Some of them do not select the same element for every order of the pixels,
+// so the vector kernels run them on the pixels in the order of the scalar code: row by row, the zero pixels left out.
+// sortPair is the compare and swap "if(a > b) swap(a, b)"
+template <typename V> inline void sortPair(typename V::U &a, typename V::U &b) {
+    typename V::U lower = V::min(a, b);
+    b                   = V::max(a, b);
+    a                   = lower;
+}
+
+template <typename V> inline typename V::U median1(typename V::U arr[]) {
+    return arr[0];
+}
+
+template <typename V> inline typename V::U median2(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    return arr[0];
+}
+
+template <typename V> inline typename V::U median3(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[1], arr[2]);
+    sortPair<V>(arr[0], arr[1]);
+    return arr[1];
+}
+
+template <typename V> inline typename V::U median4(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[2], arr[3]);
+    sortPair<V>(arr[0], arr[2]);
+    sortPair<V>(arr[1], arr[3]);
+    sortPair<V>(arr[1], arr[2]);
+    return arr[1];
+}
+
+template <typename V> inline typename V::U median5(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[3], arr[4]);
+    sortPair<V>(arr[0], arr[2]);
+    sortPair<V>(arr[1], arr[2]);
+    sortPair<V>(arr[3], arr[2]);
+    sortPair<V>(arr[4], arr[2]);
+    sortPair<V>(arr[1], arr[3]);
+    return arr[2];
+}
+
+template <typename V> inline typename V::U median6(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[2], arr[3]);
+    sortPair<V>(arr[4], arr[5]);
+    sortPair<V>(arr[0], arr[2]);
+    sortPair<V>(arr[1], arr[3]);
+    sortPair<V>(arr[2], arr[4]);
+    sortPair<V>(arr[3], arr[5]);
+    sortPair<V>(arr[1], arr[4]);
+    sortPair<V>(arr[3], arr[4]);
+    return arr[2];
+}
+
+template <typename V> inline typename V::U median7(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[5]);
+    sortPair<V>(arr[0], arr[3]);
+    sortPair<V>(arr[1], arr[6]);
+    sortPair<V>(arr[2], arr[4]);
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[3], arr[5]);
+    sortPair<V>(arr[2], arr[6]);
+    sortPair<V>(arr[2], arr[3]);
+    sortPair<V>(arr[3], arr[6]);
+    sortPair<V>(arr[4], arr[5]);
+    sortPair<V>(arr[1], arr[5]);
+    sortPair<V>(arr[1], arr[3]);
+    sortPair<V>(arr[3], arr[4]);
+    return arr[3];
+}
+
+template <typename V> inline typename V::U median8(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[2], arr[3]);
+    sortPair<V>(arr[4], arr[5]);
+    sortPair<V>(arr[6], arr[7]);
+    sortPair<V>(arr[0], arr[2]);
+    sortPair<V>(arr[1], arr[3]);
+    sortPair<V>(arr[4], arr[6]);
+    sortPair<V>(arr[5], arr[7]);
+    sortPair<V>(arr[1], arr[4]);
+    sortPair<V>(arr[3], arr[6]);
+    sortPair<V>(arr[2], arr[5]);
+    sortPair<V>(arr[3], arr[4]);
+    sortPair<V>(arr[2], arr[6]);
+    sortPair<V>(arr[1], arr[3]);
+    sortPair<V>(arr[5], arr[7]);
+    sortPair<V>(arr[3], arr[5]);
+    sortPair<V>(arr[4], arr[6]);
+    return arr[3];
+}
+
+template <typename V> inline typename V::U median9(typename V::U arr[]) {
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[3], arr[4]);
+    sortPair<V>(arr[6], arr[7]);
+    sortPair<V>(arr[1], arr[2]);
+    sortPair<V>(arr[4], arr[5]);
+    sortPair<V>(arr[7], arr[8]);
+    sortPair<V>(arr[0], arr[1]);
+    sortPair<V>(arr[3], arr[4]);
+    sortPair<V>(arr[6], arr[7]);
+    sortPair<V>(arr[1], arr[2]);
+    sortPair<V>(arr[4], arr[5]);
+    sortPair<V>(arr[7], arr[8]);
+    arr[3] = V::max(arr[0], arr[3]);
+    arr[5] = V::min(arr[5], arr[8]);
+    sortPair<V>(arr[4], arr[7]);
+    arr[6] = V::max(arr[3], arr[6]);
+    arr[4] = V::max(arr[1], arr[4]);
+    arr[2] = V::min(arr[2], arr[5]);
+    arr[4] = V::min(arr[4], arr[7]);
+    sortPair<V>(arr[4], arr[2]);
+    arr[4] = V::min(arr[4], arr[6]);
+    return arr[4];
+}
+
+struct ScalarVector {
+    typedef uint16_t U;
+    static const int WIDTH = 1;
+
+    static U min(U a, U b) {
+        return a > b ? b : a;
+    }
+    static U max(U a, U b) {
+        return a > b ? a : b;
+    }
+};
+
+// The median of the non-zero pixels of the patch of pixel col, 0 if there are none
+inline uint16_t medianOfNonZero(const uint16_t *const *rows, int scale, int col) {
+    typedef uint16_t (*MedianFunc)(uint16_t arr[]);
+    static const MedianFunc median_funcs[] = { nullptr,
+                                               median1<ScalarVector>,
+                                               median2<ScalarVector>,
+                                               median3<ScalarVector>,
+                                               median4<ScalarVector>,
+                                               median5<ScalarVector>,
+                                               median6<ScalarVector>,
+                                               median7<ScalarVector>,
+                                               median8<ScalarVector>,
+                                               median9<ScalarVector> };
+
+    uint16_t working_kernel[9];
+    int      count = 0;
+    for(int n = 0; n < scale; n++) {
+        const uint16_t *p = rows[n] + col * scale;
+        for(int m = 0; m < scale; m++) {
+            if(p[m]) {
+                working_kernel[count++] = p[m];
+            }
+        }
+    }
+    return count == 0 ? 0 : median_funcs[count](working_kernel);
+}
+
+template <typename V> void decimateMedianKernel(const uint16_t *const *rows, int scale, int count, uint16_t *out) {
+    typedef typename V::U U;
+    for(int i = 0; i < count; i += V::WIDTH) {
+        U        median;
+        uint32_t zero_lanes;
+        if(scale == 2) {
+            U arr[4];
+            V::load2(rows[0] + 2 * i, arr[0], arr[1]);
+            V::load2(rows[1] + 2 * i, arr[2], arr[3]);
+            zero_lanes = V::zeroLanes(V::min(V::min(arr[0], arr[1]), V::min(arr[2], arr[3])));
+            median     = median4<V>(arr);
+        }
+        else {
+            U arr[9];
+            V::load3(rows[0] + 3 * i, arr[0], arr[1], arr[2]);
+            V::load3(rows[1] + 3 * i, arr[3], arr[4], arr[5]);
+            V::load3(rows[2] + 3 * i, arr[6], arr[7], arr[8]);
+            U lowest   = V::min(V::min(V::min(arr[0], arr[1]), V::min(arr[2], arr[3])), V::min(V::min(arr[4], arr[5]), V::min(arr[6], arr[7])));
+            zero_lanes = V::zeroLanes(V::min(lowest, arr[8]));
+            median     = median9<V>(arr);
+        }
+        V::store(out + i, median);
+
+        // the patches with zero pixels: the median of fewer pixels
+        for(int lane = 0; zero_lanes != 0; lane++, zero_lanes >>= 1) {
+            if(zero_lanes & 1) {
+                out[i + lane] = medianOfNonZero(rows, scale, i + lane);
+            }
+        }
+    }
+}
+
+}  // namespace
+}  // namespace libobsensor
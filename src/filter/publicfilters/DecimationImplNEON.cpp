@@ -0,0 +1,14 @@
+#include "DecimationImplKernel.hpp"
+
+// NEON is part of the 64-bit ARM baseline; 32-bit ARM uses the SSE kernel through SSE2NEON
+#if defined(__aarch64__)
+#include "SimdVectorNEON.hpp"
+
+namespace libobsensor {
+
+void decimateMedianNEON(const uint16_t *const *rows, int scale, int count, uint16_t *out) {
+    decimateMedianKernel<NeonU16Vector>(rows, scale, count, out);
+}
+
+}  // namespace libobsensor
+#endif  // __aarch64__
@@ -0,0 +1,10 @@
+#include "DecimationImplKernel.hpp"
+#include "SimdVectorSSE.hpp"
+
+namespace libobsensor {
+
+void decimateMedianSSE(const uint16_t *const *rows, int scale, int count, uint16_t *out) {
+    decimateMedianKernel<SseU16Vector>(rows, scale, count, out);
+}
+
+}  // namespace libobsensor
@@ -6,198 +6,6 @@
 
 namespace libobsensor {
 
-#define SWAP(a, b)            \
-    {                         \
-        uint16_t temp = (a);  \
-        (a)           = (b);  \
-        (b)           = temp; \
-    }
-
-inline uint16_t median1(uint16_t arr[]) {
-    return arr[0];
-}
-
-inline uint16_t median2(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    return arr[0];
-}
-
-inline uint16_t median3(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[1] > arr[2])
-        SWAP(arr[1], arr[2]);
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    return arr[1];
-}
-
-inline uint16_t median4(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[2] > arr[3])
-        SWAP(arr[2], arr[3]);
-    if(arr[0] > arr[2])
-        SWAP(arr[0], arr[2]);
-    if(arr[1] > arr[3])
-        SWAP(arr[1], arr[3]);
-    if(arr[1] > arr[2])
-        SWAP(arr[1], arr[2]);
-    return arr[1];
-}
-
-inline uint16_t median5(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[3] > arr[4])
-        SWAP(arr[3], arr[4]);
-    if(arr[0] > arr[2])
-        SWAP(arr[0], arr[2]);
-    if(arr[1] > arr[2])
-        SWAP(arr[1], arr[2]);
-    if(arr[3] > arr[2])
-        SWAP(arr[3], arr[2]);
-    if(arr[4] > arr[2])
-        SWAP(arr[4], arr[2]);
-    if(arr[1] > arr[3])
-        SWAP(arr[1], arr[3]);
-    return arr[2];
-}
-
-inline uint16_t median6(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[2] > arr[3])
-        SWAP(arr[2], arr[3]);
-    if(arr[4] > arr[5])
-        SWAP(arr[4], arr[5]);
-    if(arr[0] > arr[2])
-        SWAP(arr[0], arr[2]);
-    if(arr[1] > arr[3])
-        SWAP(arr[1], arr[3]);
-    if(arr[2] > arr[4])
-        SWAP(arr[2], arr[4]);
-    if(arr[3] > arr[5])
-        SWAP(arr[3], arr[5]);
-    if(arr[1] > arr[4])
-        SWAP(arr[1], arr[4]);
-    if(arr[3] > arr[4])
-        SWAP(arr[3], arr[4]);
-    return arr[2];
-}
-
-inline uint16_t median7(uint16_t arr[]) {
-    if(arr[0] > arr[5])
-        SWAP(arr[0], arr[5]);
-    if(arr[0] > arr[3])
-        SWAP(arr[0], arr[3]);
-    if(arr[1] > arr[6])
-        SWAP(arr[1], arr[6]);
-    if(arr[2] > arr[4])
-        SWAP(arr[2], arr[4]);
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[3] > arr[5])
-        SWAP(arr[3], arr[5]);
-    if(arr[2] > arr[6])
-        SWAP(arr[2], arr[6]);
-    if(arr[2] > arr[3])
-        SWAP(arr[2], arr[3]);
-    if(arr[3] > arr[6])
-        SWAP(arr[3], arr[6]);
-    if(arr[4] > arr[5])
-        SWAP(arr[4], arr[5]);
-    if(arr[1] > arr[5])
-        SWAP(arr[1], arr[5]);
-    if(arr[1] > arr[3])
-        SWAP(arr[1], arr[3]);
-    if(arr[3] > arr[4])
-        SWAP(arr[3], arr[4]);
-    return arr[3];
-}
-
-inline uint16_t median8(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[2] > arr[3])
-        SWAP(arr[2], arr[3]);
-    if(arr[4] > arr[5])
-        SWAP(arr[4], arr[5]);
-    if(arr[6] > arr[7])
-        SWAP(arr[6], arr[7]);
-    if(arr[0] > arr[2])
-        SWAP(arr[0], arr[2]);
-    if(arr[1] > arr[3])
-        SWAP(arr[1], arr[3]);
-    if(arr[4] > arr[6])
-        SWAP(arr[4], arr[6]);
-    if(arr[5] > arr[7])
-        SWAP(arr[5], arr[7]);
-    if(arr[1] > arr[4])
-        SWAP(arr[1], arr[4]);
-    if(arr[3] > arr[6])
-        SWAP(arr[3], arr[6]);
-    if(arr[2] > arr[5])
-        SWAP(arr[2], arr[5]);
-    if(arr[3] > arr[4])
-        SWAP(arr[3], arr[4]);
-    if(arr[2] > arr[6])
-        SWAP(arr[2], arr[6]);
-    if(arr[1] > arr[3])
-        SWAP(arr[1], arr[3]);
-    if(arr[5] > arr[7])
-        SWAP(arr[5], arr[7]);
-    if(arr[3] > arr[5])
-        SWAP(arr[3], arr[5]);
-    if(arr[4] > arr[6])
-        SWAP(arr[4], arr[6]);
-    return arr[3];
-}
-
-inline uint16_t median9(uint16_t arr[]) {
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[3] > arr[4])
-        SWAP(arr[3], arr[4]);
-    if(arr[6] > arr[7])
-        SWAP(arr[6], arr[7]);
-    if(arr[1] > arr[2])
-        SWAP(arr[1], arr[2]);
-    if(arr[4] > arr[5])
-        SWAP(arr[4], arr[5]);
-    if(arr[7] > arr[8])
-        SWAP(arr[7], arr[8]);
-    if(arr[0] > arr[1])
-        SWAP(arr[0], arr[1]);
-    if(arr[3] > arr[4])
-        SWAP(arr[3], arr[4]);
-    if(arr[6] > arr[7])
-        SWAP(arr[6], arr[7]);
-    if(arr[1] > arr[2])
-        SWAP(arr[1], arr[2]);
-    if(arr[4] > arr[5])
-        SWAP(arr[4], arr[5]);
-    if(arr[7] > arr[8])
-        SWAP(arr[7], arr[8]);
-    arr[3] = arr[0] > arr[3] ? arr[0] : arr[3];
-    arr[5] = arr[5] > arr[8] ? arr[8] : arr[5];
-    if(arr[4] > arr[7])
-        SWAP(arr[4], arr[7]);
-    arr[6] = arr[3] > arr[6] ? arr[3] : arr[6];
-    arr[4] = arr[1] > arr[4] ? arr[1] : arr[4];
-    arr[2] = arr[2] > arr[5] ? arr[5] : arr[2];
-    arr[4] = arr[4] > arr[7] ? arr[7] : arr[4];
-    if(arr[4] > arr[2])
-        SWAP(arr[4], arr[2]);
-    arr[4] = arr[4] > arr[6] ? arr[6] : arr[4];
-    return arr[4];
-}
-
-typedef uint16_t (*MDFUNC)(uint16_t arr[]);
-// 0     1       2        3        4         5        6        7       8       9
-static MDFUNC _mdfunc[] = { 0, median1, median2, median3, median4, median5, median6, median7, median8, median9 };
-
 DecimationFilter::DecimationFilter()
     : decimation_factor_(2),
       control_val_(2),
@@ -208,12 +16,14 @@ DecimationFilter::DecimationFilter()
       padded_width_(0),
       padded_height_(0),
       recalc_profile_(false),
-      options_changed_(false) {}
+      options_changed_(false),
+      impl_(std::make_shared<DecimationImpl>()) {}
 
 DecimationFilter::~DecimationFilter() noexcept {}
 
 void DecimationFilter::updateConfig(std::vector<std::string> &params) {
-    if(params.size() != 1) {
+    // decimate[, threadCount]
+    if(params.size() < 1 || params.size() > 2) {
         throw invalid_value_exception("DecimationFilter config error: params size not match");
     }
     try {
@@ -227,6 +37,13 @@ void DecimationFilter::updateConfig(std::vector<std::string> &params) {
                 options_changed_   = true;
             }
         }
+        if(params.size() > 1) {
+            int threadCount = std::stoi(params[1]);
+            if(threadCount < 0) {
+                throw invalid_value_exception("threadCount must not be negative");
+            }
+            impl_->setThreadCount(threadCount);
+        }
     }
     catch(const std::exception &e) {
         throw invalid_value_exception("DecimationFilter config error: " + std::string(e.what()));
@@ -235,7 +52,8 @@ void DecimationFilter::updateConfig(std::vector<std::string> &params) {
 
 const std::string &DecimationFilter::getConfigSchema() const {
     // csv format: name，type， min，max，step，default，description
-    static const std::string schema = "decimate, int, 1, 8, 1, 2, value decimate factor";
+    static const std::string schema = "decimate, int, 1, 8, 1, 2, value decimate factor\n"
+                                      "threadCount, int, 0, 16, 1, 0, number of threads to decimate on (0 for one per cpu core)";
     return schema;
 }
 
@@ -272,10 +90,12 @@ std::shared_ptr<Frame> DecimationFilter::process(std::shared_ptr<const Frame> fr
     auto srcVideosFrame = frame->as<VideoFrame>();
     auto newVideoFrame  = newOutFrame->as<VideoFrame>();
     if(frame->getType() == OB_FRAME_DEPTH && (frameFormat == OB_FORMAT_Y16 || frameFormat == OB_FORMAT_Z16)) {
-        decimateDepth((uint16_t *)frame->getData(), (uint16_t *)newVideoFrame->getData(), srcVideosFrame->getWidth(), patch_size_);
+        impl_->decimateDepth((const uint16_t *)frame->getData(), srcVideosFrame->getWidth(), patch_size_, real_width_, real_height_, padded_width_,
+                             padded_height_, (uint16_t *)newVideoFrame->getData());
     }
     else {
-        decimateOthers(frameFormat, (void *)frame->getData(), (void *)newVideoFrame->getData(), srcVideosFrame->getWidth(), patch_size_);
+        impl_->decimateOthers(frameFormat, frame->getData(), srcVideosFrame->getWidth(), patch_size_, real_width_, real_height_, padded_width_,
+                              padded_height_, (void *)newVideoFrame->getData());
     }
 
     return newOutFrame;
@@ -357,362 +177,4 @@ void DecimationFilter::updateOutputProfile(const std::shared_ptr<const Frame> fr
     }
 }
 
-void DecimationFilter::decimateDepth(uint16_t *frame_data_in, uint16_t *frame_data_out, size_t width_in, size_t scale) {
-
-    // construct internal register buf
-    uint16_t  working_kernel[9];
-    uint16_t *pixel_raws[10];  // max scale set 10
-    uint16_t *block_start = const_cast<uint16_t *>(frame_data_in);
-    uint16_t *p{};
-    int       wk_count = 0;
-    int       wk_sum   = 0;
-    MDFUNC    f;
-
-    if(scale == 2 || scale == 3) {
-        // loop through rows
-        for(int j = 0; j < real_height_; j++) {
-
-            for(size_t i = 0; i < scale; i++) {
-                pixel_raws[i] = block_start + (width_in * i);
-                //__builtin_prefetch(pixel_raws[i] + (width_in * scale), 0, 3);
-            }
-
-            // processing row-wisely
-            for(size_t i = 0, chunk_offset = 0; i < real_width_; i++, chunk_offset += scale) {
-                wk_count = 0;
-                // processing kernel
-                for(size_t n = 0; n < scale; ++n) {
-                    p = pixel_raws[n] + chunk_offset;
-                    for(size_t m = 0; m < scale; ++m) {
-                        if(*(p + m)) {
-                            working_kernel[wk_count] = *(p + m);
-                            wk_count++;
-                        }
-                    }
-                }
-
-                if(wk_count == 0)
-                    *frame_data_out++ = 0;
-                else {
-                    f                 = _mdfunc[wk_count];
-                    *frame_data_out++ = f(working_kernel);
-                }
-            }
-
-            // filling right side blanks
-            for(int k = real_width_; k < padded_width_; k++)
-                *frame_data_out++ = 0;
-
-            // move to the start position of next processing block
-            block_start += width_in * scale;
-        }
-    }
-    else {
-
-        for(int j = 0; j < real_height_; j++) {
-
-            for(size_t i = 0; i < scale; i++) {
-                pixel_raws[i] = block_start + (width_in * i);
-            }
-
-            for(size_t i = 0, chunk_offset = 0; i < real_width_; i++, chunk_offset += scale) {
-                wk_sum   = 0;
-                wk_count = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    p = pixel_raws[n] + chunk_offset;
-                    for(size_t m = 0; m < scale; ++m) {
-                        if(*(p + m)) {
-                            wk_sum += p[m];
-                            ++wk_count;
-                        }
-                    }
-                }
-
-                *frame_data_out++ = (uint16_t)(wk_count == 0 ? 0 : wk_sum / wk_count);
-            }
-
-            for(int k = real_width_; k < padded_width_; k++)
-                *frame_data_out++ = 0;
-
-            block_start += width_in * scale;
-        }
-    }
-    memset(frame_data_out, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint16_t));
-}
-
-void DecimationFilter::decimateOthers(OBFormat format, void *frame_data_in, void *frame_data_out, size_t width_in, size_t scale) {
-
-    auto patch_size = scale * scale;
-
-    int wk_sum = 0;
-    // int wk_count = 0;
-
-    switch(format) {
-    case OB_FORMAT_YUYV: {
-        uint8_t *from = (uint8_t *)frame_data_in;
-        uint8_t *p    = nullptr;
-        uint8_t *q    = (uint8_t *)frame_data_out;
-
-        auto w_2  = width_in >> 1;
-        auto rw_2 = real_width_ >> 1;
-        auto pw_2 = padded_width_ >> 1;
-        auto s2   = scale >> 1;
-        bool odd  = (scale & 1);
-        for(int j = 0; j < real_height_; ++j) {
-            for(int i = 0; i < rw_2; ++i) {
-                p      = from + scale * (j * w_2 + i) * 4;
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < scale; ++m)
-                        wk_sum += p[m * 2];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-
-                p      = from + scale * (j * w_2 + i) * 4 + 1;
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < s2; ++m)
-                        wk_sum += 2 * p[m * 4];
-
-                    if(odd)
-                        wk_sum += p[s2 * 4];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-
-                p      = from + scale * (j * w_2 + i) * 4 + s2 * 4 + (odd ? 2 : 0);
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < scale; ++m)
-                        wk_sum += p[m * 2];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-
-                p      = from + scale * (j * w_2 + i) * 4 + 3;
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < s2; ++m)
-                        wk_sum += 2 * p[m * 4];
-
-                    if(odd)
-                        wk_sum += p[s2 * 4];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-            }
-
-            for(int i = rw_2; i < pw_2; ++i) {
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-            }
-        }
-
-        memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 2);
-    } break;
-
-    case OB_FORMAT_UYVY: {
-        uint8_t *from = (uint8_t *)frame_data_in;
-        uint8_t *p    = nullptr;
-        uint8_t *q    = (uint8_t *)frame_data_out;
-
-        auto w_2  = width_in >> 1;
-        auto rw_2 = real_width_ >> 1;
-        auto pw_2 = padded_width_ >> 1;
-        auto s2   = scale >> 1;
-        bool odd  = (scale & 1);
-        for(int j = 0; j < real_height_; ++j) {
-            for(int i = 0; i < rw_2; ++i) {
-                p      = from + scale * (j * w_2 + i) * 4;
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < s2; ++m)
-                        wk_sum += 2 * p[m * 4];
-
-                    if(odd)
-                        wk_sum += p[s2 * 4];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-
-                p      = from + scale * (j * w_2 + i) * 4 + 1;
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < scale; ++m)
-                        wk_sum += p[m * 2];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-
-                p      = from + scale * (j * w_2 + i) * 4 + 2;
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < s2; ++m)
-                        wk_sum += 2 * p[m * 4];
-
-                    if(odd)
-                        wk_sum += p[s2 * 4];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-
-                p      = from + scale * (j * w_2 + i) * 4 + s2 * 4 + (odd ? 3 : 1);
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < scale; ++m)
-                        wk_sum += p[m * 2];
-
-                    p += w_2 * 4;
-                }
-                *q++ = (uint8_t)(wk_sum / patch_size);
-            }
-
-            for(int i = rw_2; i < pw_2; ++i) {
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-            }
-        }
-
-        memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 2);
-    } break;
-
-    case OB_FORMAT_RGB:
-    case OB_FORMAT_BGR: {
-        uint8_t *from = (uint8_t *)frame_data_in;
-        uint8_t *p    = nullptr;
-        uint8_t *q    = (uint8_t *)frame_data_out;
-        ;
-
-        for(int j = 0; j < real_height_; ++j) {
-            for(int i = 0; i < real_width_; ++i) {
-                for(int k = 0; k < 3; ++k) {
-                    p      = from + scale * (j * width_in + i) * 3 + k;
-                    wk_sum = 0;
-                    for(size_t n = 0; n < scale; ++n) {
-                        for(size_t m = 0; m < scale; ++m)
-                            wk_sum += p[m * 3];
-
-                        p += width_in * 3;
-                    }
-
-                    *q++ = (uint8_t)(wk_sum / patch_size);
-                }
-            }
-
-            for(int i = real_width_; i < padded_width_; ++i) {
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-            }
-        }
-
-        memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 3);
-    } break;
-
-    case OB_FORMAT_RGBA:
-    case OB_FORMAT_BGRA: {
-        uint8_t *from = (uint8_t *)frame_data_in;
-        uint8_t *p    = nullptr;
-        uint8_t *q    = (uint8_t *)frame_data_out;
-
-        for(int j = 0; j < real_height_; ++j) {
-            for(int i = 0; i < real_width_; ++i) {
-                for(int k = 0; k < 4; ++k) {
-                    p      = from + scale * (j * width_in + i) * 4 + k;
-                    wk_sum = 0;
-                    for(size_t n = 0; n < scale; ++n) {
-                        for(size_t m = 0; m < scale; ++m)
-                            wk_sum += p[m * 4];
-
-                        p += width_in * 4;
-                    }
-
-                    *q++ = (uint8_t)(wk_sum / patch_size);
-                }
-            }
-
-            for(int i = real_width_; i < padded_width_; ++i) {
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-                *q++ = 0;
-            }
-        }
-
-        memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 4);
-
-    } break;
-
-    case OB_FORMAT_Y8: {
-        uint8_t *from = (uint8_t *)frame_data_in;
-        uint8_t *p    = nullptr;
-        uint8_t *q    = (uint8_t *)frame_data_out;
-
-        for(int j = 0; j < real_height_; ++j) {
-            for(int i = 0; i < real_width_; ++i) {
-                p      = from + scale * (j * width_in + i);
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < scale; ++m) {
-                        wk_sum += p[m];
-                    }
-
-                    p += width_in;
-                }
-
-                *q++ = (uint8_t)(wk_sum / patch_size);
-            }
-
-            for(int i = real_width_; i < padded_width_; ++i)
-                *q++ = 0;
-        }
-
-        memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t));
-
-    } break;
-
-    case OB_FORMAT_Y16: {
-        uint16_t *from = (uint16_t *)frame_data_in;
-        uint16_t *p    = nullptr;
-        uint16_t *q    = (uint16_t *)frame_data_out;
-
-        for(int j = 0; j < real_height_; ++j) {
-            for(int i = 0; i < real_width_; ++i) {
-                p      = from + scale * (j * width_in + i);
-                wk_sum = 0;
-                for(size_t n = 0; n < scale; ++n) {
-                    for(size_t m = 0; m < scale; ++m) {
-                        wk_sum += p[m];
-                    }
-                    p += width_in;
-                }
-
-                *q++ = (uint16_t)(wk_sum / patch_size);
-            }
-
-            for(int i = real_width_; i < padded_width_; ++i)
-                *q++ = 0;
-        }
-
-        memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint16_t));
-
-    } break;
-
-    default:
-        break;
-    }
-}
-
 }  // namespace libobsensor
@@ -1,6 +1,7 @@
 #pragma once
 #include "IFilter.hpp"
 #include "stream/StreamProfile.hpp"
+#include "DecimationImpl.hpp"
 #include <mutex>
 #include <map>
 #include <tuple>
@@ -21,8 +22,6 @@ private:
 
     bool isFrameFormatTypeSupported(OBFormat type);
     void updateOutputProfile(const std::shared_ptr<const Frame> frame);
-    void decimateDepth(uint16_t *frame_data_in, uint16_t *frame_data_out, size_t width_in, size_t scale);
-    void decimateOthers(OBFormat format, void *frame_data_in, void *frame_data_out, size_t width_in, size_t scale);
 
 protected:
     std::map<std::tuple<const VideoStreamProfile *, uint8_t>, std::shared_ptr<VideoStreamProfile>> registered_profiles_;
@@ -39,6 +38,8 @@ protected:
     uint16_t padded_height_;
     bool     recalc_profile_;
     bool     options_changed_;  // Tracking changes imposed by user
+
+    std::shared_ptr<DecimationImpl> impl_;
 };
 
 }  // namespace libobsensor
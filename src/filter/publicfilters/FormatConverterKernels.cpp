@@ -0,0 +1,149 @@
+#include "FormatConverterKernels.hpp"
+
+#include <libyuv.h>
+#include <vector>
+
+#if(defined(__ARM_NEON__) || defined(__aarch64__) || defined(__arm__))
+#include "SSE2NEON.h"
+#define KERNELS_SSE2_CPU_FLAG libyuv::kCpuHasNEON
+#else
+#include <emmintrin.h>
+#define KERNELS_SSE2_CPU_FLAG libyuv::kCpuHasSSE2
+#endif
+
+#if defined(__SSE2__) || defined(__NEON__)
+#define KERNELS_HAS_SSE2
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KERNELS_HAS_AVX2 1
+#endif
+
+namespace libobsensor {
+namespace kernels {
+
+// Packed 4:2:2 to RGB is done by pairs of rows through two rows of I420, which stay in L1 cache. As the full frame I420 of the FormatConverter
+// before, each pair of rows takes the average of their chroma.
+typedef int (*PackedToI420Func)(const uint8_t *, int, uint8_t *, int, uint8_t *, int, uint8_t *, int, int, int);
+typedef int (*I420ToDstFunc)(const uint8_t *, int, const uint8_t *, int, const uint8_t *, int, uint8_t *, int, int, int);
+
+static void packedToRgbByRowPair(PackedToI420Func toI420, I420ToDstFunc i420ToDst, uint32_t dstPixelSize, const uint8_t *src, uint8_t *dst,
+                                 uint32_t width, uint32_t height) {
+    const uint32_t       chromaWidth = (width + 1) / 2;
+    std::vector<uint8_t> i420(width * 2 + chromaWidth * 2);
+    uint8_t             *yData = i420.data();
+    uint8_t             *uData = yData + width * 2;
+    uint8_t             *vData = uData + chromaWidth;
+    for(uint32_t row = 0; row < height; row += 2) {
+        int rows = height - row >= 2 ? 2 : 1;
+        toI420(src + row * width * 2, width * 2, yData, width, uData, chromaWidth, vData, chromaWidth, width, rows);
+        i420ToDst(yData, width, uData, chromaWidth, vData, chromaWidth, dst + row * width * dstPixelSize, width * dstPixelSize, width, rows);
+    }
+}
+
+void yuyvToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    packedToRgbByRowPair(libyuv::YUY2ToI420, libyuv::I420ToRAW, 3, src, dst, width, height);
+}
+
+void yuyvToBgr(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    packedToRgbByRowPair(libyuv::YUY2ToI420, libyuv::I420ToRGB24, 3, src, dst, width, height);
+}
+
+void yuyvToRgba(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    packedToRgbByRowPair(libyuv::YUY2ToI420, libyuv::I420ToABGR, 4, src, dst, width, height);
+}
+
+void yuyvToBgra(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    packedToRgbByRowPair(libyuv::YUY2ToI420, libyuv::I420ToARGB, 4, src, dst, width, height);
+}
+
+void uyvyToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    packedToRgbByRowPair(libyuv::UYVYToI420, libyuv::I420ToRAW, 3, src, dst, width, height);
+}
+
+void yuyvToY8(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    libyuv::YUY2ToY(src, width * 2, dst, width, width, height);
+}
+
+static void yuyvToY16C(const uint8_t *src, uint8_t *dst, size_t pixelCount) {
+    for(size_t i = 0; i < pixelCount; i++) {
+        dst[i * 2]     = 0;
+        dst[i * 2 + 1] = src[i * 2];
+    }
+}
+
+#ifdef KERNELS_HAS_SSE2
+// Each 16-bit YUYV lane is Y | (U or V) << 8, shifting it left by 8 gives Y << 8
+static void yuyvToY16SSE2(const uint8_t *src, uint8_t *dst, size_t pixelCount) {
+    size_t i = 0;
+    for(; i + 16 <= pixelCount; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2 + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), _mm_slli_epi16(a, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 16), _mm_slli_epi16(b, 8));
+    }
+    yuyvToY16C(src + i * 2, dst + i * 2, pixelCount - i);
+}
+#endif
+
+#ifdef KERNELS_HAS_AVX2
+__attribute__((target("avx2"))) static void yuyvToY16AVX2(const uint8_t *src, uint8_t *dst, size_t pixelCount) {
+    size_t i = 0;
+    for(; i + 32 <= pixelCount; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 2));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 2 + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2), _mm256_slli_epi16(a, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2 + 32), _mm256_slli_epi16(b, 8));
+    }
+    yuyvToY16C(src + i * 2, dst + i * 2, pixelCount - i);
+}
+#endif
+
+void yuyvToY16(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    size_t pixelCount = static_cast<size_t>(width) * height;
+#ifdef KERNELS_HAS_AVX2
+    if(libyuv::TestCpuFlag(libyuv::kCpuHasAVX2)) {
+        yuyvToY16AVX2(src, dst, pixelCount);
+        return;
+    }
+#endif
+#ifdef KERNELS_HAS_SSE2
+    if(libyuv::TestCpuFlag(KERNELS_SSE2_CPU_FLAG)) {
+        yuyvToY16SSE2(src, dst, pixelCount);
+        return;
+    }
+#endif
+    yuyvToY16C(src, dst, pixelCount);
+}
+
+void i420ToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    const uint8_t *yData = src;
+    const uint8_t *uData = src + width * height;
+    const uint8_t *vData = src + width * height * 5 / 4;
+    libyuv::I420ToRAW(yData, width, uData, width / 2, vData, width / 2, dst, width * 3, width, height);
+}
+
+void nv12ToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    const uint8_t *yData  = src;
+    const uint8_t *uvData = src + width * height;
+    libyuv::NV12ToRAW(yData, width, uvData, width, dst, width * 3, width, height);
+}
+
+void nv21ToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height) {
+    const uint8_t *yData  = src;
+    const uint8_t *vuData = src + width * height;
+    libyuv::NV21ToRAW(yData, width, vuData, width, dst, width * 3, width, height);
+}
+
+void swapRB(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height, uint32_t pixelSize) {
+    if(pixelSize == 4) {
+        libyuv::ARGBToABGR(src, width * 4, dst, width * 4, width, height);
+    }
+    else {
+        libyuv::RAWToRGB24(src, width * 3, dst, width * 3, width, height);
+    }
+}
+
+}  // namespace kernels
+}  // namespace libobsensor
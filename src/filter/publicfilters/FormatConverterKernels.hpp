@@ -0,0 +1,29 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2020 Orbbec Corporation. All Rights Reserved.
+
+#pragma once
+#include <cstdint>
+
+namespace libobsensor {
+
+// Pixel conversion kernels of the FormatConverter.
+// The YUV to RGB kernels use libyuv row functions, the others have their own SSE2/AVX2 implementations (NEON through SSE2NEON.h on ARM). The
+// implementation is selected at runtime according to the CPU flags detected by libyuv, so libyuv::MaskCpuFlags(1) forces the scalar C path
+// of all kernels, which is the reference the SIMD paths must be bit-exact with.
+// Output format names follow the memory byte order, e.g. RGB is R,G,B.
+namespace kernels {
+
+void yuyvToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void yuyvToBgr(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void yuyvToRgba(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void yuyvToBgra(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void yuyvToY8(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void yuyvToY16(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);  // Y in the high byte, low byte is zero
+void uyvyToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void i420ToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void nv12ToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void nv21ToRgb(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height);
+void swapRB(const uint8_t *src, uint8_t *dst, uint32_t width, uint32_t height, uint32_t pixelSize = 3);  // RGB <-> BGR, or RGBA <-> BGRA
+
+}  // namespace kernels
+}  // namespace libobsensor
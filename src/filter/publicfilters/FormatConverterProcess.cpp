@@ -1,4 +1,5 @@
 #include "FormatConverterProcess.hpp"
+#include "FormatConverterKernels.hpp"
 #include "exception/ObException.hpp"
 #include "logger/LoggerInterval.hpp"
 #include "frame/FrameFactory.hpp"
@@ -11,7 +12,12 @@
 namespace libobsensor {
 
 FormatConverter::FormatConverter() {}
-FormatConverter::~FormatConverter() noexcept {}
+FormatConverter::~FormatConverter() noexcept {
+    if(tjHandle_) {
+        tjDestroy(tjHandle_);
+        tjHandle_ = nullptr;
+    }
+}
 
 void FormatConverter::updateConfig(std::vector<std::string> &params) {
     if(params.size() != 1) {
@@ -111,43 +117,43 @@ std::shared_ptr<Frame> FormatConverter::process(std::shared_ptr<const Frame> fra
     tarFrame->copyInfoFromOther(frame);
     switch(convertType_) {
     case FORMAT_YUYV_TO_RGB:
-        yuyvToRgb((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::yuyvToRgb((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGB);
         break;
     case FORMAT_YUYV_TO_RGBA:
-        yuyvToRgba((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::yuyvToRgba((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGBA);
         break;
     case FORMAT_YUYV_TO_BGR:
-        yuyvToBgr((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
-        tarStreamProfile_->setFormat(OB_FORMAT_RGB);
+        kernels::yuyvToBgr((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        tarStreamProfile_->setFormat(OB_FORMAT_BGR);
         break;
     case FORMAT_YUYV_TO_BGRA:
-        yuyvToBgra((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::yuyvToBgra((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_BGRA);
         break;
     case FORMAT_YUYV_TO_Y16:
-        yuyvToy16((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::yuyvToY16((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_Y16);
         break;
     case FORMAT_YUYV_TO_Y8:
-        yuyvToy8((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::yuyvToY8((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_Y8);
         break;
     case FORMAT_UYVY_TO_RGB:
-        uyvyToRgb((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::uyvyToRgb((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGB);
         break;
     case FORMAT_I420_TO_RGB:
-        i420ToRgb((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::i420ToRgb((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGB);
         break;
     case FORMAT_NV21_TO_RGB:
-        nv21ToRgb((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::nv21ToRgb((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGB);
         break;
     case FORMAT_NV12_TO_RGB:
-        nv12ToRgb((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::nv12ToRgb((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGB);
         break;
     case FORMAT_MJPG_TO_I420:
@@ -155,11 +161,11 @@ std::shared_ptr<Frame> FormatConverter::process(std::shared_ptr<const Frame> fra
         tarStreamProfile_->setFormat(OB_FORMAT_I420);
         break;
     case FORMAT_RGB_TO_BGR:
-        exchangeRAndB((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::swapRB((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_BGR);
         break;
     case FORMAT_BGR_TO_RGB:
-        exchangeRAndB((uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
+        kernels::swapRB((const uint8_t *)frame->getData(), (uint8_t *)tarFrame->getData(), w, h);
         tarStreamProfile_->setFormat(OB_FORMAT_RGB);
         break;
     case FORMAT_MJPG_TO_NV21:
@@ -192,137 +198,77 @@ std::shared_ptr<Frame> FormatConverter::process(std::shared_ptr<const Frame> fra
     return tarFrame;
 }
 
-void FormatConverter::yuyvToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    const auto preferSize = width * height * 3 / 2;
-    if(tempDataBuf_ == nullptr || preferSize != tempDataBufSize_) {
-        if(nullptr != tempDataBuf_) {
-            delete[] tempDataBuf_;
+void *FormatConverter::getDecompressHandle() {
+    if(!tjHandle_) {
+        tjHandle_ = tjInitDecompress();
+        if(!tjHandle_) {
+            LOG_ERROR_INTVL("Failed to create mjpeg decompressor! {}", tjGetErrorStr2(nullptr));
         }
-        tempDataBuf_     = new uint8_t[preferSize];
-        tempDataBufSize_ = preferSize;
     }
-    uint8_t *yData = tempDataBuf_;
-    uint8_t *uData = tempDataBuf_ + width * height;
-    uint8_t *vData = tempDataBuf_ + width * height * 5 / 4;
-    libyuv::YUY2ToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
-    libyuv::I420ToRAW(yData, width, uData, width / 2, vData, width / 2, target, width * 3, width, height);
+    return tjHandle_;
 }
 
-void FormatConverter::yuyvToRgba(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    const auto preferSize = width * height * 4;
-    if(tempDataBuf_ == nullptr || preferSize != tempDataBufSize_) {
-        if(nullptr != tempDataBuf_) {
-            delete[] tempDataBuf_;
-        }
-        tempDataBuf_     = new uint8_t[preferSize];
-        tempDataBufSize_ = preferSize;
+// Decode the mjpeg frame to the planar/semi-planar 4:2:0 target buffer without going through an intermediate image.
+// Returns false if the frame can not be decoded this way (not 4:2:0 or 4:2:2 subsampled, odd or unexpected size), the caller falls back to libyuv then.
+bool FormatConverter::mjpgToYuvPlanes(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height, OBFormat dstFormat) {
+    auto handle = getDecompressHandle();
+    if(!handle) {
+        return false;
     }
-    uint8_t *yData = tempDataBuf_;
-    uint8_t *uData = tempDataBuf_ + width * height;
-    uint8_t *vData = tempDataBuf_ + width * height * 5 / 4;
-    libyuv::YUY2ToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
-    libyuv::I420ToABGR(yData, width, uData, width / 2, vData, width / 2, target, width * 4, width, height);
-}
 
-void FormatConverter::yuyvToBgr(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    const auto preferSize = width * height * 3 / 2;
-    if(tempDataBuf_ == nullptr || preferSize != tempDataBufSize_) {
-        if(nullptr != tempDataBuf_) {
-            delete[] tempDataBuf_;
-        }
-        tempDataBuf_     = new uint8_t[preferSize];
-        tempDataBufSize_ = preferSize;
+    int jpegWidth = 0, jpegHeight = 0, jpegSubsamp = 0, jpegColorspace = 0;
+    if(tjDecompressHeader3(handle, src, src_len, &jpegWidth, &jpegHeight, &jpegSubsamp, &jpegColorspace) != 0) {
+        return false;
+    }
+    if(static_cast<uint32_t>(jpegWidth) != width || static_cast<uint32_t>(jpegHeight) != height || (width & 1) || (height & 1)
+       || (jpegSubsamp != TJSAMP_420 && jpegSubsamp != TJSAMP_422)) {
+        return false;
     }
-    uint8_t *yData = tempDataBuf_;
-    uint8_t *uData = tempDataBuf_ + width * height;
-    uint8_t *vData = tempDataBuf_ + width * height * 5 / 4;
-    libyuv::YUY2ToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
-    libyuv::I420ToRGB24(yData, width, uData, width / 2, vData, width / 2, target, width * 3, width, height);
-}
 
-void FormatConverter::yuyvToBgra(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    const auto preferSize = width * height * 4;
-    if(tempDataBuf_ == nullptr || preferSize != tempDataBufSize_) {
-        if(nullptr != tempDataBuf_) {
-            delete[] tempDataBuf_;
+    const uint32_t chromaWidth     = width / 2;
+    const uint32_t chromaHeight    = jpegSubsamp == TJSAMP_420 ? height / 2 : height;
+    const uint32_t dstChromaSize   = chromaWidth * (height / 2);
+    uint8_t       *dstY            = target;
+    uint8_t       *dstU            = target + width * height;
+    uint8_t       *dstV            = dstU + dstChromaSize;
+    bool           decodeToDstUV   = dstFormat == OB_FORMAT_I420 && jpegSubsamp == TJSAMP_420;
+    bool           needChromaScale = jpegSubsamp == TJSAMP_422;
+
+    uint8_t *planes[3]  = { dstY, dstU, dstV };
+    int      strides[3] = { static_cast<int>(width), static_cast<int>(chromaWidth), static_cast<int>(chromaWidth) };
+    if(!decodeToDstUV) {
+        // decoded U/V planes, followed by the 4:2:0 U/V planes if they need to be downscaled from 4:2:2 before interleaving
+        size_t bufSize = 2 * chromaWidth * chromaHeight + (needChromaScale && dstFormat != OB_FORMAT_I420 ? 2 * dstChromaSize : 0);
+        if(chromaPlaneBuf_.size() < bufSize) {
+            chromaPlaneBuf_.resize(bufSize);
         }
-        tempDataBuf_     = new uint8_t[preferSize];
-        tempDataBufSize_ = preferSize;
+        planes[1] = chromaPlaneBuf_.data();
+        planes[2] = planes[1] + chromaWidth * chromaHeight;
     }
-    uint8_t *yData = tempDataBuf_;
-    uint8_t *uData = tempDataBuf_ + width * height;
-    uint8_t *vData = tempDataBuf_ + width * height * 5 / 4;
-    libyuv::YUY2ToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
-    libyuv::I420ToARGB(yData, width, uData, width / 2, vData, width / 2, target, width * 4, width, height);
-}
 
-void FormatConverter::yuyvToy16(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    auto size = width * height;
-    for(uint32_t i = 0; i < size; i += 16) {
-        uint8_t tarArray[32] = {
-            0, src[i * 2],      0, src[i * 2 + 2],  0, src[i * 2 + 4],  0, src[i * 2 + 6],  0, src[i * 2 + 8],  0, src[i * 2 + 10],
-            0, src[i * 2 + 12], 0, src[i * 2 + 14], 0, src[i * 2 + 16], 0, src[i * 2 + 18], 0, src[i * 2 + 20], 0, src[i * 2 + 22],
-            0, src[i * 2 + 24], 0, src[i * 2 + 26], 0, src[i * 2 + 28], 0, src[i * 2 + 30],
-        };
-        memcpy(target + i * 2, tarArray, 32);
+    if(tjDecompressToYUVPlanes(handle, src, src_len, planes, width, strides, height, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0) {
+        LOG_WARN_INTVL("Failed to decode mjpeg frame to yuv planes! {}", tjGetErrorStr2(handle));
+        return false;
     }
-}
 
-void FormatConverter::yuyvToy8(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    auto size = width * height;
-    for(uint32_t i = 0; i < size; i += 16) {
-        target[i]      = src[i * 2];
-        target[i + 1]  = src[i * 2 + 2];
-        target[i + 2]  = src[i * 2 + 4];
-        target[i + 3]  = src[i * 2 + 6];
-        target[i + 4]  = src[i * 2 + 8];
-        target[i + 5]  = src[i * 2 + 10];
-        target[i + 6]  = src[i * 2 + 12];
-        target[i + 7]  = src[i * 2 + 14];
-        target[i + 8]  = src[i * 2 + 16];
-        target[i + 9]  = src[i * 2 + 18];
-        target[i + 10] = src[i * 2 + 20];
-        target[i + 11] = src[i * 2 + 22];
-        target[i + 12] = src[i * 2 + 24];
-        target[i + 13] = src[i * 2 + 26];
-        target[i + 14] = src[i * 2 + 28];
-        target[i + 15] = src[i * 2 + 30];
+    uint8_t *srcU = planes[1];
+    uint8_t *srcV = planes[2];
+    if(needChromaScale) {
+        // Y plane is already in place, only the chroma planes are downscaled
+        uint8_t *scaledU = dstFormat == OB_FORMAT_I420 ? dstU : planes[2] + chromaWidth * chromaHeight;
+        uint8_t *scaledV = scaledU + dstChromaSize;
+        libyuv::I422ToI420(dstY, width, srcU, chromaWidth, srcV, chromaWidth, nullptr, 0, scaledU, chromaWidth, scaledV, chromaWidth, width, height);
+        srcU = scaledU;
+        srcV = scaledV;
     }
-}
 
-void FormatConverter::uyvyToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    const auto preferSize = width * height * 3 / 2;
-    if(tempDataBuf_ == nullptr || preferSize != tempDataBufSize_) {
-        if(nullptr != tempDataBuf_) {
-            delete[] tempDataBuf_;
-        }
-        tempDataBuf_     = new uint8_t[preferSize];
-        tempDataBufSize_ = preferSize;
+    if(dstFormat == OB_FORMAT_NV12) {
+        libyuv::MergeUVPlane(srcU, chromaWidth, srcV, chromaWidth, dstU, width, chromaWidth, height / 2);
     }
-    uint8_t *yData = tempDataBuf_;
-    uint8_t *uData = tempDataBuf_ + width * height;
-    uint8_t *vData = tempDataBuf_ + width * height * 5 / 4;
-    libyuv::UYVYToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
-    libyuv::I420ToRAW(yData, width, uData, width / 2, vData, width / 2, target, width * 3, width, height);
-}
-
-void FormatConverter::i420ToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    uint8_t *yData = src;
-    uint8_t *uData = src + width * height;
-    uint8_t *vData = src + width * height * 5 / 4;
-    libyuv::I420ToRAW(yData, width, uData, width / 2, vData, width / 2, target, width * 3, width, height);
-}
-
-void FormatConverter::nv21ToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    uint8_t *yData  = src;
-    uint8_t *vuData = src + width * height;
-    libyuv::NV21ToRAW(yData, width, vuData, width, target, width * 3, width, height);
-}
-
-void FormatConverter::nv12ToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
-    uint8_t *yData  = src;
-    uint8_t *vuData = src + width * height;
-    libyuv::NV12ToRAW(yData, width, vuData, width, target, width * 3, width, height);
+    else if(dstFormat == OB_FORMAT_NV21) {
+        libyuv::MergeUVPlane(srcV, chromaWidth, srcU, chromaWidth, dstU, width, chromaWidth, height / 2);
+    }
+    return true;
 }
 
 void FormatConverter::mjpgToI420(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
@@ -330,6 +276,9 @@ void FormatConverter::mjpgToI420(uint8_t *src, uint32_t src_len, uint8_t *target
         LOG_ERROR_INTVL("FormatConverter mjpegFrame is null or dstFrame is null");
         return;
     }
+    if(mjpgToYuvPlanes(src, src_len, target, width, height, OB_FORMAT_I420)) {
+        return;
+    }
 
     uint8_t *yData = target;
     uint8_t *uData = target + width * height;
@@ -342,6 +291,10 @@ void FormatConverter::mjpgToI420(uint8_t *src, uint32_t src_len, uint8_t *target
 }
 
 void FormatConverter::mjpgToNv21(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
+    if(mjpgToYuvPlanes(src, src_len, target, width, height, OB_FORMAT_NV21)) {
+        return;
+    }
+
     int ret;
 
     uint8_t *yData  = target;
@@ -354,6 +307,10 @@ void FormatConverter::mjpgToNv21(uint8_t *src, uint32_t src_len, uint8_t *target
 }
 
 void FormatConverter::mjpgToNv12(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
+    if(mjpgToYuvPlanes(src, src_len, target, width, height, OB_FORMAT_NV12)) {
+        return;
+    }
+
     int ret;
 
     uint8_t *yData  = target;
@@ -365,60 +322,31 @@ void FormatConverter::mjpgToNv12(uint8_t *src, uint32_t src_len, uint8_t *target
     }
 }
 
-bool FormatConverter::mjpgToRgb(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
-    tjhandle tjHandle;
-    tjHandle = tjInitDecompress();
-    if(tjDecompress2(tjHandle, src, src_len, target, width,
-                     0,  // pitch
-                     height, TJPF_RGB, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE)
-       != 0) {
-        LOG_WARN_INTVL("Failed to decode mjpeg frame to rgb! {}", tjGetErrorStr2(tjHandle));
-        tjDestroy(tjHandle);
+bool FormatConverter::mjpgDecompress(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height, int pixelFormat) {
+    auto handle = getDecompressHandle();
+    if(!handle) {
         return false;
     }
-    tjDestroy(tjHandle);
-    return true;
-}
-
-bool FormatConverter::mjpgToBgr(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
-    tjhandle tjHandle;
-    tjHandle = tjInitDecompress();
-    if(tjDecompress2(tjHandle, src, src_len, target, width,
+    if(tjDecompress2(handle, src, src_len, target, width,
                      0,  // pitch
-                     height, TJPF_BGR, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE)
+                     height, pixelFormat, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE)
        != 0) {
-        LOG_WARN_INTVL("Failed to decode mjpeg frame to bgr! {}", tjGetErrorStr2(tjHandle));
-        tjDestroy(tjHandle);
+        LOG_WARN_INTVL("Failed to decode mjpeg frame! pixel format={}, {}", pixelFormat, tjGetErrorStr2(handle));
         return false;
     }
-    tjDestroy(tjHandle);
     return true;
 }
 
-void FormatConverter::exchangeRAndB(uint8_t *pucRgb, uint8_t *target, uint32_t width, uint32_t height, uint32_t pixelSize) {
-    if(pucRgb == nullptr || target == nullptr) {
-        return;
-    }
-    for(uint32_t i = 0; i < height; i++) {
-        for(uint32_t j = 0; j < width; j++) {
-            uint8_t tmp1                                      = pucRgb[i * width * pixelSize + j * pixelSize];
-            target[i * width * pixelSize + j * pixelSize]     = pucRgb[i * width * pixelSize + j * pixelSize + 2];
-            target[i * width * pixelSize + j * pixelSize + 1] = pucRgb[i * width * pixelSize + j * pixelSize + 1];
-            target[i * width * pixelSize + j * pixelSize + 2] = tmp1;
-        }
-    }
+bool FormatConverter::mjpgToRgb(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
+    return mjpgDecompress(src, src_len, target, width, height, TJPF_RGB);
+}
+
+bool FormatConverter::mjpgToBgr(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
+    return mjpgDecompress(src, src_len, target, width, height, TJPF_BGR);
 }
 
 void FormatConverter::mjpegToBgra(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height) {
-    tjhandle tjHandle;
-    tjHandle = tjInitDecompress();
-    if(tjDecompress2(tjHandle, src, src_len, target, width,
-                     0,  // pitch
-                     height, TJPF_BGRA, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE)
-       != 0) {
-        LOG_WARN_INTVL("Failed to decompress color frame");
-    }
-    tjDestroy(tjHandle);
+    mjpgDecompress(src, src_len, target, width, height, TJPF_BGRA);
 }
 
 }  // namespace libobsensor
@@ -1,6 +1,7 @@
 #pragma once
 #include "IFilter.hpp"
 #include <mutex>
+#include <vector>
 
 namespace libobsensor {
 
@@ -17,30 +18,25 @@ public:
     void setConversion(OBFormat srcFormat, OBFormat dstFormat);
 
 private:
-    void yuyvToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void yuyvToRgba(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void yuyvToBgr(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void yuyvToBgra(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void yuyvToy16(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void yuyvToy8(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void uyvyToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void i420ToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void nv21ToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
-    void nv12ToRgb(uint8_t *src, uint8_t *target, uint32_t width, uint32_t height);
     void mjpgToI420(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height);
     void mjpgToNv21(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height);
     bool mjpgToRgb(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height);
     bool mjpgToBgr(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height);
-    void exchangeRAndB(uint8_t *pucRgb, uint8_t *target, uint32_t width, uint32_t height, uint32_t pixelSize = 3);
     void mjpegToBgra(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height);
     void mjpgToNv12(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height);
+    bool mjpgToYuvPlanes(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height, OBFormat dstFormat);
+    bool mjpgDecompress(uint8_t *src, uint32_t src_len, uint8_t *target, uint32_t width, uint32_t height, int pixelFormat);
+    void *getDecompressHandle();
 
 protected:
     std::shared_ptr<const StreamProfile> currentStreamProfile_;
     std::shared_ptr<StreamProfile>       tarStreamProfile_;
     OBConvertFormat                      convertType_;
-    uint8_t                             *tempDataBuf_     = nullptr;
-    uint32_t                             tempDataBufSize_ = 0;
+
+    // TurboJPEG decompressor, created on first use and reused for all following frames.
+    // Like the chroma plane buffer, it is owned by this converter instance, so one instance must not be used by several threads at the same time.
+    void                *tjHandle_ = nullptr;
+    std::vector<uint8_t> chromaPlaneBuf_;  // U/V planes decoded from mjpeg, for conversions that can not decode to the target buffer directly
 };
 
 }  // namespace libobsensor
@@ -0,0 +1,130 @@
+#include "HdrMergeImpl.hpp"
+#include <algorithm>
+
+namespace libobsensor {
+
+// The fewest pixels of a band: the merge is bound by memory bandwidth, smaller bands cost more to schedule than they save
+static const size_t MIN_BAND_PIXELS = 128 * 1024;
+
+namespace {
+
+// The triangle weights of the IR values: 0 for the completely dark and over-saturated pixels, up to 255 in the middle of the range
+template <typename T> void triangleWeights(std::vector<uint8_t> &w) {
+    int length = 1 << (sizeof(T) * 8);
+    w.resize(length, 0);
+    int   half  = length >> 1;
+    float slope = 256.f / half;
+    for(int i = 0; i < half; i++) {
+        w[i]              = static_cast<uint8_t>(i * slope);
+        w[length - i - 1] = w[i];
+    }
+}
+
+template <typename T>
+void mergeUsingIrScalar(const uint8_t *weights, const uint16_t *d0, const uint16_t *d1, const T *ir0, const T *ir1, size_t count, uint16_t *out) {
+    for(size_t i = 0; i < count; i++) {
+        uint8_t c0 = weights[ir0[i]];
+        uint8_t c1 = weights[ir1[i]];
+        out[i]     = c1 > c0 ? d1[i] : (c0 ? d0[i] : 0);
+    }
+}
+
+void mergeUsingOnlyDepthScalar(const uint16_t *d0, const uint16_t *d1, size_t count, uint16_t *out) {
+    for(size_t i = 0; i < count; i++) {
+        bool take_d1 = d0[i] == 0 || (d0[i] == 65535 && d1[i] != 0);
+        out[i]       = take_d1 ? d1[i] : d0[i];
+    }
+}
+
+}  // namespace
+
+static const HdrMergeFuncs *getMergeFuncs(HdrMergeKernel kernel) {
+    typedef const HdrMergeFuncs *(*GetFuncs)();
+    static const GetFuncs kernels[SIMD_ISA_COUNT] = { nullptr, getHdrMergeFuncsSSE, SIMD_KERNEL_AVX2(getHdrMergeFuncsAVX2),
+                                                      SIMD_KERNEL_AVX512(getHdrMergeFuncsAVX512), SIMD_KERNEL_NEON(getHdrMergeFuncsNEON) };
+    GetFuncs get_funcs = getSimdKernel(kernels, kernel);
+    return get_funcs ? get_funcs() : nullptr;
+}
+
+HdrMergeImpl::HdrMergeImpl() : thread_count_(0), kernel_(HDR_MERGE_KERNEL_SCALAR), funcs_(nullptr) {
+    thread_pool_ = ThreadPool::getInstance();
+
+    setWidestSimdKernel<HdrMergeKernel>([this](HdrMergeKernel kernel) { return setKernel(kernel); });
+}
+
+bool HdrMergeImpl::isKernelAvailable(HdrMergeKernel kernel) {
+    return kernel == HDR_MERGE_KERNEL_SCALAR || getMergeFuncs(kernel) != nullptr;
+}
+
+bool HdrMergeImpl::setKernel(HdrMergeKernel kernel) {
+    if(!isKernelAvailable(kernel)) {
+        return false;
+    }
+    kernel_ = kernel;
+    funcs_  = getMergeFuncs(kernel);
+    return true;
+}
+
+const std::vector<uint8_t> &HdrMergeImpl::getWeights(OBFormat ir_format) {
+    if(ir_format == OB_FORMAT_Y8) {
+        if(y8_weights_.empty()) {
+            triangleWeights<uint8_t>(y8_weights_);
+        }
+        return y8_weights_;
+    }
+    if(y16_weights_.empty()) {
+        triangleWeights<uint16_t>(y16_weights_);
+    }
+    return y16_weights_;
+}
+
+void HdrMergeImpl::runPixelBands(size_t pixels, const std::function<void(size_t pixel_begin, size_t pixel_end)> &process_pixels) const {
+    // the bands are rows of the blocks of the kernels, so only the last one has pixels after its blocks
+    const size_t blocks = (pixels + HDR_MERGE_KERNEL_PIXELS - 1) / HDR_MERGE_KERNEL_PIXELS;
+    thread_pool_->parallelForRows(
+        blocks, thread_count_,
+        [&](size_t block_begin, size_t block_end) {
+            process_pixels(block_begin * HDR_MERGE_KERNEL_PIXELS, std::min(pixels, block_end * HDR_MERGE_KERNEL_PIXELS));
+        },
+        1, MIN_BAND_PIXELS / HDR_MERGE_KERNEL_PIXELS);
+}
+
+void HdrMergeImpl::mergeUsingIr(OBFormat ir_format, const uint16_t *d0, const uint16_t *d1, const void *ir0, const void *ir1, int width, int height,
+                                uint16_t *out) {
+    const uint8_t *weights = getWeights(ir_format).data();
+    runPixelBands(static_cast<size_t>(width) * height, [&](size_t pixel_begin, size_t pixel_end) {
+        size_t count        = pixel_end - pixel_begin;
+        size_t kernel_count = funcs_ ? count / HDR_MERGE_KERNEL_PIXELS * HDR_MERGE_KERNEL_PIXELS : 0;
+        size_t tail         = pixel_begin + kernel_count;
+        if(ir_format == OB_FORMAT_Y8) {
+            auto p0 = static_cast<const uint8_t *>(ir0);
+            auto p1 = static_cast<const uint8_t *>(ir1);
+            if(kernel_count) {
+                funcs_->merge_ir_y8(d0 + pixel_begin, d1 + pixel_begin, p0 + pixel_begin, p1 + pixel_begin, static_cast<int>(kernel_count), out + pixel_begin);
+            }
+            mergeUsingIrScalar(weights, d0 + tail, d1 + tail, p0 + tail, p1 + tail, count - kernel_count, out + tail);
+        }
+        else {
+            auto p0 = static_cast<const uint16_t *>(ir0);
+            auto p1 = static_cast<const uint16_t *>(ir1);
+            if(kernel_count) {
+                funcs_->merge_ir_y16(d0 + pixel_begin, d1 + pixel_begin, p0 + pixel_begin, p1 + pixel_begin, static_cast<int>(kernel_count), out + pixel_begin);
+            }
+            mergeUsingIrScalar(weights, d0 + tail, d1 + tail, p0 + tail, p1 + tail, count - kernel_count, out + tail);
+        }
+    });
+}
+
+void HdrMergeImpl::mergeUsingOnlyDepth(const uint16_t *d0, const uint16_t *d1, int width, int height, uint16_t *out) const {
+    runPixelBands(static_cast<size_t>(width) * height, [&](size_t pixel_begin, size_t pixel_end) {
+        size_t count        = pixel_end - pixel_begin;
+        size_t kernel_count = funcs_ ? count / HDR_MERGE_KERNEL_PIXELS * HDR_MERGE_KERNEL_PIXELS : 0;
+        size_t tail         = pixel_begin + kernel_count;
+        if(kernel_count) {
+            funcs_->merge_depth(d0 + pixel_begin, d1 + pixel_begin, static_cast<int>(kernel_count), out + pixel_begin);
+        }
+        mergeUsingOnlyDepthScalar(d0 + tail, d1 + tail, count - kernel_count, out + tail);
+    });
+}
+
+}  // namespace libobsensor
@@ -0,0 +1,76 @@
+#pragma once
+#include "libobsensor/h/ObTypes.h"
+#include "utils/ThreadPool.hpp"
+#include "HdrMergeImplKernel.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace libobsensor {
+
+/**
+ * @brief Implementation of the merge of HDRMerge: the pixels of the two depth frames are selected by the branch-free SIMD kernels, on bands of pixels
+ * in parallel for the frames large enough. The confidence weights of the IR pixels are tables of the instance, so several HDR pipelines share no state.
+ */
+class HdrMergeImpl {
+public:
+    HdrMergeImpl();
+
+    ~HdrMergeImpl() = default;
+
+    /**
+     * @brief Set the number of threads the merge runs on; the frames too small to benefit from it are merged on the calling thread
+     * @param[in] thread_count thread count, 0 for one thread per cpu core
+     */
+    void setThreadCount(int thread_count) {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * @brief Select the SIMD kernel of the merge, the best one the cpu supports by default
+     * @param[in] kernel the kernel
+     * @retval false if the kernel is not built for this architecture or not supported by the cpu
+     */
+    bool setKernel(HdrMergeKernel kernel);
+
+    HdrMergeKernel getKernel() const {
+        return kernel_;
+    }
+
+    static bool isKernelAvailable(HdrMergeKernel kernel);
+
+    /**
+     * @brief Merge two depth frames by the confidence of their IR pixels, a triangle weight of the IR value: the depth of the pixel of higher
+     * confidence, of the first frame if they are equal, 0 if neither is confident (over-saturated or completely dark)
+     * @param[in] ir_format OB_FORMAT_Y8 or OB_FORMAT_Y16
+     * @param[in] d0, d1 depth of the first and second frame
+     * @param[in] ir0, ir1 IR of the first and second frame, of the size of the depth frames
+     * @param[in] width, height size of the frames
+     * @param[out] out merged depth
+     */
+    void mergeUsingIr(OBFormat ir_format, const uint16_t *d0, const uint16_t *d1, const void *ir0, const void *ir1, int width, int height, uint16_t *out);
+
+    /**
+     * @brief Merge two depth frames without IR: the depth of the first frame, unless it is 0, or 65535 and the second frame has a depth
+     * The parameters are the ones of mergeUsingIr.
+     */
+    void mergeUsingOnlyDepth(const uint16_t *d0, const uint16_t *d1, int width, int height, uint16_t *out) const;
+
+private:
+    const std::vector<uint8_t> &getWeights(OBFormat ir_format);
+
+    void runPixelBands(size_t pixels, const std::function<void(size_t pixel_begin, size_t pixel_end)> &process_pixels) const;
+
+private:
+    std::shared_ptr<ThreadPool> thread_pool_;
+    int                         thread_count_;
+
+    HdrMergeKernel       kernel_;
+    const HdrMergeFuncs *funcs_;  // nullptr for the scalar kernel
+
+    // the confidence of each IR value, for the scalar kernel and the pixels after the SIMD kernel blocks
+    std::vector<uint8_t> y8_weights_;
+    std::vector<uint8_t> y16_weights_;
+};
+
+}  // namespace libobsensor
@@ -0,0 +1,14 @@
+#include "HdrMergeImplKernel.hpp"
+
+// Built with the AVX2 flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX2_KERNELS
+#include "SimdVectorAVX2.hpp"
+
+namespace libobsensor {
+
+const HdrMergeFuncs *getHdrMergeFuncsAVX2() {
+    return getHdrMergeFuncs<Avx2U16Vector>();
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX2_KERNELS
@@ -0,0 +1,14 @@
+#include "HdrMergeImplKernel.hpp"
+
+// Built with the AVX-512 flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX512_KERNELS
+#include "SimdVectorAVX512.hpp"
+
+namespace libobsensor {
+
+const HdrMergeFuncs *getHdrMergeFuncsAVX512() {
+    return getHdrMergeFuncs<Avx512U16Vector>();
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX512_KERNELS
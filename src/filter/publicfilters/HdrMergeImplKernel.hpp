@@ -0,0 +1,92 @@
+#pragma once
+#include "SimdKernel.hpp"
+#include <stdint.h>
+
+// The SIMD kernels of the HDR merge for HdrMergeImpl, written once for a uint16_t vector type V (SseU16Vector, ...) and built for each instruction
+// set in its own translation unit (HdrMergeImplSSE.cpp, HdrMergeImplAVX2.cpp, ...), see SimdKernel.hpp.
+
+namespace libobsensor {
+
+typedef enum {
+    HDR_MERGE_KERNEL_SCALAR = SIMD_ISA_SCALAR,
+    HDR_MERGE_KERNEL_SSE    = SIMD_ISA_SSE,
+    HDR_MERGE_KERNEL_AVX2   = SIMD_ISA_AVX2,
+    HDR_MERGE_KERNEL_AVX512 = SIMD_ISA_AVX512,
+    HDR_MERGE_KERNEL_NEON   = SIMD_ISA_NEON,
+} HdrMergeKernel;
+
+// The kernels take pixels in groups of HDR_MERGE_KERNEL_PIXELS, a multiple of the vector width of every instruction set
+#define HDR_MERGE_KERNEL_PIXELS 32
+
+/**
+ * @brief Merge count pixels (a multiple of HDR_MERGE_KERNEL_PIXELS) of two depth frames by the confidence of their IR pixels: the depth of the pixel of
+ * higher confidence, of the first frame if they are equal, 0 if neither is confident (over-saturated or completely dark)
+ * @param[in] d0, d1 depth of the first and second frame
+ * @param[in] ir0, ir1 Y8 or Y16 IR of the first and second frame
+ * @param[out] out merged depth
+ */
+typedef void (*HdrMergeIrY8Func)(const uint16_t *d0, const uint16_t *d1, const uint8_t *ir0, const uint8_t *ir1, int count, uint16_t *out);
+typedef void (*HdrMergeIrY16Func)(const uint16_t *d0, const uint16_t *d1, const uint16_t *ir0, const uint16_t *ir1, int count, uint16_t *out);
+
+/**
+ * @brief Merge count pixels (a multiple of HDR_MERGE_KERNEL_PIXELS) of two depth frames without IR: the depth of the first frame, unless it is 0, or
+ * 65535 and the second frame has a depth
+ */
+typedef void (*HdrMergeDepthFunc)(const uint16_t *d0, const uint16_t *d1, int count, uint16_t *out);
+
+struct HdrMergeFuncs {
+    HdrMergeIrY8Func  merge_ir_y8;
+    HdrMergeIrY16Func merge_ir_y16;
+    HdrMergeDepthFunc merge_depth;
+};
+
+const HdrMergeFuncs *getHdrMergeFuncsSSE();
+const HdrMergeFuncs *getHdrMergeFuncsAVX2();
+const HdrMergeFuncs *getHdrMergeFuncsAVX512();
+const HdrMergeFuncs *getHdrMergeFuncsNEON();
+
+namespace {
+
+// The confidence of the IR pixels, the triangle weights of HdrMergeImpl computed instead of looked up: 2 * min(v, 255 - v) for Y8, and
+// min(v, 65535 - v) / 128 for Y16, at most 255 either way
+template <typename V> inline typename V::U irConfidence(const uint8_t *ir) {
+    typename V::U v = V::loadWiden(ir);
+    typename V::U m = V::min(v, V::sub(V::set1(255), v));
+    return V::add(m, m);
+}
+
+template <typename V> inline typename V::U irConfidence(const uint16_t *ir) {
+    typename V::U v = V::load(ir);
+    return V::template shiftRight<7>(V::min(v, V::sub(V::set1(0xffff), v)));
+}
+
+template <typename V, typename T> void mergeUsingIrKernel(const uint16_t *d0, const uint16_t *d1, const T *ir0, const T *ir1, int count, uint16_t *out) {
+    typedef typename V::U U;
+    const U zero = V::set1(0);
+    for(int i = 0; i < count; i += V::WIDTH) {
+        U c0 = irConfidence<V>(ir0 + i);
+        U c1 = irConfidence<V>(ir1 + i);
+        U d  = V::select(V::eq(c0, zero), zero, V::load(d0 + i));
+        V::store(out + i, V::select(V::greater(c1, c0), V::load(d1 + i), d));
+    }
+}
+
+template <typename V> void mergeUsingOnlyDepthKernel(const uint16_t *d0, const uint16_t *d1, int count, uint16_t *out) {
+    typedef typename V::U U;
+    const U zero    = V::set1(0);
+    const U invalid = V::set1(0xffff);
+    for(int i = 0; i < count; i += V::WIDTH) {
+        U             a      = V::load(d0 + i);
+        U             b      = V::load(d1 + i);
+        typename V::M take_b = V::maskOr(V::eq(a, zero), V::maskAndNot(V::eq(b, zero), V::eq(a, invalid)));
+        V::store(out + i, V::select(take_b, b, a));
+    }
+}
+
+template <typename V> const HdrMergeFuncs *getHdrMergeFuncs() {
+    static const HdrMergeFuncs funcs = { mergeUsingIrKernel<V, uint8_t>, mergeUsingIrKernel<V, uint16_t>, mergeUsingOnlyDepthKernel<V> };
+    return &funcs;
+}
+
+}  // namespace
+}  // namespace libobsensor
@@ -0,0 +1,14 @@
+#include "HdrMergeImplKernel.hpp"
+
+// NEON is part of the 64-bit ARM baseline; 32-bit ARM uses the SSE kernel through SSE2NEON
+#if defined(__aarch64__)
+#include "SimdVectorNEON.hpp"
+
+namespace libobsensor {
+
+const HdrMergeFuncs *getHdrMergeFuncsNEON() {
+    return getHdrMergeFuncs<NeonU16Vector>();
+}
+
+}  // namespace libobsensor
+#endif  // __aarch64__
@@ -0,0 +1,11 @@
+#include "HdrMergeImplKernel.hpp"
+
+#include "SimdVectorSSE.hpp"
+
+namespace libobsensor {
+
+const HdrMergeFuncs *getHdrMergeFuncsSSE() {
+    return getHdrMergeFuncs<SseU16Vector>();
+}
+
+}  // namespace libobsensor
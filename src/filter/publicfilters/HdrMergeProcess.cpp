@@ -4,66 +4,10 @@
 #include "frame/FrameFactory.hpp"
 #include "libobsensor/h/ObTypes.h"
 #include "utils/PublicTypeHelper.hpp"
+#include <utility>
 
 namespace libobsensor {
 
-// avoids returning too old merged frame - frame counter jumps forward
-std::pair<OBFormat, std::vector<uint8_t>> EXP_LUT_;
-
-template <typename T> void generateConfidenceMap(const T *ir, uint8_t *map, int width, int height) {
-    const T *p_ir  = ir;
-    uint8_t *p_map = map;
-    for(int i = 0; i < height; i++) {
-        for(int j = 0; j < width; j++) {
-            *p_map++ = EXP_LUT_[*p_ir++];
-        }
-    }
-}
-
-template <typename T> void triangleWeights(std::vector<uint8_t> &w) {
-    int length = 1 << (sizeof(T) * 8);
-    w.resize(length, 0);
-    int   half  = length >> 1;
-    float slope = 256.f / half;
-    for(int i = 0; i < half; i++) {
-        w[i]              = static_cast<uint8_t>(i * slope);
-        w[length - i - 1] = w[i];
-    }
-}
-
-template <typename T> void mergeFramesUsingIr(uint16_t *new_data, uint16_t *d0, uint16_t *d1, const T *ir0, const T *ir1, int width, int height) {
-    int pix_num = width * height;
-
-    for(int i = 0; i < pix_num; i++) {
-        uint8_t c0 = EXP_LUT_.second[ir0[i]];
-        uint8_t c1 = EXP_LUT_.second[ir1[i]];
-        // new_data[i] = c0 > c1 ? d0[i] : d1[i];
-        uint8_t c = c0, idx = 0;
-        if(c1 > c0) {
-            c   = c1;
-            idx = 1;
-        }
-        if(c) {  // over-staturated or completely dark pixels
-            new_data[i] = idx ? d1[i] : d0[i];
-        }
-    }
-}
-
-void mergeFramesUsingOnlyDepth(uint16_t *new_data, uint16_t *d0, uint16_t *d1, int width, int height) {
-    for(int i = 0; i < width * height; i++) {
-        if(d0[i] && d1[i]) {
-            if(d0[i] == 65535)
-                new_data[i] = d1[i];
-            else
-                new_data[i] = d0[i];
-        }
-        else if(d0[i])
-            new_data[i] = d0[i];
-        else if(d1[i])
-            new_data[i] = d1[i];
-    }
-}
-
 std::shared_ptr<const IRFrame> getIRFrameFromFrameSet(std::shared_ptr<const Frame> frame_fs) {
     if(!frame_fs->is<FrameSet>()) {
         return nullptr;
@@ -134,17 +78,31 @@ bool checkIRAvailability(std::shared_ptr<const DepthFrame> first_depth, std::sha
     return true;
 }
 
-HDRMerge::HDRMerge() {}
+HDRMerge::HDRMerge() : impl_(std::make_shared<HdrMergeImpl>()) {}
 HDRMerge::~HDRMerge() noexcept {}
 
 void HDRMerge::updateConfig(std::vector<std::string> &params) {
-    if(params.size() != 0) {
-        throw unsupported_operation_exception("HDRMerge update config error: unsupported operation.");
+    // [threadCount]
+    if(params.size() > 1) {
+        throw invalid_value_exception("HDRMerge config error: params size not match");
+    }
+    try {
+        if(params.size() == 1) {
+            int threadCount = std::stoi(params[0]);
+            if(threadCount < 0) {
+                throw invalid_value_exception("threadCount must not be negative");
+            }
+            impl_->setThreadCount(threadCount);
+        }
+    }
+    catch(const std::exception &e) {
+        throw invalid_value_exception("HDRMerge config error: " + std::string(e.what()));
     }
 }
 
 const std::string &HDRMerge::getConfigSchema() const {
-    static const std::string schema = "";
+    // csv format: name，type， min，max，step，default，description
+    static const std::string schema = "threadCount, int, 0, 16, 1, 0, number of threads to merge high resolution frames on (0 for one per cpu core)";
     return schema;
 }
 
@@ -159,7 +117,7 @@ std::shared_ptr<Frame> HDRMerge::process(std::shared_ptr<const Frame> frame) {
 
     std::shared_ptr<const DepthFrame> depthFrame = nullptr;
     if(frame->is<FrameSet>()) {
-        depthFrame = frame->as<FrameSet>()->getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
+        depthFrame = frame->asRef<FrameSet>().getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
     }
     else {
         depthFrame = frame->as<DepthFrame>();
@@ -190,14 +148,14 @@ std::shared_ptr<Frame> HDRMerge::process(std::shared_ptr<const Frame> frame) {
             auto frame_0       = frames_[0];
             auto depth_frame_0 = frame_0;
             if(frame_0->is<FrameSet>()) {
-                depth_frame_0 = frame_0->as<FrameSet>()->getFrame(OB_FRAME_DEPTH);
+                depth_frame_0 = frame_0->asRef<FrameSet>().getFrame(OB_FRAME_DEPTH);
             }
             auto frame_0_framenumber = depth_frame_0->getMetadataValue(OB_FRAME_METADATA_TYPE_FRAME_NUMBER);
 
             auto frame_1       = frames_[1];
             auto depth_frame_1 = frame_1;
             if(depth_frame_1->is<FrameSet>()) {
-                depth_frame_1 = depth_frame_1->as<FrameSet>()->getFrame(OB_FRAME_DEPTH);
+                depth_frame_1 = depth_frame_1->asRef<FrameSet>().getFrame(OB_FRAME_DEPTH);
             }
             auto frame_1_framenumber = depth_frame_1->getMetadataValue(OB_FRAME_METADATA_TYPE_FRAME_NUMBER);
             frames_.clear();
@@ -228,7 +186,7 @@ void HDRMerge::discardDepthMergedFrameIfNeeded(std::shared_ptr<const Frame> fram
     if(depth_merged_frame_) {
         std::shared_ptr<const DepthFrame> newFrame = nullptr;
         if(frame->is<FrameSet>()) {
-            newFrame = frame->as<FrameSet>()->getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
+            newFrame = frame->asRef<FrameSet>().getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
         }
         else {
             newFrame = frame->as<DepthFrame>();
@@ -255,7 +213,7 @@ std::shared_ptr<Frame> HDRMerge::merge(std::shared_ptr<const Frame> first_fs, st
     std::shared_ptr<const IRFrame>    second_ir    = nullptr;
 
     if(first_fs->is<FrameSet>()) {
-        first_depth = first_fs->as<FrameSet>()->getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
+        first_depth = first_fs->asRef<FrameSet>().getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
     }
     else {
         first_depth = first_fs->as<DepthFrame>();
@@ -263,7 +221,7 @@ std::shared_ptr<Frame> HDRMerge::merge(std::shared_ptr<const Frame> first_fs, st
     first_ir = getIRFrameFromFrameSet(first_fs);
 
     if(second_fs->is<FrameSet>()) {
-        second_depth = second_fs->as<FrameSet>()->getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
+        second_depth = second_fs->asRef<FrameSet>().getFrame(OB_FRAME_DEPTH)->as<DepthFrame>();
     }
     else {
         second_depth = second_fs->as<DepthFrame>();
@@ -282,32 +240,17 @@ std::shared_ptr<Frame> HDRMerge::merge(std::shared_ptr<const Frame> first_fs, st
         auto d0 = (uint16_t *)first_depth->getData();
         auto d1 = (uint16_t *)second_depth->getData();
         auto d  = (uint16_t *)newFrame->getData();
-        memset(d, 0, newFrame->getDataSize());
         if(checkIRAvailability(first_depth, first_ir, second_depth, second_ir)) {
-            OBFormat ir_format = first_ir->getFormat();
-            if((EXP_LUT_.first != ir_format) || (EXP_LUT_.second.empty())) {
-                EXP_LUT_.first = ir_format;
-                if(ir_format == OB_FORMAT_Y8)
-                    triangleWeights<uint8_t>(EXP_LUT_.second);
-                else
-                    triangleWeights<uint16_t>(EXP_LUT_.second);
+            // pair each depth frame with the IR frame of its exposure
+            auto ir0 = first_ir->getData();
+            auto ir1 = second_ir->getData();
+            if(first_depth->getMetadataValue(OB_FRAME_METADATA_TYPE_EXPOSURE) != first_ir->getMetadataValue(OB_FRAME_METADATA_TYPE_EXPOSURE)) {
+                std::swap(ir0, ir1);
             }
-            if(OB_FORMAT_Y8 == ir_format) {
-                if(first_depth->getMetadataValue(OB_FRAME_METADATA_TYPE_EXPOSURE) == first_ir->getMetadataValue(OB_FRAME_METADATA_TYPE_EXPOSURE))
-                    mergeFramesUsingIr<uint8_t>(d, d0, d1, first_ir->getData(), second_ir->getData(), width, height);
-                else
-                    mergeFramesUsingIr<uint8_t>(d, d0, d1, second_ir->getData(), first_ir->getData(), width, height);
-            }
-            else {
-                if(first_depth->getMetadataValue(OB_FRAME_METADATA_TYPE_EXPOSURE) == first_ir->getMetadataValue(OB_FRAME_METADATA_TYPE_EXPOSURE))
-                    mergeFramesUsingIr<uint16_t>(d, d0, d1, (uint16_t *)first_ir->getData(), (uint16_t *)second_ir->getData(), width, height);
-                else
-                    mergeFramesUsingIr<uint16_t>(d, d0, d1, (uint16_t *)second_ir->getData(), (uint16_t *)first_ir->getData(), width, height);
-            }
-
+            impl_->mergeUsingIr(first_ir->getFormat(), d0, d1, ir0, ir1, width, height, d);
         }
         else {
-            mergeFramesUsingOnlyDepth(d, d0, d1, width, height);
+            impl_->mergeUsingOnlyDepth(d0, d1, width, height, d);
         }
         return newFrame;
     }
@@ -1,5 +1,6 @@
 #pragma once
 #include "IFilter.hpp"
+#include "HdrMergeImpl.hpp"
 #include <map>
 
 namespace libobsensor {
@@ -22,6 +23,7 @@ private:
 protected:
     std::map<uint64_t, std::shared_ptr<const Frame>> frames_;
     std::shared_ptr<Frame>                           depth_merged_frame_;
+    std::shared_ptr<HdrMergeImpl>                    impl_;
 };
 
 }  // namespace libobsensor
@@ -39,7 +39,7 @@ OBIMUCalibrateParams IMUCorrector::getDefaultImuCalibParam() {
     return params;
 }
 
-float IMUCorrector::calculateAccelGravity(int16_t accelValue, uint8_t accelFSR) {
+float IMUCorrector::calculateAccelSensitivity(uint8_t accelFSR) {
     float sensitivity = 0.f;
 
     switch(accelFSR) {
@@ -57,10 +57,10 @@ float IMUCorrector::calculateAccelGravity(int16_t accelValue, uint8_t accelFSR)
         break;
     }
 
-    return (accelValue / sensitivity);
+    return sensitivity;
 }
 
-float IMUCorrector::calculateGyroDPS(int16_t gyroValue, uint8_t gyroFSR) {
+float IMUCorrector::calculateGyroSensitivity(uint8_t gyroFSR) {
     float sensitivity = 0.f;
 
     switch(gyroFSR) {
@@ -90,7 +90,15 @@ float IMUCorrector::calculateGyroDPS(int16_t gyroValue, uint8_t gyroFSR) {
         break;
     }
 
-    return (gyroValue / sensitivity);
+    return sensitivity;
+}
+
+float IMUCorrector::calculateAccelGravity(int16_t accelValue, uint8_t accelFSR) {
+    return (accelValue / calculateAccelSensitivity(accelFSR));
+}
+
+float IMUCorrector::calculateGyroDPS(int16_t gyroValue, uint8_t gyroFSR) {
+    return (gyroValue / calculateGyroSensitivity(gyroFSR));
 }
 
 float IMUCorrector::calculateRegisterTemperature(int16_t tempValue) {
@@ -128,8 +136,13 @@ std::shared_ptr<Frame> IMUCorrector::process(std::shared_ptr<const Frame> frame)
         auto accelSp   = sp->as<AccelStreamProfile>();
         auto intrinsic = accelSp->getIntrinsic();
 
-        auto frameData   = (AccelFrame::Data *)accelFrame->getData();
-        frameData->value = correctAccel(frameData->value, &intrinsic);
+        if(accelFrame->is<ImuBatchFrame>()) {
+            correctImuBatch(accelFrame->asRef<ImuBatchFrame>(), intrinsic.bias, intrinsic.scaleMisalignment);
+        }
+        else {
+            auto frameData   = (AccelFrame::Data *)accelFrame->getData();
+            frameData->value = correctAccel(frameData->value, &intrinsic);
+        }
     }
 
     auto gyroFrame = frameSet->getFrame(OB_FRAME_GYRO);
@@ -138,13 +151,39 @@ std::shared_ptr<Frame> IMUCorrector::process(std::shared_ptr<const Frame> frame)
         auto gyroSp    = sp->as<GyroStreamProfile>();
         auto intrinsic = gyroSp->getIntrinsic();
 
-        auto frameData   = (GyroFrame::Data *)gyroFrame->getData();
-        frameData->value = correctGyro(frameData->value, &intrinsic);
+        if(gyroFrame->is<ImuBatchFrame>()) {
+            correctImuBatch(gyroFrame->asRef<ImuBatchFrame>(), intrinsic.bias, intrinsic.scaleMisalignment);
+        }
+        else {
+            auto frameData   = (GyroFrame::Data *)gyroFrame->getData();
+            frameData->value = correctGyro(frameData->value, &intrinsic);
+        }
     }
 
     return newFrame;
 }
 
+void IMUCorrector::correctImuBatch(const ImuBatchFrame &frame, const double bias[3], const double scaleMisalignment[9]) {
+    const uint32_t count = frame.getSampleCount();
+    float         *x     = frame.getValuesMutable(0);
+    float         *y     = frame.getValuesMutable(1);
+    float         *z     = frame.getValuesMutable(2);
+
+    // Same arithmetic as correctAccel()/correctGyro(), over the contiguous value arrays so that the compiler can vectorize the loop
+    const double m00 = scaleMisalignment[0], m01 = scaleMisalignment[1], m02 = scaleMisalignment[2];
+    const double m10 = scaleMisalignment[3], m11 = scaleMisalignment[4], m12 = scaleMisalignment[5];
+    const double m20 = scaleMisalignment[6], m21 = scaleMisalignment[7], m22 = scaleMisalignment[8];
+    const double b0 = bias[0], b1 = bias[1], b2 = bias[2];
+    for(uint32_t i = 0; i < count; i++) {
+        double dx = x[i] - b0;
+        double dy = y[i] - b1;
+        double dz = z[i] - b2;
+        x[i]      = static_cast<float>(m00 * dx + m01 * dy + m02 * dz);
+        y[i]      = static_cast<float>(m10 * dx + m11 * dy + m12 * dz);
+        z[i]      = static_cast<float>(m20 * dx + m21 * dy + m22 * dz);
+    }
+}
+
 OBAccelValue IMUCorrector::correctAccel(const OBAccelValue &accelValue, OBAccelIntrinsic *intrinsic) {
     double M_acc[3][3];
     double bias_acc[3];
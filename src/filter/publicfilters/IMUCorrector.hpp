@@ -3,6 +3,7 @@
 #include "libobsensor/h/ObTypes.h"
 // #include "IProperty.hpp"
 #include "InternalTypes.hpp"
+#include "frame/Frame.hpp"
 
 namespace libobsensor {
 
@@ -13,6 +14,11 @@ public:
     static float                calculateAccelGravity(int16_t accelValue, uint8_t accelFSR);
     static float                calculateGyroDPS(int16_t gyroValue, uint8_t gyroFSR);
     static float                calculateRegisterTemperature(int16_t tempValue);
+    static float                calculateAccelSensitivity(uint8_t accelFSR);
+    static float                calculateGyroSensitivity(uint8_t gyroFSR);
+
+    // Apply scaleMisalignment * (value - bias) to all samples of an imu batch frame in place
+    static void correctImuBatch(const ImuBatchFrame &frame, const double bias[3], const double scaleMisalignment[9]);
 
 public:
     IMUCorrector();
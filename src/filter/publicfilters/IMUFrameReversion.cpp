@@ -7,6 +7,16 @@
 
 namespace libobsensor {
 
+static void reverseImuBatch(const ImuBatchFrame &frame) {
+    auto count = frame.getSampleCount();
+    for(uint32_t axis = 0; axis < 3; axis++) {
+        auto values = frame.getValuesMutable(axis);
+        for(uint32_t i = 0; i < count; i++) {
+            values[i] *= -1;
+        }
+    }
+}
+
 IMUFrameReversion::IMUFrameReversion() {}
 
 IMUFrameReversion::~IMUFrameReversion() noexcept {}
@@ -34,7 +44,10 @@ std::shared_ptr<Frame> IMUFrameReversion::process(std::shared_ptr<const Frame> f
 
     auto frameSet   = newFrame->as<FrameSet>();
     auto accelFrame = frameSet->getFrame(OB_FRAME_ACCEL);
-    if(accelFrame) {
+    if(accelFrame && accelFrame->is<ImuBatchFrame>()) {
+        reverseImuBatch(accelFrame->asRef<ImuBatchFrame>());
+    }
+    else if(accelFrame) {
         AccelFrame::Data *frameData = (AccelFrame::Data *)accelFrame->getData();
         frameData->value.x *= -1;
         frameData->value.y *= -1;
@@ -42,7 +55,10 @@ std::shared_ptr<Frame> IMUFrameReversion::process(std::shared_ptr<const Frame> f
     }
 
     auto gyroFrame = frameSet->getFrame(OB_FRAME_GYRO);
-    if(gyroFrame) {
+    if(gyroFrame && gyroFrame->is<ImuBatchFrame>()) {
+        reverseImuBatch(gyroFrame->asRef<ImuBatchFrame>());
+    }
+    else if(gyroFrame) {
         GyroFrame::Data *gyroFrameData = (GyroFrame::Data *)gyroFrame->getData();
         gyroFrameData->value.x *= -1;
         gyroFrameData->value.y *= -1;
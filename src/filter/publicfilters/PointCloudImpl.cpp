@@ -0,0 +1,456 @@
+#include "PointCloudImpl.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace libobsensor {
+
+// Pixels computed by a kernel call before they are packed to points
+static const int CHUNK_PIXELS = 64;
+
+namespace {
+
+struct ScalarVector {
+    typedef float F;
+    typedef bool  M;
+    static const int WIDTH = 1;
+
+    static F set1(float v) {
+        return v;
+    }
+    static F ramp(float v) {
+        return v;
+    }
+    static F loadDepth(const uint16_t *p) {
+        return static_cast<float>(*p);
+    }
+    static F load(const float *p) {
+        return *p;
+    }
+    static void store(float *p, F v) {
+        *p = v;
+    }
+    static void storeInt16(int16_t *p, F v) {
+        *p = static_cast<int16_t>(lrintf(std::min(std::max(v, -32768.0f), 32767.0f)));
+    }
+    static void storeHalf(uint16_t *p, F v) {
+        *p = floatToHalf(v);
+    }
+    static F sub(F a, F b) {
+        return a - b;
+    }
+    static F mul(F a, F b) {
+        return a * b;
+    }
+    static F div(F a, F b) {
+        return a / b;
+    }
+    static M eq(F a, F b) {
+        return a == b;
+    }
+    static M lt(F a, F b) {
+        return a < b;
+    }
+    static M maskAnd(M a, M b) {
+        return a && b;
+    }
+    static F select(M m, F a, F b) {
+        return m ? a : b;
+    }
+};
+
+void projectPointsScalar(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                         void *x, void *y, void *z) {
+    projectPointsKernel<ScalarVector>(proj, depth, x_table, y_table, row, col, count, x, y, z);
+}
+
+template <typename Point> struct HasColor {
+    static const bool value = false;
+};
+template <> struct HasColor<OBColorPoint> {
+    static const bool value = true;
+};
+template <> struct HasColor<OBColorPointInt16> {
+    static const bool value = true;
+};
+template <> struct HasColor<OBColorPointHalf> {
+    static const bool value = true;
+};
+
+// Colors of the points: float (normalized or not) for OB_FORMAT_RGB_POINT, the 8-bit values for the 16-bit formats
+inline void setColor(OBColorPoint &point, uint8_t r, uint8_t g, uint8_t b, const float *color_lut) {
+    point.r = color_lut[r];
+    point.g = color_lut[g];
+    point.b = color_lut[b];
+}
+
+template <typename ColorPoint16> inline void setColor8(ColorPoint16 &point, uint8_t r, uint8_t g, uint8_t b) {
+    point.r = r;
+    point.g = g;
+    point.b = b;
+}
+
+inline void setColor(OBColorPointInt16 &point, uint8_t r, uint8_t g, uint8_t b, const float *) {
+    setColor8(point, r, g, b);
+}
+
+inline void setColor(OBColorPointHalf &point, uint8_t r, uint8_t g, uint8_t b, const float *) {
+    setColor8(point, r, g, b);
+}
+
+// points without colors
+template <typename Point> inline void setColor(Point &, uint8_t, uint8_t, uint8_t, const float *) {}
+
+// round() of the non-negative uv table values, without a libm call
+inline int roundPositive(float value) {
+    int truncated = static_cast<int>(value);
+    return truncated + (value - static_cast<float>(truncated) >= 0.5f ? 1 : 0);
+}
+
+}  // namespace
+
+static PointCloudProjectFunc getProjectFunc(PointCloudKernel kernel) {
+    static const PointCloudProjectFunc kernels[SIMD_ISA_COUNT] = { projectPointsScalar, projectPointsSSE, SIMD_KERNEL_AVX2(projectPointsAVX2),
+                                                                   SIMD_KERNEL_AVX512(projectPointsAVX512), SIMD_KERNEL_NEON(projectPointsNEON) };
+    return getSimdKernel(kernels, kernel);
+}
+
+static PointCloudCoordinateType getCoordinateType(OBFormat format) {
+    switch(format) {
+    case OB_FORMAT_POINT_INT16:
+    case OB_FORMAT_RGB_POINT_INT16:
+        return POINTCLOUD_COORDINATE_INT16;
+    case OB_FORMAT_POINT_HALF:
+    case OB_FORMAT_RGB_POINT_HALF:
+        return POINTCLOUD_COORDINATE_HALF;
+    default:
+        return POINTCLOUD_COORDINATE_FLOAT;
+    }
+}
+
+struct PointCloudRequest {
+    const OBXYTables             *tables;
+    const uint16_t               *depth;
+    const uint8_t                *color;
+    const PointCloudColorMapFunc *color_map;  // nullptr if the color frame is aligned to the depth frame
+    int                           color_width;
+    OBFormat                      format;
+    float                         color_lut[256];  // float color of the 8-bit values
+    bool                          valid_points_only;
+    uint8_t                      *points;
+    PointCloudProjection          projection;
+};
+
+namespace {
+
+// Write the points of count pixels from pixel index idx, from their coordinates computed by the kernel; returns the end of the points written.
+// With the valid points only, every point is written after the last valid one and only kept if valid, so there is no branch on the pixels. The
+// points after the last valid one of the rows would be written over the first points of the next rows, which another thread may be writing,
+// so from out_end on they go to a scratch point instead.
+template <typename Point, bool VALID_POINTS_ONLY, typename Coordinate>
+uint8_t *packPoints(const PointCloudRequest &request, size_t idx, int count, const Coordinate (*coordinates)[CHUNK_PIXELS], const int *color_pixels,
+                    uint8_t *out, uint8_t *out_end) {
+    const OBXYTables &tables = *request.tables;
+    const uint16_t   *depth  = request.depth + idx;
+    const float      *x_tab  = tables.xTable + idx;
+    const float      *y_tab  = tables.yTable + idx;
+
+    Point       *points   = reinterpret_cast<Point *>(out);
+    const size_t capacity = static_cast<size_t>(reinterpret_cast<Point *>(out_end) - points);
+    Point        scratch;
+    size_t       kept = 0;
+    for(int i = 0; i < count; i++) {
+        uint16_t depth_value = depth[i];
+        bool     valid       = (x_tab[i] == x_tab[i]) & (depth_value != 65535);  // false for NAN
+
+        Point &point = VALID_POINTS_ONLY ? (kept < capacity ? points[kept] : scratch) : points[i];
+        point.x      = coordinates[0][i];
+        point.y      = coordinates[1][i];
+        point.z      = coordinates[2][i];
+        if(HasColor<Point>::value) {
+            // the color of an invalid pixel is read from a valid address and masked to 0, so there is no branch on the pixels
+            size_t color_idx = idx + i;
+            bool   colored   = valid;
+            if(color_pixels) {
+                int u_rgb = color_pixels[2 * i], v_rgb = color_pixels[2 * i + 1];
+                colored   = colored & (u_rgb >= 0);
+                color_idx = u_rgb >= 0 ? static_cast<size_t>(v_rgb) * request.color_width + u_rgb : 0;
+            }
+            else if(request.projection.from_pixel) {
+                int u_rgb = roundPositive(valid ? x_tab[i] : 0.0f);
+                int v_rgb = roundPositive(valid ? y_tab[i] : 0.0f);
+                color_idx = static_cast<size_t>(v_rgb) * tables.width + u_rgb;
+            }
+            const uint8_t *rgb  = request.color + 3 * color_idx;
+            uint8_t        mask = colored ? 0xff : 0;
+            setColor(point, rgb[0] & mask, rgb[1] & mask, rgb[2] & mask, request.color_lut);
+        }
+        kept += VALID_POINTS_ONLY ? (valid & (depth_value != 0)) : 1;
+    }
+    return out + kept * sizeof(Point);
+}
+
+template <typename Point, typename Coordinate>
+uint8_t *packPoints(const PointCloudRequest &request, size_t idx, int count, const Coordinate (*coordinates)[CHUNK_PIXELS], const int *color_pixels,
+                    uint8_t *out, uint8_t *out_end) {
+    if(request.valid_points_only) {
+        return packPoints<Point, true>(request, idx, count, coordinates, color_pixels, out, out_end);
+    }
+    return packPoints<Point, false>(request, idx, count, coordinates, color_pixels, out, out_end);
+}
+
+}  // namespace
+
+PointCloudImpl::PointCloudImpl() : thread_count_(0), kernel_(POINTCLOUD_KERNEL_SCALAR), project_func_(projectPointsScalar) {
+    thread_pool_ = ThreadPool::getInstance();
+
+    setWidestSimdKernel<PointCloudKernel>([this](PointCloudKernel kernel) { return setKernel(kernel); });
+}
+
+bool PointCloudImpl::isKernelAvailable(PointCloudKernel kernel) {
+    return getProjectFunc(kernel) != nullptr;
+}
+
+bool PointCloudImpl::setKernel(PointCloudKernel kernel) {
+    auto func = getProjectFunc(kernel);
+    if(!func) {
+        return false;
+    }
+    kernel_       = kernel;
+    project_func_ = func;
+    return true;
+}
+
+bool PointCloudImpl::isPointFormat(OBFormat format) {
+    return format == OB_FORMAT_POINT || format == OB_FORMAT_POINT_INT16 || format == OB_FORMAT_POINT_HALF || isColorPointFormat(format);
+}
+
+bool PointCloudImpl::isColorPointFormat(OBFormat format) {
+    return format == OB_FORMAT_RGB_POINT || format == OB_FORMAT_RGB_POINT_INT16 || format == OB_FORMAT_RGB_POINT_HALF;
+}
+
+size_t PointCloudImpl::countValidPoints(const PointCloudRequest &request, int row_begin, int row_end) const {
+    const size_t width  = static_cast<size_t>(request.tables->width);
+    size_t       count  = 0;
+    const float *x_tab  = request.tables->xTable;
+    for(size_t i = row_begin * width; i < row_end * width; i++) {
+        uint16_t depth_value = request.depth[i];
+        // x_tab[i] == x_tab[i] is false for NAN; & instead of && so the compiler does not branch on the pixels
+        count += (depth_value != 0) & (depth_value != 65535) & (x_tab[i] == x_tab[i]);
+    }
+    return count;
+}
+
+size_t PointCloudImpl::processRows(const PointCloudRequest &request, int row_begin, int row_end, size_t point_offset, size_t point_end) const {
+    const OBXYTables &tables = *request.tables;
+    const bool        padded = kernel_ != POINTCLOUD_KERNEL_SCALAR;
+
+    float    float_coordinates[3][CHUNK_PIXELS];
+    int16_t  int16_coordinates[3][CHUNK_PIXELS];
+    uint16_t half_coordinates[3][CHUNK_PIXELS];
+    size_t   coordinate_size = 0;
+    uint8_t *coordinates[3];
+    for(int k = 0; k < 3; k++) {
+        switch(request.projection.coordinate_type) {
+        case POINTCLOUD_COORDINATE_INT16:
+            coordinates[k]  = reinterpret_cast<uint8_t *>(int16_coordinates[k]);
+            coordinate_size = sizeof(int16_t);
+            break;
+        case POINTCLOUD_COORDINATE_HALF:
+            coordinates[k]  = reinterpret_cast<uint8_t *>(half_coordinates[k]);
+            coordinate_size = sizeof(uint16_t);
+            break;
+        default:
+            coordinates[k]  = reinterpret_cast<uint8_t *>(float_coordinates[k]);
+            coordinate_size = sizeof(float);
+            break;
+        }
+    }
+
+    // the color pixels of the depth pixels, if mapped to the color frame as they are converted
+    int        color_pixels_data[2 * CHUNK_PIXELS];
+    const int *color_pixels = request.color_map ? color_pixels_data : nullptr;
+
+    // the last pixels of a row, fewer than the kernel takes, are copied to a padded group
+    uint16_t tail_depth[POINTCLOUD_KERNEL_PIXELS];
+    float    tail_x_table[POINTCLOUD_KERNEL_PIXELS];
+    float    tail_y_table[POINTCLOUD_KERNEL_PIXELS];
+
+    const size_t point_size = getPointSize(request.format);
+    uint8_t     *begin      = request.points + point_offset * point_size;
+    uint8_t     *end        = request.points + point_end * point_size;
+    uint8_t     *out        = begin;
+    for(int row = row_begin; row < row_end; row++) {
+        for(int col = 0; col < tables.width; col += CHUNK_PIXELS) {
+            int          count  = std::min(CHUNK_PIXELS, tables.width - col);
+            size_t       idx    = static_cast<size_t>(row) * tables.width + col;
+            int          simd   = padded ? count / POINTCLOUD_KERNEL_PIXELS * POINTCLOUD_KERNEL_PIXELS : count;
+            const float *x_tab  = tables.xTable + idx;
+            const float *y_tab  = tables.yTable + idx;
+            if(simd > 0) {
+                project_func_(request.projection, request.depth + idx, x_tab, y_tab, row, col, simd, coordinates[0], coordinates[1], coordinates[2]);
+            }
+            if(simd < count) {
+                int tail = count - simd;
+                memset(tail_depth, 0, sizeof(tail_depth));
+                memset(tail_x_table, 0, sizeof(tail_x_table));
+                memset(tail_y_table, 0, sizeof(tail_y_table));
+                memcpy(tail_depth, request.depth + idx + simd, tail * sizeof(uint16_t));
+                memcpy(tail_x_table, x_tab + simd, tail * sizeof(float));
+                memcpy(tail_y_table, y_tab + simd, tail * sizeof(float));
+                project_func_(request.projection, tail_depth, tail_x_table, tail_y_table, row, col + simd, POINTCLOUD_KERNEL_PIXELS,
+                              coordinates[0] + simd * coordinate_size, coordinates[1] + simd * coordinate_size, coordinates[2] + simd * coordinate_size);
+            }
+
+            if(request.color_map && !(*request.color_map)(static_cast<int>(idx), static_cast<int>(idx) + count, color_pixels_data)) {
+                std::fill(color_pixels_data, color_pixels_data + 2 * count, -1);
+            }
+
+            switch(request.format) {
+            case OB_FORMAT_POINT:
+                out = packPoints<OBPoint>(request, idx, count, float_coordinates, color_pixels, out, end);
+                break;
+            case OB_FORMAT_RGB_POINT:
+                out = packPoints<OBColorPoint>(request, idx, count, float_coordinates, color_pixels, out, end);
+                break;
+            case OB_FORMAT_POINT_INT16:
+                out = packPoints<OBPointInt16>(request, idx, count, int16_coordinates, color_pixels, out, end);
+                break;
+            case OB_FORMAT_RGB_POINT_INT16:
+                out = packPoints<OBColorPointInt16>(request, idx, count, int16_coordinates, color_pixels, out, end);
+                break;
+            case OB_FORMAT_POINT_HALF:
+                out = packPoints<OBPointHalf>(request, idx, count, half_coordinates, color_pixels, out, end);
+                break;
+            case OB_FORMAT_RGB_POINT_HALF:
+                out = packPoints<OBColorPointHalf>(request, idx, count, half_coordinates, color_pixels, out, end);
+                break;
+            default:
+                return 0;
+            }
+        }
+    }
+    return (out - begin) / point_size;
+}
+
+size_t PointCloudImpl::getPointSize(OBFormat format) {
+    switch(format) {
+    case OB_FORMAT_POINT:
+        return sizeof(OBPoint);
+    case OB_FORMAT_RGB_POINT:
+        return sizeof(OBColorPoint);
+    case OB_FORMAT_POINT_INT16:
+        return sizeof(OBPointInt16);
+    case OB_FORMAT_POINT_HALF:
+        return sizeof(OBPointHalf);
+    case OB_FORMAT_RGB_POINT_INT16:
+        return sizeof(OBColorPointInt16);
+    case OB_FORMAT_RGB_POINT_HALF:
+        return sizeof(OBColorPointHalf);
+    default:
+        return 0;
+    }
+}
+
+static void initRequest(PointCloudRequest &request, const OBXYTables &tables, const uint16_t *depth, const uint8_t *color, OBFormat format,
+                        float position_scale, OBCoordinateSystemType coordinate_system, bool color_normalization, bool valid_points_only, void *points) {
+    request.tables                     = &tables;
+    request.depth                      = depth;
+    request.color                      = PointCloudImpl::isColorPointFormat(format) ? color : nullptr;
+    request.color_map                  = nullptr;
+    request.color_width                = 0;
+    request.format                     = format;
+    request.valid_points_only          = valid_points_only;
+    request.points                     = static_cast<uint8_t *>(points);
+    request.projection.from_pixel      = false;
+    request.projection.fx              = 1.0f;
+    request.projection.fy              = 1.0f;
+    request.projection.cx              = 0.0f;
+    request.projection.cy              = 0.0f;
+    request.projection.y_sign          = coordinate_system == OB_LEFT_HAND_COORDINATE_SYSTEM ? -1.0f : 1.0f;
+    request.projection.position_scale  = position_scale;
+    request.projection.coordinate_type = getCoordinateType(format);
+    const float color_div              = color_normalization ? 255.0f : 1.0f;
+    for(int i = 0; i < 256; i++) {
+        request.color_lut[i] = i / color_div;
+    }
+}
+
+size_t PointCloudImpl::process(const OBXYTables &tables, bool uv_tables, const OBCameraIntrinsic &intrinsic, const uint16_t *depth, const uint8_t *color,
+                               OBFormat format, float position_scale, OBCoordinateSystemType coordinate_system, bool color_normalization,
+                               bool valid_points_only, void *points) {
+    if(!isPointFormat(format) || tables.width <= 0 || tables.height <= 0) {
+        return 0;
+    }
+
+    PointCloudRequest request;
+    initRequest(request, tables, depth, color, format, position_scale, coordinate_system, color_normalization, valid_points_only, points);
+    request.projection.from_pixel = uv_tables;
+    request.projection.fx         = intrinsic.fx;
+    request.projection.fy         = intrinsic.fy;
+    request.projection.cx         = intrinsic.cx;
+    request.projection.cy         = intrinsic.cy;
+    return processRequest(request);
+}
+
+size_t PointCloudImpl::processWithColorMap(const OBXYTables &tables, const uint16_t *depth, const uint8_t *color, int color_width,
+                                           const PointCloudColorMapFunc &color_map, OBFormat format, float position_scale,
+                                           OBCoordinateSystemType coordinate_system, bool color_normalization, bool valid_points_only, void *points) {
+    if(!isColorPointFormat(format) || tables.width <= 0 || tables.height <= 0 || color_width <= 0) {
+        return 0;
+    }
+
+    PointCloudRequest request;
+    initRequest(request, tables, depth, color, format, position_scale, coordinate_system, color_normalization, valid_points_only, points);
+    request.color_map   = &color_map;
+    request.color_width = color_width;
+    return processRequest(request);
+}
+
+size_t PointCloudImpl::processRequest(const PointCloudRequest &request) const {
+    const OBXYTables &tables     = *request.tables;
+    const int         rows       = tables.height;
+    const size_t      band_count = thread_pool_->getRowBandCount(rows, thread_count_);
+    if(band_count == 1) {
+        return processRows(request, 0, rows, 0, static_cast<size_t>(rows) * tables.width);
+    }
+
+    // the bands of the thread pool, with their index as the points of a band go after the points of the bands before
+    auto getRowBand = [&](size_t band, int &row_begin, int &row_end) {
+        size_t begin, end;
+        ThreadPool::getRowBand(band, band_count, rows, 1, begin, end);
+        row_begin = static_cast<int>(begin);
+        row_end   = static_cast<int>(end);
+    };
+
+    std::vector<size_t> offsets(band_count + 1, 0);
+    if(request.valid_points_only) {
+        thread_pool_->parallelFor(band_count, thread_count_, [&](size_t band) {
+            int row_begin, row_end;
+            getRowBand(band, row_begin, row_end);
+            offsets[band + 1] = countValidPoints(request, row_begin, row_end);
+        });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    }
+    else {
+        for(size_t band = 0; band < band_count; band++) {
+            int row_begin, row_end;
+            getRowBand(band, row_begin, row_end);
+            offsets[band] = static_cast<size_t>(row_begin) * tables.width;
+        }
+        offsets[band_count] = static_cast<size_t>(rows) * tables.width;
+    }
+
+    // The bands are taken from the last one: a band writing past its points would overwrite the points of the next band already written, even when
+    // the bands run one after the other (one cpu core), so pointcloud_test catches it on any machine.
+    thread_pool_->parallelFor(band_count, thread_count_, [&](size_t task) {
+        size_t band = band_count - 1 - task;
+        int    row_begin, row_end;
+        getRowBand(band, row_begin, row_end);
+        processRows(request, row_begin, row_end, offsets[band], offsets[band + 1]);
+    });
+    return offsets[band_count];
+}
+
+}  // namespace libobsensor
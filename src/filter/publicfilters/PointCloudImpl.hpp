@@ -0,0 +1,111 @@
+#pragma once
+#include "libobsensor/h/ObTypes.h"
+#include "utils/ThreadPool.hpp"
+#include "PointCloudImplKernel.hpp"
+#include <functional>
+#include <memory>
+
+namespace libobsensor {
+
+struct PointCloudRequest;
+
+/**
+ * @brief Maps the depth pixels [pixel_begin, pixel_end) to the pixels of a color frame: the x and y of each pixel to map, -1 if it has no color pixel.
+ * Called by the threads of the conversion at the same time, see AlignImpl::mapDepthPixels.
+ * @return false if the pixels could not be mapped, their points then have no color
+ */
+typedef std::function<bool(int pixel_begin, int pixel_end, int *map)> PointCloudColorMapFunc;
+
+/**
+ * @brief Implementation of the depth to point cloud conversion of PointCloudFilter: the coordinates are computed by the SIMD kernels on row bands in
+ * parallel, and written in the float or 16-bit point formats, organized or with the valid points only
+ */
+class PointCloudImpl {
+public:
+    PointCloudImpl();
+
+    ~PointCloudImpl() = default;
+
+    /**
+     * @brief Set the number of threads the conversion runs on
+     * @param[in] thread_count thread count, 0 for one thread per cpu core
+     */
+    void setThreadCount(int thread_count) {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * @brief Select the SIMD kernel the conversion runs with, the best one the cpu supports by default
+     * @param[in] kernel the kernel
+     * @retval false if the kernel is not built for this architecture or not supported by the cpu
+     */
+    bool setKernel(PointCloudKernel kernel);
+
+    PointCloudKernel getKernel() const {
+        return kernel_;
+    }
+
+    static bool isKernelAvailable(PointCloudKernel kernel);
+
+    /**
+     * @brief Check if a format is a point cloud format, and if it has colors
+     */
+    static bool isPointFormat(OBFormat format);
+    static bool isColorPointFormat(OBFormat format);
+
+    /**
+     * @brief Get the size of a point of a point cloud format, 0 for the other formats
+     */
+    static size_t getPointSize(OBFormat format);
+
+    /**
+     * @brief Convert a depth frame to a point cloud
+     * @param[in] tables xy tables of the depth frame, or uv tables to the color frame if uv_tables
+     * @param[in] uv_tables if the tables are uv tables, see CoordinateUtil::transformationInitAddDistortionUVTables
+     * @param[in] intrinsic depth intrinsic, only used with uv tables
+     * @param[in] depth depth data, of the resolution of the tables
+     * @param[in] color RGB888 color data of the resolution of the tables for the formats with colors, else nullptr
+     * @param[in] format point format: OB_FORMAT_POINT, OB_FORMAT_RGB_POINT or one of their 16-bit variants
+     * @param[in] position_scale coordinate data scale
+     * @param[in] coordinate_system coordinate system type
+     * @param[in] color_normalization normalize the colors of OB_FORMAT_RGB_POINT to [0, 1]
+     * @param[in] valid_points_only leave out the points of zero or invalid depth
+     * @param[out] points the point cloud, room for one point per depth pixel
+     *
+     * @return size_t the number of points written
+     */
+    size_t process(const OBXYTables &tables, bool uv_tables, const OBCameraIntrinsic &intrinsic, const uint16_t *depth, const uint8_t *color, OBFormat format,
+                   float position_scale, OBCoordinateSystemType coordinate_system, bool color_normalization, bool valid_points_only, void *points);
+
+    /**
+     * @brief Convert a depth frame to a point cloud with the colors of a color frame not aligned to it: each depth pixel is mapped to the color frame
+     * by color_map as it is converted, instead of aligning the color frame to the depth frame first
+     * @param[in] color RGB888 color data
+     * @param[in] color_width width of the color frame
+     * @param[in] color_map maps the depth pixels to the pixels of the color frame
+     * @param[in] format point format with colors: OB_FORMAT_RGB_POINT or one of its 16-bit variants
+     * The other parameters are the ones of process, and the points without a color pixel are black.
+     *
+     * @return size_t the number of points written
+     */
+    size_t processWithColorMap(const OBXYTables &tables, const uint16_t *depth, const uint8_t *color, int color_width, const PointCloudColorMapFunc &color_map,
+                               OBFormat format, float position_scale, OBCoordinateSystemType coordinate_system, bool color_normalization,
+                               bool valid_points_only, void *points);
+
+private:
+    size_t processRequest(const PointCloudRequest &request) const;
+
+    size_t countValidPoints(const PointCloudRequest &request, int row_begin, int row_end) const;
+    // writes the points of the rows from point index point_offset, and never at or after point_end (the points of the next rows); returns the number
+    // of points written
+    size_t processRows(const PointCloudRequest &request, int row_begin, int row_end, size_t point_offset, size_t point_end) const;
+
+private:
+    std::shared_ptr<ThreadPool> thread_pool_;
+    int                         thread_count_;
+
+    PointCloudKernel      kernel_;
+    PointCloudProjectFunc project_func_;
+};
+
+}  // namespace libobsensor
@@ -0,0 +1,15 @@
+#include "PointCloudImplKernel.hpp"
+
+// Built with the AVX2, FMA and F16C flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX2_KERNELS
+#include "SimdVectorAVX2.hpp"
+
+namespace libobsensor {
+
+void projectPointsAVX2(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                       void *x, void *y, void *z) {
+    projectPointsKernel<Avx2FloatVector>(proj, depth, x_table, y_table, row, col, count, x, y, z);
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX2_KERNELS
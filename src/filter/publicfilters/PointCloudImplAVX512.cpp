@@ -0,0 +1,15 @@
+#include "PointCloudImplKernel.hpp"
+
+// Built with the AVX-512 flags, only called if the cpu supports them
+#ifdef OB_BUILD_AVX512_KERNELS
+#include "SimdVectorAVX512.hpp"
+
+namespace libobsensor {
+
+void projectPointsAVX512(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                         void *x, void *y, void *z) {
+    projectPointsKernel<Avx512FloatVector>(proj, depth, x_table, y_table, row, col, count, x, y, z);
+}
+
+}  // namespace libobsensor
+#endif  // OB_BUILD_AVX512_KERNELS
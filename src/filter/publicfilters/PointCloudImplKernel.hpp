@@ -0,0 +1,108 @@
+#pragma once
+#include "libobsensor/h/ObTypes.h"
+#include "SimdKernel.hpp"
+#include <stdint.h>
+
+// The SIMD kernels computing the point coordinates of depth pixels for PointCloudImpl, written once for a float vector type V (SseFloatVector, ...) and
+// built for each instruction set in its own translation unit (PointCloudImplSSE.cpp, PointCloudImplAVX2.cpp, ...), see SimdKernel.hpp.
+
+namespace libobsensor {
+
+typedef enum {
+    POINTCLOUD_KERNEL_SCALAR = SIMD_ISA_SCALAR,
+    POINTCLOUD_KERNEL_SSE    = SIMD_ISA_SSE,
+    POINTCLOUD_KERNEL_AVX2   = SIMD_ISA_AVX2,
+    POINTCLOUD_KERNEL_AVX512 = SIMD_ISA_AVX512,
+    POINTCLOUD_KERNEL_NEON   = SIMD_ISA_NEON,
+} PointCloudKernel;
+
+// The kernels take pixels in groups of POINTCLOUD_KERNEL_PIXELS, a multiple of the vector width of every instruction set
+#define POINTCLOUD_KERNEL_PIXELS 16
+
+typedef enum {
+    POINTCLOUD_COORDINATE_FLOAT,  // float
+    POINTCLOUD_COORDINATE_INT16,  // int16_t, rounded to nearest and saturated
+    POINTCLOUD_COORDINATE_HALF,   // uint16_t holding an IEEE 754 half float, rounded to nearest even
+} PointCloudCoordinateType;
+
+struct PointCloudProjection {
+    // true for the uv tables (the color pixel of each depth pixel, see CoordinateUtil::transformationInitAddDistortionUVTables): the normalized
+    // coordinates are then computed from the depth pixel and intrinsic, and the tables only mark the invalid pixels
+    bool  from_pixel;
+    float fx, fy, cx, cy;
+
+    float                    y_sign;          // -1 for the left hand coordinate system
+    float                    position_scale;  // coordinate data scale
+    PointCloudCoordinateType coordinate_type;
+};
+
+/**
+ * @brief Compute the coordinates of count pixels (a multiple of POINTCLOUD_KERNEL_PIXELS) of a row, in the same order of operations as
+ * CoordinateUtil::transformationDepthToPointCloud, so the float coordinates are the same. The pixels of invalid depth (65535) or tables (NAN) are 0.
+ * @param[in] depth, x_table, y_table the data of the first pixel, at column col of row
+ * @param[out] x, y, z the coordinates of the pixels, of the type of proj.coordinate_type
+ */
+typedef void (*PointCloudProjectFunc)(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col,
+                                      int count, void *x, void *y, void *z);
+
+void projectPointsSSE(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                      void *x, void *y, void *z);
+void projectPointsAVX2(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                       void *x, void *y, void *z);
+void projectPointsAVX512(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                         void *x, void *y, void *z);
+void projectPointsNEON(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                       void *x, void *y, void *z);
+
+namespace {
+
+template <typename V> inline void storeCoordinates(PointCloudCoordinateType type, void *dst, int index, typename V::F v) {
+    switch(type) {
+    case POINTCLOUD_COORDINATE_INT16:
+        V::storeInt16(static_cast<int16_t *>(dst) + index, v);
+        break;
+    case POINTCLOUD_COORDINATE_HALF:
+        V::storeHalf(static_cast<uint16_t *>(dst) + index, v);
+        break;
+    default:
+        V::store(static_cast<float *>(dst) + index, v);
+        break;
+    }
+}
+
+template <typename V>
+void projectPointsKernel(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                         void *x, void *y, void *z) {
+    typedef typename V::F F;
+    const F zero          = V::set1(0.0f);
+    const F invalid_depth = V::set1(65535.0f);
+    const F scale         = V::set1(proj.position_scale);
+    const F y_sign        = V::set1(proj.y_sign);
+    const F fx            = V::set1(proj.fx);
+    const F cx            = V::set1(proj.cx);
+    const F row_y         = V::set1((row - proj.cy) / proj.fy);
+
+    for(int i = 0; i < count; i += V::WIDTH) {
+        F    d       = V::loadDepth(depth + i);
+        F    table_x = V::load(x_table + i);
+        auto valid   = V::maskAnd(V::eq(table_x, table_x), V::lt(d, invalid_depth));
+
+        F nx, ny;
+        if(proj.from_pixel) {
+            nx = V::div(V::sub(V::ramp(static_cast<float>(col + i)), cx), fx);
+            ny = row_y;
+        }
+        else {
+            nx = table_x;
+            ny = V::load(y_table + i);
+        }
+
+        // x = nx * d * scale, y = ny * d * sign * scale and z = d * scale, rounded as the scalar code
+        storeCoordinates<V>(proj.coordinate_type, x, i, V::select(valid, V::mul(V::mul(nx, d), scale), zero));
+        storeCoordinates<V>(proj.coordinate_type, y, i, V::select(valid, V::mul(V::mul(V::mul(ny, d), y_sign), scale), zero));
+        storeCoordinates<V>(proj.coordinate_type, z, i, V::select(valid, V::mul(d, scale), zero));
+    }
+}
+
+}  // namespace
+}  // namespace libobsensor
@@ -0,0 +1,15 @@
+#include "PointCloudImplKernel.hpp"
+
+// NEON is part of the 64-bit ARM baseline; 32-bit ARM uses the SSE kernel through SSE2NEON
+#if defined(__aarch64__)
+#include "SimdVectorNEON.hpp"
+
+namespace libobsensor {
+
+void projectPointsNEON(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                       void *x, void *y, void *z) {
+    projectPointsKernel<NeonFloatVector>(proj, depth, x_table, y_table, row, col, count, x, y, z);
+}
+
+}  // namespace libobsensor
+#endif  // __aarch64__
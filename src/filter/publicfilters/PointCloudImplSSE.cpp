@@ -0,0 +1,11 @@
+#include "PointCloudImplKernel.hpp"
+#include "SimdVectorSSE.hpp"
+
+namespace libobsensor {
+
+void projectPointsSSE(const PointCloudProjection &proj, const uint16_t *depth, const float *x_table, const float *y_table, int row, int col, int count,
+                      void *x, void *y, void *z) {
+    projectPointsKernel<SseFloatVector>(proj, depth, x_table, y_table, row, col, count, x, y, z);
+}
+
+}  // namespace libobsensor
@@ -4,6 +4,7 @@
 #include "frame/FrameFactory.hpp"
 #include "stream/StreamProfile.hpp"
 #include "libobsensor/h/ObTypes.h"
+#include "utils/CoordinateTablesCache.hpp"
 #include "utils/CoordinateUtil.hpp"
 #include "utils/Utils.hpp"
 
@@ -14,7 +15,8 @@ PointCloudFilter::PointCloudFilter()
       positionDataScale_(1.0f),
       coordinateSystemType_(OB_LEFT_HAND_COORDINATE_SYSTEM),
       isColorDataNormalization_(false),
-      tablesDataSize_(0),
+      validPointsOnly_(false),
+      impl_(std::make_shared<PointCloudImpl>()),
       tablesData_(nullptr) {}
 
 PointCloudFilter::~PointCloudFilter() noexcept {
@@ -25,20 +27,20 @@ void PointCloudFilter::reset() {
     if(formatConverter_) {
         formatConverter_.reset();
     }
-    if(tablesData_) {
-        tablesData_.reset();
-        tablesDataSize_ = 0;
-    }
+    tablesData_.reset();
+    alignImpl_.reset();
+    alignParams_.clear();
 }
 
 void PointCloudFilter::updateConfig(std::vector<std::string> &params) {
-    if(params.size() != 4) {
+    // pointFormat, coordinateDataScale, colorDataNormalization, coordinateSystemType[, validPointsOnly[, threadCount]]
+    if(params.size() < 4 || params.size() > 6) {
         throw invalid_value_exception("PointCloudFilter config error: params size not match");
     }
     try {
         OBFormat type = (OBFormat)std::stoi(params[0]);
-        if(type != OB_FORMAT_POINT && type != OB_FORMAT_RGB_POINT) {
-            LOG_ERROR("Invalid type, the pointType must be OB_FORMAT_POINT or OB_FORMAT_RGB_POINT");
+        if(!PointCloudImpl::isPointFormat(type)) {
+            LOG_ERROR("Invalid type, the pointType must be OB_FORMAT_POINT, OB_FORMAT_RGB_POINT or one of their 16-bit variants");
         }
         else {
             pointFormat_ = type;
@@ -54,6 +56,17 @@ void PointCloudFilter::updateConfig(std::vector<std::string> &params) {
 
         int csType            = std::stoi(params[3]);
         coordinateSystemType_ = static_cast<OBCoordinateSystemType>(csType);
+
+        if(params.size() > 4) {
+            validPointsOnly_ = std::stoi(params[4]) != 0;
+        }
+        if(params.size() > 5) {
+            int threadCount = std::stoi(params[5]);
+            if(threadCount < 0) {
+                throw invalid_value_exception("threadCount must not be negative");
+            }
+            impl_->setThreadCount(threadCount);
+        }
     }
     catch(const std::exception &e) {
         throw invalid_value_exception("PointCloudFilter config error: " + std::string(e.what()));
@@ -62,10 +75,13 @@ void PointCloudFilter::updateConfig(std::vector<std::string> &params) {
 
 const std::string &PointCloudFilter::getConfigSchema() const {
     // csv format: name，type， min，max，step，default，description
-    static const std::string schema = "pointFormat, integer, 19, 20, 1, 19, create point type: 19 is OB_FORMAT_POINT; 20 is OB_FORMAT_RGB_POINT\n"
-                                      "coordinateDataScale, float, 0.00000001, 100, 0.00001, 1.0, coordinate data scale\n"
-                                      "colorDataNormalization, integer, 0, 1, 1, 0, color data normal state\n"
-                                      "coordinateSystemType, integer, 0, 1, 1, 1, Coordinate system representation type: 0 is left hand; 1 is right hand\n";
+    static const std::string schema =
+        "pointFormat, integer, 19, 37, 1, 19, create point type: 19 is OB_FORMAT_POINT; 20 is OB_FORMAT_RGB_POINT; 34 to 37 are their 16-bit variants\n"
+        "coordinateDataScale, float, 0.00000001, 100, 0.00001, 1.0, coordinate data scale\n"
+        "colorDataNormalization, integer, 0, 1, 1, 0, color data normal state\n"
+        "coordinateSystemType, integer, 0, 1, 1, 1, Coordinate system representation type: 0 is left hand; 1 is right hand\n"
+        "validPointsOnly, integer, 0, 1, 1, 0, output only the points of valid depth instead of one point per depth pixel\n"
+        "threadCount, integer, 0, 16, 1, 0, number of threads to compute the point cloud on (0 for one per cpu core)\n";
     return schema;
 }
 
@@ -88,40 +104,26 @@ std::shared_ptr<Frame> PointCloudFilter::createDepthPointCloud(std::shared_ptr<c
     auto depthVideoStreamProfile = depthVideoFrame->getStreamProfile()->as<VideoStreamProfile>();
     auto depthWidth              = depthVideoFrame->getWidth();
     auto depthHeight             = depthVideoFrame->getHeight();
-    auto pointDataSize           = depthWidth * depthHeight * sizeof(OBPoint);
+    auto pointDataSize           = depthWidth * depthHeight * PointCloudImpl::getPointSize(pointFormat_);
 
-    auto pointFrame = FrameFactory::createFrame(OB_FRAME_POINTS, OB_FORMAT_POINT, pointDataSize);
+    auto pointFrame = FrameFactory::createFrame(OB_FRAME_POINTS, pointFormat_, pointDataSize);
     if(pointFrame == nullptr) {
         LOG_ERROR_INTVL("Acquire point cloud frame failed!");
         return nullptr;
     }
 
-    auto frameSize = depthWidth * depthHeight * 2;
-    if(tablesData_ && tablesDataSize_ != frameSize){
+    // shared with the other filters of the same camera parameters, and only computed on their first use
+    tablesData_ = CoordinateUtil::getCachedXYTables(depthVideoStreamProfile->getIntrinsic(), depthVideoStreamProfile->getDistortion(), &xyTables_);
+    if(tablesData_ == nullptr || xyTables_.width != static_cast<int>(depthWidth) || xyTables_.height != static_cast<int>(depthHeight)) {
+        LOG_ERROR_INTVL("Init transformation coordinate tables failed!");
         tablesData_.reset();
-        tablesData_ = nullptr;
-    }
-
-    if(tablesData_ == nullptr) {
-        tablesDataSize_ = frameSize;
-        tablesData_     = std::shared_ptr<float>(new float[tablesDataSize_], std::default_delete<float[]>());
-        OBCameraIntrinsic  depthIntrinsic = depthVideoStreamProfile->getIntrinsic();
-        OBCameraDistortion depthDisto     = depthVideoStreamProfile->getDistortion();
-        if(!CoordinateUtil::transformationInitXYTables(depthIntrinsic, depthDisto, reinterpret_cast<float *>(tablesData_.get()), &tablesDataSize_, &xyTables_)) {
-            LOG_ERROR_INTVL("Init transformation coordinate tables failed!");
-            tablesData_.reset();
-            return nullptr;
-        }
+        return nullptr;
     }
 
-    CoordinateUtil::transformationDepthToPointCloud(&xyTables_, depthFrame->getData(), (void *)pointFrame->getData(), positionDataScale_,
-                                                    coordinateSystemType_);
-
-    float depthValueScale = depthFrame->as<DepthFrame>()->getValueScale();
-    pointFrame->copyInfoFromOther(depthFrame);
-    // Actual coordinate scaling = Depth scaling factor / Set coordinate scaling factor.
-    pointFrame->as<PointsFrame>()->setCoordinateValueScale(depthValueScale / positionDataScale_);
-
+    auto pointCount = impl_->process(xyTables_, false, depthVideoStreamProfile->getIntrinsic(), reinterpret_cast<const uint16_t *>(depthFrame->getData()),
+                                     nullptr, pointFormat_, positionDataScale_, coordinateSystemType_, isColorDataNormalization_, validPointsOnly_,
+                                     pointFrame->getDataMutable());
+    finishPointCloud(pointFrame, depthFrame, pointCount);
     return pointFrame;
 }
 
@@ -154,7 +156,7 @@ std::shared_ptr<Frame> PointCloudFilter::createRGBDPointCloud(std::shared_ptr<co
     OBCameraDistortion dstDistortion         = dstVideoStreamProfile->getDistortion();
 
     // Create an RGBD point cloud frame
-    auto pointFrame = FrameFactory::createFrame(OB_FRAME_POINTS, OB_FORMAT_RGB_POINT, dstWidth * dstHeight * sizeof(OBColorPoint));
+    auto pointFrame = FrameFactory::createFrame(OB_FRAME_POINTS, pointFormat_, dstWidth * dstHeight * PointCloudImpl::getPointSize(pointFormat_));
     if(pointFrame == nullptr) {
         LOG_WARN_INTVL("Acquire point cloud frame failed!");
         return nullptr;
@@ -218,49 +220,121 @@ std::shared_ptr<Frame> PointCloudFilter::createRGBDPointCloud(std::shared_ptr<co
         return nullptr;
     }
 
-    auto frameSize = dstWidth * dstHeight * 2;
-    if(tablesData_ && tablesDataSize_ != frameSize){
-        tablesData_.reset();
-        tablesData_ = nullptr;
-    }
-
-    if(tablesData_ == nullptr) {
-        tablesDataSize_ = frameSize;
-        tablesData_         = std::shared_ptr<float>(new float[tablesDataSize_], std::default_delete<float[]>());
-        if(distortionType == OBPointCloudDistortionType::OB_POINT_CLOUD_ZERO_DISTORTION_TYPE) {
-            memset(&dstDistortion, 0, sizeof(OBCameraDistortion));
-        }
-
-        if(distortionType == OBPointCloudDistortionType::OB_POINT_CLOUD_ADD_DISTORTION_TYPE) {
-            if(!CoordinateUtil::transformationInitAddDistortionUVTables(dstIntrinsic, dstDistortion, reinterpret_cast<float *>(tablesData_.get()), &tablesDataSize_,
-                                                                        &xyTables_)) {
-                LOG_ERROR_INTVL("Init add distortion transformation coordinate tables failed!");
-                return nullptr;
-            }
+    // a color frame not aligned to the depth frame is mapped to the depth pixels as the points are computed, instead of aligned by an Align filter first
+    bool colorAligned = true;
+    if(!isColorAligned(depthVideoStreamProfile, colorVideoStreamProfile, colorAligned)) {
+        if(colorVideoFrame->getWidth() != dstWidth || colorVideoFrame->getHeight() != dstHeight) {
+            LOG_ERROR_INTVL("No extrinsic from the depth frame to the color frame of another resolution, can not convert to pointcloud!");
+            return nullptr;
         }
-        else {
-            if(!CoordinateUtil::transformationInitXYTables(dstIntrinsic, dstDistortion, reinterpret_cast<float *>(tablesData_.get()), &tablesDataSize_,
-                                                           &xyTables_)) {
-                LOG_ERROR_INTVL("Init transformation coordinate tables failed!");
-                return nullptr;
-            }
+    }
+    else if(!colorAligned) {
+        size_t pointCount = 0;
+        if(!mapColorPointCloud(depthVideoFrame, colorData, depthVideoStreamProfile, colorVideoStreamProfile, pointFrame->getDataMutable(), pointCount)) {
+            return nullptr;
         }
+        finishPointCloud(pointFrame, depthFrame, pointCount);
+        return pointFrame;
     }
 
+    // shared with the other filters of the same camera parameters, and only computed on their first use
+    if(distortionType == OBPointCloudDistortionType::OB_POINT_CLOUD_ZERO_DISTORTION_TYPE) {
+        memset(&dstDistortion, 0, sizeof(OBCameraDistortion));
+    }
     if(distortionType == OBPointCloudDistortionType::OB_POINT_CLOUD_ADD_DISTORTION_TYPE) {
-        CoordinateUtil::transformationDepthToRGBDPointCloudByUVTables(dstIntrinsic, &xyTables_, depthFrame->getData(), colorData, (void *)pointFrame->getData(),
-                                                                      positionDataScale_, coordinateSystemType_, isColorDataNormalization_);
+        tablesData_ = CoordinateUtil::getCachedAddDistortionUVTables(dstIntrinsic, dstDistortion, &xyTables_);
     }
     else {
-        CoordinateUtil::transformationDepthToRGBDPointCloud(&xyTables_, depthFrame->getData(), colorData, (void *)pointFrame->getData(), positionDataScale_,
-                                                            coordinateSystemType_, isColorDataNormalization_);
+        tablesData_ = CoordinateUtil::getCachedXYTables(dstIntrinsic, dstDistortion, &xyTables_);
+    }
+    if(tablesData_ == nullptr || xyTables_.width != static_cast<int>(dstWidth) || xyTables_.height != static_cast<int>(dstHeight)) {
+        LOG_ERROR_INTVL("Init transformation coordinate tables failed!");
+        tablesData_.reset();
+        return nullptr;
     }
 
-    float depthValueScale = depthVideoFrame->as<DepthFrame>()->getValueScale();
+    bool uvTables   = distortionType == OBPointCloudDistortionType::OB_POINT_CLOUD_ADD_DISTORTION_TYPE;
+    auto pointCount = impl_->process(xyTables_, uvTables, dstIntrinsic, reinterpret_cast<const uint16_t *>(depthFrame->getData()), colorData, pointFormat_,
+                                     positionDataScale_, coordinateSystemType_, isColorDataNormalization_, validPointsOnly_, pointFrame->getDataMutable());
+    finishPointCloud(pointFrame, depthFrame, pointCount);
+    return pointFrame;
+}
+
+bool PointCloudFilter::isColorAligned(std::shared_ptr<const VideoStreamProfile> depthProfile, std::shared_ptr<const VideoStreamProfile> colorProfile,
+                                      bool &aligned) {
+    OBExtrinsic depthToColor;
+    try {
+        depthToColor = depthProfile->getExtrinsicTo(colorProfile);
+    }
+    catch(const libobsensor_exception &) {
+        return false;
+    }
+
+    // the profiles of the aligned frames share the extrinsic of the frame they are aligned to, the identity extrinsic
+    const float identityRot[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+    const float zeroTrans[3]   = { 0, 0, 0 };
+    aligned = depthProfile->getWidth() == colorProfile->getWidth() && depthProfile->getHeight() == colorProfile->getHeight()
+              && memcmp(depthToColor.rot, identityRot, sizeof(identityRot)) == 0 && memcmp(depthToColor.trans, zeroTrans, sizeof(zeroTrans)) == 0;
+    return true;
+}
+
+bool PointCloudFilter::mapColorPointCloud(std::shared_ptr<const VideoFrame> depthFrame, const uint8_t *colorData,
+                                          std::shared_ptr<const VideoStreamProfile> depthProfile, std::shared_ptr<const VideoStreamProfile> colorProfile,
+                                          void *points, size_t &pointCount) {
+    auto depthIntrinsic  = depthProfile->getIntrinsic();
+    auto depthDistortion = depthProfile->getDistortion();
+    auto colorIntrinsic  = colorProfile->getIntrinsic();
+    auto colorDistortion = colorProfile->getDistortion();
+    auto depthToColor    = depthProfile->getExtrinsicTo(colorProfile);
+    auto depthUnitMm     = depthFrame->asRef<DepthFrame>().getValueScale();
+    if(colorIntrinsic.width != static_cast<int16_t>(colorProfile->getWidth()) || colorIntrinsic.height != static_cast<int16_t>(colorProfile->getHeight())) {
+        LOG_ERROR_INTVL("The color intrinsic does not match the color frame resolution, can not convert to pointcloud!");
+        return false;
+    }
+
+    // the depth pixels are projected to the color frame as the C2D alignment does, with the pixel centers and the color distortion added
+    std::string alignParams;
+    CoordinateTablesCache::appendParam(alignParams, depthIntrinsic);
+    CoordinateTablesCache::appendParam(alignParams, depthDistortion);
+    CoordinateTablesCache::appendParam(alignParams, colorIntrinsic);
+    CoordinateTablesCache::appendParam(alignParams, colorDistortion);
+    CoordinateTablesCache::appendParam(alignParams, depthToColor);
+    CoordinateTablesCache::appendParam(alignParams, depthUnitMm);
+    if(!alignImpl_ || alignParams != alignParams_) {
+        if(!alignImpl_) {
+            alignImpl_ = std::make_shared<AlignImpl>();
+        }
+        alignImpl_->reset();
+        alignImpl_->initialize(depthIntrinsic, depthDistortion, colorIntrinsic, colorDistortion, depthToColor, depthUnitMm, true, true);
+        alignParams_ = alignParams;
+    }
+
+    // the points are in the depth camera coordinate system, the one of the aligned color frame
+    tablesData_ = CoordinateUtil::getCachedXYTables(depthIntrinsic, depthDistortion, &xyTables_);
+    if(tablesData_ == nullptr || xyTables_.width != static_cast<int>(depthFrame->getWidth()) || xyTables_.height != static_cast<int>(depthFrame->getHeight())) {
+        LOG_ERROR_INTVL("Init transformation coordinate tables failed!");
+        tablesData_.reset();
+        return false;
+    }
+
+    auto                   depthData = reinterpret_cast<const uint16_t *>(depthFrame->getData());
+    auto                   alignImpl = alignImpl_.get();
+    PointCloudColorMapFunc colorMap  = [alignImpl, depthData](int pixelBegin, int pixelEnd, int *map) {
+        return alignImpl->mapDepthPixels(depthData, pixelBegin, pixelEnd, map) == 0;
+    };
+    pointCount = impl_->processWithColorMap(xyTables_, depthData, colorData, colorProfile->getWidth(), colorMap, pointFormat_, positionDataScale_,
+                                            coordinateSystemType_, isColorDataNormalization_, validPointsOnly_, points);
+    return true;
+}
+
+void PointCloudFilter::finishPointCloud(std::shared_ptr<Frame> pointFrame, std::shared_ptr<const Frame> depthFrame, size_t pointCount) {
+    // with the valid points only, the frame holds fewer points than depth pixels
+    pointFrame->setDataSize(pointCount * PointCloudImpl::getPointSize(pointFormat_));
+
+    float depthValueScale = depthFrame->asRef<DepthFrame>().getValueScale();
     pointFrame->copyInfoFromOther(depthFrame);
     // Actual coordinate scaling = Depth scaling factor / Set coordinate scaling factor.
-    pointFrame->as<PointsFrame>()->setCoordinateValueScale(depthValueScale / positionDataScale_);
-    return pointFrame;
+    pointFrame->asRef<PointsFrame>().setCoordinateValueScale(depthValueScale / positionDataScale_);
 }
 
 std::shared_ptr<Frame> PointCloudFilter::process(std::shared_ptr<const Frame> frame) {
@@ -269,7 +343,7 @@ std::shared_ptr<Frame> PointCloudFilter::process(std::shared_ptr<const Frame> fr
     }
 
     std::shared_ptr<Frame> pointsFrame = nullptr;
-    if(pointFormat_ == OB_FORMAT_POINT) {
+    if(!PointCloudImpl::isColorPointFormat(pointFormat_)) {
         pointsFrame = createDepthPointCloud(frame);
     }
     else {
@@ -1,6 +1,10 @@
 #pragma once
 #include "IFilter.hpp"
+#include "stream/StreamProfile.hpp"
+#include "frame/Frame.hpp"
 #include "FormatConverterProcess.hpp"
+#include "PointCloudImpl.hpp"
+#include "AlignImpl.hpp"
 #include <mutex>
 
 namespace libobsensor {
@@ -33,6 +37,11 @@ public:
 private:
     std::shared_ptr<Frame> createDepthPointCloud(std::shared_ptr<const Frame> frame);
     std::shared_ptr<Frame> createRGBDPointCloud(std::shared_ptr<const Frame> frame);
+    // returns false if the profiles have no extrinsic, else if the color frame is aligned to the depth frame in aligned
+    bool isColorAligned(std::shared_ptr<const VideoStreamProfile> depthProfile, std::shared_ptr<const VideoStreamProfile> colorProfile, bool &aligned);
+    bool mapColorPointCloud(std::shared_ptr<const VideoFrame> depthFrame, const uint8_t *colorData, std::shared_ptr<const VideoStreamProfile> depthProfile,
+                            std::shared_ptr<const VideoStreamProfile> colorProfile, void *points, size_t &pointCount);
+    void                   finishPointCloud(std::shared_ptr<Frame> pointFrame, std::shared_ptr<const Frame> depthFrame, size_t pointCount);
 
     std::shared_ptr<Frame> process(std::shared_ptr<const Frame> frame) override;
 
@@ -43,12 +52,18 @@ protected:
     float                  positionDataScale_;
     OBCoordinateSystemType coordinateSystemType_;
     bool                   isColorDataNormalization_;
+    bool                   validPointsOnly_;
+
+    std::shared_ptr<PointCloudImpl> impl_;
 
     std::shared_ptr<FormatConverter> formatConverter_;
 
-    uint32_t               tablesDataSize_;
-    std::shared_ptr<float> tablesData_;
-    OBXYTables             xyTables_;
+    std::shared_ptr<const float> tablesData_;  // from CoordinateTablesCache
+    OBXYTables                   xyTables_;
+
+    // maps the depth pixels to a color frame not aligned to the depth frame
+    std::shared_ptr<AlignImpl> alignImpl_;
+    std::string                alignParams_;
 };
 
 }  // namespace libobsensor
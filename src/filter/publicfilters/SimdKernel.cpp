@@ -0,0 +1,28 @@
+#include "SimdKernel.hpp"
+#include "utils/CpuFeatures.hpp"
+
+namespace libobsensor {
+
+bool isSimdIsaAvailable(SimdIsa isa) {
+    switch(isa) {
+    case SIMD_ISA_SCALAR:
+    case SIMD_ISA_SSE:
+        return true;
+#ifdef OB_BUILD_AVX2_KERNELS
+    case SIMD_ISA_AVX2:
+        return utils::cpuSupportsAVX2();
+#endif
+#ifdef OB_BUILD_AVX512_KERNELS
+    case SIMD_ISA_AVX512:
+        return utils::cpuSupportsAVX512();
+#endif
+#if defined(__aarch64__)
+    case SIMD_ISA_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+}  // namespace libobsensor
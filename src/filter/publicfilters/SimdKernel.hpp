@@ -0,0 +1,108 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// The instruction sets of the SIMD kernels of the filters, and the selection of the kernel a filter runs.
+//
+// The kernels are written once for a vector type V and built for each instruction set in its own translation unit (e.g. AlignImplSSE.cpp,
+// AlignImplAVX2.cpp, ...), with the compiler flags of that instruction set. The vector types of an instruction set are in SimdVectorSSE.hpp,
+// SimdVectorAVX2.hpp, SimdVectorAVX512.hpp and SimdVectorNEON.hpp. They provide the vector operations as static functions and are declared in an
+// anonymous namespace, so no function built for a wider instruction set may be shared (and picked by the linker) with code running on any cpu; for
+// the same reason, the kernel translation units only include the kernel header of their filter and the vector header of their instruction set.
+
+namespace libobsensor {
+
+// The kernel enums of the filters (AlignKernel, ...) list their kernels in this order, so a kernel converts to its instruction set
+typedef enum {
+    SIMD_ISA_SCALAR,
+    SIMD_ISA_SSE,     // SSE2 on x86, SSE2NEON on 32-bit ARM
+    SIMD_ISA_AVX2,    // AVX2, FMA and F16C, x86-64 only
+    SIMD_ISA_AVX512,  // AVX-512 F/BW/DQ/VL, x86-64 only
+    SIMD_ISA_NEON,    // 64-bit ARM only
+    SIMD_ISA_COUNT,
+} SimdIsa;
+
+// Whether the kernels of the instruction set are built and the cpu supports them
+bool isSimdIsaAvailable(SimdIsa isa);
+
+// The entries of the kernel tables of getSimdKernel(), nullptr for the kernels not built
+#ifdef OB_BUILD_AVX2_KERNELS
+#define SIMD_KERNEL_AVX2(kernel) kernel
+#else
+#define SIMD_KERNEL_AVX2(kernel) nullptr
+#endif
+#ifdef OB_BUILD_AVX512_KERNELS
+#define SIMD_KERNEL_AVX512(kernel) kernel
+#else
+#define SIMD_KERNEL_AVX512(kernel) nullptr
+#endif
+#if defined(__aarch64__)
+#define SIMD_KERNEL_NEON(kernel) kernel
+#else
+#define SIMD_KERNEL_NEON(kernel) nullptr
+#endif
+
+// The entry of kernel in a table of the kernels of each instruction set, nullptr if it is not built or the cpu does not support it
+template <typename Func, typename Kernel> Func getSimdKernel(const Func (&kernels)[SIMD_ISA_COUNT], Kernel kernel) {
+    int isa = static_cast<int>(kernel);
+    if(isa < 0 || isa >= SIMD_ISA_COUNT || !isSimdIsaAvailable(static_cast<SimdIsa>(isa))) {
+        return nullptr;
+    }
+    return kernels[isa];
+}
+
+// Calls setKernel with the kernels from the widest instruction set down to SSE until it returns true, i.e. sets the widest kernel the cpu supports
+template <typename Kernel, typename SetKernel> void setWidestSimdKernel(SetKernel setKernel) {
+    const SimdIsa isas[] = { SIMD_ISA_NEON, SIMD_ISA_AVX512, SIMD_ISA_AVX2, SIMD_ISA_SSE };
+    for(auto isa: isas) {
+        if(setKernel(static_cast<Kernel>(isa))) {
+            break;
+        }
+    }
+}
+
+namespace {
+
+// float to IEEE 754 half float, rounded to nearest even as the F16C and NEON conversions
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign     = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t abs_bits = bits & 0x7fffffff;
+
+    if(abs_bits > 0x7f800000) {
+        return sign | 0x7e00;  // NAN
+    }
+    if(abs_bits >= 0x47800000) {
+        return sign | 0x7c00;  // 65536 and above (and infinity) overflow
+    }
+    if(abs_bits < 0x33000000) {
+        return sign;  // below half the smallest subnormal
+    }
+
+    uint32_t exponent = abs_bits >> 23;
+    uint32_t result, remainder, halfway;
+    if(exponent < 113) {
+        // subnormal: the mantissa with its implicit bit in units of 2^-24
+        uint32_t mantissa = (abs_bits & 0x7fffff) | 0x800000;
+        uint32_t shift    = 126 - exponent;
+        result            = mantissa >> shift;
+        remainder         = mantissa & ((1u << shift) - 1);
+        halfway           = 1u << (shift - 1);
+    }
+    else {
+        result    = ((exponent - 112) << 10) | ((abs_bits >> 13) & 0x3ff);
+        remainder = abs_bits & 0x1fff;
+        halfway   = 0x1000;
+    }
+    // a carry out of the mantissa increments the exponent, up to infinity
+    if(remainder > halfway || (remainder == halfway && (result & 1))) {
+        result++;
+    }
+    return static_cast<uint16_t>(sign | result);
+}
+
+}  // namespace
+
+}  // namespace libobsensor
@@ -0,0 +1,185 @@
+#pragma once
+#include <stdint.h>
+
+// The vector types of the AVX2 kernels, see SimdKernel.hpp: AVX2, FMA and F16C, only included by the translation units built with their flags
+#include <immintrin.h>
+
+namespace libobsensor {
+namespace {
+
+// float vectors F of WIDTH lanes and their masks M
+struct Avx2FloatVector {
+    typedef __m256 F;
+    typedef __m256 M;
+    static const int WIDTH = 8;
+
+    static F set1(float v) {
+        return _mm256_set1_ps(v);
+    }
+    static F ramp(float v) {
+        return _mm256_add_ps(_mm256_set1_ps(v), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+    }
+    static F loadDepth(const uint16_t *p) {
+        return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+    }
+    static F load(const float *p) {
+        return _mm256_loadu_ps(p);
+    }
+    static void loadDeinterleave(const float *p, F &even, F &odd) {
+        F lo = _mm256_loadu_ps(p);
+        F hi = _mm256_loadu_ps(p + 8);
+        // the shuffles work on 128-bit lanes: a0 a2 b0 b2 | a4 a6 b4 b6, then reorder the 64-bit pairs
+        F e  = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        F o  = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+        even = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(e), _MM_SHUFFLE(3, 1, 2, 0)));
+        odd  = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(o), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    static void store(float *p, F v) {
+        _mm256_storeu_ps(p, v);
+    }
+    static void storeInt16(int16_t *p, F v) {
+        __m256i i = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1)));
+    }
+    static void storeHalf(uint16_t *p, F v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+    static F add(F a, F b) {
+        return _mm256_add_ps(a, b);
+    }
+    static F sub(F a, F b) {
+        return _mm256_sub_ps(a, b);
+    }
+    static F mul(F a, F b) {
+        return _mm256_mul_ps(a, b);
+    }
+    static F div(F a, F b) {
+        return _mm256_div_ps(a, b);
+    }
+    static F sqrt(F a) {
+        return _mm256_sqrt_ps(a);
+    }
+    static F madd(F a, F b, F c) {
+        return _mm256_fmadd_ps(a, b, c);
+    }
+    static M eq(F a, F b) {
+        return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+    }
+    static M lt(F a, F b) {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+    static M gt(F a, F b) {
+        return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+    }
+    static M maskAnd(M a, M b) {
+        return _mm256_and_ps(a, b);
+    }
+    static F select(M m, F a, F b) {
+        return _mm256_blendv_ps(b, a, m);
+    }
+};
+
+// uint16_t vectors U of WIDTH lanes and their masks M
+struct Avx2U16Vector {
+    typedef __m256i U;
+    typedef __m256i M;
+    static const int WIDTH = 16;
+
+    static U min(U a, U b) {
+        return _mm256_min_epu16(a, b);
+    }
+    static U max(U a, U b) {
+        return _mm256_max_epu16(a, b);
+    }
+    static void store(uint16_t *p, U v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    }
+    static U set1(uint16_t v) {
+        return _mm256_set1_epi16(static_cast<short>(v));
+    }
+    static U load(const uint16_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static U loadWiden(const uint8_t *p) {
+        return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+    static U add(U a, U b) {
+        return _mm256_add_epi16(a, b);
+    }
+    static U sub(U a, U b) {
+        return _mm256_sub_epi16(a, b);
+    }
+    template <int N> static U shiftRight(U v) {
+        return _mm256_srli_epi16(v, N);
+    }
+    static M eq(U a, U b) {
+        return _mm256_cmpeq_epi16(a, b);
+    }
+    // signed, for the confidences of at most 255
+    static M greater(U a, U b) {
+        return _mm256_cmpgt_epi16(a, b);
+    }
+    static M maskOr(M a, M b) {
+        return _mm256_or_si256(a, b);
+    }
+    // ~a & b
+    static M maskAndNot(M a, M b) {
+        return _mm256_andnot_si256(a, b);
+    }
+    // m ? a : b
+    static U select(M m, U a, U b) {
+        return _mm256_blendv_epi8(b, a, m);
+    }
+    static uint32_t zeroLanes(U v) {
+        // the pack of the 128-bit lanes leaves the bits of lanes 0-7 in bits 0-7, and of lanes 8-15 in bits 16-23
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_packs_epi16(_mm256_cmpeq_epi16(v, _mm256_setzero_si256()), _mm256_setzero_si256())));
+        return (bits & 0xff) | ((bits >> 8) & 0xff00);
+    }
+    // the even and odd pixels of 2 * WIDTH pixels, the packs of the 128-bit lanes put back in order
+    static void load2(const uint16_t *p, U &c0, U &c1) {
+        const __m256i low = _mm256_set1_epi32(0xffff);
+        __m256i       lo  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i       hi  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 16));
+        c0 = _mm256_permute4x64_epi64(_mm256_packus_epi32(_mm256_and_si256(lo, low), _mm256_and_si256(hi, low)), 0xd8);
+        c1 = _mm256_permute4x64_epi64(_mm256_packus_epi32(_mm256_srli_epi32(lo, 16), _mm256_srli_epi32(hi, 16)), 0xd8);
+    }
+    // every third pixel of 3 * WIDTH pixels, from pixel 0, 1 and 2: the 24 pixels of 8 outputs in each 128-bit lane of a, b and c, picked by byte
+    // shuffles
+    static void load3(const uint16_t *p, U &c0, U &c1, U &c2) {
+        static const Stride3Shuffles shuffles;
+        const __m256i                regs[3] = { load2x128(p, p + 24), load2x128(p + 8, p + 32), load2x128(p + 16, p + 40) };
+        U                           *c[3]    = { &c0, &c1, &c2 };
+        for(int k = 0; k < 3; k++) {
+            __m256i result = _mm256_setzero_si256();
+            for(int r = 0; r < 3; r++) {
+                __m256i mask = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffles.bytes[k][r])));
+                result       = _mm256_or_si256(result, _mm256_shuffle_epi8(regs[r], mask));
+            }
+            *c[k] = result;
+        }
+    }
+    static __m256i load2x128(const uint16_t *lo, const uint16_t *hi) {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo))),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi)), 1);
+    }
+
+    // bytes[k][r]: the bytes of register r holding the pixels 3 * i + k, at the bytes of output i; -1 (zero) for the others
+    struct Stride3Shuffles {
+        int8_t bytes[3][3][16];
+        Stride3Shuffles() {
+            for(int k = 0; k < 3; k++) {
+                for(int r = 0; r < 3; r++) {
+                    for(int i = 0; i < 8; i++) {
+                        int  pixel             = 3 * i + k;
+                        bool here              = pixel / 8 == r;
+                        bytes[k][r][2 * i]     = static_cast<int8_t>(here ? 2 * (pixel % 8) : -1);
+                        bytes[k][r][2 * i + 1] = static_cast<int8_t>(here ? 2 * (pixel % 8) + 1 : -1);
+                    }
+                }
+            }
+        }
+    };
+};
+
+}  // namespace
+}  // namespace libobsensor
@@ -0,0 +1,183 @@
+#pragma once
+#include <stdint.h>
+
+// The vector types of the AVX-512 kernels, see SimdKernel.hpp: AVX-512 F/BW/DQ/VL, only included by the translation units built with their flags
+
+// GCC 12 takes the _mm512_undefined_*() pass-through operand of the AVX-512 intrinsics for an uninitialized variable once they are inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace libobsensor {
+namespace {
+
+// float vectors F of WIDTH lanes and their masks M
+struct Avx512FloatVector {
+    typedef __m512    F;
+    typedef __mmask16 M;
+    static const int WIDTH = 16;
+
+    static F set1(float v) {
+        return _mm512_set1_ps(v);
+    }
+    static F ramp(float v) {
+        return _mm512_add_ps(_mm512_set1_ps(v), _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f,
+                                                               14.0f, 15.0f));
+    }
+    static F loadDepth(const uint16_t *p) {
+        return _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))));
+    }
+    static F load(const float *p) {
+        return _mm512_loadu_ps(p);
+    }
+    static void loadDeinterleave(const float *p, F &even, F &odd) {
+        F lo = _mm512_loadu_ps(p);
+        F hi = _mm512_loadu_ps(p + 16);
+        even = _mm512_permutex2var_ps(lo, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30), hi);
+        odd  = _mm512_permutex2var_ps(lo, _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31), hi);
+    }
+    static void store(float *p, F v) {
+        _mm512_storeu_ps(p, v);
+    }
+    static void storeInt16(int16_t *p, F v) {
+        __m512i i = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(v, _mm512_set1_ps(-32768.0f)), _mm512_set1_ps(32767.0f)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm512_cvtsepi32_epi16(i));
+    }
+    static void storeHalf(uint16_t *p, F v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+    static F add(F a, F b) {
+        return _mm512_add_ps(a, b);
+    }
+    static F sub(F a, F b) {
+        return _mm512_sub_ps(a, b);
+    }
+    static F mul(F a, F b) {
+        return _mm512_mul_ps(a, b);
+    }
+    static F div(F a, F b) {
+        return _mm512_div_ps(a, b);
+    }
+    static F sqrt(F a) {
+        return _mm512_sqrt_ps(a);
+    }
+    static F madd(F a, F b, F c) {
+        return _mm512_fmadd_ps(a, b, c);
+    }
+    static M eq(F a, F b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+    }
+    static M lt(F a, F b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+    }
+    static M gt(F a, F b) {
+        return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ);
+    }
+    static M maskAnd(M a, M b) {
+        return static_cast<M>(a & b);
+    }
+    static F select(M m, F a, F b) {
+        return _mm512_mask_blend_ps(m, b, a);
+    }
+};
+
+// uint16_t vectors U of WIDTH lanes and their masks M
+struct Avx512U16Vector {
+    typedef __m512i U;
+    typedef __mmask32 M;
+    static const int WIDTH = 32;
+
+    static U min(U a, U b) {
+        return _mm512_min_epu16(a, b);
+    }
+    static U max(U a, U b) {
+        return _mm512_max_epu16(a, b);
+    }
+    static void store(uint16_t *p, U v) {
+        _mm512_storeu_si512(p, v);
+    }
+    static U set1(uint16_t v) {
+        return _mm512_set1_epi16(static_cast<short>(v));
+    }
+    static U load(const uint16_t *p) {
+        return _mm512_loadu_si512(p);
+    }
+    static U loadWiden(const uint8_t *p) {
+        return _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+    }
+    static U add(U a, U b) {
+        return _mm512_add_epi16(a, b);
+    }
+    static U sub(U a, U b) {
+        return _mm512_sub_epi16(a, b);
+    }
+    template <int N> static U shiftRight(U v) {
+        return _mm512_srli_epi16(v, N);
+    }
+    static M eq(U a, U b) {
+        return _mm512_cmpeq_epi16_mask(a, b);
+    }
+    static M greater(U a, U b) {
+        return _mm512_cmpgt_epu16_mask(a, b);
+    }
+    static M maskOr(M a, M b) {
+        return a | b;
+    }
+    // ~a & b
+    static M maskAndNot(M a, M b) {
+        return ~a & b;
+    }
+    // m ? a : b
+    static U select(M m, U a, U b) {
+        return _mm512_mask_blend_epi16(m, b, a);
+    }
+    static uint32_t zeroLanes(U v) {
+        return static_cast<uint32_t>(_mm512_cmpeq_epi16_mask(v, _mm512_setzero_si512()));
+    }
+    // the even and odd pixels of 2 * WIDTH pixels
+    static void load2(const uint16_t *p, U &c0, U &c1) {
+        static const StrideIndices indices;
+        __m512i                    lo = _mm512_loadu_si512(p);
+        __m512i                    hi = _mm512_loadu_si512(p + 32);
+        c0                            = _mm512_permutex2var_epi16(lo, _mm512_loadu_si512(indices.stride2[0]), hi);
+        c1                            = _mm512_permutex2var_epi16(lo, _mm512_loadu_si512(indices.stride2[1]), hi);
+    }
+    // every third pixel of 3 * WIDTH pixels, from pixel 0, 1 and 2: the ones of the first 64 pixels, then the ones of the last 32
+    static void load3(const uint16_t *p, U &c0, U &c1, U &c2) {
+        static const StrideIndices indices;
+        __m512i                    a    = _mm512_loadu_si512(p);
+        __m512i                    b    = _mm512_loadu_si512(p + 32);
+        __m512i                    c    = _mm512_loadu_si512(p + 64);
+        U                         *r[3] = { &c0, &c1, &c2 };
+        for(int k = 0; k < 3; k++) {
+            __m512i first = _mm512_permutex2var_epi16(a, _mm512_loadu_si512(indices.stride3[k][0]), b);
+            *r[k]         = _mm512_permutex2var_epi16(first, _mm512_loadu_si512(indices.stride3[k][1]), c);
+        }
+    }
+
+    // the indices of the permutations of two registers: 0-31 for the lanes of the first one, 32-63 for the lanes of the second one
+    struct StrideIndices {
+        uint16_t stride2[2][32];
+        uint16_t stride3[3][2][32];
+        StrideIndices() {
+            for(int i = 0; i < 32; i++) {
+                for(int k = 0; k < 2; k++) {
+                    stride2[k][i] = static_cast<uint16_t>(2 * i + k);
+                }
+                for(int k = 0; k < 3; k++) {
+                    int pixel        = 3 * i + k;
+                    stride3[k][0][i] = static_cast<uint16_t>(pixel < 64 ? pixel : 0);
+                    stride3[k][1][i] = static_cast<uint16_t>(pixel < 64 ? i : pixel - 32);
+                }
+            }
+        }
+    };
+};
+
+}  // namespace
+}  // namespace libobsensor
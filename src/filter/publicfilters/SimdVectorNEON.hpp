@@ -0,0 +1,147 @@
+#pragma once
+#include <stdint.h>
+
+// The vector types of the NEON kernels, see SimdKernel.hpp: NEON is part of the 64-bit ARM baseline, 32-bit ARM uses the SSE kernels through SSE2NEON
+#include <arm_neon.h>
+
+namespace libobsensor {
+namespace {
+
+// float vectors F of WIDTH lanes and their masks M
+struct NeonFloatVector {
+    typedef float32x4_t F;
+    typedef uint32x4_t  M;
+    static const int WIDTH = 4;
+
+    static F set1(float v) {
+        return vdupq_n_f32(v);
+    }
+    static F ramp(float v) {
+        static const float offsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        return vaddq_f32(vdupq_n_f32(v), vld1q_f32(offsets));
+    }
+    static F loadDepth(const uint16_t *p) {
+        return vcvtq_f32_u32(vmovl_u16(vld1_u16(p)));
+    }
+    static F load(const float *p) {
+        return vld1q_f32(p);
+    }
+    static void loadDeinterleave(const float *p, F &even, F &odd) {
+        float32x4x2_t v = vld2q_f32(p);
+        even            = v.val[0];
+        odd             = v.val[1];
+    }
+    static void store(float *p, F v) {
+        vst1q_f32(p, v);
+    }
+    static void storeInt16(int16_t *p, F v) {
+        vst1_s16(p, vqmovn_s32(vcvtnq_s32_f32(vminq_f32(vmaxq_f32(v, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f)))));
+    }
+    static void storeHalf(uint16_t *p, F v) {
+        vst1_u16(p, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+    }
+    static F add(F a, F b) {
+        return vaddq_f32(a, b);
+    }
+    static F sub(F a, F b) {
+        return vsubq_f32(a, b);
+    }
+    static F mul(F a, F b) {
+        return vmulq_f32(a, b);
+    }
+    static F div(F a, F b) {
+        return vdivq_f32(a, b);
+    }
+    static F sqrt(F a) {
+        return vsqrtq_f32(a);
+    }
+    static F madd(F a, F b, F c) {
+        return vfmaq_f32(c, a, b);
+    }
+    static M eq(F a, F b) {
+        return vceqq_f32(a, b);
+    }
+    static M lt(F a, F b) {
+        return vcltq_f32(a, b);
+    }
+    static M gt(F a, F b) {
+        return vcgtq_f32(a, b);
+    }
+    static M maskAnd(M a, M b) {
+        return vandq_u32(a, b);
+    }
+    static F select(M m, F a, F b) {
+        return vbslq_f32(m, a, b);
+    }
+};
+
+// uint16_t vectors U of WIDTH lanes and their masks M
+struct NeonU16Vector {
+    typedef uint16x8_t U;
+    typedef uint16x8_t M;
+    static const int WIDTH = 8;
+
+    static U min(U a, U b) {
+        return vminq_u16(a, b);
+    }
+    static U max(U a, U b) {
+        return vmaxq_u16(a, b);
+    }
+    static void store(uint16_t *p, U v) {
+        vst1q_u16(p, v);
+    }
+    static U set1(uint16_t v) {
+        return vdupq_n_u16(v);
+    }
+    static U load(const uint16_t *p) {
+        return vld1q_u16(p);
+    }
+    static U loadWiden(const uint8_t *p) {
+        return vmovl_u8(vld1_u8(p));
+    }
+    static U add(U a, U b) {
+        return vaddq_u16(a, b);
+    }
+    static U sub(U a, U b) {
+        return vsubq_u16(a, b);
+    }
+    template <int N> static U shiftRight(U v) {
+        return vshrq_n_u16(v, N);
+    }
+    static M eq(U a, U b) {
+        return vceqq_u16(a, b);
+    }
+    static M greater(U a, U b) {
+        return vcgtq_u16(a, b);
+    }
+    static M maskOr(M a, M b) {
+        return vorrq_u16(a, b);
+    }
+    // ~a & b
+    static M maskAndNot(M a, M b) {
+        return vbicq_u16(b, a);
+    }
+    // m ? a : b
+    static U select(M m, U a, U b) {
+        return vbslq_u16(m, a, b);
+    }
+    static uint32_t zeroLanes(U v) {
+        static const uint16_t bits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+        return vaddvq_u16(vandq_u16(vceqq_u16(v, vdupq_n_u16(0)), vld1q_u16(bits)));
+    }
+    // the structure loads deinterleave the pixels
+    static void load2(const uint16_t *p, U &c0, U &c1) {
+        uint16x8x2_t v = vld2q_u16(p);
+        c0             = v.val[0];
+        c1             = v.val[1];
+    }
+    static void load3(const uint16_t *p, U &c0, U &c1, U &c2) {
+        uint16x8x3_t v = vld3q_u16(p);
+        c0             = v.val[0];
+        c1             = v.val[1];
+        c2             = v.val[2];
+    }
+};
+
+}  // namespace
+}  // namespace libobsensor
@@ -0,0 +1,167 @@
+#pragma once
+#include "SimdKernel.hpp"
+#include <stdint.h>
+
+// The vector types of the SSE kernels, see SimdKernel.hpp: SSE2 on x86, SSE2NEON on 32-bit ARM
+
+#if(defined(__ARM_NEON__) || defined(__aarch64__) || defined(__arm__))
+#include "SSE2NEON.h"
+#else
+#include <emmintrin.h>
+#endif
+
+namespace libobsensor {
+namespace {
+
+// float vectors F of WIDTH lanes and their masks M
+struct SseFloatVector {
+    typedef __m128 F;
+    typedef __m128 M;
+    static const int WIDTH = 4;
+
+    static F set1(float v) {
+        return _mm_set_ps1(v);
+    }
+    static F ramp(float v) {
+        return _mm_add_ps(_mm_set_ps1(v), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+    }
+    static F loadDepth(const uint16_t *p) {
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128()));
+    }
+    static F load(const float *p) {
+        return _mm_loadu_ps(p);
+    }
+    static void loadDeinterleave(const float *p, F &even, F &odd) {
+        F lo = _mm_loadu_ps(p);
+        F hi = _mm_loadu_ps(p + 4);
+        even = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+        odd  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static void store(float *p, F v) {
+        _mm_storeu_ps(p, v);
+    }
+    static void storeInt16(int16_t *p, F v) {
+        __m128i i = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, _mm_set_ps1(-32768.0f)), _mm_set_ps1(32767.0f)));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(i, i));
+    }
+    static void storeHalf(uint16_t *p, F v) {
+        // no conversion instruction in SSE2
+        float values[4];
+        _mm_storeu_ps(values, v);
+        for(int i = 0; i < 4; i++) {
+            p[i] = floatToHalf(values[i]);
+        }
+    }
+    static F add(F a, F b) {
+        return _mm_add_ps(a, b);
+    }
+    static F sub(F a, F b) {
+        return _mm_sub_ps(a, b);
+    }
+    static F mul(F a, F b) {
+        return _mm_mul_ps(a, b);
+    }
+    static F div(F a, F b) {
+        return _mm_div_ps(a, b);
+    }
+    static F sqrt(F a) {
+        return _mm_sqrt_ps(a);
+    }
+    // a * b + c, rounded twice as there is no FMA
+    static F madd(F a, F b, F c) {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+    static M eq(F a, F b) {
+        return _mm_cmpeq_ps(a, b);
+    }
+    static M lt(F a, F b) {
+        return _mm_cmplt_ps(a, b);
+    }
+    static M gt(F a, F b) {
+        return _mm_cmpgt_ps(a, b);
+    }
+    static M maskAnd(M a, M b) {
+        return _mm_and_ps(a, b);
+    }
+    static F select(M m, F a, F b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+};
+
+// uint16_t vectors U of WIDTH lanes and their masks M
+struct SseU16Vector {
+    typedef __m128i U;
+    typedef __m128i M;
+    static const int WIDTH = 8;
+
+    // the unsigned min and max of SSE4.1, by a saturated subtraction
+    static U min(U a, U b) {
+        return _mm_sub_epi16(a, _mm_subs_epu16(a, b));
+    }
+    static U max(U a, U b) {
+        return _mm_add_epi16(b, _mm_subs_epu16(a, b));
+    }
+    static void store(uint16_t *p, U v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    }
+    static U set1(uint16_t v) {
+        return _mm_set1_epi16(static_cast<short>(v));
+    }
+    static U load(const uint16_t *p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+    static U loadWiden(const uint8_t *p) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)), _mm_setzero_si128());
+    }
+    static U add(U a, U b) {
+        return _mm_add_epi16(a, b);
+    }
+    static U sub(U a, U b) {
+        return _mm_sub_epi16(a, b);
+    }
+    template <int N> static U shiftRight(U v) {
+        return _mm_srli_epi16(v, N);
+    }
+    static M eq(U a, U b) {
+        return _mm_cmpeq_epi16(a, b);
+    }
+    // signed, for the confidences of at most 255
+    static M greater(U a, U b) {
+        return _mm_cmpgt_epi16(a, b);
+    }
+    static M maskOr(M a, M b) {
+        return _mm_or_si128(a, b);
+    }
+    // ~a & b
+    static M maskAndNot(M a, M b) {
+        return _mm_andnot_si128(a, b);
+    }
+    // m ? a : b
+    static U select(M m, U a, U b) {
+        return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+    }
+    static uint32_t zeroLanes(U v) {
+        __m128i zero = _mm_setzero_si128();
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(v, zero), zero)));
+    }
+    // the even and odd pixels of 2 * WIDTH pixels; sign extended so the signed saturation of the pack keeps them
+    static void load2(const uint16_t *p, U &c0, U &c1) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 8));
+        c0         = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+        c1         = _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+    }
+    // every third pixel of 3 * WIDTH pixels, from pixel 0, 1 and 2
+    static void load3(const uint16_t *p, U &c0, U &c1, U &c2) {
+        c0 = set(p[0], p[3], p[6], p[9], p[12], p[15], p[18], p[21]);
+        c1 = set(p[1], p[4], p[7], p[10], p[13], p[16], p[19], p[22]);
+        c2 = set(p[2], p[5], p[8], p[11], p[14], p[17], p[20], p[23]);
+    }
+    static U set(uint16_t v0, uint16_t v1, uint16_t v2, uint16_t v3, uint16_t v4, uint16_t v5, uint16_t v6, uint16_t v7) {
+        return _mm_setr_epi16(static_cast<short>(v0), static_cast<short>(v1), static_cast<short>(v2), static_cast<short>(v3), static_cast<short>(v4),
+                              static_cast<short>(v5), static_cast<short>(v6), static_cast<short>(v7));
+    }
+};
+
+}  // namespace
+}  // namespace libobsensor
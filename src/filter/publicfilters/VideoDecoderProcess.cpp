@@ -0,0 +1,387 @@
+#include "VideoDecoderProcess.hpp"
+#include "exception/ObException.hpp"
+#include "logger/LoggerInterval.hpp"
+#include "frame/FrameFactory.hpp"
+#include "stream/StreamProfile.hpp"
+#include "environment/EnvConfig.hpp"
+#include "libobsensor/h/ObTypes.h"
+#include <dylib.hpp>
+#include <libyuv.h>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/error.h>
+#include <libavutil/frame.h>
+#include <libavutil/opt.h>
+}
+
+namespace libobsensor {
+
+// Far more than the frames a frame threaded decoder holds (thread count + 1)
+static const size_t MAX_PENDING_FRAME_COUNT = 64;
+
+// The FFmpeg functions used by the decoder, resolved from the libraries found at runtime.
+// Only libraries with the major version of the bundled headers are loaded, as the structs are accessed directly.
+class FFmpegLibrary {
+public:
+    static std::shared_ptr<FFmpegLibrary> getInstance();
+
+    unsigned (*avcodec_version)(void);
+    AVCodec *(*avcodec_find_decoder)(enum AVCodecID id);
+    AVCodecContext *(*avcodec_alloc_context3)(const AVCodec *codec);
+    int (*avcodec_open2)(AVCodecContext *avctx, const AVCodec *codec, AVDictionary **options);
+    void (*avcodec_free_context)(AVCodecContext **avctx);
+    int (*avcodec_send_packet)(AVCodecContext *avctx, const AVPacket *avpkt);
+    int (*avcodec_receive_frame)(AVCodecContext *avctx, AVFrame *frame);
+    AVPacket *(*av_packet_alloc)(void);
+    void (*av_packet_free)(AVPacket **pkt);
+    AVFrame *(*av_frame_alloc)(void);
+    void (*av_frame_free)(AVFrame **frame);
+    void (*av_frame_unref)(AVFrame *frame);
+    int (*av_opt_set_int)(void *obj, const char *name, int64_t val, int search_flags);
+
+private:
+    FFmpegLibrary();
+    std::shared_ptr<dylib> loadLibrary(const std::string &name, int major);
+
+private:
+    std::shared_ptr<dylib> avutil_;
+    std::shared_ptr<dylib> avcodec_;
+};
+
+std::shared_ptr<dylib> FFmpegLibrary::loadLibrary(const std::string &name, int major) {
+    // Versioned name first, the unversioned one is only installed with the development package
+#if(defined(WIN32) || defined(_WIN32) || defined(WINCE))
+    std::vector<std::string> fileNames = { name + "-" + std::to_string(major) + ".dll" };
+#elif defined(__APPLE__)
+    std::vector<std::string> fileNames = { "lib" + name + "." + std::to_string(major) + ".dylib", "lib" + name + ".dylib" };
+#else
+    std::vector<std::string> fileNames = { "lib" + name + ".so." + std::to_string(major), "lib" + name + ".so" };
+#endif
+    std::vector<std::string> dirs = { EnvConfig::getExtensionsDirectory() + "/ffmpeg/", "" };
+    for(auto &dir: dirs) {
+        for(auto &fileName: fileNames) {
+            try {
+                return std::make_shared<dylib>(dir, fileName, dylib::no_filename_decorations);
+            }
+            catch(const dylib::exception &e) {
+                LOG_DEBUG("Load {}{} failed: {}", dir, fileName, e.what());
+            }
+        }
+    }
+    throw std::runtime_error("FFmpeg library " + name + " not found");
+}
+
+FFmpegLibrary::FFmpegLibrary() {
+    // libavcodec depends on libavutil, load it first so libavcodec finds it in the extensions directory too
+    avutil_  = loadLibrary("avutil", LIBAVUTIL_VERSION_MAJOR);
+    avcodec_ = loadLibrary("avcodec", LIBAVCODEC_VERSION_MAJOR);
+
+    avcodec_version = avcodec_->get_function<unsigned(void)>("avcodec_version");
+    if(AV_VERSION_MAJOR(avcodec_version()) != LIBAVCODEC_VERSION_MAJOR) {
+        throw std::runtime_error("FFmpeg libavcodec version " + std::to_string(AV_VERSION_MAJOR(avcodec_version())) + " not supported, version "
+                                 + std::to_string(LIBAVCODEC_VERSION_MAJOR) + " is required");
+    }
+
+    avcodec_find_decoder   = avcodec_->get_function<AVCodec *(enum AVCodecID)>("avcodec_find_decoder");
+    avcodec_alloc_context3 = avcodec_->get_function<AVCodecContext *(const AVCodec *)>("avcodec_alloc_context3");
+    avcodec_open2          = avcodec_->get_function<int(AVCodecContext *, const AVCodec *, AVDictionary **)>("avcodec_open2");
+    avcodec_free_context   = avcodec_->get_function<void(AVCodecContext **)>("avcodec_free_context");
+    avcodec_send_packet    = avcodec_->get_function<int(AVCodecContext *, const AVPacket *)>("avcodec_send_packet");
+    avcodec_receive_frame  = avcodec_->get_function<int(AVCodecContext *, AVFrame *)>("avcodec_receive_frame");
+    av_packet_alloc        = avcodec_->get_function<AVPacket *(void)>("av_packet_alloc");
+    av_packet_free         = avcodec_->get_function<void(AVPacket **)>("av_packet_free");
+    av_frame_alloc         = avutil_->get_function<AVFrame *(void)>("av_frame_alloc");
+    av_frame_free          = avutil_->get_function<void(AVFrame **)>("av_frame_free");
+    av_frame_unref         = avutil_->get_function<void(AVFrame *)>("av_frame_unref");
+    av_opt_set_int         = avutil_->get_function<int(void *, const char *, int64_t, int)>("av_opt_set_int");
+}
+
+std::shared_ptr<FFmpegLibrary> FFmpegLibrary::getInstance() {
+    static std::mutex                   instanceMutex;
+    static std::weak_ptr<FFmpegLibrary> instanceWeakPtr;
+    static bool                         loadFailed = false;  // do not search the libraries again for every stream once they were not found
+
+    std::unique_lock<std::mutex> lock(instanceMutex);
+    auto                         instance = instanceWeakPtr.lock();
+    if(!instance && !loadFailed) {
+        // FFmpeg is optional, so its absence is only logged for debugging
+        try {
+            instance        = std::shared_ptr<FFmpegLibrary>(new FFmpegLibrary());
+            instanceWeakPtr = instance;
+        }
+        catch(const std::exception &e) {
+            LOG_DEBUG("FFmpeg is not available, H.264/H.265 streams will not be decoded: {}", e.what());
+            loadFailed = true;
+        }
+    }
+    return instance;
+}
+
+VideoDecoder::VideoDecoder() : outputFormat_(OB_FORMAT_RGB), threadCount_(0) {
+    EnvConfig::getInstance()->getIntValue("Misc.VideoDecodeThreadCount", threadCount_);
+}
+
+VideoDecoder::~VideoDecoder() noexcept {
+    closeDecoder();
+}
+
+bool VideoDecoder::isAvailable() {
+    return FFmpegLibrary::getInstance() != nullptr;
+}
+
+void VideoDecoder::updateConfig(std::vector<std::string> &params) {
+    if(params.size() != 2) {
+        throw invalid_value_exception("VideoDecoder config error: params size not match");
+    }
+    try {
+        int outputFormat = std::stoi(params[0]);
+        int threadCount  = std::stoi(params[1]);
+        if(threadCount < 0) {
+            throw invalid_value_exception("VideoDecoder config error: threadCount must not be negative");
+        }
+        setOutputFormat(static_cast<OBFormat>(outputFormat));
+        if(threadCount != threadCount_) {
+            threadCount_ = threadCount;
+            closeDecoder();  // the thread count only applies when the decoder is opened
+        }
+    }
+    catch(const std::exception &e) {
+        throw invalid_value_exception("VideoDecoder config error: " + std::string(e.what()));
+    }
+}
+
+const std::string &VideoDecoder::getConfigSchema() const {
+    // csv format: name，type， min，max，step，default，description
+    static const std::string schema = "outputFormat, int, 3, 25, 1, 22, decoded frame format: NV12(3)/I420(15)/RGB(22)/BGR(23)/BGRA(25)\n"
+                                      "threadCount, int, 0, 16, 1, 0, decode thread count (0 for one thread per cpu core)";
+    return schema;
+}
+
+void VideoDecoder::setOutputFormat(OBFormat format) {
+    if(format != OB_FORMAT_NV12 && format != OB_FORMAT_I420 && format != OB_FORMAT_RGB && format != OB_FORMAT_BGR && format != OB_FORMAT_BGRA) {
+        throw invalid_value_exception("VideoDecoder config error: unsupported output format");
+    }
+    if(format != outputFormat_) {
+        outputFormat_ = format;
+        tarStreamProfile_.reset();
+    }
+}
+
+void VideoDecoder::reset() {
+    closeDecoder();
+    decodedFrames_.clear();
+    buffering_ = false;
+    currentStreamProfile_.reset();
+    tarStreamProfile_.reset();
+}
+
+void VideoDecoder::openDecoder(OBFormat codecFormat) {
+    if(!ffmpeg_) {
+        ffmpeg_ = FFmpegLibrary::getInstance();
+        if(!ffmpeg_) {
+            throw unsupported_operation_exception("VideoDecoder: FFmpeg libraries not found");
+        }
+    }
+
+    auto codec = ffmpeg_->avcodec_find_decoder(codecFormat == OB_FORMAT_H264 ? AV_CODEC_ID_H264 : AV_CODEC_ID_HEVC);
+    if(!codec) {
+        throw unsupported_operation_exception("VideoDecoder: FFmpeg has no decoder for format " + std::to_string(codecFormat));
+    }
+    codecContext_ = ffmpeg_->avcodec_alloc_context3(codec);
+    packet_       = ffmpeg_->av_packet_alloc();
+    decodedFrame_ = ffmpeg_->av_frame_alloc();
+    if(!codecContext_ || !packet_ || !decodedFrame_) {
+        closeDecoder();
+        throw memory_exception("VideoDecoder: alloc decoder failed");
+    }
+
+    // Decode consecutive frames on their own threads. Slice threading would not help, the device encodes a single slice per frame.
+    ffmpeg_->av_opt_set_int(codecContext_, "threads", threadCount_, 0);
+    ffmpeg_->av_opt_set_int(codecContext_, "thread_type", FF_THREAD_FRAME, 0);
+    auto ret = ffmpeg_->avcodec_open2(codecContext_, codec, nullptr);
+    if(ret < 0) {
+        closeDecoder();
+        throw io_exception("VideoDecoder: open decoder failed, error " + std::to_string(ret));
+    }
+    codecFormat_ = codecFormat;
+    LOG_DEBUG("VideoDecoder: {} decoder opened, thread count: {}", codecFormat == OB_FORMAT_H264 ? "H.264" : "H.265", threadCount_);
+}
+
+void VideoDecoder::closeDecoder() {
+    if(ffmpeg_) {
+        if(codecContext_) {
+            ffmpeg_->avcodec_free_context(&codecContext_);
+        }
+        if(packet_) {
+            ffmpeg_->av_packet_free(&packet_);
+        }
+        if(decodedFrame_) {
+            ffmpeg_->av_frame_free(&decodedFrame_);
+        }
+    }
+    codecContext_ = nullptr;
+    packet_       = nullptr;
+    decodedFrame_ = nullptr;
+    codecFormat_  = OB_FORMAT_UNKNOWN;
+    pendingFrames_.clear();
+}
+
+std::shared_ptr<Frame> VideoDecoder::process(std::shared_ptr<const Frame> frame) {
+    buffering_ = false;
+    if(!frame) {
+        return nullptr;
+    }
+
+    auto format = frame->getFormat();
+    if(format == OB_FORMAT_HEVC) {
+        format = OB_FORMAT_H265;
+    }
+    if(format != OB_FORMAT_H264 && format != OB_FORMAT_H265) {
+        LOG_WARN_INTVL("VideoDecoder: unsupported frame format {}", format);
+        return nullptr;
+    }
+    if(format != codecFormat_) {
+        closeDecoder();
+        openDecoder(format);
+    }
+
+    // The decoder copies the bitstream, as the packet does not own it
+    packet_->data = const_cast<uint8_t *>(frame->getData());
+    packet_->size = static_cast<int>(frame->getDataSize());
+    packet_->pts  = sentFrameCount_;
+    auto ret      = ffmpeg_->avcodec_send_packet(codecContext_, packet_);
+    packet_->data = nullptr;
+    packet_->size = 0;
+    if(ret < 0) {
+        LOG_WARN_INTVL("VideoDecoder: decode frame failed, error {}", ret);
+        return nullptr;
+    }
+    pendingFrames_.emplace_back(sentFrameCount_++, frame);
+    if(pendingFrames_.size() > MAX_PENDING_FRAME_COUNT) {
+        pendingFrames_.pop_front();  // sent before the first key frame, or not decodable
+    }
+
+    // Once all decode threads are busy, every frame sent returns the oldest one
+    while((ret = ffmpeg_->avcodec_receive_frame(codecContext_, decodedFrame_)) >= 0) {
+        // Frames lost in decoding (corrupted bitstream) have no picture, skip their info
+        while(pendingFrames_.size() > 1 && pendingFrames_.front().first < decodedFrame_->pts) {
+            pendingFrames_.pop_front();
+        }
+        auto srcFrame = pendingFrames_.front().second;
+        pendingFrames_.pop_front();
+        auto outFrame = convertDecodedFrame(srcFrame);
+        ffmpeg_->av_frame_unref(decodedFrame_);
+        if(outFrame) {
+            decodedFrames_.push_back(outFrame);
+        }
+        if(pendingFrames_.empty()) {
+            break;
+        }
+    }
+    if(ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+        LOG_WARN_INTVL("VideoDecoder: decode frame failed, error {}", ret);
+        return popDecodedFrame();
+    }
+    auto outFrame = popDecodedFrame();
+    buffering_    = !outFrame && !pendingFrames_.empty();
+    return outFrame;
+}
+
+bool VideoDecoder::isBuffering() const {
+    return buffering_;
+}
+
+std::shared_ptr<Frame> VideoDecoder::popDecodedFrame() {
+    if(decodedFrames_.empty()) {
+        return nullptr;
+    }
+    auto frame = decodedFrames_.front();
+    decodedFrames_.pop_front();
+    return frame;
+}
+
+std::shared_ptr<Frame> VideoDecoder::convertDecodedFrame(std::shared_ptr<const Frame> srcFrame) {
+    if(decodedFrame_->format != AV_PIX_FMT_YUV420P && decodedFrame_->format != AV_PIX_FMT_YUVJ420P) {
+        LOG_WARN_INTVL("VideoDecoder: unsupported decoded pixel format {}", decodedFrame_->format);
+        return nullptr;
+    }
+
+    int      w           = decodedFrame_->width;
+    int      h           = decodedFrame_->height;
+    int      chromaW     = (w + 1) / 2;
+    int      chromaH     = (h + 1) / 2;
+    uint32_t dataSize    = 0;
+    switch(outputFormat_) {
+    case OB_FORMAT_NV12:
+    case OB_FORMAT_I420:
+        dataSize = w * h + chromaW * chromaH * 2;
+        break;
+    case OB_FORMAT_RGB:
+    case OB_FORMAT_BGR:
+        dataSize = w * h * 3;
+        break;
+    default:
+        dataSize = w * h * 4;
+        break;
+    }
+
+    auto tarFrame = FrameFactory::createFrame(srcFrame->getType(), outputFormat_, dataSize);
+    if(tarFrame == nullptr) {
+        LOG_ERROR_INTVL("Create frame by frame factory failed!");
+        return nullptr;
+    }
+
+    auto streamProfile = srcFrame->getStreamProfile();
+    if(!tarStreamProfile_ || currentStreamProfile_.get() != streamProfile.get()) {
+        currentStreamProfile_ = streamProfile;
+        tarStreamProfile_     = streamProfile->clone();
+        tarStreamProfile_->setFormat(outputFormat_);
+    }
+    tarFrame->copyInfoFromOther(srcFrame);
+
+    const uint8_t *srcY       = decodedFrame_->data[0];
+    const uint8_t *srcU       = decodedFrame_->data[1];
+    const uint8_t *srcV       = decodedFrame_->data[2];
+    int            strideY    = decodedFrame_->linesize[0];
+    int            strideU    = decodedFrame_->linesize[1];
+    int            strideV    = decodedFrame_->linesize[2];
+    bool           fullRange  = decodedFrame_->format == AV_PIX_FMT_YUVJ420P || decodedFrame_->color_range == AVCOL_RANGE_JPEG;
+    uint8_t       *dst        = tarFrame->getDataMutable();
+    switch(outputFormat_) {
+    case OB_FORMAT_NV12:
+        libyuv::I420ToNV12(srcY, strideY, srcU, strideU, srcV, strideV, dst, w, dst + w * h, chromaW * 2, w, h);
+        break;
+    case OB_FORMAT_I420:
+        libyuv::I420Copy(srcY, strideY, srcU, strideU, srcV, strideV, dst, w, dst + w * h, chromaW, dst + w * h + chromaW * chromaH, chromaW, w, h);
+        break;
+    // libyuv names the formats by their byte order in a little endian word: RAW is R,G,B in memory, RGB24 is B,G,R and ARGB is B,G,R,A
+    case OB_FORMAT_RGB:
+        (fullRange ? libyuv::J420ToRAW : libyuv::I420ToRAW)(srcY, strideY, srcU, strideU, srcV, strideV, dst, w * 3, w, h);
+        break;
+    case OB_FORMAT_BGR:
+        (fullRange ? libyuv::J420ToRGB24 : libyuv::I420ToRGB24)(srcY, strideY, srcU, strideU, srcV, strideV, dst, w * 3, w, h);
+        break;
+    default:
+        (fullRange ? libyuv::J420ToARGB : libyuv::I420ToARGB)(srcY, strideY, srcU, strideU, srcV, strideV, dst, w * 4, w, h);
+        break;
+    }
+
+    // The stream profile resolution is the one the device was asked for, the bitstream is the reference for the decoded picture.
+    // The frames already returned keep the profile they were created with, the next ones share a new one of the decoded size, which VideoSensor
+    // keeps on the frames it outputs.
+    auto videoStreamProfile = tarStreamProfile_->as<VideoStreamProfile>();
+    if(static_cast<int>(videoStreamProfile->getWidth()) != w || static_cast<int>(videoStreamProfile->getHeight()) != h) {
+        LOG_WARN_INTVL("VideoDecoder: decoded frame size {}x{} does not match the stream profile {}x{}", w, h, videoStreamProfile->getWidth(),
+                       videoStreamProfile->getHeight());
+        tarStreamProfile_  = tarStreamProfile_->clone();
+        videoStreamProfile = tarStreamProfile_->as<VideoStreamProfile>();
+        videoStreamProfile->setWidth(w);
+        videoStreamProfile->setHeight(h);
+    }
+    tarFrame->setStreamProfile(tarStreamProfile_);
+    return tarFrame;
+}
+
+}  // namespace libobsensor
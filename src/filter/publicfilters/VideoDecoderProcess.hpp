@@ -0,0 +1,70 @@
+#pragma once
+#include "IFilter.hpp"
+#include <deque>
+#include <memory>
+
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+
+namespace libobsensor {
+
+class FFmpegLibrary;
+
+// Decodes H.264/H.265 frames with the FFmpeg software decoder to RGB/BGR/BGRA/NV12/I420 frames.
+// FFmpeg is loaded at runtime from the extensions directory or the system, see isAvailable().
+//
+// The decoder context is kept from frame to frame, and decodes several frames in parallel (frame threading) on threadCount threads.
+// A frame threaded decoder returns each picture a few frames after its bitstream was sent, so process() returns nullptr for the first
+// frames of a stream, and the frames it returns later carry the info (timestamps, metadata, ...) of the bitstream frame they were decoded from.
+// Like the other filters, one instance must not be used by several threads at the same time.
+class VideoDecoder : public IFilterBase {
+public:
+    VideoDecoder();
+    virtual ~VideoDecoder() noexcept;
+
+    void                   updateConfig(std::vector<std::string> &params) override;
+    const std::string     &getConfigSchema() const override;
+    void                   reset() override;
+    std::shared_ptr<Frame> process(std::shared_ptr<const Frame> frame) override;
+
+    void setOutputFormat(OBFormat format);
+
+    // A packet may complete several pictures at once (e.g. when a decode thread catches up), process() returns the first of them and keeps the others,
+    // returning them first on its next calls. Callers that run process() synchronously take them from here right away, nullptr when there is none.
+    std::shared_ptr<Frame> popDecodedFrame();
+
+    // Whether the last process() returned nullptr only because its frame is still being decoded, rather than because it failed.
+    bool isBuffering() const;
+
+    // Whether the FFmpeg libraries could be loaded, so devices only offer the decoded stream profiles when they can be decoded.
+    static bool isAvailable();
+
+private:
+    void                   openDecoder(OBFormat codecFormat);
+    void                   closeDecoder();
+    std::shared_ptr<Frame> convertDecodedFrame(std::shared_ptr<const Frame> srcFrame);
+
+private:
+    std::shared_ptr<FFmpegLibrary> ffmpeg_;
+    OBFormat                       outputFormat_;
+    int                            threadCount_;
+
+    AVCodecContext *codecContext_ = nullptr;
+    AVPacket       *packet_       = nullptr;
+    AVFrame        *decodedFrame_ = nullptr;
+    OBFormat        codecFormat_  = OB_FORMAT_UNKNOWN;
+
+    // Frames sent to the decoder and not decoded yet, with the index used as their packet pts
+    std::deque<std::pair<int64_t, std::shared_ptr<const Frame>>> pendingFrames_;
+    int64_t                                                        sentFrameCount_ = 0;
+
+    // Frames decoded and not returned yet, oldest first
+    std::deque<std::shared_ptr<Frame>> decodedFrames_;
+    bool                               buffering_ = false;
+
+    std::shared_ptr<const StreamProfile> currentStreamProfile_;
+    std::shared_ptr<StreamProfile>       tarStreamProfile_;
+};
+
+}  // namespace libobsensor
@@ -9,6 +9,7 @@
 #include "PointCloudProcess.hpp"
 #include "IMUCorrector.hpp"
 #include "Align.hpp"
+#include "VideoDecoderProcess.hpp"
 #include "FilterDecorator.hpp"
 
 namespace libobsensor {
@@ -35,6 +36,7 @@ std::map<std::string, std::shared_ptr<IFilterCreator>> getCreators() {
         ADD_FILTER_CREATOR(FrameMirror),       ADD_FILTER_CREATOR(FrameFlip),
         ADD_FILTER_CREATOR(FrameRotate),       ADD_FILTER_CREATOR(PointCloudFilter),
         ADD_FILTER_CREATOR(IMUCorrector),      ADD_FILTER_CREATOR(Align),
+        ADD_FILTER_CREATOR(VideoDecoder),
     };
 
     return filterCreators;
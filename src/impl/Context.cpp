@@ -85,6 +85,26 @@ void ob_free_idle_memory(ob_context *context, ob_error **error) BEGIN_API_CALL {
 }
 HANDLE_EXCEPTIONS_NO_RETURN(context)
 
+void ob_get_frame_memory_pool_usage(ob_context *context, ob_frame_buffer_manager_usage *usage_list, uint32_t *count, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(context);
+    VALIDATE_NOT_NULL(count);
+    auto frameMemPool = context->context->getFrameMemoryPool();
+    auto usages       = frameMemPool->getFrameBufferManagerUsageList();
+    if(usage_list) {
+        for(uint32_t i = 0; i < *count && i < usages.size(); i++) {
+            auto &usage                     = usages[i];
+            usage_list[i].frame_type        = usage.frameType;
+            usage_list[i].frame_buffer_size = static_cast<uint32_t>(usage.frameDataBufferSize);
+            usage_list[i].allocated_count   = static_cast<uint32_t>(usage.statistics.allocatedCount);
+            usage_list[i].idle_count        = static_cast<uint32_t>(usage.statistics.cachedCount);
+            usage_list[i].hit_count         = usage.statistics.hitCount;
+            usage_list[i].miss_count        = usage.statistics.missCount;
+        }
+    }
+    *count = static_cast<uint32_t>(usages.size());
+}
+HANDLE_EXCEPTIONS_NO_RETURN(context, usage_list, count)
+
 void ob_set_logger_severity(ob_log_severity severity, ob_error **error) BEGIN_API_CALL {
     libobsensor::Logger::setLogSeverity(severity);
 }
@@ -128,7 +128,7 @@ uint32_t ob_video_frame_get_width(const ob_frame *frame, ob_error **error) BEGIN
     if(!frame->frame->is<libobsensor::VideoFrame>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video frame!");
     }
-    return frame->frame->as<libobsensor::VideoFrame>()->getWidth();
+    return frame->frame->asRef<libobsensor::VideoFrame>().getWidth();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(uint32_t(0), frame)
 
@@ -137,7 +137,7 @@ uint32_t ob_video_frame_get_height(const ob_frame *frame, ob_error **error) BEGI
     if(!frame->frame->is<libobsensor::VideoFrame>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video frame!");
     }
-    return frame->frame->as<libobsensor::VideoFrame>()->getHeight();
+    return frame->frame->asRef<libobsensor::VideoFrame>().getHeight();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(uint32_t(0), frame)
 
@@ -194,22 +194,19 @@ HANDLE_EXCEPTIONS_NO_RETURN(frame)
 
 float ob_depth_frame_get_value_scale(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    auto depthFrame = frame->frame->as<libobsensor::DepthFrame>();
-    return depthFrame->getValueScale();
+    return frame->frame->asRef<libobsensor::DepthFrame>().getValueScale();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(-1.0f, frame)
 
 void ob_depth_frame_set_value_scale(ob_frame *frame, float value_scale, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    auto depthFrame = frame->frame->as<libobsensor::DepthFrame>();
-    depthFrame->setValueScale(value_scale);
+    frame->frame->asRef<libobsensor::DepthFrame>().setValueScale(value_scale);
 }
 HANDLE_EXCEPTIONS_NO_RETURN(frame)
 
 float ob_points_frame_get_coordinate_value_scale(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    auto pointsFrame = frame->frame->as<libobsensor::PointsFrame>();
-    return pointsFrame->getCoordinateValueScale();
+    return frame->frame->asRef<libobsensor::PointsFrame>().getCoordinateValueScale();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(-1.0f, frame)
 
@@ -261,7 +258,7 @@ HANDLE_EXCEPTIONS_AND_RETURN(false, frame)
 
 int64_t ob_frame_get_metadata_value(const ob_frame *frame, ob_frame_metadata_type type, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    return frame->frame->as<libobsensor::VideoFrame>()->getMetadataValue(type);
+    return frame->frame->asRef<libobsensor::VideoFrame>().getMetadataValue(type);
 }
 HANDLE_EXCEPTIONS_AND_RETURN(-1, frame)
 
@@ -341,31 +338,31 @@ HANDLE_EXCEPTIONS_AND_RETURN(nullptr, frame)
 
 ob_pixel_type ob_video_frame_get_pixel_type(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    return frame->frame->as<libobsensor::VideoFrame>()->getPixelType();
+    return frame->frame->asRef<libobsensor::VideoFrame>().getPixelType();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(OB_PIXEL_UNKNOWN, frame)
 
 void ob_video_frame_set_pixel_type(ob_frame *frame, ob_pixel_type pixel_type, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    frame->frame->as<libobsensor::VideoFrame>()->setPixelType(pixel_type);
+    frame->frame->asRef<libobsensor::VideoFrame>().setPixelType(pixel_type);
 }
 HANDLE_EXCEPTIONS_NO_RETURN(frame)
 
 uint8_t ob_video_frame_get_pixel_available_bit_size(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    return frame->frame->as<libobsensor::VideoFrame>()->getPixelAvailableBitSize();
+    return frame->frame->asRef<libobsensor::VideoFrame>().getPixelAvailableBitSize();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(uint8_t(0), frame)
 
 void ob_video_frame_set_pixel_available_bit_size(ob_frame *frame, uint8_t bit_size, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    frame->frame->as<libobsensor::VideoFrame>()->setPixelAvailableBitSize(bit_size);
+    frame->frame->asRef<libobsensor::VideoFrame>().setPixelAvailableBitSize(bit_size);
 }
 HANDLE_EXCEPTIONS_NO_RETURN(frame)
 
 ob_sensor_type ob_ir_frame_get_data_source(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frame);
-    auto type = frame->frame->as<libobsensor::VideoFrame>()->getType();
+    auto type = frame->frame->asRef<libobsensor::VideoFrame>().getType();
     if(type == OB_FRAME_IR) {
         return OB_SENSOR_IR;
     }
@@ -384,7 +381,7 @@ ob_accel_value ob_accel_frame_get_value(const ob_frame *frame, ob_error **error)
     if(!frame->frame->is<libobsensor::AccelFrame>()) {
         throw libobsensor::unsupported_operation_exception("It's not a accel frame!");
     }
-    return frame->frame->as<libobsensor::AccelFrame>()->value();
+    return frame->frame->asRef<libobsensor::AccelFrame>().value();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_accel_value(), frame)
 
@@ -393,7 +390,7 @@ float ob_accel_frame_get_temperature(const ob_frame *frame, ob_error **error) BE
     if(!frame->frame->is<libobsensor::AccelFrame>()) {
         throw libobsensor::unsupported_operation_exception("It's not a accel frame!");
     }
-    return frame->frame->as<libobsensor::AccelFrame>()->temperature();
+    return frame->frame->asRef<libobsensor::AccelFrame>().temperature();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(0.0f, frame)
 
@@ -402,7 +399,7 @@ ob_gyro_value ob_gyro_frame_get_value(const ob_frame *frame, ob_error **error) B
     if(!frame->frame->is<libobsensor::GyroFrame>()) {
         throw libobsensor::unsupported_operation_exception("It's not a gyro frame!");
     }
-    return frame->frame->as<libobsensor::GyroFrame>()->value();
+    return frame->frame->asRef<libobsensor::GyroFrame>().value();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_gyro_value(), frame)
 
@@ -411,16 +408,58 @@ float ob_gyro_frame_get_temperature(const ob_frame *frame, ob_error **error) BEG
     if(!frame->frame->is<libobsensor::GyroFrame>()) {
         throw libobsensor::unsupported_operation_exception("It's not a gyro frame!");
     }
-    return frame->frame->as<libobsensor::GyroFrame>()->temperature();
+    return frame->frame->asRef<libobsensor::GyroFrame>().temperature();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(0.0f, frame)
 
+bool ob_frame_is_imu_batch(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(frame);
+    return frame->frame->is<libobsensor::ImuBatchFrame>();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(false, frame)
+
+uint32_t ob_imu_batch_frame_get_sample_count(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(frame);
+    if(!frame->frame->is<libobsensor::ImuBatchFrame>()) {
+        throw libobsensor::unsupported_operation_exception("It's not a imu batch frame!");
+    }
+    return frame->frame->asRef<libobsensor::ImuBatchFrame>().getSampleCount();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(0, frame)
+
+const uint64_t *ob_imu_batch_frame_get_timestamps(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(frame);
+    if(!frame->frame->is<libobsensor::ImuBatchFrame>()) {
+        throw libobsensor::unsupported_operation_exception("It's not a imu batch frame!");
+    }
+    return frame->frame->asRef<libobsensor::ImuBatchFrame>().getTimestamps();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, frame)
+
+const float *ob_imu_batch_frame_get_values(const ob_frame *frame, uint32_t axis, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(frame);
+    if(!frame->frame->is<libobsensor::ImuBatchFrame>()) {
+        throw libobsensor::unsupported_operation_exception("It's not a imu batch frame!");
+    }
+    return frame->frame->asRef<libobsensor::ImuBatchFrame>().getValues(axis);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, frame, axis)
+
+const float *ob_imu_batch_frame_get_temperatures(const ob_frame *frame, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(frame);
+    if(!frame->frame->is<libobsensor::ImuBatchFrame>()) {
+        throw libobsensor::unsupported_operation_exception("It's not a imu batch frame!");
+    }
+    return frame->frame->asRef<libobsensor::ImuBatchFrame>().getTemperatures();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, frame)
+
 uint32_t ob_frameset_get_count(const ob_frame *frameset, ob_error **error) BEGIN_API_CALL {
     VALIDATE_NOT_NULL(frameset);
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    return frameset->frame->as<libobsensor::FrameSet>()->getCount();
+    return frameset->frame->asRef<libobsensor::FrameSet>().getCount();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(uint32_t(0), frameset)
 
@@ -429,7 +468,7 @@ ob_frame *ob_frameset_get_depth_frame(const ob_frame *frameset, ob_error **error
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    auto innerFrame = frameset->frame->as<libobsensor::FrameSet>()->getFrame(OB_FRAME_DEPTH);
+    auto innerFrame = frameset->frame->asRef<libobsensor::FrameSet>().getFrame(OB_FRAME_DEPTH);
     if(innerFrame == nullptr) {
         return nullptr;
     }
@@ -444,7 +483,7 @@ ob_frame *ob_frameset_get_color_frame(const ob_frame *frameset, ob_error **error
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    auto innerFrame = frameset->frame->as<libobsensor::FrameSet>()->getFrame(OB_FRAME_COLOR);
+    auto innerFrame = frameset->frame->asRef<libobsensor::FrameSet>().getFrame(OB_FRAME_COLOR);
     if(innerFrame == nullptr) {
         return nullptr;
     }
@@ -459,7 +498,7 @@ ob_frame *ob_frameset_get_ir_frame(const ob_frame *frameset, ob_error **error) B
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    auto innerFrame = frameset->frame->as<libobsensor::FrameSet>()->getFrame(OB_FRAME_IR);
+    auto innerFrame = frameset->frame->asRef<libobsensor::FrameSet>().getFrame(OB_FRAME_IR);
     if(innerFrame == nullptr) {
         return nullptr;
     }
@@ -474,7 +513,7 @@ ob_frame *ob_frameset_get_points_frame(const ob_frame *frameset, ob_error **erro
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    auto innerFrame = frameset->frame->as<libobsensor::FrameSet>()->getFrame(OB_FRAME_POINTS);
+    auto innerFrame = frameset->frame->asRef<libobsensor::FrameSet>().getFrame(OB_FRAME_POINTS);
     if(innerFrame == nullptr) {
         return nullptr;
     }
@@ -489,7 +528,7 @@ ob_frame *ob_frameset_get_frame(const ob_frame *frameset, ob_frame_type frame_ty
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    auto innerFrame = frameset->frame->as<libobsensor::FrameSet>()->getFrame(frame_type);
+    auto innerFrame = frameset->frame->asRef<libobsensor::FrameSet>().getFrame(frame_type);
     if(innerFrame == nullptr) {
         return nullptr;
     }
@@ -504,7 +543,7 @@ ob_frame *ob_frameset_get_frame_by_index(const ob_frame *frameset, uint32_t inde
     if(!frameset->frame->is<libobsensor::FrameSet>()) {
         throw libobsensor::unsupported_operation_exception("It's not a frameset!");
     }
-    auto innerFrame = frameset->frame->as<libobsensor::FrameSet>()->getFrame(index);
+    auto innerFrame = frameset->frame->asRef<libobsensor::FrameSet>().getFrame(index);
     if(innerFrame == nullptr) {
         return nullptr;
     }
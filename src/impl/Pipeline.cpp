@@ -142,6 +142,12 @@ void ob_pipeline_disable_frame_sync(ob_pipeline *pipeline, ob_error **error) BEG
 }
 HANDLE_EXCEPTIONS_NO_RETURN(pipeline)
 
+ob_frame_sync_stats ob_pipeline_get_frame_sync_stats(const ob_pipeline *pipeline, ob_stream_type stream_type, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(pipeline);
+    return pipeline->pipeline->getFrameSyncStats(stream_type);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(ob_frame_sync_stats(), pipeline, stream_type)
+
 ob_stream_profile_list *ob_get_d2c_depth_profile_list(const ob_pipeline *pipeline, const ob_stream_profile *color_profile, ob_align_mode align_mode,
                                                       ob_error **error) BEGIN_API_CALL {
     auto innerProfiles = pipeline->pipeline->getD2CDepthProfileList(color_profile->profile, align_mode);
@@ -261,6 +267,19 @@ void ob_config_set_frame_aggregate_output_mode(ob_config *config, ob_frame_aggre
 }
 HANDLE_EXCEPTIONS_NO_RETURN(config, mode)
 
+void ob_config_set_frame_sync_timestamp_type(ob_config *config, ob_frame_sync_timestamp_type type, ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(config);
+    config->config->setFrameSyncTimestampType(type);
+}
+HANDLE_EXCEPTIONS_NO_RETURN(config, type)
+
+void ob_config_set_frame_sync_tolerance(ob_config *config, ob_stream_type stream_type_1, ob_stream_type stream_type_2, uint32_t tolerance_us,
+                                        ob_error **error) BEGIN_API_CALL {
+    VALIDATE_NOT_NULL(config);
+    config->config->setFrameSyncTolerance(stream_type_1, stream_type_2, tolerance_us);
+}
+HANDLE_EXCEPTIONS_NO_RETURN(config, stream_type_1, stream_type_2, tolerance_us)
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -110,8 +110,7 @@ uint32_t ob_video_stream_profile_get_fps(const ob_stream_profile *profile, ob_er
     if(!profile->profile->is<libobsensor::VideoStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video stream profile!");
     }
-    auto videoProfile = profile->profile->as<libobsensor::VideoStreamProfile>();
-    return videoProfile->getFps();
+    return profile->profile->asRef<libobsensor::VideoStreamProfile>().getFps();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(0, profile)
 
@@ -120,8 +119,7 @@ uint32_t ob_video_stream_profile_get_width(const ob_stream_profile *profile, ob_
     if(!profile->profile->is<libobsensor::VideoStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video stream profile!");
     }
-    auto videoProfile = profile->profile->as<libobsensor::VideoStreamProfile>();
-    return videoProfile->getWidth();
+    return profile->profile->asRef<libobsensor::VideoStreamProfile>().getWidth();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(0, profile)
 
@@ -142,8 +140,7 @@ uint32_t ob_video_stream_profile_get_height(const ob_stream_profile *profile, ob
     if(!profile->profile->is<libobsensor::VideoStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video stream profile!");
     }
-    auto videoProfile = profile->profile->as<libobsensor::VideoStreamProfile>();
-    return videoProfile->getHeight();
+    return profile->profile->asRef<libobsensor::VideoStreamProfile>().getHeight();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(0, profile)
 
@@ -164,8 +161,7 @@ ob_camera_intrinsic ob_video_stream_profile_get_intrinsic(const ob_stream_profil
     if(!profile->profile->is<libobsensor::VideoStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video stream profile!");
     }
-    auto videoProfile = profile->profile->as<libobsensor::VideoStreamProfile>();
-    return videoProfile->getIntrinsic();
+    return profile->profile->asRef<libobsensor::VideoStreamProfile>().getIntrinsic();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_camera_intrinsic(), profile)
 
@@ -185,8 +181,7 @@ ob_camera_distortion ob_video_stream_profile_get_distortion(const ob_stream_prof
     if(!profile->profile->is<libobsensor::VideoStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a video stream profile!");
     }
-    auto videoProfile = profile->profile->as<libobsensor::VideoStreamProfile>();
-    return videoProfile->getDistortion();
+    return profile->profile->asRef<libobsensor::VideoStreamProfile>().getDistortion();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_camera_distortion(), profile)
 
@@ -206,8 +201,7 @@ ob_disparity_param ob_disparity_based_stream_profile_get_disparity_param(const o
     if(!profile->profile->is<libobsensor::DisparityBasedStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a disparity based stream profile!");
     }
-    auto disparityProfile = profile->profile->as<libobsensor::DisparityBasedStreamProfile>();
-    return disparityProfile->getDisparityParam();
+    return profile->profile->asRef<libobsensor::DisparityBasedStreamProfile>().getDisparityParam();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_disparity_param(), profile)
 
@@ -227,8 +221,7 @@ ob_accel_full_scale_range ob_accel_stream_profile_get_full_scale_range(const ob_
     if(!profile->profile->is<libobsensor::AccelStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not an accel stream profile!");
     }
-    auto accelProfile = profile->profile->as<libobsensor::AccelStreamProfile>();
-    return accelProfile->getFullScaleRange();
+    return profile->profile->asRef<libobsensor::AccelStreamProfile>().getFullScaleRange();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_accel_full_scale_range(), profile)
 
@@ -237,8 +230,7 @@ ob_accel_sample_rate ob_accel_stream_profile_get_sample_rate(const ob_stream_pro
     if(!profile->profile->is<libobsensor::AccelStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not an accel stream profile!");
     }
-    auto accelProfile = profile->profile->as<libobsensor::AccelStreamProfile>();
-    return accelProfile->getSampleRate();
+    return profile->profile->asRef<libobsensor::AccelStreamProfile>().getSampleRate();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_accel_sample_rate(), profile)
 
@@ -247,8 +239,7 @@ ob_accel_intrinsic ob_accel_stream_profile_get_intrinsic(const ob_stream_profile
     if(!profile->profile->is<libobsensor::AccelStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not an accel stream profile!");
     }
-    auto accelProfile = profile->profile->as<libobsensor::AccelStreamProfile>();
-    return accelProfile->getIntrinsic();
+    return profile->profile->asRef<libobsensor::AccelStreamProfile>().getIntrinsic();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_accel_intrinsic(), profile)
 
@@ -268,8 +259,7 @@ ob_gyro_full_scale_range ob_gyro_stream_profile_get_full_scale_range(const ob_st
     if(!profile->profile->is<libobsensor::GyroStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a gyro stream profile!");
     }
-    auto gyroProfile = profile->profile->as<libobsensor::GyroStreamProfile>();
-    return gyroProfile->getFullScaleRange();
+    return profile->profile->asRef<libobsensor::GyroStreamProfile>().getFullScaleRange();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_gyro_full_scale_range(), profile)
 
@@ -278,8 +268,7 @@ ob_gyro_sample_rate ob_gyro_stream_profile_get_sample_rate(const ob_stream_profi
     if(!profile->profile->is<libobsensor::GyroStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a gyro stream profile!");
     }
-    auto gyroProfile = profile->profile->as<libobsensor::GyroStreamProfile>();
-    return gyroProfile->getSampleRate();
+    return profile->profile->asRef<libobsensor::GyroStreamProfile>().getSampleRate();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_gyro_sample_rate(), profile)
 
@@ -288,8 +277,7 @@ ob_gyro_intrinsic ob_gyro_stream_get_intrinsic(const ob_stream_profile *profile,
     if(!profile->profile->is<libobsensor::GyroStreamProfile>()) {
         throw libobsensor::unsupported_operation_exception("It's not a gyro stream profile!");
     }
-    auto gyroProfile = profile->profile->as<libobsensor::GyroStreamProfile>();
-    return gyroProfile->getIntrinsic();
+    return profile->profile->asRef<libobsensor::GyroStreamProfile>().getIntrinsic();
 }
 HANDLE_EXCEPTIONS_AND_RETURN(ob_gyro_intrinsic(), profile)
 
@@ -206,7 +206,25 @@ bool transformation_init_xy_tables(const ob_calibration_param calibration_param,
     } else {
         return false;
     }
-    return libobsensor::CoordinateUtil::transformationInitXYTables(sourceIntrinsic, depthDistortion, data, data_size, xy_tables);
+
+    // copied from the tables shared by the process, only computed once for the same camera
+    size_t                       tableSize = static_cast<size_t>(sourceIntrinsic.width) * sourceIntrinsic.height;
+    ob_xy_tables                 cachedTables;
+    std::shared_ptr<const float> cachedData;
+    if(sourceIntrinsic.width > 0 && sourceIntrinsic.height > 0 && *data_size >= 2 * tableSize) {
+        cachedData = libobsensor::CoordinateUtil::getCachedXYTables(sourceIntrinsic, depthDistortion, &cachedTables);
+    }
+    if(!cachedData) {
+        // reports the invalid parameters
+        return libobsensor::CoordinateUtil::transformationInitXYTables(sourceIntrinsic, depthDistortion, data, data_size, xy_tables);
+    }
+    memcpy(data, cachedData.get(), 2 * tableSize * sizeof(float));
+    xy_tables->width  = sourceIntrinsic.width;
+    xy_tables->height = sourceIntrinsic.height;
+    xy_tables->xTable = data;
+    xy_tables->yTable = data + tableSize;
+    *data_size        = static_cast<uint32_t>(2 * tableSize);
+    return true;
 }
 HANDLE_EXCEPTIONS_AND_RETURN(false, calibration_param, sensor_type, data, data_size, xy_tables)
 
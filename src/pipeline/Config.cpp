@@ -87,8 +87,31 @@ OBFrameAggregateOutputMode Config::getFrameAggregateOutputMode() const {
     return frameAggregateOutputMode_;
 }
 
+void Config::setFrameSyncTimestampType(OBFrameSyncTimestampType type) {
+    frameSyncTimestampType_ = type;
+}
+
+OBFrameSyncTimestampType Config::getFrameSyncTimestampType() const {
+    return frameSyncTimestampType_;
+}
+
+void Config::setFrameSyncTolerance(OBStreamType streamType1, OBStreamType streamType2, uint32_t toleranceUsec) {
+    auto key = std::make_pair(std::min(streamType1, streamType2), std::max(streamType1, streamType2));
+    if(toleranceUsec == 0) {
+        frameSyncToleranceMap_.erase(key);
+        return;
+    }
+    frameSyncToleranceMap_[key] = toleranceUsec;
+}
+
+uint32_t Config::getFrameSyncTolerance(OBStreamType streamType1, OBStreamType streamType2) const {
+    auto iter = frameSyncToleranceMap_.find(std::make_pair(std::min(streamType1, streamType2), std::max(streamType1, streamType2)));
+    return iter != frameSyncToleranceMap_.end() ? iter->second : 0;
+}
+
 bool Config::operator==(const Config &cmp) const {
-    if(cmp.alignMode_ != alignMode_ || cmp.depthScaleRequire_ != depthScaleRequire_
+    if(cmp.alignMode_ != alignMode_ || cmp.depthScaleRequire_ != depthScaleRequire_ || cmp.frameAggregateOutputMode_ != frameAggregateOutputMode_
+       || cmp.frameSyncTimestampType_ != frameSyncTimestampType_ || cmp.frameSyncToleranceMap_ != frameSyncToleranceMap_
        || cmp.enabledStreamProfileList_.size() != enabledStreamProfileList_.size()) {
         return false;
     }
@@ -120,6 +143,8 @@ std::shared_ptr<Config> Config::clone() const {
     config->depthScaleRequire_        = depthScaleRequire_;
     config->enabledStreamProfileList_ = enabledStreamProfileList_;
     config->frameAggregateOutputMode_ = frameAggregateOutputMode_;
+    config->frameSyncTimestampType_   = frameSyncTimestampType_;
+    config->frameSyncToleranceMap_    = frameSyncToleranceMap_;
     return config;
 }
 
@@ -3,6 +3,7 @@
 #include <libobsensor/h/ObTypes.h>
 #include <vector>
 #include <memory>
+#include <map>
 
 namespace libobsensor {
 
@@ -32,6 +33,11 @@ public:
     void                       setFrameAggregateOutputMode(OBFrameAggregateOutputMode mode);
     OBFrameAggregateOutputMode getFrameAggregateOutputMode() const;
 
+    void                     setFrameSyncTimestampType(OBFrameSyncTimestampType type);
+    OBFrameSyncTimestampType getFrameSyncTimestampType() const;
+    void                     setFrameSyncTolerance(OBStreamType streamType1, OBStreamType streamType2, uint32_t toleranceUsec);
+    uint32_t                 getFrameSyncTolerance(OBStreamType streamType1, OBStreamType streamType2) const;  // 0 if the default tolerance is used
+
     bool operator==(const Config &cmp) const;
     bool operator!=(const Config &cmp) const;
 
@@ -42,5 +48,8 @@ private:
     OBAlignMode                alignMode_{ ALIGN_DISABLE };
     bool                       depthScaleRequire_        = true;
     OBFrameAggregateOutputMode frameAggregateOutputMode_ = OB_FRAME_AGGREGATE_OUTPUT_ANY_SITUATION;
+    OBFrameSyncTimestampType   frameSyncTimestampType_   = OB_FRAME_SYNC_TIMESTAMP_AUTO;
+
+    std::map<std::pair<OBStreamType, OBStreamType>, uint32_t> frameSyncToleranceMap_;  // key is ordered by stream type
 };
 }  // namespace libobsensor
\ No newline at end of file
@@ -2,16 +2,18 @@
 #include "FrameAggregator.hpp"
 #include "frame/FrameFactory.hpp"
 #include "logger/Logger.hpp"
+#include "logger/LoggerInterval.hpp"
+#include "exception/ObException.hpp"
 #include "utils/PublicTypeHelper.hpp"
+#include "utils/Utils.hpp"
 
-#include <thread>
+#include <map>
 
 namespace libobsensor {
 
 #define MAX_FRAME_DELAY 0.5f  // 0.3s max delay diff + 0.1s max frame gap
 #define MAX_NORMAL_MODE_QUEUE_SIZE 3
-
-typedef std::map<OBFrameType, SourceFrameQueue>::iterator FrameQueuePair;
+#define MAX_PENDING_FRAMESET_COUNT 8  // framesets waiting for a callback that lags behind the streams, the oldest ones are dropped
 
 const std::map<OBStreamType, OBFrameType> STREAM_FRAME_TYPE_MAP = {
     { OB_STREAM_COLOR, OB_FRAME_COLOR },     { OB_STREAM_DEPTH, OB_FRAME_DEPTH },        { OB_STREAM_IR, OB_FRAME_IR },
@@ -19,30 +21,44 @@ const std::map<OBStreamType, OBFrameType> STREAM_FRAME_TYPE_MAP = {
     { OB_STREAM_GYRO, OB_FRAME_GYRO },       { OB_STREAM_RAW_PHASE, OB_FRAME_RAW_PHASE }
 };
 
-uint64_t getFrameTimestampMsec(const std::shared_ptr<const Frame> &frame, FrameSyncMode syncMode) {
+uint64_t getFrameTimestampUsec(const std::shared_ptr<const Frame> &frame, FrameSyncMode syncMode) {
     if(syncMode == FrameSyncModeSyncAccordingSystemTimestamp) {
-        return frame->getSystemTimeStampUsec() / 1000;
+        return frame->getSystemTimeStampUsec();
+    }
+    if(syncMode == FrameSyncModeSyncAccordingGlobalTimestamp) {  // falls back to the device timestamp if global timestamp is not enabled
+        auto globalTsp = frame->getGlobalTimeStampUsec();
+        if(globalTsp != 0) {
+            return globalTsp;
+        }
     }
-    return frame->getTimeStampUsec() / 1000;
+    return frame->getTimeStampUsec();
 }
 
 FrameAggregator::FrameAggregator()
     : frameSyncMode_(FrameSyncModeDisable),
-      miniTimeStamp_(0),
+      withOverflowQueue_(false),
+      withOverflowQueueSlot_(0),
       frameAggregateOutputMode_(OB_FRAME_AGGREGATE_OUTPUT_ANY_SITUATION),
-      frameCnt_(0),
-      withColorFrame_(false),
-      matchingRateFirst_(true) {}
+      matchingRateFirst_(true),
+      delivering_(false),
+      droppedFrameSetCount_(0) {
+    frameTypeSlots_.fill(-1);
+}
 
 FrameAggregator::~FrameAggregator() noexcept {
-    reset();
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
+    clearAllFrameQueueLocked();
+    srcFrameQueues_.clear();
 }
 
 void FrameAggregator::updateConfig(std::shared_ptr<const Config> config, const bool matchingRateFirst) {
-    std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
     frameAggregateOutputMode_ = config->getFrameAggregateOutputMode();
     matchingRateFirst_        = matchingRateFirst;
-    reset();
+    clearAllFrameQueueLocked();
+    srcFrameQueues_.clear();
+    frameTypeSlots_.fill(-1);
+
     auto profiles = config->getEnabledStreamProfileList();
     for(auto &profile: profiles) {
         float fps = 0;
@@ -61,204 +77,254 @@ void FrameAggregator::updateConfig(std::shared_ptr<const Config> config, const b
 
         float maxSyncQueueSize = fps * MAX_FRAME_DELAY + 1;
         maxSyncQueueSize += ((maxSyncQueueSize - (int)maxSyncQueueSize) > 0 ? 1 : 0);
-        auto halfTspGap = static_cast<uint32_t>(500.0f / fps + 0.5);  // +0.5以完成四舍五入
-        srcFrameQueueMap_.insert(
-            { STREAM_FRAME_TYPE_MAP.find(profile->getType())->second, { std::queue<std::shared_ptr<const Frame>>(), (uint32_t)maxSyncQueueSize, halfTspGap } });
-    }
-}
+        auto halfTspGapUsec = static_cast<uint32_t>(500000.0f / fps + 0.5);  // +0.5以完成四舍五入
+        auto streamType     = profile->getType();
+        auto frameType      = STREAM_FRAME_TYPE_MAP.find(streamType)->second;
+        if(frameTypeSlots_[frameType] >= 0) {
+            continue;
+        }
 
-void FrameAggregator::pushFrame(std::shared_ptr<const Frame> frame) {
-    std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
-    withEmptyQueue_ = false;
-    // auto tmp = frame->getSystemTimeStamp();
-    // LOG_INFO("Type: {}, AggFrameTimeStamp: {}", frame->getType(), frame->getSystemTimeStamp());
-    auto frameType = frame->getType();
-    for(auto &item: srcFrameQueueMap_) {
-        if(item.first == frameType) {
-            item.second.queue.push(frame);
-            uint32_t maxQueueSize_ = frameSyncMode_ == FrameSyncModeDisable ? MAX_NORMAL_MODE_QUEUE_SIZE : item.second.maxSyncQueueSize_;
-            // auto size = item.second.queue.size();
-            // LOG_INFO("Type: {}, queueSize: {}", frame->getType(), size);
-            if(item.second.queue.size() >= maxQueueSize_) {
-                withOverflowQueue_          = true;
-                withOverflowQueueFrameType_ = frameType;
-            }
+        // The queue is drained as soon as it reaches the max size of the current sync mode, so this capacity is only exceeded if the
+        // frameset can not be created
+        auto capacity = std::max<uint32_t>((uint32_t)maxSyncQueueSize, MAX_NORMAL_MODE_QUEUE_SIZE);
+        frameTypeSlots_[frameType] = static_cast<int>(srcFrameQueues_.size());
+        srcFrameQueues_.push_back(
+            { frameType, streamType, std::vector<SourceFrameQueue::Item>(capacity), 0, 0, (uint32_t)maxSyncQueueSize, halfTspGapUsec, OBFrameSyncStats() });
+    }
 
-            auto timestamp = getFrameTimestampMsec(frame, frameSyncMode_);
-            if(srcFrameQueueMap_.size() > 1 && frameSyncMode_ && (srcFrameQueueMap_.size() == 2 || !matchingRateFirst_)
-               && (miniTimeStamp_ == 0 || timestamp < miniTimeStamp_)) {
-                miniTimeStamp_          = timestamp;
-                miniTimeStampFrameType_ = frameType;
+    // The tolerance of a stream pair is set by the config, or half of the frame interval of the stream with the higher frame rate by default
+    const size_t queueCount = srcFrameQueues_.size();
+    tspToleranceUsec_.assign(queueCount * queueCount, 0);
+    for(size_t i = 0; i < queueCount; i++) {
+        for(size_t j = 0; j < queueCount; j++) {
+            auto &queue1    = srcFrameQueues_[i];
+            auto &queue2    = srcFrameQueues_[j];
+            auto  tolerance = config->getFrameSyncTolerance(queue1.streamType, queue2.streamType);
+            if(tolerance == 0) {
+                tolerance = std::min(queue1.halfTspGapUsec, queue2.halfTspGapUsec);
             }
-        }
-        else if(item.second.queue.empty()) {
-            withEmptyQueue_ = true;
+            tspToleranceUsec_[i * queueCount + j] = tolerance;
         }
     }
-    tryAggregator();
 }
 
-void sortFrameMap(std::map<OBFrameType, SourceFrameQueue> &frameMap, std::vector<FrameQueuePair> &frameVec, FrameSyncMode frameSyncMode) {
-    // srcFrameQueueMap_排序，队头时间戳小的队列的pair放前面
-    auto iter = frameMap.begin();
-    while(iter != frameMap.end()) {
-        if(!iter->second.queue.empty()) {
-            frameVec.push_back(iter);
-        }
-        iter++;
+uint32_t FrameAggregator::getTspToleranceUsec(size_t slot1, size_t slot2) const {
+    return tspToleranceUsec_[slot1 * srcFrameQueues_.size() + slot2];
+}
+
+void FrameAggregator::pushFrame(std::shared_ptr<const Frame> frame) {
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
+    auto                         frameType = frame->getType();
+    if(frameType < 0 || frameType >= OB_FRAME_TYPE_COUNT || frameTypeSlots_[frameType] < 0) {
+        return;
+    }
+    auto  slot     = static_cast<size_t>(frameTypeSlots_[frameType]);
+    auto &srcQueue = srcFrameQueues_[slot];
+    if(frameSyncMode_ == FrameSyncModeSyncAccordingGlobalTimestamp && frame->getGlobalTimeStampUsec() == 0) {
+        LOG_WARN_INTVL("Frame has no global timestamp, sync according to device timestamp instead! Is global timestamp enabled on the device?");
+    }
+    auto timestamp = getFrameTimestampUsec(frame, frameSyncMode_);
+    if(!srcQueue.push(std::move(frame), timestamp)) {
+        srcQueue.stats.droppedFrameCount++;
+        LOG_WARN_INTVL("Frame aggregator queue of {} is full, drop oldest frame!", frameType);
     }
-    std::sort(frameVec.begin(), frameVec.end(), [frameSyncMode](const FrameQueuePair &x, const FrameQueuePair &y) {
-        auto xTsp = getFrameTimestampMsec(x->second.queue.front(), frameSyncMode);
-        auto yTsp = getFrameTimestampMsec(y->second.queue.front(), frameSyncMode);
-        return xTsp < yTsp;
-    });
+
+    uint32_t maxQueueSize_ = frameSyncMode_ == FrameSyncModeDisable ? MAX_NORMAL_MODE_QUEUE_SIZE : srcQueue.maxSyncQueueSize_;
+    if(srcQueue.size >= maxQueueSize_) {
+        withOverflowQueue_     = true;
+        withOverflowQueueSlot_ = slot;
+    }
+
+    tryAggregator();
+    deliverFrameSets(lk);
 }
 
 void FrameAggregator::tryAggregator() {
-    std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
-    while(!withEmptyQueue_ || withOverflowQueue_) {
-        frameCnt_       = 0;
-        withColorFrame_ = false;
-        auto frameSet   = FrameFactory::createFrameSet();
+    const size_t queueCount = srcFrameQueues_.size();
+    while(true) {
+        bool withEmptyQueue = false;
+        bool allQueueEmpty  = true;
+        for(auto &srcQueue: srcFrameQueues_) {
+            withEmptyQueue |= srcQueue.empty();
+            allQueueEmpty &= srcQueue.empty();
+        }
+        if(allQueueEmpty) {
+            withOverflowQueue_ = false;
+            break;
+        }
+        if(withEmptyQueue && !withOverflowQueue_) {
+            break;
+        }
+
+        auto frameSet = FrameFactory::createFrameSet();
         if(!frameSet) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));  // 等100ms后再次尝试是否能申请成功
-            continue;
+            // Keep the frames queued and try again when the next frame arrives, the ring buffers drop the oldest frames in the meantime
+            LOG_WARN_INTVL("Failed to create frameset, frames will be aggregated when the next frame arrives!");
+            break;
         }
-        if(srcFrameQueueMap_.size() > 1 && frameSyncMode_) {
-            if(matchingRateFirst_ && srcFrameQueueMap_.size() != 2) {  // 匹配率优先
-                std::vector<FrameQueuePair> frameVector;
-                sortFrameMap(srcFrameQueueMap_, frameVector, frameSyncMode_);  // srcFrameQueueMap_排序
-                auto refIter       = frameVector.begin();
-                auto refTsp        = getFrameTimestampMsec((*refIter)->second.queue.front(), frameSyncMode_);
-                auto refHalfTspGap = (*refIter)->second.halfTspGap;
-                for(auto &item: frameVector) {
-                    auto    &tarFrame      = item->second.queue.front();
-                    auto     tarHalfTspGap = item->second.halfTspGap;
-                    uint32_t tspHalfGap    = tarHalfTspGap < refHalfTspGap ? tarHalfTspGap : refHalfTspGap;
-
-                    auto tarTsp = getFrameTimestampMsec(tarFrame, frameSyncMode_);
-                    if(tarTsp - refTsp > tspHalfGap) {
-                        break;
-                    }
-                    refTsp        = tarTsp;  // 出队后，将本次参考时间戳保存下来，作为下一次循环的参考
-                    refHalfTspGap = tarHalfTspGap;
-                    frameSet->pushFrame(std::move(tarFrame));
-                    frameCnt_++;
-                    if(item->first == OB_FRAME_COLOR) {
-                        withColorFrame_ = true;
+
+        uint32_t                                  frameCnt       = 0;
+        bool                                      withColorFrame = false;
+        bool                                      aggregateOnce  = false;
+        std::array<size_t, OB_FRAME_TYPE_COUNT>   frameSlots;
+        std::array<uint64_t, OB_FRAME_TYPE_COUNT> frameTsps;
+        auto                                      popToFrameSet = [&](size_t slot) {
+            auto &srcQueue       = srcFrameQueues_[slot];
+            frameSlots[frameCnt] = slot;
+            frameTsps[frameCnt]  = srcQueue.front().timestamp;
+            frameSet->pushFrame(std::move(srcQueue.front().frame));
+            srcQueue.pop();
+            frameCnt++;
+            if(srcQueue.frameType == OB_FRAME_COLOR) {
+                withColorFrame = true;
+            }
+            if(withOverflowQueue_ && slot == withOverflowQueueSlot_) {
+                withOverflowQueue_ = false;
+            }
+        };
+
+        if(queueCount > 1 && frameSyncMode_) {
+            if(matchingRateFirst_ && queueCount != 2) {  // 匹配率优先
+                // Order the non-empty queues by their front timestamp, there are only a few streams so an insertion sort on the stack is enough
+                std::array<size_t, OB_FRAME_TYPE_COUNT> order;
+                size_t                                  orderCount = 0;
+                for(size_t slot = 0; slot < queueCount; slot++) {
+                    if(srcFrameQueues_[slot].empty()) {
+                        continue;
                     }
-                    item->second.queue.pop();
-                    if(withOverflowQueue_ && item->first == withOverflowQueueFrameType_) {
-                        withOverflowQueue_ = false;
+                    auto   tsp = srcFrameQueues_[slot].front().timestamp;
+                    size_t pos = orderCount++;
+                    while(pos > 0 && srcFrameQueues_[order[pos - 1]].front().timestamp > tsp) {
+                        order[pos] = order[pos - 1];
+                        pos--;
                     }
-                    if(!withEmptyQueue_ && item->second.queue.empty()) {
-                        withEmptyQueue_ = true;
+                    order[pos] = slot;
+                }
+
+                auto refSlot = order[0];
+                auto refTsp  = srcFrameQueues_[refSlot].front().timestamp;
+                for(size_t i = 0; i < orderCount; i++) {
+                    auto tarTsp = srcFrameQueues_[order[i]].front().timestamp;
+                    if(tarTsp - refTsp > getTspToleranceUsec(refSlot, order[i])) {
+                        break;
                     }
+                    refSlot = order[i];  // 出队后，将本次参考时间戳保存下来，作为下一次循环的参考
+                    refTsp  = tarTsp;
+                    popToFrameSet(order[i]);
                 }
             }
             else {  // 匹配精度优先
-                uint64_t    newMiniTimeStamp_          = 0;
-                OBFrameType newMiniTimeStampFrameType_ = miniTimeStampFrameType_;
-                // 同步匹配
-                auto refIter       = srcFrameQueueMap_.find(miniTimeStampFrameType_);
-                auto refTsp        = getFrameTimestampMsec(refIter->second.queue.front(), frameSyncMode_);
-                auto refHalfTspGap = refIter->second.halfTspGap;
-                for(auto &item: srcFrameQueueMap_) {
-                    if(!item.second.queue.empty()) {
-                        auto    &tarFrame      = item.second.queue.front();
-                        auto     tarHalfTspGap = item.second.halfTspGap;
-                        uint32_t tspHalfGap    = tarHalfTspGap < refHalfTspGap ? tarHalfTspGap : refHalfTspGap;
-                        auto     tarTsp        = getFrameTimestampMsec(tarFrame, frameSyncMode_);
-                        if(tarTsp - refTsp <= tspHalfGap) {
-                            frameSet->pushFrame(std::move(tarFrame));
-                            frameCnt_++;
-                            if(item.first == OB_FRAME_COLOR) {
-                                withColorFrame_ = true;
-                            }
-                            item.second.queue.pop();
-                            if(withOverflowQueue_ && item.first == withOverflowQueueFrameType_) {
-                                withOverflowQueue_ = false;
-                            }
-                        }
-                    }
-
-                    if(item.second.queue.empty()) {
-                        withEmptyQueue_ = true;
-                        continue;
+                // The reference is the oldest frame of all queues
+                size_t refSlot = queueCount;
+                for(size_t slot = 0; slot < queueCount; slot++) {
+                    if(!srcFrameQueues_[slot].empty()
+                       && (refSlot == queueCount || srcFrameQueues_[slot].front().timestamp < srcFrameQueues_[refSlot].front().timestamp)) {
+                        refSlot = slot;
                     }
-
-                    auto tsp = getFrameTimestampMsec(item.second.queue.front(), frameSyncMode_);
-                    if(newMiniTimeStamp_ == 0 || newMiniTimeStamp_ > tsp) {
-                        newMiniTimeStamp_          = tsp;
-                        newMiniTimeStampFrameType_ = item.second.queue.front()->getType();
+                }
+                auto refTsp = srcFrameQueues_[refSlot].front().timestamp;
+                for(size_t slot = 0; slot < queueCount; slot++) {
+                    if(!srcFrameQueues_[slot].empty() && srcFrameQueues_[slot].front().timestamp - refTsp <= getTspToleranceUsec(refSlot, slot)) {
+                        popToFrameSet(slot);
                     }
                 }
-                miniTimeStamp_          = newMiniTimeStamp_;
-                miniTimeStampFrameType_ = newMiniTimeStampFrameType_;
             }
         }
         else {
             // 非同步匹配
-            for(auto &item: srcFrameQueueMap_) {
-                if(!withEmptyQueue_ || item.second.queue.size() >= MAX_NORMAL_MODE_QUEUE_SIZE - 1) {
-                    auto &srcFrame = item.second.queue.front();
-                    frameSet->pushFrame(std::move(srcFrame));
-                    item.second.queue.pop();
-                    frameCnt_++;
-                    if(item.first == OB_FRAME_COLOR) {
-                        withColorFrame_ = true;
-                    }
+            for(size_t slot = 0; slot < queueCount; slot++) {
+                if(!withEmptyQueue || srcFrameQueues_[slot].size >= MAX_NORMAL_MODE_QUEUE_SIZE - 1) {
+                    popToFrameSet(slot);
                 }
             }
-            withEmptyQueue_    = true;
             withOverflowQueue_ = false;
+            aggregateOnce      = true;
+        }
+
+        bool outputRequired = isOutputRequired(frameCnt, withColorFrame);
+        auto minTsp         = frameCnt > 0 ? *std::min_element(frameTsps.begin(), frameTsps.begin() + frameCnt) : 0;
+        for(uint32_t i = 0; i < frameCnt; i++) {
+            auto &stats = srcFrameQueues_[frameSlots[i]].stats;
+            if(!outputRequired) {
+                stats.droppedFrameCount++;
+            }
+            else if(frameCnt == 1) {
+                stats.unmatchedFrameCount++;
+            }
+            else {
+                stats.matchedFrameCount++;
+                stats.maxMatchedTspDiffUsec = std::max(stats.maxMatchedTspDiffUsec, frameTsps[i] - minTsp);
+            }
+        }
+        if(outputRequired) {
+            if(pendingFrameSets_.size() >= MAX_PENDING_FRAMESET_COUNT) {
+                dropOldestPendingFrameSet();
+            }
+            pendingFrameSets_.push_back(frameSet);
+        }
+        if(aggregateOnce) {
+            break;
         }
-        // test code:
-        // auto        depthFrame = frameSet->getFrame(OB_FRAME_DEPTH);
-        // auto        colorFrame = frameSet->getFrame(OB_FRAME_COLOR);
-        // auto        irFrame    = frameSet->getFrame(OB_FRAME_IR);
-        // std::string msg;
-        // if(depthFrame) {
-        //     msg = msg + " | depthFrame tsp=" + std::to_string(depthFrame->getTimeStamp());
-        // }
-        // if(irFrame) {
-        //     msg = msg + " | irFrame tsp=" + std::to_string(irFrame->getTimeStamp());
-        // }
-        // if(colorFrame) {
-        //     msg = msg + " | colorFrame tsp=" + std::to_string(colorFrame->getTimeStamp());
-        // }
-        // if(depthFrame && irFrame) {
-        //     msg = msg + " | depth-ir diff=" + std::to_string((int64_t)depthFrame->getTimeStamp() - (int64_t)irFrame->getTimeStamp());
-        // }
-        // if(depthFrame && colorFrame) {
-        //     msg = msg + " | depth-color diff=" + std::to_string((int64_t)depthFrame->getTimeStamp() - (int64_t)colorFrame->getTimeStamp());
-        // }
-        // if(frameSyncMode_){
-        //     LOG_WARN(msg;
-        // }
-        outputFrameset(frameSet);
     }
 }
 
-void FrameAggregator::outputFrameset(std::shared_ptr<const FrameSet> frameSet) {
-    if(frameSet != nullptr) {
-        if(srcFrameQueueMap_.size() == 1 || frameAggregateOutputMode_ == OB_FRAME_AGGREGATE_OUTPUT_ANY_SITUATION) {
-            FrameSetCallbackFunc_(frameSet);
-        }
-        else if(frameAggregateOutputMode_ == OB_FRAME_AGGREGATE_OUTPUT_COLOR_FRAME_REQUIRE && withColorFrame_) {
-            FrameSetCallbackFunc_(frameSet);
+bool FrameAggregator::isOutputRequired(uint32_t frameCnt, bool withColorFrame) const {
+    if(srcFrameQueues_.size() == 1 || frameAggregateOutputMode_ == OB_FRAME_AGGREGATE_OUTPUT_ANY_SITUATION) {
+        return true;
+    }
+    else if(frameAggregateOutputMode_ == OB_FRAME_AGGREGATE_OUTPUT_COLOR_FRAME_REQUIRE) {
+        return withColorFrame;
+    }
+    else if(frameAggregateOutputMode_ == OB_FRAME_AGGREGATE_OUTPUT_ALL_TYPE_FRAME_REQUIRE) {
+        return frameCnt == srcFrameQueues_.size();
+    }
+    return false;
+}
+
+void FrameAggregator::dropOldestPendingFrameSet() {
+    auto frameSet = std::move(pendingFrameSets_.front());
+    pendingFrameSets_.pop_front();
+    droppedFrameSetCount_++;
+    LOG_WARN_INTVL("Frameset callback lags behind the streams, drop oldest frameset! dropped={}", droppedFrameSetCount_);
+
+    // The frames were counted as output when they were aggregated
+    auto frameCnt = frameSet->getCount();
+    for(uint32_t i = 0; i < frameCnt; i++) {
+        auto frameType = frameSet->getFrame(static_cast<int>(i))->getType();
+        int  slot      = frameType >= 0 && frameType < OB_FRAME_TYPE_COUNT ? frameTypeSlots_[frameType] : -1;
+        if(slot < 0) {
+            continue;
         }
-        else if(frameAggregateOutputMode_ == OB_FRAME_AGGREGATE_OUTPUT_ALL_TYPE_FRAME_REQUIRE && frameCnt_ == srcFrameQueueMap_.size()) {
-            FrameSetCallbackFunc_(frameSet);
+        auto &stats = srcFrameQueues_[slot].stats;
+        auto &count = frameCnt == 1 ? stats.unmatchedFrameCount : stats.matchedFrameCount;
+        if(count > 0) {
+            count--;
         }
+        stats.droppedFrameCount++;
     }
 }
 
+void FrameAggregator::deliverFrameSets(std::unique_lock<std::mutex> &lock) {
+    if(delivering_) {
+        return;  // the delivering thread will output the new framesets after its current one
+    }
+    delivering_ = true;
+    while(!pendingFrameSets_.empty()) {
+        auto frameSet = std::move(pendingFrameSets_.front());
+        pendingFrameSets_.pop_front();
+        lock.unlock();
+        TRY_EXECUTE(FrameSetCallbackFunc_(frameSet));
+        frameSet.reset();
+        lock.lock();
+    }
+    delivering_ = false;
+}
+
 void FrameAggregator::enableFrameSync(FrameSyncMode mode) {
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
     if(frameSyncMode_ != mode) {
-        std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
         frameSyncMode_ = mode;
-        clearAllFrameQueue();
+        clearAllFrameQueueLocked();
     }
 }
 
@@ -267,34 +333,35 @@ void FrameAggregator::setCallback(FrameCallback callback) {
 }
 
 void FrameAggregator::clearAllFrameQueue() {
-    std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
-    for(auto &item: srcFrameQueueMap_) {
-        auto &queue = item.second.queue;
-        while(!queue.empty()) {
-            queue.pop();
-        }
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
+    clearAllFrameQueueLocked();
+}
+
+void FrameAggregator::clearAllFrameQueueLocked() {
+    for(auto &srcQueue: srcFrameQueues_) {
+        srcQueue.clear();
     }
-    miniTimeStamp_     = 0;
+    pendingFrameSets_.clear();
     withOverflowQueue_ = false;
 }
 
-void FrameAggregator::reset() {
-    std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
-    clearAllFrameQueue();
-    srcFrameQueueMap_.clear();
+OBFrameSyncStats FrameAggregator::getFrameSyncStats(OBFrameType frameType) {
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
+    if(frameType < 0 || frameType >= OB_FRAME_TYPE_COUNT || frameTypeSlots_[frameType] < 0) {
+        throw invalid_value_exception(utils::string::to_string() << "The stream of frame type " << frameType << " is not enabled!");
+    }
+    return srcFrameQueues_[frameTypeSlots_[frameType]].stats;
 }
 
 void FrameAggregator::clearFrameQueue(OBFrameType frameType) {
-    std::unique_lock<std::recursive_mutex> lk(srcFrameQueueMutex_);
-    for(auto &item: srcFrameQueueMap_) {
-        if(frameType == item.first) {
-            auto &queue = item.second.queue;
-            while(!queue.empty()) {
-                queue.pop();
-            }
-            break;
+    std::unique_lock<std::mutex> lk(srcFrameQueueMutex_);
+    if(frameType >= 0 && frameType < OB_FRAME_TYPE_COUNT && frameTypeSlots_[frameType] >= 0) {
+        auto slot = static_cast<size_t>(frameTypeSlots_[frameType]);
+        srcFrameQueues_[slot].clear();
+        if(withOverflowQueue_ && slot == withOverflowQueueSlot_) {
+            withOverflowQueue_ = false;
         }
     }
 }
 
-}  // namespace libobsensor
\ No newline at end of file
+}  // namespace libobsensor
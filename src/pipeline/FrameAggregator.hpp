@@ -4,24 +4,68 @@
 #include "frame/Frame.hpp"
 #include "Config.hpp"
 
-#include <map>
-#include <queue>
+#include <array>
+#include <deque>
+#include <vector>
 #include <mutex>
 #include <memory>
 #include <algorithm>
 
 namespace libobsensor {
 
+// Frames of one stream waiting to be aggregated. The ring buffer capacity is fixed when the config is applied, so pushing and popping frames
+// never allocates. The sync timestamp of each frame is cached next to it, so matching does not need to query the frames.
 struct SourceFrameQueue {
-    std::queue<std::shared_ptr<const Frame>> queue;
-    uint32_t                                 maxSyncQueueSize_;
-    uint32_t                                 halfTspGap;
+    struct Item {
+        std::shared_ptr<const Frame> frame;
+        uint64_t                     timestamp;
+    };
+
+    OBFrameType       frameType;
+    OBStreamType      streamType;
+    std::vector<Item> items;
+    size_t            head;
+    size_t            size;
+    uint32_t          maxSyncQueueSize_;
+    uint32_t          halfTspGapUsec;
+    OBFrameSyncStats  stats;
+
+    bool empty() const {
+        return size == 0;
+    }
+    Item &front() {
+        return items[head];
+    }
+    // Returns false if the queue is full and its oldest frame was dropped to make room for the new one
+    bool push(std::shared_ptr<const Frame> frame, uint64_t timestamp) {
+        bool full = size == items.size();
+        if(full) {
+            pop();
+        }
+        auto &item     = items[(head + size) % items.size()];
+        item.frame     = std::move(frame);
+        item.timestamp = timestamp;
+        size++;
+        return !full;
+    }
+    void pop() {
+        items[head].frame.reset();
+        head = (head + 1) % items.size();
+        size--;
+    }
+    void clear() {
+        while(size > 0) {
+            pop();
+        }
+        head = 0;
+    }
 };
 
 enum FrameSyncMode {
     FrameSyncModeDisable,
     FrameSyncModeSyncAccordingFrameTimestamp,
     FrameSyncModeSyncAccordingSystemTimestamp,
+    FrameSyncModeSyncAccordingGlobalTimestamp,
 };
 class FrameAggregator {
 public:
@@ -37,24 +81,34 @@ public:
     void clearFrameQueue(OBFrameType frameType);
     void clearAllFrameQueue();
 
+    OBFrameSyncStats getFrameSyncStats(OBFrameType frameType);
+
 private:
-    void outputFrameset(std::shared_ptr<const FrameSet> frameSet);
-    void reset();
+    bool     isOutputRequired(uint32_t frameCnt, bool withColorFrame) const;
+    uint32_t getTspToleranceUsec(size_t slot1, size_t slot2) const;
+    void clearAllFrameQueueLocked();
     void tryAggregator();
+    void deliverFrameSets(std::unique_lock<std::mutex> &lock);
+    void dropOldestPendingFrameSet();
 
 private:
-    FrameSyncMode                           frameSyncMode_;
-    std::map<OBFrameType, SourceFrameQueue> srcFrameQueueMap_;
-    std::recursive_mutex                    srcFrameQueueMutex_;
-    FrameCallback                           FrameSetCallbackFunc_;
-    uint64_t                                miniTimeStamp_;
-    OBFrameType                             miniTimeStampFrameType_;
-    bool                                    withOverflowQueue_;
-    OBFrameType                             withOverflowQueueFrameType_;
-    bool                                    withEmptyQueue_;
-    OBFrameAggregateOutputMode              frameAggregateOutputMode_;
-    uint32_t                                frameCnt_;
-    bool                                    withColorFrame_;
-    bool                                    matchingRateFirst_;
+    FrameSyncMode frameSyncMode_;
+
+    // Streams are indexed by a dense slot, frameTypeSlots_ maps the frame type to its slot or -1 if the stream is not enabled
+    std::vector<SourceFrameQueue>            srcFrameQueues_;
+    std::array<int, OB_FRAME_TYPE_COUNT>     frameTypeSlots_;
+    std::vector<uint32_t>                    tspToleranceUsec_;  // max timestamp difference of matched frames of each pair of slots
+    std::mutex                               srcFrameQueueMutex_;
+    FrameCallback                            FrameSetCallbackFunc_;
+    bool                                     withOverflowQueue_;
+    size_t                                   withOverflowQueueSlot_;
+    OBFrameAggregateOutputMode               frameAggregateOutputMode_;
+    bool                                     matchingRateFirst_;
+
+    // Framesets are handed to the callback after the lock is released. Only one thread delivers at a time, so the output order is kept
+    // when frames are pushed from several sensor threads. While the callback lags behind, the oldest pending framesets are dropped.
+    std::deque<std::shared_ptr<const FrameSet>> pendingFrameSets_;
+    bool                                        delivering_;
+    uint64_t                                    droppedFrameSetCount_;
 };
-}  // namespace libobsensor
\ No newline at end of file
+}  // namespace libobsensor
@@ -11,6 +11,8 @@
 #include "utils/Utils.hpp"
 #include "IAlgParamManager.hpp"
 #include "frameprocessor/FrameProcessor.hpp"
+#include "frame/FrameBufferManager.hpp"
+#include "utils/PublicTypeHelper.hpp"
 
 #include <cmath>
 #include <algorithm>
@@ -25,7 +27,7 @@ Pipeline::Pipeline(std::shared_ptr<IDevice> dev) : device_(dev), config_(nullptr
 
     loadFrameQueueSizeConfig();
 
-    outputFrameQueue_ = std::make_shared<FrameQueue<const Frame>>(maxFrameQueueSize_);
+    outputFrameQueue_ = std::make_shared<FrameQueue<const Frame>>(maxFrameQueueSize_, FRAME_QUEUE_DROP_OLDEST);
     frameAggregator_  = std::make_shared<FrameAggregator>();
     frameAggregator_->setCallback([&](std::shared_ptr<const Frame> frame) { outputFrame(frame); });
 
@@ -132,6 +134,19 @@ void Pipeline::loadFrameQueueSizeConfig() {
     LOG_DEBUG("loadFrameQueueSizeConfig() config queue size: {}", maxFrameQueueSize_);
 }
 
+void Pipeline::prefaultFrameMemory(const StreamProfileList &spList) {
+    // Estimate the frame memory used by the streams: a full output queue of frames plus the one being processed for each stream
+    size_t frameMemorySize = 0;
+    for(const auto &sp: spList) {
+        if(!sp->is<VideoStreamProfile>()) {
+            continue;
+        }
+        auto vsp = sp->as<VideoStreamProfile>();
+        frameMemorySize += static_cast<size_t>(utils::calcVideoFrameMaxDataSize(vsp->getFormat(), vsp->getWidth(), vsp->getHeight())) * (maxFrameQueueSize_ + 1);
+    }
+    FrameMemoryAllocator::getInstance()->prefault(frameMemorySize);
+}
+
 StreamProfileList Pipeline::getEnabledStreamProfileList() {
     if(!config_) {
         return {};
@@ -190,6 +205,9 @@ void Pipeline::start(std::shared_ptr<const Config> cfg) {
         configAlignMode();
     }
 
+    if(frameSyncEnabled_) {
+        enableFrameSync();  // apply the sync timestamp type of the config
+    }
     frameAggregator_->updateConfig(config_, true);
 
     streamState_ = STREAM_STATE_STARTING;
@@ -220,6 +238,7 @@ void Pipeline::startStream() {
     outputFrameQueue_->reset();  // reset output frame queue before restart streams
 
     auto spList = config_->getEnabledStreamProfileList();
+    prefaultFrameMemory(spList);
     for(const auto &sp: spList) {
         auto streamType = sp->getType();
         auto sensorType = utils::mapStreamTypeToSensorType(streamType);
@@ -256,9 +275,8 @@ void Pipeline::outputFrame(std::shared_ptr<const Frame> frame) {
 
         if(outputFrameQueue_->fulled()) {
             LOG_WARN_INTVL("Output frameset queue is full, drop oldest frameset!");
-            outputFrameQueue_->dequeue();
         }
-        outputFrameQueue_->enqueue(std::move(frame));
+        outputFrameQueue_->enqueue(std::move(frame));  // the oldest frameset is dropped inside the queue if it is full
     }
 }
 
@@ -528,19 +546,39 @@ OBCalibrationParam Pipeline::getCalibrationParam(std::shared_ptr<Config> cfg) {
 }
 
 void Pipeline::enableFrameSync() {
-    if(device_->getExtensionInfo("AllSensorsUsingSameClock") == "true") {
+    frameSyncEnabled_  = true;
+    auto timestampType = config_ ? config_->getFrameSyncTimestampType() : OB_FRAME_SYNC_TIMESTAMP_AUTO;
+    switch(timestampType) {
+    case OB_FRAME_SYNC_TIMESTAMP_DEVICE:
         frameAggregator_->enableFrameSync(FrameSyncModeSyncAccordingFrameTimestamp);
-    }
-    else {
-        LOG_WARN("Frame sync is not supported for sensors with different clocks! Use system timestamp instead, the accuracy may be lower!");
+        break;
+    case OB_FRAME_SYNC_TIMESTAMP_GLOBAL:
+        frameAggregator_->enableFrameSync(FrameSyncModeSyncAccordingGlobalTimestamp);
+        break;
+    case OB_FRAME_SYNC_TIMESTAMP_SYSTEM:
         frameAggregator_->enableFrameSync(FrameSyncModeSyncAccordingSystemTimestamp);
+        break;
+    default:
+        if(device_->getExtensionInfo("AllSensorsUsingSameClock") == "true") {
+            frameAggregator_->enableFrameSync(FrameSyncModeSyncAccordingFrameTimestamp);
+        }
+        else {
+            LOG_WARN("Frame sync is not supported for sensors with different clocks! Use system timestamp instead, the accuracy may be lower!");
+            frameAggregator_->enableFrameSync(FrameSyncModeSyncAccordingSystemTimestamp);
+        }
+        break;
     }
 }
 
 void Pipeline::disableFrameSync() {
+    frameSyncEnabled_ = false;
     frameAggregator_->enableFrameSync(FrameSyncModeDisable);
 }
 
+OBFrameSyncStats Pipeline::getFrameSyncStats(OBStreamType streamType) {
+    return frameAggregator_->getFrameSyncStats(utils::mapStreamTypeToFrameType(streamType));
+}
+
 void Pipeline::checkHardwareD2CConfig() {
     auto frameProcessor      = device_->getComponentT<FrameProcessor>(OB_DEV_COMPONENT_DEPTH_FRAME_PROCESSOR, false);
     auto depthFrameProcessor = std::dynamic_pointer_cast<DepthFrameProcessor>(frameProcessor.get());
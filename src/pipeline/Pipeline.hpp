@@ -29,8 +29,9 @@ public:
     OBCameraParam getCameraParam(uint32_t colorWidth, uint32_t colorHeight, uint32_t depthWidth, uint32_t depthHeight);
     OBCalibrationParam getCalibrationParam(std::shared_ptr<Config> cfg);
 
-    void enableFrameSync();
-    void disableFrameSync();
+    void             enableFrameSync();
+    void             disableFrameSync();
+    OBFrameSyncStats getFrameSyncStats(OBStreamType streamType);
 
     std::shared_ptr<const Config> getConfig();
     void switchConfig(std::shared_ptr<const Config> cfg);
@@ -43,6 +44,7 @@ private:
 
     void loadDefaultConfig();
     void loadFrameQueueSizeConfig();
+    void prefaultFrameMemory(const StreamProfileList &spList);
 
     void configAlignMode();
     void resetAlignMode();
@@ -65,6 +67,7 @@ private:
     FrameCallback                            pipelineCallback_;
 
     std::shared_ptr<FrameAggregator> frameAggregator_;
+    bool                             frameSyncEnabled_ = false;
 
     int maxFrameQueueSize_ = 10;
 };
@@ -3,9 +3,18 @@
 #include "exception/ObException.hpp"
 #include "frame/FrameFactory.hpp"
 #include "utils/Utils.hpp"
+#include "logger/LoggerInterval.hpp"
+
+#include <cstring>
 
 namespace libobsensor {
 
+static const size_t   PACK_SIZE                = 248;
+static const size_t   RECEIVE_BUFFER_SIZE      = PACK_SIZE * 64;
+static const size_t   MAX_RECEIVE_BUFFER_COUNT = 8;
+static const uint32_t POLL_TIMEOUT_MS          = 100;  // bounds the delay of stopStream
+static const uint32_t RETRY_INTERVAL_MS        = 100;
+
 NetDataStreamPort::NetDataStreamPort(std::shared_ptr<const NetDataStreamPortInfo> portInfo) : portInfo_(portInfo), isStreaming_(false) {}
 
 NetDataStreamPort::~NetDataStreamPort() noexcept{
@@ -47,38 +56,77 @@ void NetDataStreamPort::stopStream() {
 }
 
 void NetDataStreamPort::readData() {
-    const int              PACK_SIZE     = 248;
-    int                    dataRecvdSize = 0;
-    int                    readSize      = 0;
-    std::shared_ptr<Frame> frame;
-    uint8_t               *data = nullptr;
+    ReceiveBuffer buffer;
+    size_t        dataSize   = 0;  // bytes received into the buffer
+    size_t        parsedSize = 0;  // bytes of the buffer already output as packets
     while(isStreaming_) {
-        if(!frame) {
-            frame         = FrameFactory::createFrame(OB_FRAME_UNKNOWN, OB_FORMAT_UNKNOWN, PACK_SIZE);
-            data          = frame->getDataMutable();
-            dataRecvdSize = 0;
+        if(!buffer) {
+            buffer     = acquireReceiveBuffer();
+            dataSize   = 0;
+            parsedSize = 0;
         }
 
-        BEGIN_TRY_EXECUTE({ readSize = tcpClient_->read(data + dataRecvdSize, PACK_SIZE - dataRecvdSize); })
+        int readSize = 0;
+        BEGIN_TRY_EXECUTE({
+            readSize = tcpClient_->readAvailable(buffer->data() + dataSize, static_cast<uint32_t>(buffer->size() - dataSize), POLL_TIMEOUT_MS);
+        })
         CATCH_EXCEPTION_AND_EXECUTE({
-            LOG_WARN("read data failed!");
+            LOG_WARN_INTVL("read data failed!");
             readSize = -1;
+            // The connection could not be re-established, do not retry at once
+            std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_INTERVAL_MS));
         })
 
         if(readSize < 0) {
-            dataRecvdSize = 0;
+            dataSize = parsedSize;  // drop the incomplete packet of the lost connection
+            continue;
         }
-        else {
-            dataRecvdSize += readSize;
+        if(readSize == 0) {
+            continue;
         }
 
-        if(PACK_SIZE == dataRecvdSize && isStreaming_) {
-            auto realtime = utils::getNowTimesUs();
-            frame->setSystemTimeStampUsec(realtime);
-            callback_(frame);
-            frame.reset();
+        dataSize += readSize;
+        dispatchPackets(buffer, parsedSize, dataSize);
+
+        if(buffer->size() - dataSize < PACK_SIZE) {
+            // No room left for a whole packet, continue in another buffer with the incomplete packet moved to its front
+            auto remainSize = dataSize - parsedSize;
+            auto nextBuffer = acquireReceiveBuffer();
+            memcpy(nextBuffer->data(), buffer->data() + parsedSize, remainSize);
+            buffer     = nextBuffer;
+            dataSize   = remainSize;
+            parsedSize = 0;
+        }
+    }
+}
+
+void NetDataStreamPort::dispatchPackets(const ReceiveBuffer &buffer, size_t &parsedSize, size_t dataSize) {
+    auto realtime = utils::getNowTimesUs();
+    while(dataSize - parsedSize >= PACK_SIZE && isStreaming_) {
+        // The frame references the packet in the receive buffer and keeps the buffer from being reused until the frame is released
+        auto frame = std::make_shared<Frame>(buffer->data() + parsedSize, PACK_SIZE, OB_FRAME_UNKNOWN, [buffer]() {});
+        frame->setSystemTimeStampUsec(realtime);
+        callback_(frame);
+        parsedSize += PACK_SIZE;
+    }
+}
+
+NetDataStreamPort::ReceiveBuffer NetDataStreamPort::acquireReceiveBuffer() {
+    for(auto &buffer: receiveBuffers_) {
+        if(buffer.use_count() == 1) {
+            return buffer;
         }
     }
+
+    auto buffer = std::make_shared<std::vector<uint8_t>>(RECEIVE_BUFFER_SIZE);
+    if(receiveBuffers_.size() < MAX_RECEIVE_BUFFER_COUNT) {
+        receiveBuffers_.push_back(buffer);
+    }
+    else {
+        // Frames are held by the user, the buffer is freed with its last frame
+        LOG_DEBUG_INTVL("NetDataStreamPort all receive buffers are in use, allocate a temporary one");
+    }
+    return buffer;
 }
 
 }  // namespace libobsensor
@@ -4,6 +4,8 @@
 #include <set>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <vector>
 
 namespace libobsensor {
 
@@ -37,9 +39,18 @@ public:
 public:
     void readData();
 
+private:
+    using ReceiveBuffer = std::shared_ptr<std::vector<uint8_t>>;
+    ReceiveBuffer acquireReceiveBuffer();
+    void          dispatchPackets(const ReceiveBuffer &buffer, size_t &parsedSize, size_t dataSize);
+
 private:
     std::shared_ptr<const NetDataStreamPortInfo> portInfo_;
-    bool                                         isStreaming_;
+    std::atomic<bool>                            isStreaming_;
+
+    // Socket data is read into these buffers in large chunks, and the packets are output as frames that reference the buffer they were read
+    // into. A buffer is reused once all frames that reference it have been released.
+    std::vector<ReceiveBuffer> receiveBuffers_;
 
     std::shared_ptr<VendorTCPClient> tcpClient_;
     std::thread                      readDataThread_;
@@ -6,6 +6,9 @@
 #include "utils/Utils.hpp"
 #include "frame/FrameFactory.hpp"
 #include "stream/StreamProfile.hpp"
+#include "utils/PublicTypeHelper.hpp"
+#include "logger/LoggerInterval.hpp"
+#include "environment/EnvConfig.hpp"
 
 #include <vector>
 #include <map>
@@ -14,6 +17,9 @@
 
 namespace libobsensor {
 
+const uint32_t ObRTPSink::DEFAULT_RTP_BUFFER_COUNT;
+const uint32_t ObRTPSink::MAX_FRAME_DATA_SIZE;
+
 #define H264_NAL_SPS 7  // Sequence parameter set
 #define H264_NAL_PPS 8  // Picture parameter set
 
@@ -63,33 +69,31 @@ ObRTPSink::ObRTPSink(std::shared_ptr<const StreamProfile> streamProfile, UsageEn
       subsession_(subsession),
       frameCallback_(callback),
       streamProfile_(streamProfile),
+      frameType_(utils::mapStreamTypeToFrameType(streamProfile->getType())),
       frameCount_(0),
       destroy_(false),
+      rtpBufferSize_(MAX_FRAME_DATA_SIZE),
+      maxRTPBufferCount_(DEFAULT_RTP_BUFFER_COUNT),
+      rtpBufferCount_(0),
+      overflowCount_(0),
+      truncatedCount_(0),
       currentBuffer_(nullptr) {
     streamId_ = strDup(streamId);
     envir() << "ObRTPSink created! streamId = " << streamId_ << "\n";
 
-    auto     frame       = std::make_shared<ObRTPBuffer>(MAX_FRAME_DATA_SIZE);
-    auto     frameBuffer = frame->getBuffer();
-    uint32_t headerSize  = 0;
+    const uint8_t nalUnitStartCode[4] = { 0, 0, 0, 1 };
 
     // Load vps/pps/sps into the frame header
     if(strcmp(subsession_.codecName(), "H264") == 0) {
-        unsigned int  nalUnitNum;
-        SPropRecord  *pSPropRecord;
-        unsigned char nalUnitStartCode[4] = { 0, 0, 0, 1 };
+        unsigned int nalUnitNum;
+        SPropRecord *pSPropRecord;
 
         pSPropRecord = parseSPropParameterSets(subsession_.fmtp_spropparametersets(), nalUnitNum);
         for(unsigned int i = 0; i < nalUnitNum; i++) {
-            memcpy(frameBuffer + headerSize, &nalUnitStartCode[0], 4);
-            headerSize += 4;
-            memcpy(frameBuffer + headerSize, pSPropRecord[i].sPropBytes, pSPropRecord[i].sPropLength);
-            headerSize += pSPropRecord[i].sPropLength;
+            staticHeader_.insert(staticHeader_.end(), nalUnitStartCode, nalUnitStartCode + 4);
+            staticHeader_.insert(staticHeader_.end(), pSPropRecord[i].sPropBytes, pSPropRecord[i].sPropBytes + pSPropRecord[i].sPropLength);
         }
-
-        memcpy(frameBuffer + headerSize, &nalUnitStartCode[0], 4);
-        headerSize += 4;
-        frame->setHeaderSize(headerSize);
+        staticHeader_.insert(staticHeader_.end(), nalUnitStartCode, nalUnitStartCode + 4);
         delete[] pSPropRecord;
     }
     else if(strcmp(subsession_.codecName(), "H265") == 0) {
@@ -99,29 +103,28 @@ ObRTPSink::ObRTPSink(std::shared_ptr<const StreamProfile> streamProfile, UsageEn
         sPropRecords[1] = parseSPropParameterSets(subsession_.fmtp_spropsps(), numSPropRecords[1]);
         sPropRecords[2] = parseSPropParameterSets(subsession_.fmtp_sproppps(), numSPropRecords[2]);
 
-        unsigned char nalUnitStartCode[4] = { 0, 0, 0, 1 };
-
         for(uint8_t i = 0; i < 3; i++) {
             for(uint32_t j = 0; j < numSPropRecords[i]; j++) {
-                memcpy(frameBuffer + headerSize, &nalUnitStartCode[0], 4);
-                headerSize += 4;
-                memcpy(frameBuffer + headerSize, sPropRecords[i][j].sPropBytes, sPropRecords[i][j].sPropLength);
-                headerSize += sPropRecords[i][j].sPropLength;
+                staticHeader_.insert(staticHeader_.end(), nalUnitStartCode, nalUnitStartCode + 4);
+                staticHeader_.insert(staticHeader_.end(), sPropRecords[i][j].sPropBytes, sPropRecords[i][j].sPropBytes + sPropRecords[i][j].sPropLength);
             }
             delete[] sPropRecords[i];
         }
-        memcpy(frameBuffer + headerSize, &nalUnitStartCode[0], 4);
-        headerSize += 4;
-        frame->setHeaderSize(headerSize);
+        staticHeader_.insert(staticHeader_.end(), nalUnitStartCode, nalUnitStartCode + 4);
     }
     // else: header size is 0
 
-    std::unique_lock<std::mutex> lk(reclaimedRTPBufferMutex_);
-    for(uint8_t i = 0; i < MAX_FRAME_NUM - 1; i++) {
-        auto newFrame = frame->cloneAndCopyHeader();
-        reclaimedRTPBufferQueue_.push(newFrame);
+    if(streamProfile_->is<VideoStreamProfile>()) {
+        auto vsp       = streamProfile_->as<VideoStreamProfile>();
+        rtpBufferSize_ = calcRTPBufferSize(vsp->getFormat(), vsp->getWidth(), vsp->getHeight(),
+                                           static_cast<uint32_t>(staticHeader_.size() + sizeof(OBNetworkFrameHeader)));
     }
-    reclaimedRTPBufferQueue_.push(frame);
+
+    int bufferCount = 0;
+    if(EnvConfig::getInstance()->getIntValue("Misc.RTPFrameBufferCount", bufferCount) && bufferCount > 0) {
+        maxRTPBufferCount_ = std::max<uint32_t>(static_cast<uint32_t>(bufferCount), 2);  // one being received and one being output
+    }
+    LOG_DEBUG("ObRTPSink created: rtp buffer size={}, max rtp buffer count={}", rtpBufferSize_, maxRTPBufferCount_);
 
     outputFrameThread_ = std::thread(&ObRTPSink::outputFrameFunc, this);
 }
@@ -135,6 +138,29 @@ ObRTPSink::~ObRTPSink() noexcept {
     if(outputFrameThread_.joinable()) {
         outputFrameThread_.join();
     }
+    if(overflowCount_ > 0) {
+        LOG_WARN("ObRTPSink destroyed, {} frames were dropped because no rtp buffer was available", overflowCount_.load());
+    }
+    if(truncatedCount_ > 0) {
+        LOG_WARN("ObRTPSink destroyed, {} frames were dropped because they were larger than the rtp buffer size {}", truncatedCount_, rtpBufferSize_);
+    }
+}
+
+uint32_t ObRTPSink::calcRTPBufferSize(OBFormat format, uint32_t width, uint32_t height, uint32_t headerSize) {
+    uint32_t frameSize = utils::calcVideoFrameMaxDataSize(format, width, height);
+    switch(format) {
+    case OB_FORMAT_H264:
+    case OB_FORMAT_H265:
+    case OB_FORMAT_HEVC:
+    case OB_FORMAT_MJPG:
+    case OB_FORMAT_RLE:
+    case OB_FORMAT_RVL:
+        frameSize = std::max(MAX_FRAME_DATA_SIZE, width * height * 3);
+        break;
+    default:
+        break;
+    }
+    return headerSize + frameSize;
 }
 
 void ObRTPSink::afterGettingFrame(void *clientData, unsigned frameSize, unsigned numTruncatedBytes, struct timeval presentationTime,
@@ -144,8 +170,6 @@ void ObRTPSink::afterGettingFrame(void *clientData, unsigned frameSize, unsigned
 }
 
 void ObRTPSink::afterGettingFrame(unsigned frameSize, unsigned numTruncatedBytes, struct timeval presentationTime, unsigned /*duration in microseconds*/) {
-    utils::unusedVar(numTruncatedBytes);
-
     do {
         if(strcmp(subsession_.codecName(), "H264") == 0) {
             auto recv = currentBuffer_->getRecvdDataBuffer();
@@ -160,6 +184,19 @@ void ObRTPSink::afterGettingFrame(unsigned frameSize, unsigned numTruncatedBytes
             }
         }
 
+        if(currentBuffer_ == discardBuffer_) {
+            currentBuffer_.reset();
+            break;
+        }
+
+        if(numTruncatedBytes > 0) {
+            // A cut bitstream or raw frame is corrupt, drop it and receive the next access unit into the same buffer
+            truncatedCount_++;
+            LOG_WARN_INTVL("Drop frame larger than the rtp buffer size {}: {} bytes truncated, truncated count={}", rtpBufferSize_, numTruncatedBytes,
+                           truncatedCount_);
+            break;
+        }
+
         currentBuffer_->setRecvdDataSize(frameSize);
         currentBuffer_->setCodecName(subsession_.codecName());
         currentBuffer_->setSequenceNumber(frameCount_);
@@ -185,29 +222,52 @@ Boolean ObRTPSink::continuePlaying() {
     }
 
     if(!currentBuffer_) {
-        std::unique_lock<std::mutex> lk(reclaimedRTPBufferMutex_);
-        if(!reclaimedRTPBufferQueue_.empty()) {
-            currentBuffer_ = reclaimedRTPBufferQueue_.front();
-            reclaimedRTPBufferQueue_.pop();
-        }
+        currentBuffer_ = acquireRTPBuffer();
     }
 
     if(!currentBuffer_) {
-        // Actively drop frames
-        std::unique_lock<std::mutex> lk(outputRTPBufferQueueMutex_);
-        if(!outputRTPBufferQueue_.empty()) {
-            currentBuffer_ = outputRTPBufferQueue_.front();
-            outputRTPBufferQueue_.pop();
-            LOG_WARN("Drop output-frame to receive new frame due to reclaimed-frame queue is empty: devTsp={}", currentBuffer_->getTimestamp());
+        // The frame memory pool is exhausted, receive the access unit into a private buffer and drop it
+        if(!discardBuffer_) {
+            auto size      = rtpBufferSize_;
+            auto frame     = std::make_shared<Frame>(new uint8_t[size], size, frameType_);
+            discardBuffer_ = std::make_shared<ObRTPBuffer>(frame, staticHeader_);
         }
+        currentBuffer_ = discardBuffer_;
+        overflowCount_++;
+        LOG_WARN_INTVL("Drop frame due to frame memory pool is exhausted, overflow count={}", overflowCount_.load());
     }
 
     // Request the next frame of data from our input source.  "afterGettingFrame()" will get called later, when it arrives:
-    fSource->getNextFrame(currentBuffer_->getRecvdDataBuffer(), MAX_FRAME_DATA_SIZE - currentBuffer_->getStaticHeaderSize(), afterGettingFrame, this,
-                          onSourceClosure, this);
+    fSource->getNextFrame(currentBuffer_->getRecvdDataBuffer(), currentBuffer_->getBufferSize() - currentBuffer_->getStaticHeaderSize(), afterGettingFrame,
+                          this, onSourceClosure, this);
     return true;
 }
 
+std::shared_ptr<ObRTPBuffer> ObRTPSink::acquireRTPBuffer() {
+    if(rtpBufferCount_ < maxRTPBufferCount_) {
+        std::shared_ptr<Frame> frame;
+        BEGIN_TRY_EXECUTE({ frame = FrameFactory::createFrame(frameType_, streamProfile_->getFormat(), rtpBufferSize_); })
+        CATCH_EXCEPTION_AND_EXECUTE({ frame.reset(); })
+        if(frame) {
+            frame->setStreamProfile(streamProfile_);
+            rtpBufferCount_++;
+            return std::make_shared<ObRTPBuffer>(frame, staticHeader_);
+        }
+    }
+
+    // Actively drop frames: receive into the buffer of the oldest frame waiting for output
+    std::unique_lock<std::mutex> lk(outputRTPBufferQueueMutex_);
+    if(outputRTPBufferQueue_.empty()) {
+        return nullptr;
+    }
+    auto buffer = outputRTPBufferQueue_.front();
+    outputRTPBufferQueue_.pop();
+    overflowCount_++;
+    LOG_WARN_INTVL("Drop output-frame to receive new frame due to all rtp buffers are in use: devTsp={}, overflow count={}", buffer->getTimestamp(),
+                   overflowCount_.load());
+    return buffer;
+}
+
 void ObRTPSink::outputFrameFunc() {
     while(!destroy_) {
         std::shared_ptr<ObRTPBuffer> output;
@@ -235,7 +295,7 @@ void ObRTPSink::outputFrameFunc() {
             }
 
             TRY_EXECUTE({
-                auto frame = FrameFactory::createFrameFromStreamProfile(streamProfile_);
+                auto frame = output->getFrame();
 
                 uint32_t frameOffset = 0;
                 if(isOBVendorCodec(codecName)) {
@@ -252,20 +312,32 @@ void ObRTPSink::outputFrameFunc() {
                     frame->setNumber(output->getSequenceNumber());
                 }
 
-                if(output->getStaticHeaderSize() > 0) {
-                    frame->updateData(output->getBuffer(), output->getRecvdDataSize() + output->getStaticHeaderSize());
+                if(output->getStaticHeaderSize() > 0 || frameOffset == 0) {
+                    // The access unit starts at the beginning of the buffer, output the frame of the buffer itself
+                    frame->setDataSize(output->getRecvdDataSize() + output->getStaticHeaderSize());
                 }
                 else {
-                    frame->updateData(output->getRecvdDataBuffer() + frameOffset, output->getRecvdDataSize() - frameOffset);
+                    // Output a frame referencing the data after the vendor header, which keeps the buffer until it is released
+                    auto vsp       = streamProfile_->as<VideoStreamProfile>();
+                    auto viewFrame = FrameFactory::createVideoFrameFromUserBuffer(frameType_, format, vsp->getWidth(), vsp->getHeight(), 0,
+                                                                                  output->getRecvdDataBuffer(static_cast<uint16_t>(frameOffset)),
+                                                                                  output->getRecvdDataSize() - frameOffset, [frame]() {});
+                    viewFrame->setStreamProfile(streamProfile_);
+                    viewFrame->copyInfoFromOther(frame);
+                    frame = viewFrame;
                 }
 
+                // The buffer is owned by the frame from now on
+                output.reset();
+                rtpBufferCount_--;
                 frameCallback_(frame);
             });
         } while(0);
 
-        {
-            std::unique_lock<std::mutex> lk(reclaimedRTPBufferMutex_);
-            reclaimedRTPBufferQueue_.push(output);
+        if(output) {
+            // Not output, reclaim the buffer to the pool
+            output.reset();
+            rtpBufferCount_--;
         }
     }
 }
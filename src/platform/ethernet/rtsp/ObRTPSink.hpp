@@ -2,6 +2,7 @@
 #include "IFrame.hpp"
 #include "IStreamProfile.hpp"
 #include "exception/ObException.hpp"
+#include "frame/Frame.hpp"
 
 #include "liveMedia.hh"
 #include "BasicUsageEnvironment.hh"
@@ -11,18 +12,31 @@
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <vector>
 
 namespace libobsensor {
 
+// An RTP receive buffer, backed by a frame of the frame memory pool. The access unit is received into the frame data directly, so the frame
+// can be output without copying the data, and the buffer is reclaimed to the pool when the frame is released.
 class ObRTPBuffer {
 public:
-    ObRTPBuffer(uint32_t maxDataSize)
-        : bufferSize_(maxDataSize), sequenceNumber_(0), timestamp_(0), staticHeaderSize_(0), recvdDataSize_(0), dynamicHeaderSize_(0) {
-        buffer_ = new uint8_t[maxDataSize];
+    ObRTPBuffer(std::shared_ptr<Frame> frame, const std::vector<uint8_t> &staticHeader)
+        : frame_(frame),
+          buffer_(frame->getDataMutable()),
+          bufferSize_(static_cast<uint32_t>(frame->getDataSize())),
+          sequenceNumber_(0),
+          timestamp_(0),
+          staticHeaderSize_(0),
+          recvdDataSize_(0),
+          dynamicHeaderSize_(0) {
+        if(!staticHeader.empty()) {
+            memcpy(buffer_, staticHeader.data(), staticHeader.size());
+            staticHeaderSize_ = static_cast<uint32_t>(staticHeader.size());
+        }
     }
 
-    ~ObRTPBuffer() {
-        delete[] buffer_;
+    std::shared_ptr<Frame> getFrame() const {
+        return frame_;
     }
 
     void setSequenceNumber(uint64_t seq) {
@@ -95,16 +109,10 @@ public:
         return buffer_ + staticHeaderSize_ + offset;
     }
 
-    std::shared_ptr<ObRTPBuffer> cloneAndCopyHeader() {
-        auto frame = std::make_shared<ObRTPBuffer>(bufferSize_);
-        memcpy(frame->getBuffer(), buffer_, staticHeaderSize_);
-        frame->setHeaderSize(staticHeaderSize_);
-        return frame;
-    }
-
 private:
-    uint8_t *buffer_;
-    uint32_t bufferSize_;
+    std::shared_ptr<Frame> frame_;
+    uint8_t               *buffer_;
+    uint32_t               bufferSize_;
 
     uint64_t    sequenceNumber_;
     uint64_t    timestamp_;
@@ -124,6 +132,11 @@ public:
 
     virtual ~ObRTPSink() noexcept;
 
+    // The size of the RTP buffers of a stream, the header put in front of the access units included. Raw frames have a known size, the
+    // buffers of compressed streams (H.264/H.265, MJPEG, RVL, ...) are sized for the largest access unit of any stream, as a key frame may
+    // take more than the pixels of the frame.
+    static uint32_t calcRTPBufferSize(OBFormat format, uint32_t width, uint32_t height, uint32_t headerSize);
+
 protected:
     ObRTPSink(std::shared_ptr<const StreamProfile> streamProfile, UsageEnvironment &env, MediaSubsession &subsession, MutableFrameCallback callback, char const *streamId = NULL);
 
@@ -134,26 +147,36 @@ private:
 
 private:
     // redefined virtual functions:
-    virtual Boolean continuePlaying();
-    void            outputFrameFunc();
+    virtual Boolean              continuePlaying();
+    void                         outputFrameFunc();
+    std::shared_ptr<ObRTPBuffer> acquireRTPBuffer();
 
 private:
     MediaSubsession                     &subsession_;
     char                                *streamId_;
     MutableFrameCallback                 frameCallback_;
     std::shared_ptr<const StreamProfile> streamProfile_;
+    OBFrameType                          frameType_;
     uint64_t                             frameCount_;
     std::atomic<bool>                    destroy_;
 
-    std::queue<std::shared_ptr<ObRTPBuffer>> reclaimedRTPBufferQueue_;
-    std::mutex                               reclaimedRTPBufferMutex_;
+    std::vector<uint8_t> staticHeader_;  // vps/sps/pps and start code put in front of each H.264/H.265 access unit
+    uint32_t             rtpBufferSize_;
+    uint32_t             maxRTPBufferCount_;
+    // RTP buffers held by the sink, i.e. being received into, waiting for output or being output. Buffers of frames that were output belong to
+    // the frames and are reclaimed to the pool when the frames are released.
+    std::atomic<uint32_t>        rtpBufferCount_;
+    std::atomic<uint64_t>        overflowCount_;   // access units dropped because no RTP buffer was available
+    uint64_t                     truncatedCount_;  // access units dropped because they did not fit in the RTP buffer
+    std::shared_ptr<ObRTPBuffer> discardBuffer_;  // receives the access units that are dropped because the pool is exhausted
+
     std::queue<std::shared_ptr<ObRTPBuffer>> outputRTPBufferQueue_;
     std::mutex                               outputRTPBufferQueueMutex_;
     std::condition_variable                  frameAvailableCv_;
     std::shared_ptr<ObRTPBuffer>             currentBuffer_;
 
-    const uint8_t  MAX_FRAME_NUM       = 4;
-    const uint32_t MAX_FRAME_DATA_SIZE = 3 * 3840 * 2160;
+    static const uint32_t DEFAULT_RTP_BUFFER_COUNT = 4;
+    static const uint32_t MAX_FRAME_DATA_SIZE      = 3 * 3840 * 2160;
 
     std::thread outputFrameThread_;
 };
@@ -1,11 +1,13 @@
 #if(defined(WIN32) || defined(_WIN32) || defined(WINCE))
 #include <winsock2.h>
 #include <WS2tcpip.h>
+#define SOCKET_POLL WSAPoll
 #else
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <errno.h>
@@ -17,6 +19,7 @@
 #define TIMEVAL timeval
 #define SD_BOTH SHUT_RDWR
 #define closesocket close
+#define SOCKET_POLL poll
 #define ioctlsocket ioctl
 #define TIMEVAL timeval
 #define SD_BOTH SHUT_RDWR
@@ -114,8 +114,8 @@ void VendorTCPClient::socketConnect() {
                                                                               << ", port=" << port_ << ", err=socket is not ready & timeout");
     }
 #else
-    // check if the socket is ready
-    rst = select(0, NULL, &write, &err, &connTimeout);
+    // check if the socket is ready, nfds is ignored on Windows but must cover the socket elsewhere, or select just waits for the timeout
+    rst = select(static_cast<int>(socketFd_ + 1), NULL, &write, &err, &connTimeout);
     if(!FD_ISSET(socketFd_, &write)) {
         throw libobsensor::invalid_value_exception(utils::string::to_string() << "VendorTCPClient: Connect to server failed! addr=" << address_
                                                                               << ", port=" << port_ << ", err=socket is not ready & timeout");
@@ -178,6 +178,61 @@ int VendorTCPClient::read(uint8_t *data, const uint32_t dataLen) {
     return -1;
 }
 
+int VendorTCPClient::readAvailable(uint8_t *data, const uint32_t dataLen, uint32_t timeoutMs) {
+    if(flushed_) {
+        return -1;
+    }
+
+    pollfd pollFd;
+    pollFd.fd      = socketFd_;
+    pollFd.events  = POLLIN;
+    pollFd.revents = 0;
+    int rst        = SOCKET_POLL(&pollFd, 1, static_cast<int>(timeoutMs));
+    if(rst == 0) {
+        return 0;
+    }
+    if(rst < 0) {
+        rst = GET_LAST_ERROR();
+#if(!defined(WIN32) && !defined(_WIN32) && !defined(WINCE))
+        if(rst == EINTR) {
+            return 0;
+        }
+#endif
+        throw libobsensor::io_exception(utils::string::to_string() << "VendorTCPClient poll socket failed! socket=" << socketFd_ << ", err_code=" << rst);
+    }
+    if(pollFd.revents & POLLNVAL) {
+        throw libobsensor::io_exception(utils::string::to_string() << "VendorTCPClient poll socket failed! socket=" << socketFd_ << ", invalid socket");
+    }
+
+    // Readable, or POLLERR/POLLHUP which recv reports below
+    rst = recv(socketFd_, (char *)data, dataLen, 0);
+    if(rst > 0) {
+        return rst;
+    }
+    if(rst == 0) {
+        // Closed by the peer
+        socketReconnect();
+        return -1;
+    }
+
+    rst = GET_LAST_ERROR();
+#if(defined(WIN32) || defined(_WIN32) || defined(WINCE))
+    if(rst == WSAEWOULDBLOCK) {
+        return 0;
+    }
+    if(rst == WSAECONNRESET || rst == WSAENOTCONN || rst == WSAETIMEDOUT) {
+#else
+    if(rst == EAGAIN || rst == EWOULDBLOCK || rst == EINTR) {
+        return 0;
+    }
+    if(rst == ECONNRESET || rst == ENOTCONN || rst == ETIMEDOUT) {
+#endif
+        socketReconnect();
+        return -1;
+    }
+    throw libobsensor::io_exception(utils::string::to_string() << "VendorTCPClient read data failed! socket=" << socketFd_ << ", err_code=" << rst);
+}
+
 void VendorTCPClient::write(const uint8_t *data, const uint32_t dataLen) {
     uint8_t retry = 2;
     while(retry-- && !flushed_) {
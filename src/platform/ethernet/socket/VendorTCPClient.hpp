@@ -10,6 +10,9 @@ public:
     ~VendorTCPClient() noexcept;
 
     int  read(uint8_t *data, const uint32_t dataLen);
+    // Wait up to timeoutMs for data to arrive, then read what has arrived (at most dataLen bytes) without blocking.
+    // Returns the number of bytes read, 0 on timeout, or -1 if the connection was lost and re-established.
+    int  readAvailable(uint8_t *data, const uint32_t dataLen, uint32_t timeoutMs);
     void write(const uint8_t *data, const uint32_t dataLen);
 
     void flush();
@@ -11,12 +11,14 @@
 #include "ObV4lUvcDevicePort.hpp"
 
 #include "logger/Logger.hpp"
+#include "logger/LoggerInterval.hpp"
 #include "exception/ObException.hpp"
 #include "utils/Utils.hpp"
 #include "stream/StreamProfile.hpp"
 #include "utils/PublicTypeHelper.hpp"
 #include "frame/FrameFactory.hpp"
 #include "stream/StreamProfileFactory.hpp"
+#include "environment/EnvConfig.hpp"
 
 namespace libobsensor {
 
@@ -308,6 +310,19 @@ std::string fourccToString(uint32_t id) {
 }
 
 ObV4lUvcDevicePort::ObV4lUvcDevicePort(std::shared_ptr<const USBSourcePortInfo> portInfo) : portInfo_(portInfo) {
+    auto envConfig   = EnvConfig::getInstance();
+    int  bufferCount = 0;
+    if(envConfig->getIntValue("Device.V4L2BufferCount", bufferCount)) {
+        if(bufferCount < static_cast<int>(DEFAULT_BUFFER_COUNT) || bufferCount > static_cast<int>(MAX_BUFFER_COUNT)) {
+            LOG_WARN("Invalid V4L2 buffer count {}, valid range is [{}, {}], will use {} instead", bufferCount, DEFAULT_BUFFER_COUNT, MAX_BUFFER_COUNT,
+                     DEFAULT_BUFFER_COUNT);
+            bufferCount = DEFAULT_BUFFER_COUNT;
+        }
+        bufferCount_ = static_cast<uint32_t>(bufferCount);
+    }
+    envConfig->getBooleanValue("Device.V4L2ZeroCopy", zeroCopy_);
+    LOG_DEBUG("V4L2 capture buffer count: {}, zero-copy: {}", bufferCount_, zeroCopy_);
+
     auto devs = queryRelatedDevices(portInfo_);
     if(devs.empty()) {
         throw libobsensor::camera_disconnected_exception("No v4l device found for port: " + portInfo_->infUrl);
@@ -378,17 +393,23 @@ void ObV4lUvcDevicePort::captureLoop(std::shared_ptr<V4lDeviceHandle> devHandle)
         int max_fd = std::max({ devHandle->fd, devHandle->metadataFd, devHandle->stopPipeFd[0], devHandle->stopPipeFd[1] });
 
         if(devHandle->metadataFd >= 0) {
-            v4l2_buffer buf = {};
-            buf.type        = LOCAL_V4L2_BUF_TYPE_META_CAPTURE;
-            buf.memory      = V4L2_MEMORY_MMAP;
-            xioctl(devHandle->metadataFd, VIDIOC_QBUF, &buf);
+            for(uint32_t i = 0; i < devHandle->metadataBuffers.size(); i++) {
+                v4l2_buffer buf = {};
+                buf.type        = LOCAL_V4L2_BUF_TYPE_META_CAPTURE;
+                buf.memory      = V4L2_MEMORY_MMAP;
+                buf.index       = i;
+                xioctl(devHandle->metadataFd, VIDIOC_QBUF, &buf);
+            }
         }
 
         if(devHandle->fd >= 0) {
-            v4l2_buffer buf = {};
-            buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buf.memory      = V4L2_MEMORY_MMAP;
-            xioctl(devHandle->fd, VIDIOC_QBUF, &buf);
+            for(uint32_t i = 0; i < devHandle->buffers.size(); i++) {
+                v4l2_buffer buf = {};
+                buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                buf.memory      = V4L2_MEMORY_MMAP;
+                buf.index       = i;
+                xioctl(devHandle->fd, VIDIOC_QBUF, &buf);
+            }
         }
 
         while(devHandle->isCapturing) {
@@ -436,10 +457,10 @@ void ObV4lUvcDevicePort::captureLoop(std::shared_ptr<V4lDeviceHandle> devHandle)
                 if(xioctl(devHandle->metadataFd, VIDIOC_DQBUF, &buf) < 0) {
                     LOG_DEBUG("VIDIOC_DQBUF failed, {}, {}", strerror(errno), devHandle->metadataInfo->name);
                 }
-                if(buf.bytesused) {
-                    devHandle->metadataBuffers[buf.index].actual_length = buf.bytesused;
-                    devHandle->metadataBuffers[buf.index].sequence      = buf.sequence;
-                    metadataBufferIndex                                 = buf.index;
+                if(buf.bytesused && buf.index < devHandle->metadataBuffers.size()) {
+                    devHandle->metadataBuffers[buf.index]->actual_length = buf.bytesused;
+                    devHandle->metadataBuffers[buf.index]->sequence      = buf.sequence;
+                    metadataBufferIndex                                  = buf.index;
                 }
 
                 if(devHandle->isCapturing) {
@@ -457,17 +478,57 @@ void ObV4lUvcDevicePort::captureLoop(std::shared_ptr<V4lDeviceHandle> devHandle)
                     LOG_DEBUG("VIDIOC_DQBUF failed, {}, {}", strerror(errno), devHandle->info->name);
                 }
 
-                if(buf.bytesused) {
+                bool bufferHandedOff = false;  // true if the buffer is owned by a zero-copy frame and will be re-queued on its release
+                if(buf.bytesused && buf.index < devHandle->buffers.size()) {
                     TRY_EXECUTE({
                         auto timestamp = (double)buf.timestamp.tv_sec * 1000.f + (double)buf.timestamp.tv_usec / 1000.f;
                         (void)timestamp;
 
-                        auto rawframe   = FrameFactory::createFrameFromStreamProfile(devHandle->profile);
-                        auto videoFrame = rawframe->as<VideoFrame>();
-                        videoFrame->updateData(static_cast<const uint8_t *>(devHandle->buffers[buf.index].ptr), buf.bytesused);
-                        if(metadataBufferIndex >= 0 && devHandle->metadataBuffers[metadataBufferIndex].sequence == buf.sequence) {
-                            auto uvc_payload_header     = devHandle->metadataBuffers[metadataBufferIndex].ptr + sizeof(V4L2UvcMetaHeader);
-                            auto uvc_payload_header_len = devHandle->metadataBuffers[metadataBufferIndex].actual_length - sizeof(V4L2UvcMetaHeader);
+                        auto                        frameBuffer = devHandle->buffers[buf.index];
+                        std::shared_ptr<VideoFrame> videoFrame;
+                        if(devHandle->zeroCopy) {
+                            std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+                            if(devHandle->zeroCopyBuffersInUse + MIN_QUEUED_BUFFER_COUNT < devHandle->buffers.size()) {
+                                devHandle->zeroCopyBuffersInUse++;
+                                bufferHandedOff = true;
+                            }
+                            else {
+                                auto fallbackCount = ++devHandle->copyFallbackCount;
+                                lock.unlock();
+                                LOG_WARN_INTVL_THREAD("Too many V4L2 buffers held by downstream, fall back to copy mode! copied frames={}, {}", fallbackCount,
+                                                      devHandle->info->name);
+                            }
+                        }
+
+                        if(bufferHandedOff) {
+                            auto     index      = buf.index;
+                            auto     weakHandle = std::weak_ptr<V4lDeviceHandle>(devHandle);
+                            auto     profile    = devHandle->profile;
+                            uint32_t stride     = utils::calcDefaultStrideBytes(profile->getFormat(), profile->getWidth());
+                            try {
+                                auto rawframe = FrameFactory::createVideoFrameFromUserBuffer(
+                                    utils::mapStreamTypeToFrameType(profile->getType()), profile->getFormat(), profile->getWidth(), profile->getHeight(), stride,
+                                    frameBuffer->ptr, frameBuffer->length,
+                                    [weakHandle, frameBuffer, index]() { releaseZeroCopyBuffer(weakHandle, frameBuffer, index); });
+                                videoFrame = rawframe->as<VideoFrame>();
+                            }
+                            catch(...) {
+                                // the frame was not created, so its reclaim function will never be called; return the buffer to the driver here
+                                releaseZeroCopyBuffer(weakHandle, frameBuffer, index);
+                                throw;
+                            }
+                            videoFrame->setStreamProfile(profile);
+                            videoFrame->setDataSize(buf.bytesused);
+                        }
+                        else {
+                            auto rawframe = FrameFactory::createFrameFromStreamProfile(devHandle->profile);
+                            videoFrame    = rawframe->as<VideoFrame>();
+                            videoFrame->updateData(static_cast<const uint8_t *>(frameBuffer->ptr), buf.bytesused);
+                        }
+
+                        if(metadataBufferIndex >= 0 && devHandle->metadataBuffers[metadataBufferIndex]->sequence == buf.sequence) {
+                            auto uvc_payload_header     = devHandle->metadataBuffers[metadataBufferIndex]->ptr + sizeof(V4L2UvcMetaHeader);
+                            auto uvc_payload_header_len = devHandle->metadataBuffers[metadataBufferIndex]->actual_length - sizeof(V4L2UvcMetaHeader);
                             if(uvc_payload_header_len >= sizeof(StandardUvcFramePayloadHeader)) {
                                 auto payloadHeader = (StandardUvcFramePayloadHeader *)uvc_payload_header;
                                 videoFrame->appendMetadata(static_cast<const uint8_t *>(uvc_payload_header), uvc_payload_header_len);
@@ -482,7 +543,7 @@ void ObV4lUvcDevicePort::captureLoop(std::shared_ptr<V4lDeviceHandle> devHandle)
                     })
                 }
 
-                if(devHandle->isCapturing) {
+                if(devHandle->isCapturing && !bufferHandedOff) {
                     xioctl(devHandle->fd, VIDIOC_QBUF, &buf);
                 }
             }
@@ -493,6 +554,50 @@ void ObV4lUvcDevicePort::captureLoop(std::shared_ptr<V4lDeviceHandle> devHandle)
     }
 }
 
+void ObV4lUvcDevicePort::releaseZeroCopyBuffer(std::weak_ptr<V4lDeviceHandle> weakHandle, std::shared_ptr<V4L2FrameBuffer> frameBuffer, uint32_t index) {
+    auto devHandle = weakHandle.lock();
+    if(!devHandle) {
+        return;  // the device port has been destroyed, the buffer is unmapped when frameBuffer goes out of scope
+    }
+
+    std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+    // Only re-queue if the buffer still belongs to the running stream; buffers of a stopped stream are unmapped right away, as the driver can only
+    // free them once none of them is mapped.
+    if(devHandle->isCapturing && index < devHandle->buffers.size() && devHandle->buffers[index] == frameBuffer) {
+        v4l2_buffer buf = {};
+        buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory      = V4L2_MEMORY_MMAP;
+        buf.index       = index;
+        if(xioctl(devHandle->fd, VIDIOC_QBUF, &buf) < 0) {
+            LOG_DEBUG("VIDIOC_QBUF failed, {}, {}", strerror(errno), devHandle->info->name);
+        }
+    }
+    else {
+        frameBuffer->unmap();
+    }
+    if(devHandle->zeroCopyBuffersInUse > 0) {
+        devHandle->zeroCopyBuffersInUse--;
+    }
+    // the last frame of a stopped stream: free the driver buffers the stop could not free
+    if(devHandle->zeroCopyBuffersInUse == 0 && devHandle->freeBuffersPending) {
+        freeDriverBuffers(devHandle);
+        devHandle->freeBuffersPending = false;
+    }
+    devHandle->bufferReleasedCv.notify_all();
+}
+
+bool ObV4lUvcDevicePort::freeDriverBuffers(std::shared_ptr<V4lDeviceHandle> devHandle) {
+    struct v4l2_requestbuffers req = {};
+    req.count                      = 0;
+    req.type                       = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory                     = V4L2_MEMORY_MMAP;
+    if(xioctl(devHandle->fd, VIDIOC_REQBUFS, &req) < 0) {
+        LOG_WARN("Failed to free buffers! {}, {}", devHandle->info->name, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
 StreamProfileList ObV4lUvcDevicePort::getStreamProfileList() {
     StreamProfileList profileList;
     foreachProfile(deviceHandles_, [&profileList](std::shared_ptr<V4lDeviceHandle> devHandle, std::shared_ptr<VideoStreamProfile> profile) {
@@ -540,6 +645,14 @@ void ObV4lUvcDevicePort::startStream(std::shared_ptr<const StreamProfile> profil
     if(devHandle->isCapturing) {
         throw libobsensor::pal_exception("V4l device is already capturing");
     }
+    {
+        // the driver buffers of the previous stream can not be freed, so no new ones can be requested
+        std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+        if(devHandle->freeBuffersPending) {
+            throw libobsensor::io_exception("Failed to start stream! " + std::to_string(devHandle->zeroCopyBuffersInUse)
+                                            + " zero-copy frames of the previous stream are still held by user, " + devHandle->info->name);
+        }
+    }
 
     if(devHandle->metadataFd >= 0) {
         v4l2_format fmt = {};
@@ -566,22 +679,29 @@ void ObV4lUvcDevicePort::startStream(std::shared_ptr<const StreamProfile> profil
         }
 
         struct v4l2_requestbuffers req = {};
-        req.count                      = MAX_BUFFER_COUNT;
+        req.count                      = bufferCount_;
         req.type                       = LOCAL_V4L2_BUF_TYPE_META_CAPTURE;
         req.memory                     = V4L2_MEMORY_MMAP;
         if(xioctl(devHandle->metadataFd, VIDIOC_REQBUFS, &req) < 0) {
             throw libobsensor::io_exception("Failed to request metadata buffers!" + devHandle->metadataInfo->name + ", " + strerror(errno));
         }
+        devHandle->metadataBuffers.clear();
         for(uint32_t i = 0; i < req.count && i < MAX_BUFFER_COUNT; i++) {
             struct v4l2_buffer buf = {};
             buf.type               = LOCAL_V4L2_BUF_TYPE_META_CAPTURE;
             buf.memory             = V4L2_MEMORY_MMAP;
-            buf.index              = i;  // only one buffer
+            buf.index              = i;
             if(xioctl(devHandle->metadataFd, VIDIOC_QUERYBUF, &buf) < 0) {
                 throw libobsensor::io_exception("Failed to query metadata buffer!" + devHandle->metadataInfo->name + ", " + strerror(errno));
             }
-            devHandle->metadataBuffers[i].ptr    = (uint8_t *)mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, devHandle->metadataFd, buf.m.offset);
-            devHandle->metadataBuffers[i].length = buf.length;
+            auto metadataBuffer    = std::make_shared<V4L2FrameBuffer>();
+            metadataBuffer->ptr    = (uint8_t *)mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, devHandle->metadataFd, buf.m.offset);
+            metadataBuffer->length = buf.length;
+            if(metadataBuffer->ptr == MAP_FAILED) {
+                metadataBuffer->ptr = nullptr;
+                throw libobsensor::io_exception("Failed to mmap metadata buffer!" + devHandle->metadataInfo->name + ", " + strerror(errno));
+            }
+            devHandle->metadataBuffers.push_back(metadataBuffer);
         }
 
         v4l2_buf_type bufType = LOCAL_V4L2_BUF_TYPE_META_CAPTURE;
@@ -616,22 +736,39 @@ void ObV4lUvcDevicePort::startStream(std::shared_ptr<const StreamProfile> profil
     }
 
     struct v4l2_requestbuffers req = {};
-    req.count                      = MAX_BUFFER_COUNT;
+    req.count                      = bufferCount_;
     req.type                       = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     req.memory                     = V4L2_MEMORY_MMAP;
     if(xioctl(devHandle->fd, VIDIOC_REQBUFS, &req) < 0) {
         throw libobsensor::io_exception("Failed to request buffers!" + devHandle->info->name + ", " + strerror(errno));
     }
-    for(uint32_t i = 0; i < req.count && i < MAX_BUFFER_COUNT; i++) {
-        struct v4l2_buffer buf = {};
-        buf.type               = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory             = V4L2_MEMORY_MMAP;
-        buf.index              = i;
-        if(xioctl(devHandle->fd, VIDIOC_QUERYBUF, &buf) < 0) {
-            throw libobsensor::io_exception("Failed to query buffer!" + devHandle->info->name + ", " + strerror(errno));
+    if(req.count < bufferCount_) {
+        LOG_DEBUG("Driver granted {} buffers, less than requested {}, {}", req.count, bufferCount_, devHandle->info->name);
+    }
+    {
+        std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+        devHandle->buffers.clear();
+        for(uint32_t i = 0; i < req.count && i < MAX_BUFFER_COUNT; i++) {
+            struct v4l2_buffer buf = {};
+            buf.type               = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory             = V4L2_MEMORY_MMAP;
+            buf.index              = i;
+            if(xioctl(devHandle->fd, VIDIOC_QUERYBUF, &buf) < 0) {
+                throw libobsensor::io_exception("Failed to query buffer!" + devHandle->info->name + ", " + strerror(errno));
+            }
+            auto frameBuffer    = std::make_shared<V4L2FrameBuffer>();
+            frameBuffer->ptr    = (uint8_t *)mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, devHandle->fd, buf.m.offset);
+            frameBuffer->length = buf.length;
+            if(frameBuffer->ptr == MAP_FAILED) {
+                frameBuffer->ptr = nullptr;
+                throw libobsensor::io_exception("Failed to mmap buffer!" + devHandle->info->name + ", " + strerror(errno));
+            }
+            devHandle->buffers.push_back(frameBuffer);
         }
-        devHandle->buffers[i].ptr    = (uint8_t *)mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, devHandle->fd, buf.m.offset);
-        devHandle->buffers[i].length = buf.length;
+        devHandle->bufferCount          = static_cast<uint32_t>(devHandle->buffers.size());
+        devHandle->zeroCopy             = zeroCopy_ && devHandle->bufferCount > MIN_QUEUED_BUFFER_COUNT;
+        devHandle->zeroCopyBuffersInUse = 0;
+        devHandle->copyFallbackCount    = 0;
     }
 
     v4l2_buf_type bufType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -656,17 +793,14 @@ void ObV4lUvcDevicePort::stopStream(std::shared_ptr<const StreamProfile> profile
 
     auto clearUp = [](std::shared_ptr<V4lDeviceHandle> devHandle) {
         // cleanup
-        for(uint32_t i = 0; i < MAX_BUFFER_COUNT; i++) {
-            if(devHandle->buffers[i].ptr) {
-                munmap(devHandle->buffers[i].ptr, devHandle->buffers[i].length);
-                devHandle->buffers[i].ptr    = nullptr;
-                devHandle->buffers[i].length = 0;
-            }
-            if(devHandle->metadataBuffers[i].ptr) {
-                munmap(devHandle->metadataBuffers[i].ptr, devHandle->metadataBuffers[i].length);
-                devHandle->metadataBuffers[i].ptr    = nullptr;
-                devHandle->metadataBuffers[i].length = 0;
+        {
+            // Buffers still held by zero-copy frames stay mapped until those frames are released.
+            std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+            if(devHandle->copyFallbackCount > 0) {
+                LOG_DEBUG("{} frames were copied due to zero-copy buffer exhaustion, {}", devHandle->copyFallbackCount, devHandle->info->name);
             }
+            devHandle->buffers.clear();
+            devHandle->metadataBuffers.clear();
         }
         if(devHandle->stopPipeFd[0] >= 0) {
             close(devHandle->stopPipeFd[0]);
@@ -698,6 +832,17 @@ void ObV4lUvcDevicePort::stopStream(std::shared_ptr<const StreamProfile> profile
         }
         devHandle->captureThread.reset();
 
+        // give downstream a chance to release zero-copy frames before the buffers are freed by the driver
+        bool buffersReleased = true;
+        if(devHandle->zeroCopy) {
+            std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+            buffersReleased = devHandle->bufferReleasedCv.wait_for(lock, std::chrono::milliseconds(1000),
+                                                                   [&devHandle]() { return devHandle->zeroCopyBuffersInUse == 0; });
+            if(!buffersReleased) {
+                LOG_WARN("{} zero-copy frames are still held by user while stopping stream, {}", devHandle->zeroCopyBuffersInUse, devHandle->info->name);
+            }
+        }
+
         v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         if(xioctl(devHandle->fd, VIDIOC_STREAMOFF, &type) < 0) {
             throw libobsensor::io_exception("Failed to stream off!" + devHandle->info->name + ", " + strerror(errno));
@@ -710,7 +855,20 @@ void ObV4lUvcDevicePort::stopStream(std::shared_ptr<const StreamProfile> profile
         req.type                       = type;
         req.memory                     = V4L2_MEMORY_MMAP;
         if(xioctl(devHandle->fd, VIDIOC_REQBUFS, &req) < 0) {
-            throw libobsensor::io_exception("Failed to request buffers!" + devHandle->info->name + ", " + strerror(errno));
+            if(buffersReleased) {
+                throw libobsensor::io_exception("Failed to request buffers!" + devHandle->info->name + ", " + strerror(errno));
+            }
+            // Older kernels refuse to free buffers that are still mapped: free them when the last zero-copy frame is released, unless it was released
+            // in the meantime. The next start fails until then.
+            std::unique_lock<std::mutex> lock(devHandle->bufferMutex);
+            if(devHandle->zeroCopyBuffersInUse > 0) {
+                devHandle->freeBuffersPending = true;
+                LOG_WARN("{} zero-copy frames are held by user, buffers will be freed when they are released, {}", devHandle->zeroCopyBuffersInUse,
+                         devHandle->info->name);
+            }
+            else {
+                freeDriverBuffers(devHandle);
+            }
         }
 
         if(devHandle->metadataFd >= 0) {
@@ -2,6 +2,9 @@
 #include <array>
 #include <string>
 #include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 #include <sys/mman.h>
 
 #include "UvcDevicePort.hpp"
@@ -30,7 +33,9 @@ constexpr bool metadata_node = false;
 namespace libobsensor {
 
 static const uint32_t MAX_META_DATA_SIZE       = 255;
-static const uint32_t MAX_BUFFER_COUNT         = 4;
+static const uint32_t DEFAULT_BUFFER_COUNT     = 4;
+static const uint32_t MAX_BUFFER_COUNT         = 32;
+static const uint32_t MIN_QUEUED_BUFFER_COUNT  = 2;  // zero-copy mode falls back to copy when fewer buffers than this are left to the driver
 static const uint32_t LOCAL_V4L2_META_FMT_D4XX = v4l2_fourcc('D', '4', 'X', 'X');  // borrows from videodev2.h, using for getting extention metadata
 #define LOCAL_V4L2_BUF_TYPE_META_CAPTURE ((v4l2_buf_type)13)
 
@@ -44,6 +49,9 @@ struct V4L2UvcMetaHeader {
 
 struct V4L2FrameBuffer {
     ~V4L2FrameBuffer() {
+        unmap();
+    }
+    void unmap() {
         if(ptr != nullptr) {
             munmap(ptr, length);
             ptr = nullptr;
@@ -63,11 +71,19 @@ struct V4lDeviceInfo {
 struct V4lDeviceHandle {
     std::shared_ptr<V4lDeviceInfo>                info;
     int                                           fd = -1;
-    std::array<V4L2FrameBuffer, MAX_BUFFER_COUNT> buffers;
+    std::vector<std::shared_ptr<V4L2FrameBuffer>> buffers;  // shared with zero-copy frames, unmapped once the last frame is released
 
     std::shared_ptr<V4lDeviceInfo>                metadataInfo;
     int                                           metadataFd = -1;
-    std::array<V4L2FrameBuffer, MAX_BUFFER_COUNT> metadataBuffers;
+    std::vector<std::shared_ptr<V4L2FrameBuffer>> metadataBuffers;
+
+    uint32_t                bufferCount = DEFAULT_BUFFER_COUNT;
+    bool                    zeroCopy    = false;
+    std::mutex              bufferMutex;  // guards re-queueing of zero-copy buffers against stream stop
+    std::condition_variable bufferReleasedCv;
+    uint32_t                zeroCopyBuffersInUse = 0;
+    uint64_t                copyFallbackCount    = 0;
+    bool                    freeBuffersPending   = false;  // the driver buffers of the stopped stream are freed once its last zero-copy frame is released
 
     MutableFrameCallback                      frameCallback;
     std::shared_ptr<const VideoStreamProfile> profile = nullptr;
@@ -100,6 +116,8 @@ public:
 
 private:
     static void     captureLoop(std::shared_ptr<V4lDeviceHandle> deviceHandle);
+    static void     releaseZeroCopyBuffer(std::weak_ptr<V4lDeviceHandle> weakHandle, std::shared_ptr<V4L2FrameBuffer> frameBuffer, uint32_t index);
+    static bool     freeDriverBuffers(std::shared_ptr<V4lDeviceHandle> devHandle);
     bool            getXu(uint8_t ctrl, uint8_t *data, uint32_t *len);
     bool            setXu(uint8_t ctrl, const uint8_t *data, uint32_t len);
     UvcControlRange getXuRange(uint8_t control, int len) const;
@@ -110,6 +128,9 @@ private:
 private:
     std::shared_ptr<const USBSourcePortInfo>      portInfo_ = nullptr;
     std::vector<std::shared_ptr<V4lDeviceHandle>> deviceHandles_;
+
+    uint32_t bufferCount_ = DEFAULT_BUFFER_COUNT;
+    bool     zeroCopy_    = false;
 };
 
 }  // namespace libobsensor
@@ -0,0 +1,269 @@
+#include "CoordinateTablesCache.hpp"
+#include "FileUtils.hpp"
+#include "environment/EnvConfig.hpp"
+#include "logger/Logger.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libobsensor {
+
+#define DEFAULT_RECENT_TABLES_COUNT 4
+
+// The tables file: the header, the key, and the tables at TABLES_FILE_ALIGN bytes so they are mapped aligned
+#define TABLES_FILE_MAGIC "OBTABLES"
+#define TABLES_FILE_VERSION 1  // to be increased when the computation of any tables changes, so the saved tables are computed again
+#define TABLES_FILE_ALIGN 64
+
+struct TablesFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t keySize;
+    uint64_t count;
+    uint64_t dataOffset;
+};
+
+// FNV-1a, the file name of the tables of a key must be the same in every process
+static uint64_t hashKey(const std::string &key) {
+    uint64_t hash = 14695981039346656037ull;
+    for(auto c: key) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Map a file read only, returns nullptr on failure; the mapping is released with the returned pointer
+static std::shared_ptr<const uint8_t> mapFile(const std::string &filePath, size_t &size) {
+#ifdef WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if(mapping == NULL) {
+        return nullptr;
+    }
+    void *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if(base == NULL) {
+        return nullptr;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return std::shared_ptr<const uint8_t>(static_cast<const uint8_t *>(base), [](const uint8_t *ptr) { UnmapViewOfFile(ptr); });
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return nullptr;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    size_t fileSize = static_cast<size_t>(fileStat.st_size);
+    void  *base     = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) {
+        return nullptr;
+    }
+    size = fileSize;
+    return std::shared_ptr<const uint8_t>(static_cast<const uint8_t *>(base), [fileSize](const uint8_t *ptr) { munmap(const_cast<uint8_t *>(ptr), fileSize); });
+#endif
+}
+
+std::shared_ptr<CoordinateTablesCache> CoordinateTablesCache::getInstance() {
+    // never released, so the tables outlive the pipelines using them
+    static std::shared_ptr<CoordinateTablesCache> instance(new CoordinateTablesCache());
+    return instance;
+}
+
+CoordinateTablesCache::CoordinateTablesCache() : recentSize_(DEFAULT_RECENT_TABLES_COUNT) {
+    auto envConfig = EnvConfig::getInstance();
+    int  size      = 0;
+    if(envConfig->getIntValue("Misc.CoordinateTablesCacheSize", size) && size >= 0) {
+        recentSize_ = static_cast<size_t>(size);
+    }
+    envConfig->getStringValue("Misc.CoordinateTablesCacheDir", cacheDir_);
+    if(!cacheDir_.empty() && !utils::checkDir(cacheDir_.c_str()) && utils::mkDirs(cacheDir_.c_str()) != 0) {
+        LOG_WARN("Failed to create the coordinate tables cache directory {}, the tables are not saved", cacheDir_);
+        cacheDir_.clear();
+    }
+    LOG_DEBUG("CoordinateTablesCache created! recent tables={}, directory={}", recentSize_, cacheDir_);
+}
+
+std::shared_ptr<const float> CoordinateTablesCache::getTables(CoordinateTablesType type, const std::string &params, size_t count,
+                                                              const std::function<bool(float *)> &init) {
+    std::string key;
+    appendParam(key, static_cast<uint32_t>(type));
+    key.append(params);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto                         iter = entries_.find(key);
+        if(iter != entries_.end() && iter->second.count == count) {
+            auto tables = iter->second.tables.lock();
+            if(tables) {
+                keepRecent(key, tables);
+                return tables;
+            }
+        }
+    }
+
+    // computed without the lock, so the users of other tables do not wait
+    auto tables = loadTables(key, count);
+    if(!tables) {
+        std::shared_ptr<float> data(new float[count], std::default_delete<float[]>());
+        if(!init(data.get())) {
+            return nullptr;
+        }
+        saveTables(key, count, data.get());
+        tables = data;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto                        &entry = entries_[key];
+    auto                         other = entry.tables.lock();
+    if(other && entry.count == count) {
+        // computed by another user meanwhile
+        tables = other;
+    }
+    else {
+        entry.count  = count;
+        entry.tables = tables;
+    }
+    keepRecent(key, tables);
+
+    for(auto iter = entries_.begin(); iter != entries_.end();) {
+        if(iter->second.tables.expired()) {
+            iter = entries_.erase(iter);
+        }
+        else {
+            iter++;
+        }
+    }
+    return tables;
+}
+
+void CoordinateTablesCache::keepRecent(const std::string &key, const std::shared_ptr<const float> &tables) {
+    for(auto iter = recent_.begin(); iter != recent_.end(); iter++) {
+        if(iter->first == key) {
+            recent_.erase(iter);
+            break;
+        }
+    }
+    if(recentSize_ == 0) {
+        return;
+    }
+    recent_.emplace_front(key, tables);
+    while(recent_.size() > recentSize_) {
+        recent_.pop_back();
+    }
+}
+
+std::string CoordinateTablesCache::getTablesFilePath(const std::string &key) const {
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "coordinate_tables_%016llx.bin", static_cast<unsigned long long>(hashKey(key)));
+    return utils::joinPaths(cacheDir_, fileName);
+}
+
+std::shared_ptr<const float> CoordinateTablesCache::loadTables(const std::string &key, size_t count) const {
+    if(cacheDir_.empty()) {
+        return nullptr;
+    }
+    auto   filePath = getTablesFilePath(key);
+    size_t fileSize = 0;
+    auto   file     = mapFile(filePath, fileSize);
+    if(!file) {
+        return nullptr;
+    }
+
+    TablesFileHeader header;
+    if(fileSize < sizeof(header)) {
+        LOG_WARN("Invalid coordinate tables file {}", filePath);
+        return nullptr;
+    }
+    memcpy(&header, file.get(), sizeof(header));
+    if(memcmp(header.magic, TABLES_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != TABLES_FILE_VERSION || header.keySize != key.size()
+       || header.count != count || header.dataOffset % TABLES_FILE_ALIGN != 0 || header.dataOffset < sizeof(header) + key.size()
+       || fileSize != header.dataOffset + count * sizeof(float)) {
+        LOG_WARN("Invalid coordinate tables file {}", filePath);
+        return nullptr;
+    }
+    if(memcmp(file.get() + sizeof(header), key.data(), key.size()) != 0) {
+        // another key of the same hash
+        return nullptr;
+    }
+
+    LOG_DEBUG("Coordinate tables loaded from {}", filePath);
+    auto tables = reinterpret_cast<const float *>(file.get() + header.dataOffset);
+    return std::shared_ptr<const float>(file, tables);
+}
+
+// The name of the temporary file a tables file is written to: unique to the process and the call, as other processes, or other threads of this one,
+// may be saving the same tables at the same time
+static std::string getTempFilePath(const std::string &filePath) {
+    static std::atomic<uint32_t> tempFileCount(0);
+#ifdef WIN32
+    auto pid = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    auto pid = static_cast<unsigned long>(getpid());
+#endif
+    return filePath + "." + std::to_string(pid) + "." + std::to_string(tempFileCount++) + ".tmp";
+}
+
+void CoordinateTablesCache::saveTables(const std::string &key, size_t count, const float *tables) const {
+    if(cacheDir_.empty()) {
+        return;
+    }
+
+    TablesFileHeader header;
+    memcpy(header.magic, TABLES_FILE_MAGIC, sizeof(header.magic));
+    header.version    = TABLES_FILE_VERSION;
+    header.keySize    = static_cast<uint32_t>(key.size());
+    header.count      = count;
+    header.dataOffset = (sizeof(header) + key.size() + TABLES_FILE_ALIGN - 1) / TABLES_FILE_ALIGN * TABLES_FILE_ALIGN;
+    std::string padding(static_cast<size_t>(header.dataOffset - sizeof(header) - key.size()), '\0');
+
+    // written to a temporary file first, so other processes never map a partial file
+    auto filePath = getTablesFilePath(key);
+    auto tempPath = getTempFilePath(filePath);
+    auto file     = fopen(tempPath.c_str(), "wb");
+    if(!file) {
+        LOG_WARN("Failed to save the coordinate tables to {}", filePath);
+        return;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(key.data(), 1, key.size(), file) == key.size()
+                   && fwrite(padding.data(), 1, padding.size(), file) == padding.size() && fwrite(tables, sizeof(float), count, file) == count;
+    written      = fclose(file) == 0 && written;
+#ifdef WIN32
+    if(written) {
+        written = MoveFileExA(tempPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+    }
+#else
+    written = written && rename(tempPath.c_str(), filePath.c_str()) == 0;
+#endif
+    if(!written) {
+        remove(tempPath.c_str());
+        LOG_WARN("Failed to save the coordinate tables to {}", filePath);
+        return;
+    }
+    LOG_DEBUG("Coordinate tables saved to {}", filePath);
+}
+
+}  // namespace libobsensor
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace libobsensor {
+
+typedef enum {
+    COORDINATE_TABLES_XY,                  // CoordinateUtil::transformationInitXYTables
+    COORDINATE_TABLES_ADD_DISTORTION_UV,   // CoordinateUtil::transformationInitAddDistortionUVTables
+    COORDINATE_TABLES_ALIGN_ROTATION,      // rotation coefficients of AlignImpl
+} CoordinateTablesType;
+
+/**
+ * @brief Process wide cache of the coordinate lookup tables: the xy/uv tables of the point cloud and the rotation coefficients of the alignment.
+ *
+ * The tables are shared by all the users of the same camera parameters while in use, and the last released ones (Misc.CoordinateTablesCacheSize)
+ * are kept for the next user, so a pipeline restarted on the same device does not compute them again. With Misc.CoordinateTablesCacheDir set,
+ * the computed tables are also saved to that directory, and memory mapped from there by the next processes.
+ */
+class CoordinateTablesCache {
+public:
+    static std::shared_ptr<CoordinateTablesCache> getInstance();
+
+    ~CoordinateTablesCache() noexcept = default;
+
+    /**
+     * @brief Get the tables of some parameters, computing them on their first use
+     * @param[in] type the type of the tables
+     * @param[in] params all the parameters the tables are computed from, see appendParam
+     * @param[in] count number of floats of the tables
+     * @param[in] init computes the tables into a buffer of count floats, returns false on failure
+     * @return the tables, shared with the other users of the same parameters, nullptr if init failed
+     */
+    std::shared_ptr<const float> getTables(CoordinateTablesType type, const std::string &params, size_t count, const std::function<bool(float *)> &init);
+
+    /**
+     * @brief Append a parameter of the tables, as its bytes
+     */
+    template <typename T> static void appendParam(std::string &params, const T &value) {
+        params.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+private:
+    CoordinateTablesCache();
+
+    std::shared_ptr<const float> loadTables(const std::string &key, size_t count) const;
+    void                         saveTables(const std::string &key, size_t count, const float *tables) const;
+    std::string                  getTablesFilePath(const std::string &key) const;
+
+    void keepRecent(const std::string &key, const std::shared_ptr<const float> &tables);
+
+private:
+    struct Entry {
+        size_t                     count;
+        std::weak_ptr<const float> tables;
+    };
+
+    std::mutex                                                      mutex_;
+    std::unordered_map<std::string, Entry>                          entries_;
+    std::list<std::pair<std::string, std::shared_ptr<const float>>> recent_;  // most recently used first
+    size_t                                                          recentSize_;
+    std::string                                                     cacheDir_;
+};
+
+}  // namespace libobsensor
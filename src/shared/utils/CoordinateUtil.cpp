@@ -1,4 +1,5 @@
 #include "CoordinateUtil.hpp"
+#include "CoordinateTablesCache.hpp"
 #include "logger/Logger.hpp"
 #include "logger/LoggerInterval.hpp"
 
@@ -569,6 +570,45 @@ bool CoordinateUtil::transformationInitAddDistortionUVTables(const OBCameraIntri
     return true;
 }
 
+typedef bool (*InitTablesFunc)(const OBCameraIntrinsic intrinsic, const OBCameraDistortion distortion, float *data, uint32_t *dataSize,
+                               OBXYTables *tables);
+
+static std::shared_ptr<const float> getCachedTables(CoordinateTablesType type, InitTablesFunc initTables, const OBCameraIntrinsic &intrinsic,
+                                                    const OBCameraDistortion &distortion, OBXYTables *tables) {
+    if(intrinsic.width <= 0 || intrinsic.height <= 0) {
+        return nullptr;
+    }
+
+    std::string params;
+    CoordinateTablesCache::appendParam(params, intrinsic);
+    CoordinateTablesCache::appendParam(params, distortion);
+    size_t tableSize = static_cast<size_t>(intrinsic.width) * intrinsic.height;
+    auto   data      = CoordinateTablesCache::getInstance()->getTables(type, params, 2 * tableSize, [&](float *buffer) {
+        uint32_t   dataSize = static_cast<uint32_t>(2 * tableSize);
+        OBXYTables bufferTables;
+        return initTables(intrinsic, distortion, buffer, &dataSize, &bufferTables);
+    });
+    if(!data) {
+        return nullptr;
+    }
+
+    // the tables are only read through the pointers of OBXYTables
+    tables->width  = intrinsic.width;
+    tables->height = intrinsic.height;
+    tables->xTable = const_cast<float *>(data.get());
+    tables->yTable = tables->xTable + tableSize;
+    return data;
+}
+
+std::shared_ptr<const float> CoordinateUtil::getCachedXYTables(const OBCameraIntrinsic intrinsic, const OBCameraDistortion distortion, OBXYTables *xyTables) {
+    return getCachedTables(COORDINATE_TABLES_XY, transformationInitXYTables, intrinsic, distortion, xyTables);
+}
+
+std::shared_ptr<const float> CoordinateUtil::getCachedAddDistortionUVTables(const OBCameraIntrinsic intrinsic, const OBCameraDistortion distortion,
+                                                                            OBXYTables *uvTables) {
+    return getCachedTables(COORDINATE_TABLES_ADD_DISTORTION_UV, transformationInitAddDistortionUVTables, intrinsic, distortion, uvTables);
+}
+
 void CoordinateUtil::transformationDepthToPointCloud(OBXYTables *xyTables, const void *depthImageData, void *pointCloudData, float positionDataScale,
                                                      OBCoordinateSystemType type) {
     const uint16_t *imageData = (const uint16_t *)depthImageData;
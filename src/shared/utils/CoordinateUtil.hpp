@@ -43,6 +43,13 @@ public:
     static bool transformationInitAddDistortionUVTables(const OBCameraIntrinsic intrinsic, const OBCameraDistortion distortion, float *data, uint32_t *dataSize,
                                                         OBXYTables *uvTables);
 
+    // The same tables, shared through CoordinateTablesCache with the other users of the same intrinsic and distortion. The tables point to the returned
+    // data, which must be kept while they are in use and must not be modified; nullptr if the tables are invalid.
+    static std::shared_ptr<const float> getCachedXYTables(const OBCameraIntrinsic intrinsic, const OBCameraDistortion distortion, OBXYTables *xyTables);
+
+    static std::shared_ptr<const float> getCachedAddDistortionUVTables(const OBCameraIntrinsic intrinsic, const OBCameraDistortion distortion,
+                                                                       OBXYTables *uvTables);
+
     static void transformationDepthToPointCloud(OBXYTables *xyTables, const void *depthImageData, void *pointCloudData, float positionDataScale = 1.0f,
                                                 OBCoordinateSystemType type = OB_RIGHT_HAND_COORDINATE_SYSTEM);
 
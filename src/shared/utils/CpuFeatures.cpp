@@ -0,0 +1,105 @@
+#include "CpuFeatures.hpp"
+#include "logger/Logger.hpp"
+
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define OB_CPU_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace libobsensor {
+namespace utils {
+
+namespace {
+
+struct CpuFeatures {
+    bool avx2   = false;
+    bool avx512 = false;
+};
+
+#ifdef OB_CPU_X86
+void cpuid(uint32_t leaf, uint32_t subLeaf, uint32_t regs[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subLeaf));
+    for(int i = 0; i < 4; i++) {
+        regs[i] = static_cast<uint32_t>(r[i]);
+    }
+#else
+    __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// the register states the OS saves on context switches (XCR0)
+uint64_t getEnabledRegisterStates() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#ifdef OB_CPU_X86
+    uint32_t regs[4];
+    cpuid(0, 0, regs);
+    uint32_t maxLeaf = regs[0];
+    if(maxLeaf < 7) {
+        return features;
+    }
+
+    cpuid(1, 0, regs);
+    bool osxsave = (regs[2] & (1u << 27)) != 0;
+    bool avx     = (regs[2] & (1u << 28)) != 0;
+    bool fma     = (regs[2] & (1u << 12)) != 0;
+    bool f16c    = (regs[2] & (1u << 29)) != 0;
+    if(!osxsave || !avx) {
+        return features;
+    }
+    uint64_t states    = getEnabledRegisterStates();
+    bool     ymmStates = (states & 0x06) == 0x06;  // XMM and YMM
+    bool     zmmStates = (states & 0xe0) == 0xe0;  // opmask, upper ZMM0-15 and ZMM16-31
+
+    cpuid(7, 0, regs);
+    bool avx2     = (regs[1] & (1u << 5)) != 0;
+    bool avx512f  = (regs[1] & (1u << 16)) != 0;
+    bool avx512dq = (regs[1] & (1u << 17)) != 0;
+    bool avx512bw = (regs[1] & (1u << 30)) != 0;
+    bool avx512vl = (regs[1] & (1u << 31)) != 0;
+
+    features.avx2   = ymmStates && avx2 && fma && f16c;
+    features.avx512 = features.avx2 && zmmStates && avx512f && avx512dq && avx512bw && avx512vl;
+#endif
+    return features;
+}
+
+const CpuFeatures &getCpuFeatures() {
+    static const CpuFeatures features = [] {
+        auto detected = detectCpuFeatures();
+        LOG_DEBUG("Cpu features: AVX2={}, AVX-512={}", detected.avx2, detected.avx512);
+        return detected;
+    }();
+    return features;
+}
+
+}  // namespace
+
+bool cpuSupportsAVX2() {
+    return getCpuFeatures().avx2;
+}
+
+bool cpuSupportsAVX512() {
+    return getCpuFeatures().avx512;
+}
+
+}  // namespace utils
+}  // namespace libobsensor
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace libobsensor {
+namespace utils {
+
+// Runtime detection of the x86 instruction set extensions beyond the baseline the SDK is built for, to select the SIMD kernels built for them.
+// Both also check that the OS saves the wider registers on context switches. Always false on other architectures.
+
+// AVX2, FMA and F16C
+bool cpuSupportsAVX2();
+
+// AVX-512 F/BW/DQ/VL (Skylake-SP and later)
+bool cpuSupportsAVX512();
+
+}  // namespace utils
+}  // namespace libobsensor
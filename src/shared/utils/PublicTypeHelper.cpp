@@ -54,6 +54,14 @@ float getBytesPerPixel(OBFormat format) {
     case OB_FORMAT_RGB_POINT:
         bytesPerPixel = 24.f;
         break;
+    case OB_FORMAT_POINT_INT16:
+    case OB_FORMAT_POINT_HALF:
+        bytesPerPixel = 6.f;
+        break;
+    case OB_FORMAT_RGB_POINT_INT16:
+    case OB_FORMAT_RGB_POINT_HALF:
+        bytesPerPixel = 9.f;
+        break;
     default:
         throw invalid_value_exception("Unsupported image format or invalid encoding detected. Unable to determine the byte-per-pixel value.");
         break;
@@ -333,7 +341,9 @@ const std::map<OBFormat, std::string> Format_Str_Map = {
     { OB_FORMAT_RVL, "RVL" },     { OB_FORMAT_Z16, "Z16" },
     { OB_FORMAT_YV12, "YV12" },   { OB_FORMAT_BA81, "BA81" },
     { OB_FORMAT_RGBA, "RGBA" },   { OB_FORMAT_BYR2, "BYR2" },
-    { OB_FORMAT_RW16, "RW16" },   { OB_FORMAT_UNKNOWN, "UNKNOWN" },
+    { OB_FORMAT_RW16, "RW16" },   { OB_FORMAT_POINT_INT16, "POINT_INT16" },
+    { OB_FORMAT_POINT_HALF, "POINT_HALF" }, { OB_FORMAT_RGB_POINT_INT16, "RGB_POINT_INT16" },
+    { OB_FORMAT_RGB_POINT_HALF, "RGB_POINT_HALF" }, { OB_FORMAT_UNKNOWN, "UNKNOWN" },
 };
 
 std::map<OBFrameMetadataType, std::string> Metadata_Str_Map = { { OB_FRAME_METADATA_TYPE_TIMESTAMP, "Timestamp" },
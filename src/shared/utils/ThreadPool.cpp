@@ -0,0 +1,159 @@
+#include "ThreadPool.hpp"
+#include "logger/Logger.hpp"
+
+#include <algorithm>
+
+namespace libobsensor {
+
+// Row bands per thread, so threads finishing their band early can take another one
+static const size_t ROW_BANDS_PER_THREAD = 4;
+
+std::shared_ptr<ThreadPool> ThreadPool::getInstance() {
+    static std::mutex                instanceMutex;
+    static std::weak_ptr<ThreadPool> instanceWeakPtr;
+
+    std::unique_lock<std::mutex> lock(instanceMutex);
+    auto                         instance = instanceWeakPtr.lock();
+    if(!instance) {
+        instance        = std::shared_ptr<ThreadPool>(new ThreadPool());
+        instanceWeakPtr = instance;
+    }
+    return instance;
+}
+
+ThreadPool::ThreadPool() : stopped_(false) {
+    size_t workerCount = std::max<unsigned>(std::thread::hardware_concurrency(), 1) - 1;
+    for(size_t i = 0; i < workerCount; i++) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+    LOG_DEBUG("ThreadPool created! worker count={}", workerCount);
+}
+
+ThreadPool::~ThreadPool() noexcept {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    condition_.notify_all();
+    for(auto &worker: workers_) {
+        if(worker.joinable()) {
+            worker.join();
+        }
+    }
+    LOG_DEBUG("ThreadPool destroyed!");
+}
+
+void ThreadPool::parallelFor(size_t taskCount, size_t maxParallelism, const std::function<void(size_t)> &task) {
+    if(taskCount == 0) {
+        return;
+    }
+    if(maxParallelism == 0 || maxParallelism > getMaxParallelism()) {
+        maxParallelism = getMaxParallelism();
+    }
+    maxParallelism = std::min(maxParallelism, taskCount);
+    if(maxParallelism <= 1) {
+        for(size_t i = 0; i < taskCount; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    auto job           = std::make_shared<Job>();
+    job->task          = &task;
+    job->taskCount     = taskCount;
+    job->helperCount   = maxParallelism - 1;
+    job->nextTask      = 0;
+    job->doneTaskCount = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        jobs_.push_back(job);
+    }
+    if(job->helperCount == 1) {
+        condition_.notify_one();
+    }
+    else {
+        condition_.notify_all();
+    }
+
+    runTasks(job);
+
+    {
+        // all tasks are taken, workers that did not join yet have nothing left to do
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto                         iter = std::find(jobs_.begin(), jobs_.end(), job);
+        if(iter != jobs_.end()) {
+            jobs_.erase(iter);
+        }
+    }
+    std::unique_lock<std::mutex> lock(job->doneMutex);
+    job->doneCondition.wait(lock, [&job] { return job->doneTaskCount == job->taskCount; });
+}
+
+size_t ThreadPool::getRowBandCount(size_t rowCount, size_t maxParallelism, size_t minBandRows) const {
+    // not capped to getMaxParallelism(), so that a thread count set by the caller splits the rows the same way on any machine
+    size_t parallelism = maxParallelism > 0 ? maxParallelism : getMaxParallelism();
+    if(parallelism <= 1) {
+        return 1;
+    }
+    return std::max<size_t>(1, std::min(rowCount / std::max<size_t>(minBandRows, 1), parallelism * ROW_BANDS_PER_THREAD));
+}
+
+void ThreadPool::getRowBand(size_t band, size_t bandCount, size_t rowCount, size_t granularity, size_t &rowBegin, size_t &rowEnd) {
+    rowBegin = rowCount * band / bandCount / granularity * granularity;
+    rowEnd   = (band == bandCount - 1) ? rowCount : rowCount * (band + 1) / bandCount / granularity * granularity;
+}
+
+void ThreadPool::parallelForRows(size_t rowCount, size_t maxParallelism, const std::function<void(size_t rowBegin, size_t rowEnd)> &processRows,
+                                 size_t granularity, size_t minBandRows) {
+    const size_t bandCount = getRowBandCount(rowCount, maxParallelism, minBandRows);
+    if(bandCount == 1) {
+        if(rowCount > 0) {
+            processRows(0, rowCount);
+        }
+        return;
+    }
+    parallelFor(bandCount, maxParallelism, [&](size_t band) {
+        size_t rowBegin, rowEnd;
+        getRowBand(band, bandCount, rowCount, granularity, rowBegin, rowEnd);
+        if(rowBegin < rowEnd) {
+            processRows(rowBegin, rowEnd);
+        }
+    });
+}
+
+void ThreadPool::runTasks(const std::shared_ptr<Job> &job) {
+    size_t doneCount = 0;
+    for(size_t i = job->nextTask++; i < job->taskCount; i = job->nextTask++) {
+        (*job->task)(i);
+        doneCount++;
+    }
+    if(doneCount > 0 && (job->doneTaskCount += doneCount) == job->taskCount) {
+        std::unique_lock<std::mutex> lock(job->doneMutex);
+        job->doneCondition.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while(true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopped_ || !jobs_.empty(); });
+            if(stopped_) {
+                break;
+            }
+            job = jobs_.front();
+            if(--job->helperCount == 0) {
+                jobs_.pop_front();
+            }
+            else if(jobs_.size() > 1) {
+                // let the other jobs be served by the next idle worker too
+                jobs_.pop_front();
+                jobs_.push_back(job);
+            }
+        }
+        runTasks(job);
+    }
+}
+
+}  // namespace libobsensor
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libobsensor {
+
+// Worker threads shared by the frame processing filters, to split the work on a frame into independent parts (e.g. row bands of an image) and run
+// them in parallel. One worker per cpu core but one, as the calling thread works on its own job too.
+//
+// Several filters (of several devices) may run jobs at the same time; their parts are taken by the idle workers in turn. The calling thread keeps
+// taking parts of its own job until none is left, so a job finishes even if all workers are busy, and a job may be run from inside another one.
+class ThreadPool {
+public:
+    static std::shared_ptr<ThreadPool> getInstance();
+    ~ThreadPool() noexcept;
+
+    // the number of threads a job can run on: the workers and the calling thread
+    size_t getMaxParallelism() const {
+        return workers_.size() + 1;
+    }
+
+    // Runs task(0) ... task(taskCount - 1) on up to maxParallelism threads (0 for all), and returns when all of them are done.
+    // The order the tasks run in is undefined, and tasks must not throw.
+    void parallelFor(size_t taskCount, size_t maxParallelism, const std::function<void(size_t)> &task);
+
+    // The number of bands to split rowCount rows of an image into for up to maxParallelism threads (0 for all): a few bands per thread, so that
+    // threads finishing their band early can take another one, of at least minBandRows rows each. 1 if the rows are better processed by the calling
+    // thread alone.
+    size_t getRowBandCount(size_t rowCount, size_t maxParallelism, size_t minBandRows = 1) const;
+
+    // The rows [rowBegin, rowEnd) of band `band` of bandCount; the bands start at a multiple of granularity rows, the last one ends at rowCount.
+    // A band may be empty if granularity is more than one.
+    static void getRowBand(size_t band, size_t bandCount, size_t rowCount, size_t granularity, size_t &rowBegin, size_t &rowEnd);
+
+    // Splits rowCount rows into bands (see getRowBandCount() and getRowBand()) and runs processRows on each non empty band in parallel, or on all
+    // rows on the calling thread if there is a single band.
+    void parallelForRows(size_t rowCount, size_t maxParallelism, const std::function<void(size_t rowBegin, size_t rowEnd)> &processRows,
+                         size_t granularity = 1, size_t minBandRows = 1);
+
+private:
+    ThreadPool();
+
+    struct Job {
+        const std::function<void(size_t)> *task;
+        size_t                             taskCount;
+        size_t                             helperCount;  // workers still to join the job
+        std::atomic<size_t>                nextTask;
+        std::atomic<size_t>                doneTaskCount;
+        std::mutex                         doneMutex;
+        std::condition_variable            doneCondition;
+    };
+
+    void workerLoop();
+    void runTasks(const std::shared_ptr<Job> &job);
+
+private:
+    std::vector<std::thread>         workers_;
+    std::mutex                       mutex_;
+    std::condition_variable          condition_;
+    std::deque<std::shared_ptr<Job>> jobs_;  // jobs still accepting workers
+    bool                             stopped_;
+};
+
+}  // namespace libobsensor
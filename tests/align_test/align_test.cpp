@@ -1,4 +1,5 @@
 #include "AlignImpl.hpp"
+#include "KernelTestUtils.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -7,6 +8,14 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+CHECK_KERNEL_ORDER(libobsensor::ALIGN_KERNEL_);
 
 // Data structure to hold the sections, keys, and values
 using IniSection = std::map<std::string, std::string>;
@@ -282,9 +291,180 @@ int main__(int argc, char *argv[]) {
     return 0;
 }
 
+// Synthetic calibration of a 1280x800 depth camera and a 1920x1080 color camera 25mm apart, with a slanted plane and a box in front of it as depth,
+// so the aligned pixels overlap (occlusion) and leave gaps.
+static void make_benchmark_data(OBCameraIntrinsic &depth_intr, OBCameraIntrinsic &color_intr, OBCameraDistortion &depth_disto, OBCameraDistortion &color_disto,
+                                OBTransform &trans, std::vector<uint16_t> &depth) {
+    depth_intr  = { 640.f, 640.f, 640.f, 400.f, 1280, 800 };
+    color_intr  = { 1100.f, 1100.f, 960.f, 540.f, 1920, 1080 };
+    depth_disto = { 0.05f, -0.02f, 0.001f, 0, 0, 0, 0.0005f, -0.0003f, OB_DISTORTION_BROWN_CONRADY };
+    color_disto = { 0.08f, -0.05f, 0.01f, 0, 0, 0, 0.0002f, 0.0001f, OB_DISTORTION_BROWN_CONRADY };
+    float rot[9] = { 0.9999f, -0.0087f, 0.0105f, 0.0088f, 0.9999f, -0.0052f, -0.0104f, 0.0053f, 0.9999f };
+    memcpy(trans.rot, rot, sizeof(rot));
+    trans.trans[0] = -25.f;
+    trans.trans[1] = 0.3f;
+    trans.trans[2] = 1.2f;
+
+    std::mt19937 rng(7);
+    depth.resize(static_cast<size_t>(depth_intr.width) * depth_intr.height);
+    for(int v = 0; v < depth_intr.height; v++) {
+        for(int u = 0; u < depth_intr.width; u++) {
+            float d = 1500.f + 0.8f * u + 0.3f * v;
+            if(u > 400 && u < 800 && v > 250 && v < 600) {
+                d = 600.f + 20.f * std::sin(u * 0.05f);
+            }
+            if(rng() % 50 == 0) {
+                d = 0;  // holes
+            }
+            depth[v * depth_intr.width + u] = static_cast<uint16_t>(d);
+        }
+    }
+}
+
+// Checks that aligning on several threads gives the same output as on a single thread, and measures the throughput
+static int run_benchmark(int frame_count) {
+    OBCameraIntrinsic     depth_intr, color_intr;
+    OBCameraDistortion    depth_disto, color_disto;
+    OBTransform           transform;
+    std::vector<uint16_t> depth;
+    make_benchmark_data(depth_intr, color_intr, depth_disto, color_disto, transform, depth);
+
+    std::vector<uint8_t> color(static_cast<size_t>(color_intr.width) * color_intr.height * 3);
+    for(size_t i = 0; i < color.size(); i++) {
+        color[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    std::vector<int> thread_counts = get_benchmark_thread_counts();
+
+    bool passed = true;
+    printf("%-9s | %-7s | %-8s | %7s | %10s | %8s | %s\n", "mode", "kernel", "gap fill", "threads", "ms/frame", "fps", "output");
+    for(int c2d = 0; c2d <= 1; c2d++) {
+        for(auto kernel: get_available_kernels<libobsensor::AlignImpl>()) {
+            for(int gap_fill_copy = 0; gap_fill_copy <= 1; gap_fill_copy++) {
+                std::vector<uint8_t> reference;
+                for(int thread_count: thread_counts) {
+                    libobsensor::AlignImpl impl;
+                    impl.initialize(depth_intr, depth_disto, color_intr, color_disto, transform, 1, true, gap_fill_copy != 0);
+                    impl.setThreadCount(thread_count);
+                    impl.setKernel(kernel);
+
+                    std::vector<uint8_t> out(c2d ? depth.size() * 3 : static_cast<size_t>(color_intr.width) * color_intr.height * 2);
+                    auto                 run = [&]() {
+                        if(c2d) {
+                            impl.C2D(depth.data(), depth_intr.width, depth_intr.height, color.data(), out.data(), color_intr.width, color_intr.height,
+                                     OB_FORMAT_RGB);
+                        }
+                        else {
+                            impl.D2C(depth.data(), depth_intr.width, depth_intr.height, reinterpret_cast<uint16_t *>(out.data()), color_intr.width,
+                                     color_intr.height, nullptr);
+                        }
+                    };
+                    run();  // warm up, allocates the buffers
+                    auto start = std::chrono::steady_clock::now();
+                    for(int i = 0; i < frame_count; i++) {
+                        run();
+                    }
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frame_count;
+
+                    const char *result = "reference";
+                    if(reference.empty()) {
+                        reference = out;
+                    }
+                    else if(reference == out) {
+                        result = "identical";
+                    }
+                    else {
+                        result = "MISMATCH";
+                        passed = false;
+                    }
+                    printf("%-9s | %-7s | %-8s | %7d | %10.2f | %8.1f | %s\n", c2d ? "C2D(RGB)" : "D2C", kernel_name(kernel),
+                           gap_fill_copy ? "copy" : "nearest", thread_count, ms, 1000.0 / ms, result);
+                }
+            }
+        }
+    }
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+// Checks that the SIMD kernels project the depth pixels to the same color pixels as the scalar path, for each target distortion model: the
+// coordinates may only differ by rounding (1 pixel, for at most 0.1% of the pixels), and a pixel may only be dropped by one of them at the frame border.
+static int run_accuracy() {
+    OBCameraIntrinsic     depth_intr, color_intr;
+    OBCameraDistortion    depth_disto, color_disto;
+    OBTransform           transform;
+    std::vector<uint16_t> depth;
+    make_benchmark_data(depth_intr, color_intr, depth_disto, color_disto, transform, depth);
+
+    const OBCameraDistortion target_distortions[] = {
+        color_disto,
+        { 0.5f, -0.1f, 0.01f, 0.42f, -0.06f, 0.005f, 0.0002f, 0.0001f, OB_DISTORTION_BROWN_CONRADY_K6 },
+        { -0.012f, 0.0031f, -0.0009f, 0.0002f, 0, 0, 0, 0, OB_DISTORTION_KANNALA_BRANDT4 },
+    };
+    const char *model_names[] = { "BC", "K6", "KB4" };
+
+    bool passed = true;
+    printf("%-5s | %-7s | %-8s | %10s | %10s | %10s | %s\n", "model", "kernel", "gap fill", "mapped", "deviating", "max (px)", "dropped at border/other");
+    for(int model = 0; model < 3; model++) {
+        for(int gap_fill_copy = 0; gap_fill_copy <= 1; gap_fill_copy++) {
+            libobsensor::AlignImpl scalar;
+            scalar.initialize(depth_intr, depth_disto, color_intr, target_distortions[model], transform, 1, true, gap_fill_copy != 0);
+            std::vector<int> reference(depth.size() * 2, -1);
+            scalar.D2C(depth.data(), depth_intr.width, depth_intr.height, nullptr, color_intr.width, color_intr.height, reference.data(), false);
+
+            for(auto kernel: get_available_kernels<libobsensor::AlignImpl>()) {
+                if(kernel == libobsensor::ALIGN_KERNEL_SCALAR) {
+                    continue;
+                }
+                libobsensor::AlignImpl impl;
+                impl.initialize(depth_intr, depth_disto, color_intr, target_distortions[model], transform, 1, true, gap_fill_copy != 0);
+                impl.setKernel(kernel);
+                std::vector<int> map(depth.size() * 2, -1);
+                impl.D2C(depth.data(), depth_intr.width, depth_intr.height, nullptr, color_intr.width, color_intr.height, map.data());
+
+                size_t mapped = 0, deviating = 0, border = 0, other = 0;
+                int    max_deviation = 0;
+                for(size_t i = 0; i < depth.size(); i++) {
+                    const int *a = &reference[2 * i], *b = &map[2 * i];
+                    if(a[0] < 0 && b[0] < 0) {
+                        continue;
+                    }
+                    mapped++;
+                    if(a[0] < 0 || b[0] < 0) {
+                        // projected just outside of the frame by one of them
+                        const int *p = a[0] < 0 ? b : a;
+                        bool       at_border = p[0] == 0 || p[1] == 0 || p[0] == color_intr.width - 1 || p[1] == color_intr.height - 1;
+                        (at_border ? border : other)++;
+                        continue;
+                    }
+                    int deviation = std::max(std::abs(a[0] - b[0]), std::abs(a[1] - b[1]));
+                    if(deviation > 0) {
+                        deviating++;
+                        max_deviation = std::max(max_deviation, deviation);
+                    }
+                }
+                bool ok = max_deviation <= 1 && deviating * 1000 <= mapped && other == 0;
+                passed  = passed && ok;
+                printf("%-5s | %-7s | %-8s | %10zu | %10zu | %10d | %zu/%zu%s\n", model_names[model], kernel_name(kernel), gap_fill_copy ? "copy" : "nearest",
+                       mapped, deviating, max_deviation, border, other, ok ? "" : "  FAILED");
+            }
+        }
+    }
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
+
 int main(int argc, char *argv[]) {
+    if(argc >= 2 && std::string(argv[1]) == "--benchmark") {
+        return run_benchmark(argc >= 3 ? std::atoi(argv[2]) : 30);
+    }
+    if(argc >= 2 && std::string(argv[1]) == "--accuracy") {
+        return run_accuracy();
+    }
     if(argc < 4) {
         std::cerr << "Usage: %s <param_file> <depth_image_file> <color_image_file>" << std::endl;
+        std::cerr << "       %s --benchmark [frame_count]" << std::endl;
+        std::cerr << "       %s --accuracy" << std::endl;
         return -1;
     }
 
@@ -0,0 +1,746 @@
+#include "DecimationImpl.hpp"
+#include "KernelTestUtils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+CHECK_KERNEL_ORDER(libobsensor::DECIMATION_KERNEL_);
+
+using namespace libobsensor;
+
+// The decimation of DecimationFilter before DecimationImpl, the reference of the check
+namespace reference {
+
+#define SWAP(a, b)            \
+    {                         \
+        uint16_t temp = (a);  \
+        (a)           = (b);  \
+        (b)           = temp; \
+    }
+
+inline uint16_t median1(uint16_t arr[]) {
+    return arr[0];
+}
+
+inline uint16_t median2(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    return arr[0];
+}
+
+inline uint16_t median3(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[1] > arr[2])
+        SWAP(arr[1], arr[2]);
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    return arr[1];
+}
+
+inline uint16_t median4(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[2] > arr[3])
+        SWAP(arr[2], arr[3]);
+    if(arr[0] > arr[2])
+        SWAP(arr[0], arr[2]);
+    if(arr[1] > arr[3])
+        SWAP(arr[1], arr[3]);
+    if(arr[1] > arr[2])
+        SWAP(arr[1], arr[2]);
+    return arr[1];
+}
+
+inline uint16_t median5(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[3] > arr[4])
+        SWAP(arr[3], arr[4]);
+    if(arr[0] > arr[2])
+        SWAP(arr[0], arr[2]);
+    if(arr[1] > arr[2])
+        SWAP(arr[1], arr[2]);
+    if(arr[3] > arr[2])
+        SWAP(arr[3], arr[2]);
+    if(arr[4] > arr[2])
+        SWAP(arr[4], arr[2]);
+    if(arr[1] > arr[3])
+        SWAP(arr[1], arr[3]);
+    return arr[2];
+}
+
+inline uint16_t median6(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[2] > arr[3])
+        SWAP(arr[2], arr[3]);
+    if(arr[4] > arr[5])
+        SWAP(arr[4], arr[5]);
+    if(arr[0] > arr[2])
+        SWAP(arr[0], arr[2]);
+    if(arr[1] > arr[3])
+        SWAP(arr[1], arr[3]);
+    if(arr[2] > arr[4])
+        SWAP(arr[2], arr[4]);
+    if(arr[3] > arr[5])
+        SWAP(arr[3], arr[5]);
+    if(arr[1] > arr[4])
+        SWAP(arr[1], arr[4]);
+    if(arr[3] > arr[4])
+        SWAP(arr[3], arr[4]);
+    return arr[2];
+}
+
+inline uint16_t median7(uint16_t arr[]) {
+    if(arr[0] > arr[5])
+        SWAP(arr[0], arr[5]);
+    if(arr[0] > arr[3])
+        SWAP(arr[0], arr[3]);
+    if(arr[1] > arr[6])
+        SWAP(arr[1], arr[6]);
+    if(arr[2] > arr[4])
+        SWAP(arr[2], arr[4]);
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[3] > arr[5])
+        SWAP(arr[3], arr[5]);
+    if(arr[2] > arr[6])
+        SWAP(arr[2], arr[6]);
+    if(arr[2] > arr[3])
+        SWAP(arr[2], arr[3]);
+    if(arr[3] > arr[6])
+        SWAP(arr[3], arr[6]);
+    if(arr[4] > arr[5])
+        SWAP(arr[4], arr[5]);
+    if(arr[1] > arr[5])
+        SWAP(arr[1], arr[5]);
+    if(arr[1] > arr[3])
+        SWAP(arr[1], arr[3]);
+    if(arr[3] > arr[4])
+        SWAP(arr[3], arr[4]);
+    return arr[3];
+}
+
+inline uint16_t median8(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[2] > arr[3])
+        SWAP(arr[2], arr[3]);
+    if(arr[4] > arr[5])
+        SWAP(arr[4], arr[5]);
+    if(arr[6] > arr[7])
+        SWAP(arr[6], arr[7]);
+    if(arr[0] > arr[2])
+        SWAP(arr[0], arr[2]);
+    if(arr[1] > arr[3])
+        SWAP(arr[1], arr[3]);
+    if(arr[4] > arr[6])
+        SWAP(arr[4], arr[6]);
+    if(arr[5] > arr[7])
+        SWAP(arr[5], arr[7]);
+    if(arr[1] > arr[4])
+        SWAP(arr[1], arr[4]);
+    if(arr[3] > arr[6])
+        SWAP(arr[3], arr[6]);
+    if(arr[2] > arr[5])
+        SWAP(arr[2], arr[5]);
+    if(arr[3] > arr[4])
+        SWAP(arr[3], arr[4]);
+    if(arr[2] > arr[6])
+        SWAP(arr[2], arr[6]);
+    if(arr[1] > arr[3])
+        SWAP(arr[1], arr[3]);
+    if(arr[5] > arr[7])
+        SWAP(arr[5], arr[7]);
+    if(arr[3] > arr[5])
+        SWAP(arr[3], arr[5]);
+    if(arr[4] > arr[6])
+        SWAP(arr[4], arr[6]);
+    return arr[3];
+}
+
+inline uint16_t median9(uint16_t arr[]) {
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[3] > arr[4])
+        SWAP(arr[3], arr[4]);
+    if(arr[6] > arr[7])
+        SWAP(arr[6], arr[7]);
+    if(arr[1] > arr[2])
+        SWAP(arr[1], arr[2]);
+    if(arr[4] > arr[5])
+        SWAP(arr[4], arr[5]);
+    if(arr[7] > arr[8])
+        SWAP(arr[7], arr[8]);
+    if(arr[0] > arr[1])
+        SWAP(arr[0], arr[1]);
+    if(arr[3] > arr[4])
+        SWAP(arr[3], arr[4]);
+    if(arr[6] > arr[7])
+        SWAP(arr[6], arr[7]);
+    if(arr[1] > arr[2])
+        SWAP(arr[1], arr[2]);
+    if(arr[4] > arr[5])
+        SWAP(arr[4], arr[5]);
+    if(arr[7] > arr[8])
+        SWAP(arr[7], arr[8]);
+    arr[3] = arr[0] > arr[3] ? arr[0] : arr[3];
+    arr[5] = arr[5] > arr[8] ? arr[8] : arr[5];
+    if(arr[4] > arr[7])
+        SWAP(arr[4], arr[7]);
+    arr[6] = arr[3] > arr[6] ? arr[3] : arr[6];
+    arr[4] = arr[1] > arr[4] ? arr[1] : arr[4];
+    arr[2] = arr[2] > arr[5] ? arr[5] : arr[2];
+    arr[4] = arr[4] > arr[7] ? arr[7] : arr[4];
+    if(arr[4] > arr[2])
+        SWAP(arr[4], arr[2]);
+    arr[4] = arr[4] > arr[6] ? arr[6] : arr[4];
+    return arr[4];
+}
+
+typedef uint16_t (*MDFUNC)(uint16_t arr[]);
+// 0     1       2        3        4         5        6        7       8       9
+static MDFUNC _mdfunc[] = { 0, median1, median2, median3, median4, median5, median6, median7, median8, median9 };
+
+struct Decimation {
+    uint16_t real_width_;
+    uint16_t real_height_;
+    uint16_t padded_width_;
+    uint16_t padded_height_;
+
+    void decimateDepth(uint16_t *frame_data_in, uint16_t *frame_data_out, size_t width_in, size_t scale) {
+
+        // construct internal register buf
+        uint16_t  working_kernel[9];
+        uint16_t *pixel_raws[10];  // max scale set 10
+        uint16_t *block_start = const_cast<uint16_t *>(frame_data_in);
+        uint16_t *p{};
+        int       wk_count = 0;
+        int       wk_sum   = 0;
+        MDFUNC    f;
+
+        if(scale == 2 || scale == 3) {
+            // loop through rows
+            for(int j = 0; j < real_height_; j++) {
+
+                for(size_t i = 0; i < scale; i++) {
+                    pixel_raws[i] = block_start + (width_in * i);
+                    //__builtin_prefetch(pixel_raws[i] + (width_in * scale), 0, 3);
+                }
+
+                // processing row-wisely
+                for(size_t i = 0, chunk_offset = 0; i < real_width_; i++, chunk_offset += scale) {
+                    wk_count = 0;
+                    // processing kernel
+                    for(size_t n = 0; n < scale; ++n) {
+                        p = pixel_raws[n] + chunk_offset;
+                        for(size_t m = 0; m < scale; ++m) {
+                            if(*(p + m)) {
+                                working_kernel[wk_count] = *(p + m);
+                                wk_count++;
+                            }
+                        }
+                    }
+
+                    if(wk_count == 0)
+                        *frame_data_out++ = 0;
+                    else {
+                        f                 = _mdfunc[wk_count];
+                        *frame_data_out++ = f(working_kernel);
+                    }
+                }
+
+                // filling right side blanks
+                for(int k = real_width_; k < padded_width_; k++)
+                    *frame_data_out++ = 0;
+
+                // move to the start position of next processing block
+                block_start += width_in * scale;
+            }
+        }
+        else {
+
+            for(int j = 0; j < real_height_; j++) {
+
+                for(size_t i = 0; i < scale; i++) {
+                    pixel_raws[i] = block_start + (width_in * i);
+                }
+
+                for(size_t i = 0, chunk_offset = 0; i < real_width_; i++, chunk_offset += scale) {
+                    wk_sum   = 0;
+                    wk_count = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        p = pixel_raws[n] + chunk_offset;
+                        for(size_t m = 0; m < scale; ++m) {
+                            if(*(p + m)) {
+                                wk_sum += p[m];
+                                ++wk_count;
+                            }
+                        }
+                    }
+
+                    *frame_data_out++ = (uint16_t)(wk_count == 0 ? 0 : wk_sum / wk_count);
+                }
+
+                for(int k = real_width_; k < padded_width_; k++)
+                    *frame_data_out++ = 0;
+
+                block_start += width_in * scale;
+            }
+        }
+        memset(frame_data_out, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint16_t));
+    }
+
+    void decimateOthers(OBFormat format, void *frame_data_in, void *frame_data_out, size_t width_in, size_t scale) {
+
+        auto patch_size = scale * scale;
+
+        int wk_sum = 0;
+        // int wk_count = 0;
+
+        switch(format) {
+        case OB_FORMAT_YUYV: {
+            uint8_t *from = (uint8_t *)frame_data_in;
+            uint8_t *p    = nullptr;
+            uint8_t *q    = (uint8_t *)frame_data_out;
+
+            auto w_2  = width_in >> 1;
+            auto rw_2 = real_width_ >> 1;
+            auto pw_2 = padded_width_ >> 1;
+            auto s2   = scale >> 1;
+            bool odd  = (scale & 1);
+            for(int j = 0; j < real_height_; ++j) {
+                for(int i = 0; i < rw_2; ++i) {
+                    p      = from + scale * (j * w_2 + i) * 4;
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < scale; ++m)
+                            wk_sum += p[m * 2];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+
+                    p      = from + scale * (j * w_2 + i) * 4 + 1;
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < s2; ++m)
+                            wk_sum += 2 * p[m * 4];
+
+                        if(odd)
+                            wk_sum += p[s2 * 4];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+
+                    p      = from + scale * (j * w_2 + i) * 4 + s2 * 4 + (odd ? 2 : 0);
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < scale; ++m)
+                            wk_sum += p[m * 2];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+
+                    p      = from + scale * (j * w_2 + i) * 4 + 3;
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < s2; ++m)
+                            wk_sum += 2 * p[m * 4];
+
+                        if(odd)
+                            wk_sum += p[s2 * 4];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+                }
+
+                for(int i = rw_2; i < pw_2; ++i) {
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                }
+            }
+
+            memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 2);
+        } break;
+
+        case OB_FORMAT_UYVY: {
+            uint8_t *from = (uint8_t *)frame_data_in;
+            uint8_t *p    = nullptr;
+            uint8_t *q    = (uint8_t *)frame_data_out;
+
+            auto w_2  = width_in >> 1;
+            auto rw_2 = real_width_ >> 1;
+            auto pw_2 = padded_width_ >> 1;
+            auto s2   = scale >> 1;
+            bool odd  = (scale & 1);
+            for(int j = 0; j < real_height_; ++j) {
+                for(int i = 0; i < rw_2; ++i) {
+                    p      = from + scale * (j * w_2 + i) * 4;
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < s2; ++m)
+                            wk_sum += 2 * p[m * 4];
+
+                        if(odd)
+                            wk_sum += p[s2 * 4];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+
+                    p      = from + scale * (j * w_2 + i) * 4 + 1;
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < scale; ++m)
+                            wk_sum += p[m * 2];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+
+                    p      = from + scale * (j * w_2 + i) * 4 + 2;
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < s2; ++m)
+                            wk_sum += 2 * p[m * 4];
+
+                        if(odd)
+                            wk_sum += p[s2 * 4];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+
+                    p      = from + scale * (j * w_2 + i) * 4 + s2 * 4 + (odd ? 3 : 1);
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < scale; ++m)
+                            wk_sum += p[m * 2];
+
+                        p += w_2 * 4;
+                    }
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+                }
+
+                for(int i = rw_2; i < pw_2; ++i) {
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                }
+            }
+
+            memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 2);
+        } break;
+
+        case OB_FORMAT_RGB:
+        case OB_FORMAT_BGR: {
+            uint8_t *from = (uint8_t *)frame_data_in;
+            uint8_t *p    = nullptr;
+            uint8_t *q    = (uint8_t *)frame_data_out;
+            ;
+
+            for(int j = 0; j < real_height_; ++j) {
+                for(int i = 0; i < real_width_; ++i) {
+                    for(int k = 0; k < 3; ++k) {
+                        p      = from + scale * (j * width_in + i) * 3 + k;
+                        wk_sum = 0;
+                        for(size_t n = 0; n < scale; ++n) {
+                            for(size_t m = 0; m < scale; ++m)
+                                wk_sum += p[m * 3];
+
+                            p += width_in * 3;
+                        }
+
+                        *q++ = (uint8_t)(wk_sum / patch_size);
+                    }
+                }
+
+                for(int i = real_width_; i < padded_width_; ++i) {
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                }
+            }
+
+            memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 3);
+        } break;
+
+        case OB_FORMAT_RGBA:
+        case OB_FORMAT_BGRA: {
+            uint8_t *from = (uint8_t *)frame_data_in;
+            uint8_t *p    = nullptr;
+            uint8_t *q    = (uint8_t *)frame_data_out;
+
+            for(int j = 0; j < real_height_; ++j) {
+                for(int i = 0; i < real_width_; ++i) {
+                    for(int k = 0; k < 4; ++k) {
+                        p      = from + scale * (j * width_in + i) * 4 + k;
+                        wk_sum = 0;
+                        for(size_t n = 0; n < scale; ++n) {
+                            for(size_t m = 0; m < scale; ++m)
+                                wk_sum += p[m * 4];
+
+                            p += width_in * 4;
+                        }
+
+                        *q++ = (uint8_t)(wk_sum / patch_size);
+                    }
+                }
+
+                for(int i = real_width_; i < padded_width_; ++i) {
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                    *q++ = 0;
+                }
+            }
+
+            memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t) * 4);
+
+        } break;
+
+        case OB_FORMAT_Y8: {
+            uint8_t *from = (uint8_t *)frame_data_in;
+            uint8_t *p    = nullptr;
+            uint8_t *q    = (uint8_t *)frame_data_out;
+
+            for(int j = 0; j < real_height_; ++j) {
+                for(int i = 0; i < real_width_; ++i) {
+                    p      = from + scale * (j * width_in + i);
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < scale; ++m) {
+                            wk_sum += p[m];
+                        }
+
+                        p += width_in;
+                    }
+
+                    *q++ = (uint8_t)(wk_sum / patch_size);
+                }
+
+                for(int i = real_width_; i < padded_width_; ++i)
+                    *q++ = 0;
+            }
+
+            memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint8_t));
+
+        } break;
+
+        case OB_FORMAT_Y16: {
+            uint16_t *from = (uint16_t *)frame_data_in;
+            uint16_t *p    = nullptr;
+            uint16_t *q    = (uint16_t *)frame_data_out;
+
+            for(int j = 0; j < real_height_; ++j) {
+                for(int i = 0; i < real_width_; ++i) {
+                    p      = from + scale * (j * width_in + i);
+                    wk_sum = 0;
+                    for(size_t n = 0; n < scale; ++n) {
+                        for(size_t m = 0; m < scale; ++m) {
+                            wk_sum += p[m];
+                        }
+                        p += width_in;
+                    }
+
+                    *q++ = (uint16_t)(wk_sum / patch_size);
+                }
+
+                for(int i = real_width_; i < padded_width_; ++i)
+                    *q++ = 0;
+            }
+
+            memset(q, 0, (padded_height_ - real_height_) * padded_width_ * sizeof(uint16_t));
+
+        } break;
+
+        default:
+            break;
+        }
+    }
+};
+
+}  // namespace reference
+
+struct Size {
+    int scale;
+    int real_width, real_height;
+    int padded_width, padded_height;
+};
+
+// the output size of DecimationFilter
+static Size get_size(int width, int height, int scale) {
+    Size size;
+    size.scale         = scale;
+    size.real_width    = width / scale;
+    size.real_height   = height / scale;
+    size.padded_width  = (size.real_width + 3) / 4 * 4;
+    size.padded_height = (size.real_height + 3) / 4 * 4;
+    return size;
+}
+
+// Synthetic depth: a slanted plane and a box in front of it, with repeated values, scattered holes and a hole region
+static std::vector<uint16_t> make_depth(int width, int height) {
+    std::mt19937          rng(5);
+    std::vector<uint16_t> depth(static_cast<size_t>(width) * height);
+    for(int v = 0; v < height; v++) {
+        for(int u = 0; u < width; u++) {
+            uint16_t d = static_cast<uint16_t>(1500 + u / 4 + v / 8 + rng() % 8);
+            if(u > width / 3 && u < 2 * width / 3 && v > height / 3 && v < 3 * height / 4) {
+                d = static_cast<uint16_t>(600 + rng() % 40);
+            }
+            if(rng() % 100 < 8 || (u < width / 8 && v < height / 5)) {
+                d = 0;
+            }
+            depth[static_cast<size_t>(v) * width + u] = d;
+        }
+    }
+    return depth;
+}
+
+static std::vector<uint8_t> make_image(size_t size) {
+    std::mt19937         rng(9);
+    std::vector<uint8_t> image(size);
+    for(auto &value: image) {
+        value = static_cast<uint8_t>(rng());
+    }
+    return image;
+}
+
+struct Format {
+    const char *name;
+    OBFormat    format;
+    int         bytes_per_pixel;
+};
+
+static const Format other_formats[] = { { "Y8", OB_FORMAT_Y8, 1 },     { "Y16", OB_FORMAT_Y16, 2 },   { "YUYV", OB_FORMAT_YUYV, 2 },
+                                        { "UYVY", OB_FORMAT_UYVY, 2 }, { "RGB", OB_FORMAT_RGB, 3 },   { "BGR", OB_FORMAT_BGR, 3 },
+                                        { "RGBA", OB_FORMAT_RGBA, 4 }, { "BGRA", OB_FORMAT_BGRA, 4 } };
+
+static void run_reference_depth(const std::vector<uint16_t> &depth, int width, const Size &size, std::vector<uint16_t> &out) {
+    reference::Decimation decimation = { static_cast<uint16_t>(size.real_width), static_cast<uint16_t>(size.real_height),
+                                         static_cast<uint16_t>(size.padded_width), static_cast<uint16_t>(size.padded_height) };
+    out.assign(static_cast<size_t>(size.padded_width) * size.padded_height, 0xffff);
+    decimation.decimateDepth(const_cast<uint16_t *>(depth.data()), out.data(), width, size.scale);
+}
+
+static void run_reference_others(const Format &format, const std::vector<uint8_t> &image, int width, const Size &size, std::vector<uint8_t> &out) {
+    reference::Decimation decimation = { static_cast<uint16_t>(size.real_width), static_cast<uint16_t>(size.real_height),
+                                         static_cast<uint16_t>(size.padded_width), static_cast<uint16_t>(size.padded_height) };
+    out.assign(static_cast<size_t>(size.padded_width) * size.padded_height * format.bytes_per_pixel, 0xff);
+    decimation.decimateOthers(format.format, const_cast<uint8_t *>(image.data()), out.data(), width, size.scale);
+}
+
+static void run_depth(const DecimationImpl &impl, const std::vector<uint16_t> &depth, int width, const Size &size, std::vector<uint16_t> &out) {
+    out.assign(static_cast<size_t>(size.padded_width) * size.padded_height, 0xffff);
+    impl.decimateDepth(depth.data(), width, size.scale, size.real_width, size.real_height, size.padded_width, size.padded_height, out.data());
+}
+
+static void run_others(const DecimationImpl &impl, const Format &format, const std::vector<uint8_t> &image, int width, const Size &size,
+                       std::vector<uint8_t> &out) {
+    out.assign(static_cast<size_t>(size.padded_width) * size.padded_height * format.bytes_per_pixel, 0xff);
+    impl.decimateOthers(format.format, image.data(), width, size.scale, size.real_width, size.real_height, size.padded_width, size.padded_height,
+                        out.data());
+}
+
+// Checks that every kernel, thread count and scale gives the same frame as the reference, on a resolution leaving a tail of pixels and rows for
+// every scale, and a tail of pixels after the kernel blocks
+static int run_check() {
+    const int width = 1286, height = 723;  // an even width, for the pixel pairs of YUYV and UYVY
+    bool      passed = true;
+
+    auto                  depth = make_depth(width, height);
+    std::vector<uint16_t> expected, out;
+    printf("%-6s | %5s | %-7s | %7s | %s\n", "format", "scale", "kernel", "threads", "result");
+    for(int scale = 1; scale <= 8; scale++) {
+        Size size = get_size(width, height, scale);
+        run_reference_depth(depth, width, size, expected);
+        for(auto kernel: get_available_kernels<DecimationImpl>()) {
+            for(int thread_count: { 1, 3 }) {
+                DecimationImpl impl;
+                impl.setKernel(kernel);
+                impl.setThreadCount(thread_count);
+                run_depth(impl, depth, width, size, out);
+                bool same = out == expected;
+                passed    = passed && same;
+                printf("%-6s | %5d | %-7s | %7d | %s\n", "depth", scale, kernel_name(kernel), thread_count, same ? "identical" : "MISMATCH");
+            }
+        }
+    }
+
+    for(auto &format: other_formats) {
+        auto                 image = make_image(static_cast<size_t>(width) * height * format.bytes_per_pixel);
+        std::vector<uint8_t> expected_image, out_image;
+        for(int scale = 1; scale <= 8; scale++) {
+            Size size = get_size(width, height, scale);
+            run_reference_others(format, image, width, size, expected_image);
+            for(int thread_count: { 1, 3 }) {
+                DecimationImpl impl;
+                impl.setThreadCount(thread_count);
+                run_others(impl, format, image, width, size, out_image);
+                bool same = out_image == expected_image;
+                passed    = passed && same;
+                printf("%-6s | %5d | %-7s | %7d | %s\n", format.name, scale, "-", thread_count, same ? "identical" : "MISMATCH");
+            }
+        }
+    }
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+// Measures the time of the depth scales on 1280x800 and of the color formats on 1920x1080, against the reference
+static int run_benchmark(int frame_count) {
+    std::vector<int> thread_counts = get_benchmark_thread_counts();
+
+    DecimationImpl default_impl;
+    printf("kernel: %s\n", kernel_name(default_impl.getKernel()));
+    printf("%-6s | %5s | %-9s | %7s | %10s | %8s\n", "format", "scale", "code", "threads", "ms/frame", "fps");
+
+    const int             depth_width = 1280, depth_height = 800;
+    auto                  depth = make_depth(depth_width, depth_height);
+    std::vector<uint16_t> out;
+    for(int scale: { 2, 3, 4 }) {
+        Size   size = get_size(depth_width, depth_height, scale);
+        double ms   = measure(frame_count, [&]() { run_reference_depth(depth, depth_width, size, out); });
+        printf("%-6s | %5d | %-9s | %7d | %10.3f | %8.1f\n", "depth", scale, "reference", 1, ms, 1000.0 / ms);
+        for(int thread_count: thread_counts) {
+            DecimationImpl impl;
+            impl.setThreadCount(thread_count);
+            ms = measure(frame_count, [&]() { run_depth(impl, depth, depth_width, size, out); });
+            printf("%-6s | %5d | %-9s | %7d | %10.3f | %8.1f\n", "depth", scale, kernel_name(impl.getKernel()), thread_count, ms, 1000.0 / ms);
+        }
+    }
+
+    const int color_width = 1920, color_height = 1080;
+    for(int f: { 2, 4, 6 }) {
+        const Format        &format = other_formats[f];
+        auto                 image  = make_image(static_cast<size_t>(color_width) * color_height * format.bytes_per_pixel);
+        std::vector<uint8_t> out_image;
+        Size                 size = get_size(color_width, color_height, 2);
+        double               ms   = measure(frame_count, [&]() { run_reference_others(format, image, color_width, size, out_image); });
+        printf("%-6s | %5d | %-9s | %7d | %10.3f | %8.1f\n", format.name, 2, "reference", 1, ms, 1000.0 / ms);
+        for(int thread_count: thread_counts) {
+            DecimationImpl impl;
+            impl.setThreadCount(thread_count);
+            ms = measure(frame_count, [&]() { run_others(impl, format, image, color_width, size, out_image); });
+            printf("%-6s | %5d | %-9s | %7d | %10.3f | %8.1f\n", format.name, 2, "box mean", thread_count, ms, 1000.0 / ms);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    return run_kernel_test(argc, argv, run_check, run_benchmark, 30);
+}
@@ -0,0 +1,245 @@
+#include "FormatConverterKernels.hpp"
+
+#include <libyuv.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace libobsensor;
+
+struct ConversionCase {
+    std::string                                                     name;
+    float                                                           srcPixelSize;
+    float                                                           dstPixelSize;
+    std::function<void(const uint8_t *, uint8_t *, uint32_t, uint32_t)> kernel;
+};
+
+static std::vector<ConversionCase> conversionCases() {
+    return {
+        { "YUYV->RGB", 2, 3, kernels::yuyvToRgb },
+        { "YUYV->BGR", 2, 3, kernels::yuyvToBgr },
+        { "YUYV->RGBA", 2, 4, kernels::yuyvToRgba },
+        { "YUYV->BGRA", 2, 4, kernels::yuyvToBgra },
+        { "YUYV->Y8", 2, 1, kernels::yuyvToY8 },
+        { "YUYV->Y16", 2, 2, kernels::yuyvToY16 },
+        { "UYVY->RGB", 2, 3, kernels::uyvyToRgb },
+        { "I420->RGB", 1.5f, 3, kernels::i420ToRgb },
+        { "NV12->RGB", 1.5f, 3, kernels::nv12ToRgb },
+        { "NV21->RGB", 1.5f, 3, kernels::nv21ToRgb },
+        { "RGB->BGR", 3, 3, [](const uint8_t *src, uint8_t *dst, uint32_t w, uint32_t h) { kernels::swapRB(src, dst, w, h, 3); } },
+        { "RGBA->BGRA", 4, 4, [](const uint8_t *src, uint8_t *dst, uint32_t w, uint32_t h) { kernels::swapRB(src, dst, w, h, 4); } },
+    };
+}
+
+// The conversions of FormatConverter before they were moved to FormatConverterKernels, to check the kernels did not change the output.
+// yuyvToY8/yuyvToY16 stop at the last pixel here, the originals wrote whole groups of 16 pixels past the end of the frame.
+namespace reference {
+
+void yuyvToI420(const uint8_t *src, std::vector<uint8_t> &i420, uint32_t width, uint32_t height, bool uyvy) {
+    i420.resize(width * height * 3 / 2);
+    uint8_t *yData = i420.data();
+    uint8_t *uData = i420.data() + width * height;
+    uint8_t *vData = i420.data() + width * height * 5 / 4;
+    if(uyvy) {
+        libyuv::UYVYToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
+    }
+    else {
+        libyuv::YUY2ToI420(src, width * 2, yData, width, uData, width / 2, vData, width / 2, width, height);
+    }
+}
+
+template <typename F> void i420ToPacked(F convert, const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height, uint32_t pixelSize, bool uyvy) {
+    std::vector<uint8_t> i420;
+    yuyvToI420(src, i420, width, height, uyvy);
+    const uint8_t *yData = i420.data();
+    const uint8_t *uData = i420.data() + width * height;
+    const uint8_t *vData = i420.data() + width * height * 5 / 4;
+    convert(yData, width, uData, width / 2, vData, width / 2, target, width * pixelSize, width, height);
+}
+
+void yuyvToRgb(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    i420ToPacked(libyuv::I420ToRAW, src, target, width, height, 3, false);
+}
+
+void yuyvToBgr(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    i420ToPacked(libyuv::I420ToRGB24, src, target, width, height, 3, false);
+}
+
+void yuyvToRgba(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    i420ToPacked(libyuv::I420ToABGR, src, target, width, height, 4, false);
+}
+
+void yuyvToBgra(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    i420ToPacked(libyuv::I420ToARGB, src, target, width, height, 4, false);
+}
+
+void uyvyToRgb(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    i420ToPacked(libyuv::I420ToRAW, src, target, width, height, 3, true);
+}
+
+void yuyvToY8(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    for(uint32_t i = 0; i < width * height; i++) {
+        target[i] = src[i * 2];
+    }
+}
+
+void yuyvToY16(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    for(uint32_t i = 0; i < width * height; i++) {
+        target[i * 2]     = 0;
+        target[i * 2 + 1] = src[i * 2];
+    }
+}
+
+void i420ToRgb(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    const uint8_t *yData = src;
+    const uint8_t *uData = src + width * height;
+    const uint8_t *vData = src + width * height * 5 / 4;
+    libyuv::I420ToRAW(yData, width, uData, width / 2, vData, width / 2, target, width * 3, width, height);
+}
+
+void nv21ToRgb(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    libyuv::NV21ToRAW(src, width, src + width * height, width, target, width * 3, width, height);
+}
+
+void nv12ToRgb(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    libyuv::NV12ToRAW(src, width, src + width * height, width, target, width * 3, width, height);
+}
+
+void exchangeRAndB(const uint8_t *src, uint8_t *target, uint32_t width, uint32_t height) {
+    for(uint32_t i = 0; i < width * height; i++) {
+        target[i * 3]     = src[i * 3 + 2];
+        target[i * 3 + 1] = src[i * 3 + 1];
+        target[i * 3 + 2] = src[i * 3];
+    }
+}
+
+}  // namespace reference
+
+struct BaselineCase {
+    std::string                                                     name;  // as in conversionCases()
+    std::function<void(const uint8_t *, uint8_t *, uint32_t, uint32_t)> baseline;
+};
+
+// RGBA->BGRA has no baseline, FormatConverter only swapped 3 byte pixels before
+static std::vector<BaselineCase> baselineCases() {
+    return {
+        { "YUYV->RGB", reference::yuyvToRgb },   { "YUYV->BGR", reference::yuyvToBgr }, { "YUYV->RGBA", reference::yuyvToRgba },
+        { "YUYV->BGRA", reference::yuyvToBgra }, { "YUYV->Y8", reference::yuyvToY8 },   { "YUYV->Y16", reference::yuyvToY16 },
+        { "UYVY->RGB", reference::uyvyToRgb },   { "I420->RGB", reference::i420ToRgb }, { "NV12->RGB", reference::nv12ToRgb },
+        { "NV21->RGB", reference::nv21ToRgb },   { "RGB->BGR", reference::exchangeRAndB },
+    };
+}
+
+// libyuv::MaskCpuFlags(1) disables all SIMD paths, the kernels then run their scalar C implementation
+static std::vector<uint8_t> runReference(const ConversionCase &c, const std::vector<uint8_t> &src, uint32_t w, uint32_t h) {
+    std::vector<uint8_t> dst(static_cast<size_t>(w * h * c.dstPixelSize));
+    libyuv::MaskCpuFlags(1);
+    c.kernel(src.data(), dst.data(), w, h);
+    libyuv::MaskCpuFlags(-1);
+    return dst;
+}
+
+// Checks every kernel against the scalar reference, with sizes that leave a tail not covered by a full vector
+static bool testBitExact() {
+    const uint32_t sizes[][2] = { { 640, 480 }, { 1920, 1080 }, { 1282, 722 }, { 34, 6 } };
+    std::mt19937   rng(2024);
+    bool           allPassed = true;
+    for(auto &size: sizes) {
+        uint32_t w = size[0], h = size[1];
+        for(auto &c: conversionCases()) {
+            std::vector<uint8_t> src(static_cast<size_t>(w * h * c.srcPixelSize));
+            for(auto &v: src) {
+                v = static_cast<uint8_t>(rng());
+            }
+            auto                 ref = runReference(c, src, w, h);
+            std::vector<uint8_t> dst(ref.size());
+            c.kernel(src.data(), dst.data(), w, h);
+            if(memcmp(ref.data(), dst.data(), ref.size()) != 0) {
+                size_t i = 0;
+                while(ref[i] == dst[i]) {
+                    i++;
+                }
+                printf("FAILED: %s %ux%u, first mismatch at byte %zu: %d != %d (reference)\n", c.name.c_str(), w, h, i, dst[i], ref[i]);
+                allPassed = false;
+            }
+        }
+    }
+    printf("Bit-exact test against scalar reference: %s\n", allPassed ? "passed" : "FAILED");
+    return allPassed;
+}
+
+// Checks every kernel bit-exact against the FormatConverter conversion it replaced, on random pixels, so the YUYV/UYVY to RGB kernels must average the
+// chroma of each pair of rows as the full frame I420 of the baseline did.
+static bool testAgainstBaseline() {
+    const uint32_t sizes[][2] = { { 640, 480 }, { 1282, 722 }, { 34, 6 } };
+    std::mt19937   rng(2025);
+    bool           allPassed = true;
+    for(auto &size: sizes) {
+        uint32_t w = size[0], h = size[1];
+        for(auto &b: baselineCases()) {
+            const ConversionCase *c = nullptr;
+            auto                  cases = conversionCases();
+            for(auto &cc: cases) {
+                if(cc.name == b.name) {
+                    c = &cc;
+                }
+            }
+            std::vector<uint8_t> src(static_cast<size_t>(w * h * c->srcPixelSize));
+            for(auto &v: src) {
+                v = static_cast<uint8_t>(rng());
+            }
+            std::vector<uint8_t> ref(static_cast<size_t>(w * h * c->dstPixelSize));
+            std::vector<uint8_t> dst(ref.size());
+            b.baseline(src.data(), ref.data(), w, h);
+            c->kernel(src.data(), dst.data(), w, h);
+            if(memcmp(ref.data(), dst.data(), ref.size()) != 0) {
+                size_t i = 0;
+                while(ref[i] == dst[i]) {
+                    i++;
+                }
+                printf("FAILED: %s %ux%u, first mismatch at byte %zu: %d != %d (baseline)\n", c->name.c_str(), w, h, i, dst[i], ref[i]);
+                allPassed = false;
+            }
+        }
+    }
+    printf("Test against baseline FormatConverter: %s\n", allPassed ? "passed" : "FAILED");
+    return allPassed;
+}
+
+static double measureMPixPerSec(const ConversionCase &c, const std::vector<uint8_t> &src, std::vector<uint8_t> &dst, uint32_t w, uint32_t h) {
+    const int iterations = 30;
+    c.kernel(src.data(), dst.data(), w, h);  // warm up
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++) {
+        c.kernel(src.data(), dst.data(), w, h);
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(w) * h * iterations / sec / 1e6;
+}
+
+static void benchmarkConversions() {
+    const uint32_t w = 1920, h = 1080;
+    printf("Conversion throughput at %ux%u (MPix/s):\n", w, h);
+    printf("  %-12s %10s %10s\n", "conversion", "scalar", "simd");
+    for(auto &c: conversionCases()) {
+        std::vector<uint8_t> src(static_cast<size_t>(w * h * c.srcPixelSize), 128);
+        std::vector<uint8_t> dst(static_cast<size_t>(w * h * c.dstPixelSize));
+        libyuv::MaskCpuFlags(1);
+        double scalar = measureMPixPerSec(c, src, dst, w, h);
+        libyuv::MaskCpuFlags(-1);
+        double simd = measureMPixPerSec(c, src, dst, w, h);
+        printf("  %-12s %10.1f %10.1f\n", c.name.c_str(), scalar, simd);
+    }
+}
+
+int main() {
+    bool passed = testBitExact();
+    passed      = testAgainstBaseline() && passed;
+    benchmarkConversions();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+#include "FrameAggregator.hpp"
+#include "frame/FrameFactory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace libobsensor;
+
+struct StreamTrace {
+    OBStreamType streamType;
+    OBFrameType  frameType;
+    uint32_t     fps;
+};
+
+struct TraceEvent {
+    uint64_t                     arrivalUsec;
+    std::shared_ptr<const Frame> frame;
+};
+
+// The streams a device may open at once, with mixed rates. The first N of them are used for an N-stream trace.
+static const StreamTrace STREAM_TRACES[] = {
+    { OB_STREAM_DEPTH, OB_FRAME_DEPTH, 30 },       { OB_STREAM_COLOR, OB_FRAME_COLOR, 30 }, { OB_STREAM_IR_LEFT, OB_FRAME_IR_LEFT, 15 },
+    { OB_STREAM_IR_RIGHT, OB_FRAME_IR_RIGHT, 15 }, { OB_STREAM_ACCEL, OB_FRAME_ACCEL, 200 }, { OB_STREAM_GYRO, OB_FRAME_GYRO, 200 },
+    { OB_STREAM_IR, OB_FRAME_IR, 60 },             { OB_STREAM_RAW_PHASE, OB_FRAME_RAW_PHASE, 5 },
+};
+
+static std::shared_ptr<Config> createConfig(size_t streamCount) {
+    auto config = std::make_shared<Config>();
+    for(size_t i = 0; i < streamCount; i++) {
+        auto &trace = STREAM_TRACES[i];
+        if(trace.streamType == OB_STREAM_ACCEL) {
+            config->enableAccelStream(OB_ACCEL_FS_4g, OB_SAMPLE_RATE_200_HZ);
+        }
+        else if(trace.streamType == OB_STREAM_GYRO) {
+            config->enableGyroStream(OB_GYRO_FS_1000dps, OB_SAMPLE_RATE_200_HZ);
+        }
+        else {
+            config->enableVideoStream(trace.streamType, 640, 480, trace.fps, OB_FORMAT_Y16);
+        }
+    }
+    return config;
+}
+
+// Frames carry the capture timestamp with +-1ms jitter and arrive in order of capture time plus a per-stream transfer delay
+static std::vector<TraceEvent> createTrace(size_t streamCount, uint32_t durationSec) {
+    std::mt19937                            rng(static_cast<uint32_t>(streamCount));
+    std::uniform_int_distribution<int64_t> jitter(-1000, 1000);
+    std::vector<TraceEvent>                 events;
+    for(size_t i = 0; i < streamCount; i++) {
+        auto    &trace      = STREAM_TRACES[i];
+        uint64_t periodUsec = 1000000 / trace.fps;
+        uint64_t delayUsec  = 2000 + i * 3000;
+        for(uint64_t tsp = 1000000; tsp < 1000000 + durationSec * 1000000ull; tsp += periodUsec) {
+            auto frame      = FrameFactory::createFrame(trace.frameType, OB_FORMAT_Y16, 16);
+            auto frameTsp   = tsp + jitter(rng);
+            frame->setTimeStampUsec(frameTsp);
+            frame->setSystemTimeStampUsec(frameTsp);
+            events.push_back({ frameTsp + delayUsec, frame });
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent &x, const TraceEvent &y) { return x.arrivalUsec < y.arrivalUsec; });
+    return events;
+}
+
+// Replays the trace several times and reports the fastest run, the frames are shared between the runs
+static void replayTrace(size_t streamCount, FrameSyncMode syncMode) {
+    const uint32_t durationSec = 60;
+    const int      runCount    = 5;
+    auto           events      = createTrace(streamCount, durationSec);
+
+    int64_t  bestElapsedNs = 0;
+    uint64_t frameSetCount = 0;
+    uint64_t frameCount    = 0;
+    for(int run = 0; run < runCount; run++) {
+        FrameAggregator aggregator;
+        frameSetCount = 0;
+        frameCount    = 0;
+        aggregator.setCallback([&](std::shared_ptr<const Frame> frame) {
+            frameSetCount++;
+            frameCount += frame->as<FrameSet>()->getCount();
+        });
+        aggregator.enableFrameSync(syncMode);
+        aggregator.updateConfig(createConfig(streamCount), true);
+
+        auto start = std::chrono::steady_clock::now();
+        for(auto &event: events) {
+            aggregator.pushFrame(event.frame);
+        }
+        auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if(run == 0 || elapsedNs < bestElapsedNs) {
+            bestElapsedNs = elapsedNs;
+        }
+    }
+
+    printf("%7zu | %-9s | %8zu | %9.1f | %10llu | %15.2f\n", streamCount, syncMode == FrameSyncModeDisable ? "off" : "timestamp", events.size(),
+           static_cast<double>(bestElapsedNs) / events.size(), static_cast<unsigned long long>(frameSetCount),
+           frameSetCount ? static_cast<double>(frameCount) / frameSetCount : 0.0);
+}
+
+// Depth and IR at 90fps triggered by hardware with a fixed IR delay, matched with a 500us tolerance. Returns the count of depth frames output
+// together with an IR frame.
+static uint64_t matchWithIrDelay(uint64_t irDelayUsec) {
+    auto config = std::make_shared<Config>();
+    config->enableVideoStream(OB_STREAM_DEPTH, 640, 480, 90, OB_FORMAT_Y16);
+    config->enableVideoStream(OB_STREAM_IR, 640, 480, 90, OB_FORMAT_Y8);
+    config->setFrameSyncTolerance(OB_STREAM_IR, OB_STREAM_DEPTH, 500);
+
+    FrameAggregator aggregator;
+    aggregator.setCallback([](std::shared_ptr<const Frame>) {});
+    aggregator.enableFrameSync(FrameSyncModeSyncAccordingFrameTimestamp);
+    aggregator.updateConfig(config, true);
+    for(uint64_t tsp = 1000000; tsp < 2000000; tsp += 11111) {
+        auto depthFrame = FrameFactory::createFrame(OB_FRAME_DEPTH, OB_FORMAT_Y16, 16);
+        auto irFrame    = FrameFactory::createFrame(OB_FRAME_IR, OB_FORMAT_Y8, 16);
+        depthFrame->setTimeStampUsec(tsp);
+        irFrame->setTimeStampUsec(tsp + irDelayUsec);
+        aggregator.pushFrame(depthFrame);
+        aggregator.pushFrame(irFrame);
+    }
+    return aggregator.getFrameSyncStats(OB_FRAME_DEPTH).matchedFrameCount;
+}
+
+static bool testToleranceMatching() {
+    auto matchedInTolerance  = matchWithIrDelay(400);
+    auto matchedOutTolerance = matchWithIrDelay(600);
+    bool passed              = matchedInTolerance >= 89 && matchedOutTolerance == 0;
+    printf("Sub-millisecond matching with 500us tolerance: ir delay 400us matched %llu frames, ir delay 600us matched %llu frames: %s\n",
+           static_cast<unsigned long long>(matchedInTolerance), static_cast<unsigned long long>(matchedOutTolerance), passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+// The callback of the first frameset blocks while another thread pushes frames: the framesets pending behind it are capped, the oldest ones
+// dropped and counted in the stats of their stream, and the ones kept are delivered in order once the callback returns.
+static bool testLaggingCallback() {
+    const int pushedCount = 100;
+    auto      config      = std::make_shared<Config>();
+    config->enableVideoStream(OB_STREAM_DEPTH, 640, 480, 30, OB_FORMAT_Y16);
+
+    FrameAggregator       aggregator;
+    std::atomic<bool>     blocked(false);
+    std::atomic<bool>     release(false);
+    std::vector<uint64_t> delivered;
+    aggregator.setCallback([&](std::shared_ptr<const Frame> frame) {
+        delivered.push_back(frame->as<FrameSet>()->getFrame(OB_FRAME_DEPTH)->getTimeStampUsec());
+        if(delivered.size() == 1) {
+            blocked = true;
+            while(!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    });
+    aggregator.updateConfig(config, true);
+
+    auto pushFrame = [&](uint64_t tsp) {
+        auto frame = FrameFactory::createFrame(OB_FRAME_DEPTH, OB_FORMAT_Y16, 16);
+        frame->setTimeStampUsec(tsp);
+        aggregator.pushFrame(frame);
+    };
+    std::thread deliveringThread([&] { pushFrame(0); });
+    while(!blocked) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for(int i = 1; i <= pushedCount; i++) {
+        pushFrame(i);
+    }
+    release = true;
+    deliveringThread.join();
+
+    auto stats   = aggregator.getFrameSyncStats(OB_FRAME_DEPTH);
+    bool inOrder = std::is_sorted(delivered.begin(), delivered.end()) && delivered.back() == pushedCount;
+    bool passed  = delivered.size() < 20 && stats.droppedFrameCount == pushedCount + 1 - delivered.size()
+                  && stats.unmatchedFrameCount == delivered.size() && inOrder;
+    printf("Lagging callback: %d framesets pushed behind a blocked callback, %zu delivered, %llu dropped: %s\n", pushedCount, delivered.size() - 1,
+           static_cast<unsigned long long>(stats.droppedFrameCount), passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+int main() {
+    bool passed = testToleranceMatching();
+    passed      = testLaggingCallback() && passed;
+
+    printf("streams | sync      |   frames | ns/frame  |  framesets | frames/frameset\n");
+    for(auto syncMode: { FrameSyncModeDisable, FrameSyncModeSyncAccordingFrameTimestamp }) {
+        for(size_t streamCount = 2; streamCount <= 8; streamCount++) {
+            replayTrace(streamCount, syncMode);
+        }
+    }
+    return passed ? 0 : 1;
+}
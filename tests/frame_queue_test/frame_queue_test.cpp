@@ -0,0 +1,166 @@
+#include "frame/FrameQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace libobsensor;
+
+struct Item {
+    int producer;
+    int sequence;
+    int hops;  // times the item was queued again from the callback
+};
+
+// Runs a test on its own thread and fails it if it does not finish in time, as a callback dispatched under the queue lock deadlocks
+static bool runWithTimeout(const char *name, bool (*test)(), int timeoutSec = 20) {
+    std::packaged_task<bool()> task(test);
+    auto                       result = task.get_future();
+    std::thread                thread(std::move(task));
+    if(result.wait_for(std::chrono::seconds(timeoutSec)) != std::future_status::ready) {
+        printf("%s: FAILED (timeout, deadlock)\n", name);
+        fflush(stdout);
+        std::_Exit(1);
+    }
+    thread.join();
+    bool passed = result.get();
+    printf("%s: %s\n", name, passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+// Producers enqueue concurrently while the callback runs: the callbacks must not overlap, every frame must be called back once, and the frames of
+// each producer in the order it queued them
+static bool testOrderUnderConcurrentEnqueue() {
+    const int producerCount = 4, itemCount = 5000;
+
+    FrameQueue<Item> queue(64, FRAME_QUEUE_BLOCK, 10000);
+    std::mutex       mutex;
+    std::vector<int> lastSequence(producerCount, -1);
+    std::atomic<int> inCallback(0), received(0);
+    bool             inOrder = true, overlapped = false;
+    queue.start([&](std::shared_ptr<Item> item) {
+        if(inCallback.fetch_add(1) != 0) {
+            overlapped = true;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if(item->sequence != lastSequence[item->producer] + 1) {
+                inOrder = false;
+            }
+            lastSequence[item->producer] = item->sequence;
+        }
+        received++;
+        inCallback--;
+    });
+
+    std::vector<std::thread> producers;
+    std::atomic<int>         rejected(0);
+    for(int p = 0; p < producerCount; p++) {
+        producers.emplace_back([&, p]() {
+            for(int i = 0; i < itemCount; i++) {
+                if(!queue.enqueue(std::make_shared<Item>(Item{ p, i, 0 }))) {
+                    rejected++;
+                }
+                if(i % 97 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto &producer: producers) {
+        producer.join();
+    }
+    queue.flush();
+
+    bool passed = inOrder && !overlapped && rejected == 0 && received == producerCount * itemCount;
+    if(!passed) {
+        printf("  in order: %d, overlapped: %d, rejected: %d, received: %d\n", inOrder, overlapped, rejected.load(), received.load());
+    }
+    return passed;
+}
+
+// The callback queues its frame again and reads the queue state: this deadlocks if the callback is dispatched with the queue lock held. The frames
+// queued again are called back after the ones already in the queue.
+static bool testReentrantCallback() {
+    const int itemCount = 100, hopCount = 3;
+
+    FrameQueue<Item>  queue(itemCount * 2);
+    std::vector<Item> order;
+    std::atomic<int>  called(0);
+    for(int i = 0; i < itemCount; i++) {
+        queue.enqueue(std::make_shared<Item>(Item{ 0, i, 0 }));
+    }
+    queue.start([&](std::shared_ptr<Item> item) {
+        order.push_back(*item);
+        (void)queue.size();
+        if(item->hops < hopCount) {
+            queue.enqueue(std::make_shared<Item>(Item{ item->producer, item->sequence, item->hops + 1 }));
+        }
+        called++;
+    });
+
+    // wait for the last hop of every item; flush() would reject the frames queued again
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(called < itemCount * (hopCount + 1) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    queue.flush();
+
+    if(order.size() != static_cast<size_t>(itemCount * (hopCount + 1))) {
+        printf("  called back %zu frames, expected %d\n", order.size(), itemCount * (hopCount + 1));
+        return false;
+    }
+    // a frame is called back after every frame queued before it, so the hops never go back
+    for(size_t i = 1; i < order.size(); i++) {
+        if(order[i].hops < order[i - 1].hops || (order[i].hops == order[i - 1].hops && order[i].sequence <= order[i - 1].sequence)) {
+            printf("  frame %zu called back out of order\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// A slow callback must not block the producer
+static bool testSlowCallbackDoesNotBlockEnqueue() {
+    FrameQueue<Item>  queue(16);
+    std::atomic<bool> callbackEntered(false), releaseCallback(false);
+    queue.start([&](std::shared_ptr<Item>) {
+        callbackEntered = true;
+        while(!releaseCallback) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    queue.enqueue(std::make_shared<Item>(Item{ 0, 0, 0 }));
+    while(!callbackEntered) {
+        std::this_thread::yield();
+    }
+
+    auto start    = std::chrono::steady_clock::now();
+    bool enqueued = true;
+    for(int i = 1; i < 10; i++) {
+        enqueued = queue.enqueue(std::make_shared<Item>(Item{ 0, i, 0 })) && enqueued;
+    }
+    auto elapsedMsec = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    releaseCallback  = true;
+    queue.flush();
+
+    bool passed = enqueued && elapsedMsec < 100;
+    if(!passed) {
+        printf("  enqueued: %d, enqueue time while the callback runs: %lld ms\n", enqueued, static_cast<long long>(elapsedMsec));
+    }
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+    passed      = runWithTimeout("Callback order under concurrent enqueue", testOrderUnderConcurrentEnqueue) && passed;
+    passed      = runWithTimeout("Re-entrant enqueue from the callback", testReentrantCallback) && passed;
+    passed      = runWithTimeout("Slow callback does not block enqueue", testSlowCallbackDoesNotBlockEnqueue) && passed;
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
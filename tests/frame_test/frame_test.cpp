@@ -2,10 +2,14 @@
 extern "C" {
 #include <libobsensor/h/Frame.h>
 #include <libobsensor/h/Filter.h>
+#include <libobsensor/h/StreamProfile.h>
 #include <libobsensor/h/Error.h>
 }
 
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 void check_ob_error(ob_error **err) {
     if(*err) {
@@ -16,6 +20,89 @@ void check_ob_error(ob_error **err) {
     *err = nullptr;
 }
 
+// Create and destroy frames on threadCount threads concurrently, returns the throughput in frames per second
+double benchmarkFrameCreateDestroy(ob_frame_type frame_type, ob_format format, uint32_t width, uint32_t height, uint32_t data_size, int threadCount,
+                                   int framesPerThread) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < threadCount; i++) {
+        threads.emplace_back([&]() {
+            ob_error *err = nullptr;
+            for(int n = 0; n < framesPerThread; n++) {
+                ob_frame *frame = nullptr;
+                if(width > 0) {
+                    frame = ob_create_video_frame(frame_type, format, width, height, OB_DEFAULT_STRIDE_BYTES, &err);
+                }
+                else {
+                    frame = ob_create_frame(frame_type, format, data_size, &err);
+                }
+                check_ob_error(&err);
+                ob_delete_frame(frame, &err);
+                check_ob_error(&err);
+            }
+        });
+    }
+    for(auto &thread: threads) {
+        thread.join();
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)threadCount * framesPerThread * 1000000.0 / (double)duration;
+}
+
+void benchmarkFrameCreation() {
+    const int framesPerThread = 200000;
+    for(int threadCount: { 1, 4 }) {
+        auto depthFps = benchmarkFrameCreateDestroy(OB_FRAME_DEPTH, OB_FORMAT_Y16, 640, 480, 0, threadCount, framesPerThread);
+        auto accelFps = benchmarkFrameCreateDestroy(OB_FRAME_ACCEL, OB_FORMAT_ACCEL, 0, 0, 64, threadCount, framesPerThread);
+        std::cout << "Frame create/destroy throughput, threads=" << threadCount << ": depth 640x480 " << (uint64_t)depthFps << " frames/s, accel "
+                  << (uint64_t)accelFps << " frames/s" << std::endl;
+    }
+}
+
+// Emulate the per-frame type checks and downcasts of a 6-filter pipeline on a depth+color frameset, returns the cost per frameset in nanoseconds
+double benchmarkFrameTypeQuery(int frameCount) {
+    const int filterCount = 6;
+    ob_error *err         = nullptr;
+
+    auto frameset = ob_create_frameset(&err);
+    check_ob_error(&err);
+    auto depth = ob_create_video_frame(OB_FRAME_DEPTH, OB_FORMAT_Y16, 640, 480, OB_DEFAULT_STRIDE_BYTES, &err);
+    check_ob_error(&err);
+    auto color = ob_create_video_frame(OB_FRAME_COLOR, OB_FORMAT_RGB, 640, 480, OB_DEFAULT_STRIDE_BYTES, &err);
+    check_ob_error(&err);
+    ob_frameset_push_frame(frameset, depth, &err);
+    check_ob_error(&err);
+    ob_frameset_push_frame(frameset, color, &err);
+    check_ob_error(&err);
+
+    uint64_t checksum = 0;
+    auto     start    = std::chrono::steady_clock::now();
+    for(int n = 0; n < frameCount; n++) {
+        for(int i = 0; i < filterCount; i++) {
+            auto frame = ob_frameset_get_frame(frameset, OB_FRAME_DEPTH, &err);
+            checksum += ob_video_frame_get_width(frame, &err);
+            checksum += ob_video_frame_get_height(frame, &err);
+            checksum += ob_video_frame_get_pixel_type(frame, &err);
+            checksum += (uint64_t)ob_depth_frame_get_value_scale(frame, &err);
+            auto profile = ob_frame_get_stream_profile(frame, &err);
+            checksum += ob_video_stream_profile_get_width(profile, &err);
+            checksum += ob_video_stream_profile_get_height(profile, &err);
+            ob_delete_stream_profile(profile, &err);
+            ob_delete_frame(frame, &err);
+            check_ob_error(&err);
+        }
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    ob_delete_frame(color, &err);
+    ob_delete_frame(depth, &err);
+    ob_delete_frame(frameset, &err);
+    check_ob_error(&err);
+    return checksum > 0 ? (double)duration / frameCount : 0;
+}
+
 int main() {
     ob_error *err   = nullptr;
     auto      frame = ob_create_video_frame(OB_FRAME_DEPTH, OB_FORMAT_Y16, 640, 480, OB_DEFAULT_STRIDE_BYTES, &err);
@@ -29,6 +116,9 @@ int main() {
     check_ob_error(&err);
     std::cout << "Data size: " << data_size << std::endl;
 
+    benchmarkFrameCreation();
+    std::cout << "Frame type query cost of a 6-filter pipeline: " << (uint64_t)benchmarkFrameTypeQuery(200000) << " ns/frameset" << std::endl;
+
     auto filter = ob_create_filter("NoiseRemovalFilter", &err);
     check_ob_error(&err);
 
@@ -0,0 +1,152 @@
+#include "timestamp/GlobalTimestampFitter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace libobsensor;
+
+// Replays device time samples, as taken by the GlobalTimestampFitter sampling loop, and measures how far the fitted host time of a device
+// timestamp is from the true host time. The device clock runs with a drift and offset against the host clock, and each sample sees a
+// request and response delay, so its host timestamp (the midpoint of the request) is off by half of the delay asymmetry.
+
+struct TraceProfile {
+    const char *name;
+    double      baseDelayUsec;     // one way delay of an undisturbed request
+    double      jitterUsec;        // uniform jitter of each one way delay
+    double      spikeProbability;  // probability that one of the two paths is delayed by the host or the bus
+    double      maxSpikeUsec;
+    bool        spikeOnResponseOnly;  // host scheduling latency only delays the response
+};
+
+static const TraceProfile TRACE_PROFILES[] = {
+    { "quiet", 300, 20, 0.0, 0, false },
+    { "busy host", 300, 20, 0.15, 8000, true },
+    { "busy bus", 300, 50, 0.25, 4000, false },
+    { "congested", 1500, 300, 0.40, 9000, false },
+};
+
+static const double   DEVICE_DRIFT_PPM       = 40.0;
+static const double   DEVICE_OFFSET_USEC     = 1.7e12;  // host time when the device clock was 0
+static const uint64_t MAX_VALID_RTT          = 10000;   // samples with a larger rtt are discarded by the fitter
+static const size_t   QUEUE_SIZE             = 100;
+static const uint64_t FAST_INTERVAL_USEC     = 1000000;   // sampling interval until 15 samples are queued
+static const uint64_t SLOW_INTERVAL_USEC     = 10000000;  // sampling interval afterwards
+static const uint64_t EVALUATE_INTERVAL_USEC = 100000;
+
+static double trueHostTime(double deviceTime) {
+    return deviceTime * (1.0 + DEVICE_DRIFT_PPM * 1e-6) + DEVICE_OFFSET_USEC;
+}
+
+static std::deque<TimestampPair> recordTrace(const TraceProfile &profile, uint32_t seed) {
+    std::mt19937                           rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::deque<TimestampPair>              samples;
+
+    uint64_t deviceTime = 3600ull * 1000000;  // the device has been running for an hour
+    while(samples.size() < QUEUE_SIZE) {
+        double requestDelay  = profile.baseDelayUsec + profile.jitterUsec * unit(rng);
+        double responseDelay = profile.baseDelayUsec + profile.jitterUsec * unit(rng);
+        if(unit(rng) < profile.spikeProbability) {
+            double spike = profile.maxSpikeUsec * unit(rng);
+            if(profile.spikeOnResponseOnly || unit(rng) < 0.5) {
+                responseDelay += spike;
+            }
+            else {
+                requestDelay += spike;
+            }
+        }
+
+        double   hostTime = trueHostTime(static_cast<double>(deviceTime));
+        uint64_t rtt      = static_cast<uint64_t>(requestDelay + responseDelay);
+        if(rtt <= MAX_VALID_RTT) {
+            double hostTsp1 = hostTime - requestDelay;
+            double hostTsp2 = hostTime + responseDelay;
+            samples.push_back({ static_cast<uint64_t>((hostTsp1 + hostTsp2) / 2), deviceTime, rtt });
+        }
+        deviceTime += samples.size() < 15 ? FAST_INTERVAL_USEC : SLOW_INTERVAL_USEC;
+    }
+    return samples;
+}
+
+// The ordinary least squares fit over all samples, as the fitter did before the samples were filtered
+static LinearFuncParam fitAllSamples(const std::deque<TimestampPair> &samples) {
+    uint64_t offsetX = samples.front().deviceTimestamp;
+    uint64_t offsetY = samples.front().systemTimestamp;
+    double   Ex = 0, Exx = 0, Ey = 0, Exy = 0;
+    for(auto &sample: samples) {
+        double x = static_cast<double>(sample.deviceTimestamp - offsetX);
+        double y = static_cast<double>(static_cast<int64_t>(sample.systemTimestamp - offsetY));
+        Ex += x;
+        Exx += x * x;
+        Ey += y;
+        Exy += x * y;
+    }
+    double          n = static_cast<double>(samples.size());
+    LinearFuncParam param;
+    param.coefficientA = (Exy * n - Ex * Ey) / (n * Exx - Ex * Ex);
+    param.constantB    = (Exx * Ey - Exy * Ex) / (n * Exx - Ex * Ex) + offsetY - param.coefficientA * offsetX;
+    return param;
+}
+
+struct Residual {
+    double rmsUsec;
+    double maxUsec;
+};
+
+// Frames are converted with the latest fit until the next sample, so the error is measured over the sampled span and one interval beyond it
+static Residual measureResidual(const std::deque<TimestampPair> &samples, const LinearFuncParam &param) {
+    double   sumSq  = 0;
+    double   maxErr = 0;
+    uint64_t count  = 0;
+    for(uint64_t t = samples.front().deviceTimestamp; t <= samples.back().deviceTimestamp + SLOW_INTERVAL_USEC; t += EVALUATE_INTERVAL_USEC) {
+        double err = param.coefficientA * static_cast<double>(t) + param.constantB - trueHostTime(static_cast<double>(t));
+        sumSq += err * err;
+        maxErr = std::max(maxErr, std::abs(err));
+        count++;
+    }
+    return { std::sqrt(sumSq / count), maxErr };
+}
+
+int main() {
+    const uint32_t TRACE_COUNT = 50;
+
+    bool passed = true;
+    printf("%-10s | %13s | %13s | %13s | %13s\n", "trace", "OLS rms(us)", "OLS max(us)", "fitted rms", "fitted max");
+    for(auto &profile: TRACE_PROFILES) {
+        Residual olsTotal = { 0, 0 }, fittedTotal = { 0, 0 };
+        double   olsSumSq = 0, fittedSumSq = 0;
+        for(uint32_t seed = 0; seed < TRACE_COUNT; seed++) {
+            auto samples = recordTrace(profile, seed);
+
+            auto olsResidual = measureResidual(samples, fitAllSamples(samples));
+
+            LinearFuncParam param = { 0, 0, 0, 0 };
+            if(!GlobalTimestampFitter::fitLinearFunc(samples, param)) {
+                printf("%s: fitting failed for trace %u\n", profile.name, seed);
+                return 1;
+            }
+            auto fittedResidual = measureResidual(samples, param);
+
+            olsSumSq += olsResidual.rmsUsec * olsResidual.rmsUsec;
+            fittedSumSq += fittedResidual.rmsUsec * fittedResidual.rmsUsec;
+            olsTotal.maxUsec    = std::max(olsTotal.maxUsec, olsResidual.maxUsec);
+            fittedTotal.maxUsec = std::max(fittedTotal.maxUsec, fittedResidual.maxUsec);
+        }
+        olsTotal.rmsUsec    = std::sqrt(olsSumSq / TRACE_COUNT);
+        fittedTotal.rmsUsec = std::sqrt(fittedSumSq / TRACE_COUNT);
+        printf("%-10s | %13.1f | %13.1f | %13.1f | %13.1f\n", profile.name, olsTotal.rmsUsec, olsTotal.maxUsec, fittedTotal.rmsUsec,
+               fittedTotal.maxUsec);
+
+        // The filtered fit must never be worse than fitting all samples by more than the sample jitter
+        if(fittedTotal.rmsUsec > olsTotal.rmsUsec + profile.jitterUsec) {
+            passed = false;
+        }
+    }
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
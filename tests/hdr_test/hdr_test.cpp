@@ -1,28 +1,48 @@
-#include <iostream>
-#include <fstream>
-#include <regex>
-#include <string>
-#include <chrono>
-
-template <typename T>
-int loadFile(char *filename, uint32_t num_element, T* data, bool swap_endianess) {
-    if(!filename || !data) {
-        throw std::string("Null pointer.");
-    }
+#include "HdrMergeImpl.hpp"
+#include "KernelTestUtils.hpp"
 
-    FILE *file = fopen(filename, "rb");
-    if(!file) {
-        throw std::string("Read file error: ").append(filename);
-    }
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+CHECK_KERNEL_ORDER(libobsensor::HDR_MERGE_KERNEL_);
+
+using namespace libobsensor;
+
+// The merge of HDRMerge before HdrMergeImpl, the reference of the check
+namespace reference {
+
+std::pair<OBFormat, std::vector<uint8_t>> EXP_LUT_;
 
-    fread(data, sizeof(T), num_element, file);
-    if(swap_endianess) {
-		for(size_t i = 0; i < num_element; i++) {
-			data[i] = static_cast<T>(_byteswap_ushort(static_cast<uint16_t>(data[i])));
-		}
+template <typename T> void triangleWeights(std::vector<uint8_t> &w) {
+    int length = 1 << (sizeof(T) * 8);
+    w.resize(length, 0);
+    int   half  = length >> 1;
+    float slope = 256.f / half;
+    for(int i = 0; i < half; i++) {
+        w[i]              = static_cast<uint8_t>(i * slope);
+        w[length - i - 1] = w[i];
     }
+}
 
-    return 0;
+template <typename T> void mergeFramesUsingIr(uint16_t *new_data, uint16_t *d0, uint16_t *d1, const T *ir0, const T *ir1, int width, int height) {
+    int pix_num = width * height;
+
+    for(int i = 0; i < pix_num; i++) {
+        uint8_t c0 = EXP_LUT_.second[ir0[i]];
+        uint8_t c1 = EXP_LUT_.second[ir1[i]];
+        // new_data[i] = c0 > c1 ? d0[i] : d1[i];
+        uint8_t c = c0, idx = 0;
+        if(c1 > c0) {
+            c   = c1;
+            idx = 1;
+        }
+        if(c) {  // over-staturated or completely dark pixels
+            new_data[i] = idx ? d1[i] : d0[i];
+        }
+    }
 }
 
 void mergeFramesUsingOnlyDepth(uint16_t *new_data, uint16_t *d0, uint16_t *d1, int width, int height) {
@@ -40,162 +60,159 @@ void mergeFramesUsingOnlyDepth(uint16_t *new_data, uint16_t *d0, uint16_t *d1, i
     }
 }
 
-template <typename T>
-void triangleWeights(float* w) {
-    if(!w)
+// HDRMerge::merge: the frame cleared, then merged
+void merge(OBFormat ir_format, uint16_t *d0, uint16_t *d1, const void *ir0, const void *ir1, int width, int height, uint16_t *d) {
+    memset(d, 0, static_cast<size_t>(width) * height * sizeof(uint16_t));
+    if(ir_format == OB_FORMAT_UNKNOWN) {
+        mergeFramesUsingOnlyDepth(d, d0, d1, width, height);
         return;
-    int   length = 1 << (sizeof(T) * 8); 
-    int   half   = length / 2;
-    memset(w, 0, sizeof(float) * length);
-    for(int i = 0; i < length; i++) {
-        *w++ = i < half ? (1.f * i / half) : (2 - 1.f * i / half);
     }
-}
-
-template <typename T>
-void censusStd(const T* ir, int width, int height, uint8_t* std, uint8_t ws = 7) {
-    int ws_2 = ws / 2;
-    int thresh = 10;
-    memset(std, 0, sizeof(uint8_t) * width * height);
-
-    for(int v = ws_2; v < height - ws_2; v++) {
-        int      row_start_idx = v * width + ws_2;
-        const T *p_ir_center   = ir + row_start_idx;
-        uint8_t *p_std         = std + row_start_idx;
-
-        for(int u = ws_2; u < width - ws_2; u++) {
-			uint8_t  count         = 0;
-
-            const T *p_ir_row = p_ir_center - ws_2 * width - ws_2;
-            for(int wv = -ws_2; wv < ws_2; wv+=1) {
-                const T *p_ir_col = p_ir_row;
-                for(int wu = -ws_2; wu < ws_2; wu+=1) {
-                    if((*p_ir_col - *p_ir_center < -thresh) || (*p_ir_col - *p_ir_center > thresh))
-                        count++;
-					p_ir_col++;
-                }
-                p_ir_row += width;
-            }
-
-            p_ir_center++;
-            *p_std++ = count;
-        }
+    if((EXP_LUT_.first != ir_format) || (EXP_LUT_.second.empty())) {
+        EXP_LUT_.first = ir_format;
+        if(ir_format == OB_FORMAT_Y8)
+            triangleWeights<uint8_t>(EXP_LUT_.second);
+        else
+            triangleWeights<uint16_t>(EXP_LUT_.second);
+    }
+    if(OB_FORMAT_Y8 == ir_format) {
+        mergeFramesUsingIr<uint8_t>(d, d0, d1, static_cast<const uint8_t *>(ir0), static_cast<const uint8_t *>(ir1), width, height);
+    }
+    else {
+        mergeFramesUsingIr<uint16_t>(d, d0, d1, static_cast<const uint16_t *>(ir0), static_cast<const uint16_t *>(ir1), width, height);
     }
 }
 
-float EXP_LUT[256];
-bool  LUT_Inited = false;
-float s_global = 256.f / (7 * 7);
-
-template <typename T> void generateConfidenceMap(const T *ir, uint8_t *map, int width, int height, uint8_t ws = 7) {
-    std::cout << ws;
-
-    if (!LUT_Inited) {
-		triangleWeights<uint8_t>(EXP_LUT);
+}  // namespace reference
+
+// The depth resolutions of the devices with HDR
+struct Resolution {
+    int width, height;
+};
+
+static const Resolution resolutions[] = { { 1280, 800 }, { 1280, 720 }, { 848, 480 }, { 640, 480 }, { 640, 400 }, { 640, 360 }, { 480, 270 }, { 424, 240 } };
+
+// The IR formats of the merge, OB_FORMAT_UNKNOWN for the merge without IR
+struct Mode {
+    const char *name;
+    OBFormat    ir_format;
+};
+
+static const Mode modes[] = { { "Y8", OB_FORMAT_Y8 }, { "Y16", OB_FORMAT_Y16 }, { "depth", OB_FORMAT_UNKNOWN } };
+
+struct HdrFrames {
+    int                   width, height;
+    std::vector<uint16_t> depth0, depth1;
+    std::vector<uint8_t>  ir0, ir1;  // Y8 or Y16
+};
+
+// Synthetic frames: depths with holes and invalid pixels, and IR over the whole range of the format, so every value of the weights is used;
+// with a few pixels of equal IR in both frames
+static HdrFrames make_frames(int width, int height, OBFormat ir_format) {
+    std::mt19937 rng(7);
+    HdrFrames    frames;
+    size_t       pixels = static_cast<size_t>(width) * height;
+    frames.width        = width;
+    frames.height       = height;
+    frames.depth0.resize(pixels);
+    frames.depth1.resize(pixels);
+    for(size_t i = 0; i < pixels; i++) {
+        uint32_t r       = rng() % 100;
+        frames.depth0[i] = static_cast<uint16_t>(r < 10 ? 0 : (r < 15 ? 65535 : 500 + rng() % 3000));
+        r                = rng() % 100;
+        frames.depth1[i] = static_cast<uint16_t>(r < 10 ? 0 : (r < 15 ? 65535 : 500 + rng() % 3000));
     }
 
-    //uint8_t *std_w = (uint8_t *)malloc(width * height * sizeof(uint8_t));
-    //memset(std_w, 0, width * height * sizeof(uint8_t));
-    //censusStd<uint8_t>(ir, width, height, std_w, ws);
-
-    const uint8_t *p_ir = ir;
-    //uint8_t       *p_std = std_w;
-    uint8_t *      p_map = map;
-
-    for(int i = 0; i < height; i++) {
-        for(int j = 0; j < width; j++) {
-            float exp                 = EXP_LUT[*p_ir++];
-            //*p_map++ = static_cast<uint8_t>(exp * (*p_std++) * s_global);
-            *p_map++ = static_cast<uint8_t>(exp * 255);
+    size_t ir_size = ir_format == OB_FORMAT_Y16 ? 2 : 1;
+    frames.ir0.resize(pixels * ir_size);
+    frames.ir1.resize(pixels * ir_size);
+    for(size_t i = 0; i < pixels; i++) {
+        uint16_t v0 = static_cast<uint16_t>(ir_format == OB_FORMAT_Y16 ? i : rng());
+        uint16_t v1 = static_cast<uint16_t>(rng() % 16 == 0 ? v0 : rng());
+        if(ir_size == 2) {
+            reinterpret_cast<uint16_t *>(frames.ir0.data())[i] = v0;
+            reinterpret_cast<uint16_t *>(frames.ir1.data())[i] = v1;
+        }
+        else {
+            frames.ir0[i] = static_cast<uint8_t>(v0);
+            frames.ir1[i] = static_cast<uint8_t>(v1);
         }
     }
-
-    //free(std_w);
+    return frames;
 }
 
-void mergeFramesUsingIr(uint16_t *new_data, uint16_t *d0, uint16_t *d1, uint8_t* first_ir,
-                        uint8_t *second_ir, int width, int height) {
-    int      pix_num     = width * height;
-    int      map_size    = sizeof(uint8_t) * pix_num;
-    uint8_t *confidence0 = (uint8_t *)malloc(map_size);
-    uint8_t *confidence1 = (uint8_t *)malloc(map_size);
-    if(!confidence0 || !confidence1) {
-        return;
-    }
-    memset(confidence0, 0, sizeof(uint8_t) * pix_num);
-    memset(confidence1, 0, sizeof(uint8_t) * pix_num);
-
-	generateConfidenceMap<uint8_t>(first_ir, confidence0, width, height);
-	generateConfidenceMap<uint8_t>(second_ir, confidence1, width, height);
-
-    for(int i = 0; i < pix_num; i++) {
-        new_data[i] = confidence0[i] > confidence1[i] ? d0[i] : d1[i];
-    }
-    free(confidence0);
-    free(confidence1);
+static void run_reference(const Mode &mode, HdrFrames &frames, std::vector<uint16_t> &out) {
+    out.resize(frames.depth0.size());
+    reference::merge(mode.ir_format, frames.depth0.data(), frames.depth1.data(), frames.ir0.data(), frames.ir1.data(), frames.width, frames.height,
+                     out.data());
 }
 
-template<typename T>
-void saveImage(T* data, int element_num, char name[]) {
-	FILE *fp = fopen(name, "wb");
-	if(fp) {
-		fwrite(data, sizeof(T), element_num, fp);
-		fclose(fp);
-	}
+static void run_merge(HdrMergeImpl &impl, const Mode &mode, const HdrFrames &frames, std::vector<uint16_t> &out) {
+    out.resize(frames.depth0.size());
+    if(mode.ir_format == OB_FORMAT_UNKNOWN) {
+        impl.mergeUsingOnlyDepth(frames.depth0.data(), frames.depth1.data(), frames.width, frames.height, out.data());
+    }
     else {
-        throw std::string("Open file error: ").append(name);
+        impl.mergeUsingIr(mode.ir_format, frames.depth0.data(), frames.depth1.data(), frames.ir0.data(), frames.ir1.data(), frames.width, frames.height,
+                          out.data());
     }
 }
 
-int main(int argc, char *argv[]) try{
-    if(argc < 7) {
-        throw std::string("Usage: %s width heght exp0 exp1 depth0 depth1 [ir0] [ir1]");
-    }
-
-    int width = std::atoi(argv[1]), height = std::atoi(argv[2]), exp0 = std::atoi(argv[3]), exp1 = std::atoi(argv[4]);
-    std::cout << exp0 << exp1 << std::endl;
-    int pix_num = width * height;
-    int depth_size = pix_num * sizeof(uint16_t);
-    int ir_size    = pix_num * sizeof(uint8_t);
-
-    uint16_t *depth0 = (uint16_t *)malloc(depth_size), *depth1 = (uint16_t*)malloc(depth_size);
-    uint8_t *ir0 = (uint8_t *)malloc(ir_size), *ir1 = (uint8_t*)malloc(ir_size);
-    loadFile<uint16_t>(argv[5], pix_num, depth0, true);
-    loadFile<uint16_t>(argv[6], pix_num, depth1, true);
-    loadFile<uint8_t>(argv[7], pix_num, ir0, false);
-    loadFile<uint8_t>(argv[8], pix_num, ir1, false);
-
-    uint16_t *depth_output = (uint16_t *)malloc(depth_size);
-    memset(depth_output, 0, depth_size);
-
-    mergeFramesUsingOnlyDepth(depth_output, depth0, depth1, width, height);
-
-	char nname[256];
-	sprintf(nname, "%s_depthonly.raw", argv[5]);
-    saveImage<uint16_t>(depth_output, pix_num, nname);
-
-    std::chrono::steady_clock::time_point start, end;
-    for(size_t i = 0; i < 100; i++) {
-        start = std::chrono::high_resolution_clock::now();
-		mergeFramesUsingIr(depth_output, depth0, depth1, ir0, ir1, width, height);
-        end = std::chrono::high_resolution_clock::now();
-        std::chrono::microseconds d = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        std::cout << d.count() << std::endl;
+// Checks that every kernel and thread count gives the same frame as the reference, on a resolution leaving a tail of pixels after the kernel
+// blocks, with every 16-bit IR value
+static int run_check() {
+    const int width = 1283, height = 723;
+    bool      passed = true;
+
+    printf("%-5s | %-7s | %7s | %s\n", "mode", "kernel", "threads", "result");
+    for(auto &mode: modes) {
+        auto                  frames = make_frames(width, height, mode.ir_format);
+        std::vector<uint16_t> expected, out;
+        run_reference(mode, frames, expected);
+        for(auto kernel: get_available_kernels<HdrMergeImpl>()) {
+            for(int thread_count: { 1, 3 }) {
+                HdrMergeImpl impl;
+                impl.setKernel(kernel);
+                impl.setThreadCount(thread_count);
+                out.assign(expected.size(), 0x1234);
+                run_merge(impl, mode, frames, out);
+                bool same = out == expected;
+                passed    = passed && same;
+                printf("%-5s | %-7s | %7d | %s\n", mode.name, kernel_name(kernel), thread_count, same ? "identical" : "MISMATCH");
+            }
+        }
     }
-	sprintf(nname, "%s_withir.raw", argv[5]);
-    saveImage<uint16_t>(depth_output, pix_num, nname);
 
-    free(depth0);
-    free(depth1);
-    free(ir0);
-    free(ir1);
-    free(depth_output);
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
 
+// Measures the merge latency at each resolution, against the reference
+static int run_benchmark(int frame_count) {
+    std::vector<int> thread_counts = get_benchmark_thread_counts();
+
+    HdrMergeImpl default_impl;
+    printf("kernel: %s\n", kernel_name(default_impl.getKernel()));
+    printf("%-9s | %-5s | %-9s | %7s | %10s\n", "size", "mode", "code", "threads", "us/frame");
+
+    std::vector<uint16_t> out;
+    for(auto &resolution: resolutions) {
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", resolution.width, resolution.height);
+        for(auto &mode: modes) {
+            auto   frames = make_frames(resolution.width, resolution.height, mode.ir_format);
+            double us     = measure<std::micro>(frame_count, [&]() { run_reference(mode, frames, out); });
+            printf("%-9s | %-5s | %-9s | %7d | %10.1f\n", size, mode.name, "reference", 1, us);
+            for(int thread_count: thread_counts) {
+                HdrMergeImpl impl;
+                impl.setThreadCount(thread_count);
+                us = measure<std::micro>(frame_count, [&]() { run_merge(impl, mode, frames, out); });
+                printf("%-9s | %-5s | %-9s | %7d | %10.1f\n", size, mode.name, kernel_name(impl.getKernel()), thread_count, us);
+            }
+        }
+    }
     return 0;
 }
-catch (const std::string& e)
-{
-    std::cerr << e << std::endl;
-    exit(-1);
-}
 
+int main(int argc, char *argv[]) {
+    return run_kernel_test(argc, argv, run_check, run_benchmark, 100);
+}
@@ -0,0 +1,226 @@
+#include "IMUCorrector.hpp"
+#include "frame/FrameFactory.hpp"
+#include "stream/StreamProfile.hpp"
+
+#include <libobsensor/ObSensor.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace libobsensor;
+
+// Checks that IMUCorrector corrects the samples of an IMU batch frame exactly like the per-sample accelerometer and gyroscope frames, and the
+// layout of the batch frame as seen through the internal class, the C functions and ob::ImuBatchFrame.
+
+static const uint32_t SAMPLE_COUNT = 37;
+static const uint32_t CAPACITY     = 255;
+
+struct Sample {
+    uint64_t timestamp;
+    float    value[3];
+    float    temperature;
+};
+
+static bool check(bool condition, const char *what) {
+    if(!condition) {
+        printf("  %s: FAILED\n", what);
+    }
+    return condition;
+}
+
+template <typename T> static void setCalibration(T &intrinsic, std::mt19937 &rng) {
+    std::uniform_real_distribution<double> bias(-0.05, 0.05), misalignment(-0.02, 0.02);
+    for(int i = 0; i < 3; i++) {
+        intrinsic.bias[i] = bias(rng);
+    }
+    for(int i = 0; i < 9; i++) {
+        intrinsic.scaleMisalignment[i] = (i % 4 == 0 ? 1.0 : 0.0) + misalignment(rng);
+    }
+}
+
+static std::vector<Sample> generateSamples(std::mt19937 &rng, float range) {
+    std::uniform_real_distribution<float> value(-range, range), temperature(20.f, 50.f);
+    std::vector<Sample>                   samples(SAMPLE_COUNT);
+    for(uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+        samples[i] = { 0x100000000ull + 5000 * i, { value(rng), value(rng), value(rng) }, temperature(rng) };
+    }
+    return samples;
+}
+
+static std::shared_ptr<ImuBatchFrame> createBatchFrame(std::shared_ptr<const StreamProfile> sp, const std::vector<Sample> &samples) {
+    auto frame = FrameFactory::createImuBatchFrame(sp, CAPACITY);
+    for(uint32_t i = 0; i < samples.size(); i++) {
+        frame->getTimestampsMutable()[i] = samples[i].timestamp;
+        for(uint32_t axis = 0; axis < 3; axis++) {
+            frame->getValuesMutable(axis)[i] = samples[i].value[axis];
+        }
+        frame->getTemperaturesMutable()[i] = samples[i].temperature;
+    }
+    frame->setSampleCount(static_cast<uint32_t>(samples.size()));
+    frame->setTimeStampUsec(samples[0].timestamp);
+    return frame;
+}
+
+// Corrects every sample as its own accel and gyro frame, the way the per-sample path does
+static void correctPerSample(IFilterBase &corrector, std::shared_ptr<const StreamProfile> accelSp, std::shared_ptr<const StreamProfile> gyroSp,
+                             std::vector<Sample> &accelSamples, std::vector<Sample> &gyroSamples) {
+    for(uint32_t i = 0; i < SAMPLE_COUNT; i++) {
+        auto accelFrame = FrameFactory::createFrameFromStreamProfile(accelSp);
+        auto gyroFrame  = FrameFactory::createFrameFromStreamProfile(gyroSp);
+        auto accelData  = (AccelFrame::Data *)accelFrame->getDataMutable();
+        auto gyroData   = (GyroFrame::Data *)gyroFrame->getDataMutable();
+        accelData->value = { accelSamples[i].value[0], accelSamples[i].value[1], accelSamples[i].value[2] };
+        gyroData->value  = { gyroSamples[i].value[0], gyroSamples[i].value[1], gyroSamples[i].value[2] };
+
+        auto frameSet = FrameFactory::createFrameSet();
+        frameSet->pushFrame(std::move(accelFrame));
+        frameSet->pushFrame(std::move(gyroFrame));
+        auto result = corrector.process(frameSet)->as<FrameSet>();
+
+        auto correctedAccel = ((const AccelFrame::Data *)result->getFrame(OB_FRAME_ACCEL)->getData())->value;
+        auto correctedGyro  = ((const GyroFrame::Data *)result->getFrame(OB_FRAME_GYRO)->getData())->value;
+        accelSamples[i].value[0] = correctedAccel.x;
+        accelSamples[i].value[1] = correctedAccel.y;
+        accelSamples[i].value[2] = correctedAccel.z;
+        gyroSamples[i].value[0]  = correctedGyro.x;
+        gyroSamples[i].value[1]  = correctedGyro.y;
+        gyroSamples[i].value[2]  = correctedGyro.z;
+    }
+}
+
+static bool sameValues(const std::shared_ptr<const Frame> &frame, const std::vector<Sample> &expected) {
+    auto &batch = frame->asRef<ImuBatchFrame>();
+    if(batch.getSampleCount() != expected.size()) {
+        return false;
+    }
+    for(uint32_t i = 0; i < expected.size(); i++) {
+        for(uint32_t axis = 0; axis < 3; axis++) {
+            // Bit-exact, the batch path must keep the per-sample arithmetic
+            if(memcmp(&batch.getValues(axis)[i], &expected[i].value[axis], sizeof(float)) != 0) {
+                printf("  sample %u axis %u: %.9g != %.9g\n", i, axis, batch.getValues(axis)[i], expected[i].value[axis]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool testCorrection(std::shared_ptr<const StreamProfile> accelSp, std::shared_ptr<const StreamProfile> gyroSp, std::mt19937 &rng) {
+    auto accelSamples = generateSamples(rng, 4.f);
+    auto gyroSamples  = generateSamples(rng, 1000.f);
+
+    auto frameSet = FrameFactory::createFrameSet();
+    frameSet->pushFrame(createBatchFrame(accelSp, accelSamples));
+    frameSet->pushFrame(createBatchFrame(gyroSp, gyroSamples));
+
+    IMUCorrector corrector;
+    auto         result = static_cast<IFilterBase &>(corrector).process(frameSet)->as<FrameSet>();
+    correctPerSample(corrector, accelSp, gyroSp, accelSamples, gyroSamples);
+
+    bool passed = true;
+    passed &= check(result->getFrame(OB_FRAME_ACCEL)->is<AccelBatchFrame>(), "corrected accel frame is a batch frame");
+    passed &= check(result->getFrame(OB_FRAME_GYRO)->is<GyroBatchFrame>(), "corrected gyro frame is a batch frame");
+    passed &= check(passed && sameValues(result->getFrame(OB_FRAME_ACCEL), accelSamples), "accel batch equals per-sample correction");
+    passed &= check(passed && sameValues(result->getFrame(OB_FRAME_GYRO), gyroSamples), "gyro batch equals per-sample correction");
+    printf("correctImuBatch matches correctAccel/correctGyro: %s\n", passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+static bool testLayout(std::shared_ptr<const StreamProfile> accelSp, std::mt19937 &rng) {
+    auto samples = generateSamples(rng, 4.f);
+    auto frame   = createBatchFrame(accelSp, samples);
+
+    bool passed = true;
+    passed &= check(frame->getCapacity() == CAPACITY, "capacity");
+    passed &= check(frame->getDataSize() >= ImuBatchFrame::calcDataSize(CAPACITY), "data size");
+    passed &= check((const uint8_t *)frame->getTimestamps() == frame->getData() + sizeof(ImuBatchFrame::Header), "timestamps follow the header");
+    passed &= check((const void *)frame->getValues(0) == (const void *)(frame->getTimestamps() + CAPACITY), "x values follow the timestamps");
+    passed &= check(frame->getValues(1) == frame->getValues(0) + CAPACITY, "y values follow the x values");
+    passed &= check(frame->getValues(2) == frame->getValues(1) + CAPACITY, "z values follow the y values");
+    passed &= check(frame->getTemperatures() == frame->getValues(2) + CAPACITY, "temperatures follow the z values");
+    passed &= check((const uint8_t *)(frame->getTemperatures() + CAPACITY) <= frame->getData() + frame->getDataSize(), "arrays fit the data buffer");
+
+    bool thrown = false;
+    try {
+        frame->setSampleCount(CAPACITY + 1);
+    }
+    catch(const invalid_value_exception &) {
+        thrown = true;
+    }
+    passed &= check(thrown && frame->getSampleCount() == SAMPLE_COUNT, "sample count beyond the capacity is rejected");
+
+    // A copy, as made by the filters, must be a batch frame of the same capacity
+    auto copy = FrameFactory::createFrameFromOtherFrame(frame, true);
+    passed &= check(copy->is<AccelBatchFrame>() && copy->as<ImuBatchFrame>()->getCapacity() == CAPACITY, "copy is a batch frame");
+    passed &= check(copy->as<ImuBatchFrame>()->getSampleCount() == SAMPLE_COUNT
+                        && memcmp(copy->as<ImuBatchFrame>()->getTemperatures(), frame->getTemperatures(), SAMPLE_COUNT * sizeof(float)) == 0,
+                    "copy has the same samples");
+    printf("ImuBatchFrame layout: %s\n", passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+static bool testCApi(std::shared_ptr<const StreamProfile> accelSp, std::mt19937 &rng) {
+    auto samples = generateSamples(rng, 4.f);
+    auto frame   = createBatchFrame(accelSp, samples);
+
+    bool      passed = true;
+    ob_error *error  = nullptr;
+    auto      impl   = new ob_frame;
+    impl->frame      = frame;
+
+    passed &= check(ob_frame_is_imu_batch(impl, &error) && !error, "ob_frame_is_imu_batch");
+    passed &= check(ob_imu_batch_frame_get_sample_count(impl, &error) == SAMPLE_COUNT && !error, "ob_imu_batch_frame_get_sample_count");
+    auto timestamps = ob_imu_batch_frame_get_timestamps(impl, &error);
+    passed &= check(timestamps == frame->getTimestamps() && timestamps[SAMPLE_COUNT - 1] == samples.back().timestamp, "ob_imu_batch_frame_get_timestamps");
+    for(uint32_t axis = 0; axis < 3; axis++) {
+        auto values = ob_imu_batch_frame_get_values(impl, axis, &error);
+        passed &= check(values == frame->getValues(axis) && values[SAMPLE_COUNT - 1] == samples.back().value[axis], "ob_imu_batch_frame_get_values");
+    }
+    auto temperatures = ob_imu_batch_frame_get_temperatures(impl, &error);
+    passed &= check(temperatures == frame->getTemperatures() && temperatures[0] == samples[0].temperature, "ob_imu_batch_frame_get_temperatures");
+    passed &= check(!error, "no error on a batch frame");
+
+    passed &= check(ob_imu_batch_frame_get_values(impl, 3, &error) == nullptr && error, "invalid axis is rejected");
+    ob_delete_error(error);
+    error = nullptr;
+
+    // The C++ wrapper owns and deletes impl
+    std::shared_ptr<ob::Frame> wrapper = std::make_shared<ob::ImuBatchFrame>(impl);
+    passed &= check(wrapper->isImuBatch() && wrapper->is<ob::ImuBatchFrame>() && !wrapper->is<ob::AccelFrame>(), "ob::Frame::is<ImuBatchFrame>");
+    auto batch = wrapper->as<ob::ImuBatchFrame>();
+    passed &= check(batch->getSampleCount() == SAMPLE_COUNT && batch->getValues(2) == frame->getValues(2), "ob::ImuBatchFrame accessors");
+
+    // A per-sample frame is not a batch frame
+    auto sampleImpl   = new ob_frame;
+    sampleImpl->frame = FrameFactory::createFrameFromStreamProfile(accelSp);
+    passed &= check(!ob_frame_is_imu_batch(sampleImpl, &error) && !error, "per-sample frame is not a batch frame");
+    passed &= check(ob_imu_batch_frame_get_sample_count(sampleImpl, &error) == 0 && error, "batch accessors reject a per-sample frame");
+    ob_delete_error(error);
+    ob_delete_frame(sampleImpl, nullptr);
+
+    printf("C API: %s\n", passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+int main() {
+    std::mt19937 rng(15);
+
+    OBAccelIntrinsic accelIntrinsic = {};
+    OBGyroIntrinsic  gyroIntrinsic  = {};
+    setCalibration(accelIntrinsic, rng);
+    setCalibration(gyroIntrinsic, rng);
+    auto accelSp = std::make_shared<AccelStreamProfile>(nullptr, OB_ACCEL_FS_4g, OB_SAMPLE_RATE_200_HZ);
+    auto gyroSp  = std::make_shared<GyroStreamProfile>(nullptr, OB_GYRO_FS_1000dps, OB_SAMPLE_RATE_200_HZ);
+    accelSp->bindIntrinsic(accelIntrinsic);
+    gyroSp->bindIntrinsic(gyroIntrinsic);
+
+    bool passed = true;
+    passed &= testCorrection(accelSp, gyroSp, rng);
+    passed &= testLayout(accelSp, rng);
+    passed &= testCApi(accelSp, rng);
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+#include "ethernet/NetDataStreamPort.hpp"
+#include "ethernet/socket/VendorTCPClient.hpp"
+#include "frame/FrameFactory.hpp"
+#include "frame/FrameMemoryPool.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if(!defined(WIN32) && !defined(_WIN32) && !defined(WINCE))
+#include <netinet/tcp.h>
+#endif
+
+using namespace libobsensor;
+
+// Streams IMU sized packets from a local TCP server, standing in for the data stream port of a networked device, and measures the packet
+// throughput and latency of NetDataStreamPort against the previous reader, which read each packet into its own pool frame with blocking reads.
+
+static const uint32_t PACK_SIZE              = 248;
+static const uint32_t THROUGHPUT_PACKETS     = 200000;
+static const uint32_t LATENCY_PACKETS        = 2000;
+static const uint32_t LATENCY_INTERVAL_USEC  = 1000;
+static const uint32_t PACKETS_PER_SEND_BURST = 16;
+
+// Packet layout: uint32 sequence number | uint32 reserved | uint64 host send time in us | padding
+static void fillPacket(uint8_t *packet, uint32_t seq, uint64_t sendTimeUsec) {
+    memset(packet, 0, PACK_SIZE);
+    memcpy(packet, &seq, sizeof(seq));
+    memcpy(packet + 8, &sendTimeUsec, sizeof(sendTimeUsec));
+}
+
+class StandInServer {
+public:
+    StandInServer() : listenFd_(INVALID_SOCKET), port_(0) {
+        listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse, sizeof(reuse));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port   = 0;
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        bind(listenFd_, (SOCKADDR *)&addr, sizeof(addr));
+        listen(listenFd_, 1);
+        socklen_t addrLen = sizeof(addr);
+        getsockname(listenFd_, (SOCKADDR *)&addr, &addrLen);
+        port_ = ntohs(addr.sin_port);
+    }
+
+    ~StandInServer() {
+        if(sendThread_.joinable()) {
+            sendThread_.join();
+        }
+        closesocket(listenFd_);
+    }
+
+    uint16_t getPort() const {
+        return port_;
+    }
+
+    // Accept the next connection and send count packets, intervalUsec apart (0 for as fast as possible), then keep the connection open until
+    // holdMsec has passed, so the client sees an idle connection rather than a closed one.
+    void serve(uint32_t count, uint32_t intervalUsec, uint32_t holdMsec) {
+        if(sendThread_.joinable()) {
+            sendThread_.join();
+        }
+        sendThread_ = std::thread([this, count, intervalUsec, holdMsec]() {
+            SOCKET fd      = accept(listenFd_, nullptr, nullptr);
+            int    noDelay = 1;  // send each packet at once, as the device does, rather than waiting for the ack of the previous one
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char *)&noDelay, sizeof(noDelay));
+            std::vector<uint8_t> burst(PACK_SIZE * PACKETS_PER_SEND_BURST);
+            auto                 start = std::chrono::steady_clock::now();
+            for(uint32_t seq = 0; seq < count;) {
+                uint32_t burstCount = intervalUsec ? 1 : std::min(PACKETS_PER_SEND_BURST, count - seq);
+                if(intervalUsec) {
+                    std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<uint64_t>(seq) * intervalUsec));
+                }
+                auto now = utils::getNowTimesUs();
+                for(uint32_t i = 0; i < burstCount; i++) {
+                    fillPacket(burst.data() + i * PACK_SIZE, seq + i, now);
+                }
+                // Split the sends at an odd offset so packets straddle the reads of the client
+                uint32_t sendSize = burstCount * PACK_SIZE;
+                uint32_t sent     = 0;
+                while(sent < sendSize) {
+                    auto chunk = std::min<uint32_t>(sendSize - sent, intervalUsec ? sendSize : 1500);
+                    auto rst   = send(fd, (const char *)burst.data() + sent, chunk, 0);
+                    if(rst <= 0) {
+                        closesocket(fd);
+                        return;
+                    }
+                    sent += static_cast<uint32_t>(rst);
+                }
+                seq += burstCount;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(holdMsec));
+            closesocket(fd);
+        });
+    }
+
+private:
+    SOCKET      listenFd_;
+    uint16_t    port_;
+    std::thread sendThread_;
+};
+
+struct ReceiveStats {
+    uint32_t              received  = 0;
+    uint32_t              lost      = 0;
+    uint64_t              firstUsec = 0;
+    uint64_t              lastUsec  = 0;
+    std::vector<uint64_t> latencyUsec;
+
+    void onPacket(const std::shared_ptr<Frame> &frame) {
+        uint32_t seq;
+        uint64_t sendTimeUsec;
+        memcpy(&seq, frame->getData(), sizeof(seq));
+        memcpy(&sendTimeUsec, frame->getData() + 8, sizeof(sendTimeUsec));
+        auto now = utils::getNowTimesUs();
+        if(seq != received + lost) {
+            lost += seq - (received + lost);
+        }
+        if(received == 0) {
+            firstUsec = now;
+        }
+        lastUsec = now;
+        received++;
+        latencyUsec.push_back(now - sendTimeUsec);
+    }
+};
+
+// The reader NetDataStreamPort used before: a pool frame per packet, filled with blocking reads
+class LegacyReader {
+public:
+    LegacyReader(uint16_t port, MutableFrameCallback callback) : isStreaming_(true), callback_(callback) {
+        tcpClient_  = std::make_shared<VendorTCPClient>("127.0.0.1", port);
+        readThread_ = std::thread(&LegacyReader::readData, this);
+    }
+
+    void stop() {
+        isStreaming_ = false;
+        readThread_.join();
+        tcpClient_.reset();
+    }
+
+private:
+    void readData() {
+        int                    dataRecvdSize = 0;
+        int                    readSize      = 0;
+        std::shared_ptr<Frame> frame;
+        uint8_t               *data = nullptr;
+        while(isStreaming_) {
+            if(!frame) {
+                frame         = FrameFactory::createFrame(OB_FRAME_UNKNOWN, OB_FORMAT_UNKNOWN, PACK_SIZE);
+                data          = frame->getDataMutable();
+                dataRecvdSize = 0;
+            }
+            try {
+                readSize = tcpClient_->read(data + dataRecvdSize, PACK_SIZE - dataRecvdSize);
+            }
+            catch(...) {
+                readSize = -1;
+            }
+            if(readSize < 0) {
+                dataRecvdSize = 0;
+            }
+            else {
+                dataRecvdSize += readSize;
+            }
+            if(static_cast<int>(PACK_SIZE) == dataRecvdSize && isStreaming_) {
+                frame->setSystemTimeStampUsec(utils::getNowTimesUs());
+                callback_(frame);
+                frame.reset();
+            }
+        }
+    }
+
+private:
+    std::atomic<bool>                isStreaming_;
+    std::shared_ptr<VendorTCPClient> tcpClient_;
+    std::thread                      readThread_;
+    MutableFrameCallback             callback_;
+};
+
+struct RunResult {
+    ReceiveStats stats;
+    double       stopMsec;  // time stopping the reader took on an idle connection
+};
+
+static RunResult run(StandInServer &server, bool legacy, uint32_t count, uint32_t intervalUsec) {
+    RunResult result;
+    auto      callback = [&result](std::shared_ptr<Frame> frame) { result.stats.onPacket(frame); };
+    result.stats.latencyUsec.reserve(count);
+
+    server.serve(count, intervalUsec, 1000);
+    std::shared_ptr<LegacyReader>      legacyReader;
+    std::shared_ptr<NetDataStreamPort> port;
+    if(legacy) {
+        legacyReader = std::make_shared<LegacyReader>(server.getPort(), callback);
+    }
+    else {
+        port = std::make_shared<NetDataStreamPort>(std::make_shared<NetDataStreamPortInfo>("127.0.0.1", server.getPort(), 0));
+        port->startStream(callback);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while(result.stats.received + result.stats.lost < count && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // the server is idle now
+
+    auto stopStart = std::chrono::steady_clock::now();
+    if(legacy) {
+        legacyReader->stop();
+    }
+    else {
+        port->stopStream();
+    }
+    result.stopMsec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stopStart).count();
+    return result;
+}
+
+static uint64_t percentile(std::vector<uint64_t> values, double p) {
+    if(values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+int main() {
+    // Held by the context in the SDK, otherwise every frame of the legacy reader would create and destroy the pool
+    auto          memoryPool = FrameMemoryPool::getInstance();
+    StandInServer server;
+    bool          passed = true;
+
+    printf("%-8s | %10s | %6s | %14s | %12s | %12s | %12s | %10s\n", "reader", "packets", "lost", "packets/s", "lat p50(us)", "lat p99(us)",
+           "lat max(us)", "stop(ms)");
+    for(int legacy = 1; legacy >= 0; legacy--) {
+        const char *name       = legacy ? "legacy" : "ring";
+        auto        throughput = run(server, legacy != 0, THROUGHPUT_PACKETS, 0);
+        auto        latency    = run(server, legacy != 0, LATENCY_PACKETS, LATENCY_INTERVAL_USEC);
+
+        auto  &ts          = throughput.stats;
+        double durationSec = (ts.lastUsec - ts.firstUsec) / 1e6;
+        printf("%-8s | %10u | %6u | %14.0f | %12s | %12s | %12s | %10.1f\n", name, ts.received, ts.lost, durationSec > 0 ? ts.received / durationSec : 0,
+               "-", "-", "-", throughput.stopMsec);
+
+        auto &ls = latency.stats;
+        printf("%-8s | %10u | %6u | %14s | %12llu | %12llu | %12llu | %10.1f\n", name, ls.received, ls.lost, "paced 1kHz",
+               (unsigned long long)percentile(ls.latencyUsec, 0.5), (unsigned long long)percentile(ls.latencyUsec, 0.99),
+               (unsigned long long)percentile(ls.latencyUsec, 1.0), latency.stopMsec);
+
+        if(!legacy) {
+            // Every packet must arrive in order, and stopping must not wait for a blocking read to time out
+            if(ts.received != THROUGHPUT_PACKETS || ts.lost != 0 || ls.received != LATENCY_PACKETS || ls.lost != 0) {
+                passed = false;
+            }
+            if(throughput.stopMsec > 500 || latency.stopMsec > 500) {
+                passed = false;
+            }
+        }
+    }
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+#include "PointCloudImpl.hpp"
+#include "AlignImpl.hpp"
+#include "utils/CoordinateUtil.hpp"
+#include "utils/CoordinateTablesCache.hpp"
+#include "KernelTestUtils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+CHECK_KERNEL_ORDER(libobsensor::POINTCLOUD_KERNEL_);
+
+using namespace libobsensor;
+
+// Synthetic depth camera with a slanted plane and a box in front of it, holes (0) and invalid pixels (65535), and a color image of the same size
+struct TestData {
+    OBCameraIntrinsic     intrinsic;
+    OBCameraDistortion    distortion;
+    std::vector<uint16_t> depth;
+    std::vector<uint8_t>  color;
+    std::vector<float>    xy_tables_data;
+    std::vector<float>    uv_tables_data;
+    OBXYTables            xy_tables;
+    OBXYTables            uv_tables;
+};
+
+static void make_test_data(int width, int height, TestData &data) {
+    data.intrinsic  = { 0.5f * width, 0.5f * width, 0.5f * width - 0.3f, 0.5f * height + 0.2f, static_cast<int16_t>(width), static_cast<int16_t>(height) };
+    data.distortion = { 0.08f, -0.05f, 0.01f, 0, 0, 0, 0.0002f, 0.0001f, OB_DISTORTION_BROWN_CONRADY };
+
+    std::mt19937 rng(7);
+    data.depth.resize(static_cast<size_t>(width) * height);
+    data.color.resize(data.depth.size() * 3);
+    for(int v = 0; v < height; v++) {
+        for(int u = 0; u < width; u++) {
+            float d = 1500.f + 0.8f * u + 0.3f * v;
+            if(u > width / 3 && u < 2 * width / 3 && v > height / 3 && v < 3 * height / 4) {
+                d = 600.f + 20.f * std::sin(u * 0.05f);
+            }
+            uint32_t r = rng() % 100;
+            size_t   i = static_cast<size_t>(v) * width + u;
+            data.depth[i] = r < 10 ? 0 : (r == 10 ? 65535 : static_cast<uint16_t>(d));
+            data.color[3 * i + 0] = static_cast<uint8_t>(u);
+            data.color[3 * i + 1] = static_cast<uint8_t>(v);
+            data.color[3 * i + 2] = static_cast<uint8_t>(u + v);
+        }
+    }
+
+    uint32_t tables_size = static_cast<uint32_t>(data.depth.size() * 2);
+    data.xy_tables_data.resize(tables_size);
+    data.uv_tables_data.resize(tables_size);
+    CoordinateUtil::transformationInitXYTables(data.intrinsic, data.distortion, data.xy_tables_data.data(), &tables_size, &data.xy_tables);
+    CoordinateUtil::transformationInitAddDistortionUVTables(data.intrinsic, data.distortion, data.uv_tables_data.data(), &tables_size, &data.uv_tables);
+}
+
+// Color camera of another resolution beside the depth camera of TestData, for the point clouds of color frames not aligned to the depth frame
+struct ColorCamera {
+    OBCameraIntrinsic    intrinsic;
+    OBCameraDistortion   distortion;
+    OBExtrinsic          depth_to_color;
+    std::vector<uint8_t> color;
+};
+
+static void make_color_camera(int width, int height, ColorCamera &camera) {
+    camera.intrinsic      = { 0.7f * width, 0.7f * width, 0.5f * width + 1.1f, 0.5f * height - 0.7f, static_cast<int16_t>(width), static_cast<int16_t>(height) };
+    camera.distortion     = { 0.05f, -0.03f, 0.005f, 0, 0, 0, -0.0003f, 0.0002f, OB_DISTORTION_BROWN_CONRADY };
+    camera.depth_to_color = { { 0.9998f, -0.0175f, 0.0052f, 0.0175f, 0.9998f, -0.0035f, -0.0051f, 0.0036f, 1.f }, { -25.f, 0.4f, 1.2f } };
+    camera.color.resize(static_cast<size_t>(width) * height * 3);
+    for(int v = 0; v < height; v++) {
+        for(int u = 0; u < width; u++) {
+            size_t i              = static_cast<size_t>(v) * width + u;
+            camera.color[3 * i + 0] = static_cast<uint8_t>(u);
+            camera.color[3 * i + 1] = static_cast<uint8_t>(v);
+            camera.color[3 * i + 2] = static_cast<uint8_t>(u / 256 + v / 256 * 16);
+        }
+    }
+}
+
+static void init_align(AlignImpl &align, const TestData &data, const ColorCamera &camera) {
+    align.initialize(data.intrinsic, data.distortion, camera.intrinsic, camera.distortion, camera.depth_to_color, 1.f, true, true);
+}
+
+// the color mapped to the depth pixels as the points are computed, as PointCloudFilter does for the unaligned color frames
+static size_t run_mapped_point_cloud(PointCloudImpl &impl, AlignImpl &align, const TestData &data, const ColorCamera &camera, OBFormat format,
+                                     bool valid_points_only, std::vector<uint8_t> &out) {
+    out.resize(data.depth.size() * PointCloudImpl::getPointSize(format));
+    const uint16_t *depth = data.depth.data();
+    return impl.processWithColorMap(
+        data.xy_tables, depth, camera.color.data(), camera.intrinsic.width,
+        [&align, depth](int pixel_begin, int pixel_end, int *map) { return align.mapDepthPixels(depth, pixel_begin, pixel_end, map) == 0; }, format, 0.5f,
+        OB_LEFT_HAND_COORDINATE_SYSTEM, false, valid_points_only, out.data());
+}
+
+// the color frame aligned to the depth frame first, as the Align filter (C2D) before PointCloudFilter does
+static size_t run_aligned_point_cloud(PointCloudImpl &impl, AlignImpl &align, const TestData &data, const ColorCamera &camera, OBFormat format,
+                                      bool valid_points_only, std::vector<uint8_t> &aligned_color, std::vector<uint8_t> &out) {
+    aligned_color.resize(data.depth.size() * 3);
+    align.C2D(data.depth.data(), data.intrinsic.width, data.intrinsic.height, camera.color.data(), aligned_color.data(), camera.intrinsic.width,
+              camera.intrinsic.height, OB_FORMAT_RGB);
+    out.resize(data.depth.size() * PointCloudImpl::getPointSize(format));
+    return impl.process(data.xy_tables, false, data.intrinsic, data.depth.data(), aligned_color.data(), format, 0.5f, OB_LEFT_HAND_COORDINATE_SYSTEM, false,
+                        valid_points_only, out.data());
+}
+
+static const char *format_name(OBFormat format) {
+    switch(format) {
+    case OB_FORMAT_POINT:
+        return "POINT";
+    case OB_FORMAT_POINT_INT16:
+        return "POINT_INT16";
+    case OB_FORMAT_POINT_HALF:
+        return "POINT_HALF";
+    case OB_FORMAT_RGB_POINT:
+        return "RGB_POINT";
+    case OB_FORMAT_RGB_POINT_INT16:
+        return "RGB_POINT_INT16";
+    case OB_FORMAT_RGB_POINT_HALF:
+        return "RGB_POINT_HALF";
+    default:
+        return "?";
+    }
+}
+
+struct Mode {
+    const char *name;
+    bool        color;
+    bool        uv_tables;
+};
+
+static const Mode modes[] = { { "depth", false, false }, { "rgbd", true, false }, { "rgbd-uv", true, true } };
+
+static std::vector<OBFormat> mode_formats(const Mode &mode) {
+    if(mode.color) {
+        return { OB_FORMAT_RGB_POINT, OB_FORMAT_RGB_POINT_INT16, OB_FORMAT_RGB_POINT_HALF };
+    }
+    return { OB_FORMAT_POINT, OB_FORMAT_POINT_INT16, OB_FORMAT_POINT_HALF };
+}
+
+static size_t run_point_cloud(PointCloudImpl &impl, const TestData &data, const Mode &mode, OBFormat format, bool valid_points_only,
+                              std::vector<uint8_t> &out) {
+    out.resize(data.depth.size() * PointCloudImpl::getPointSize(format));
+    return impl.process(mode.uv_tables ? data.uv_tables : data.xy_tables, mode.uv_tables, data.intrinsic, data.depth.data(),
+                        mode.color ? data.color.data() : nullptr, format, 0.5f, OB_LEFT_HAND_COORDINATE_SYSTEM, false, valid_points_only, out.data());
+}
+
+// the float point cloud of CoordinateUtil
+static void run_reference(const TestData &data, const Mode &mode, std::vector<uint8_t> &out) {
+    out.resize(data.depth.size() * (mode.color ? sizeof(OBColorPoint) : sizeof(OBPoint)));
+    OBXYTables tables = mode.uv_tables ? data.uv_tables : data.xy_tables;
+    if(!mode.color) {
+        CoordinateUtil::transformationDepthToPointCloud(&tables, data.depth.data(), out.data(), 0.5f, OB_LEFT_HAND_COORDINATE_SYSTEM);
+    }
+    else if(!mode.uv_tables) {
+        CoordinateUtil::transformationDepthToRGBDPointCloud(&tables, data.depth.data(), data.color.data(), out.data(), 0.5f, OB_LEFT_HAND_COORDINATE_SYSTEM,
+                                                            false);
+    }
+    else {
+        CoordinateUtil::transformationDepthToRGBDPointCloudByUVTables(data.intrinsic, &tables, data.depth.data(), data.color.data(), out.data(), 0.5f,
+                                                                      OB_LEFT_HAND_COORDINATE_SYSTEM, false);
+    }
+}
+
+// Checks on a resolution leaving a tail of pixels in each row:
+// - the scalar kernel gives the same float point cloud as CoordinateUtil
+// - every kernel and thread count gives the same points as the scalar kernel on one thread; with several threads the row bands are written from
+//   the last one, so a band writing past its valid points shows up as a mismatch even on a single core
+// - the valid points only are the organized points of valid, non-zero depth
+// - the points of a color frame mapped as they are computed are the points of the color frame aligned first
+static int run_check() {
+    TestData data;
+    make_test_data(643, 401, data);
+    const OBXYTables *tables[] = { &data.xy_tables, &data.xy_tables, &data.uv_tables };
+
+    bool passed = true;
+    printf("%-7s | %-15s | %-7s | %7s | %-11s | %s\n", "mode", "format", "kernel", "threads", "points", "result");
+    for(int m = 0; m < 3; m++) {
+        const Mode &mode = modes[m];
+        for(auto format: mode_formats(mode)) {
+            size_t               point_size = PointCloudImpl::getPointSize(format);
+            std::vector<uint8_t> reference;
+            PointCloudImpl       scalar;
+            scalar.setKernel(POINTCLOUD_KERNEL_SCALAR);
+            scalar.setThreadCount(1);
+            run_point_cloud(scalar, data, mode, format, false, reference);
+
+            const char *result = "reference";
+            if(format == OB_FORMAT_POINT || format == OB_FORMAT_RGB_POINT) {
+                std::vector<uint8_t> expected;
+                run_reference(data, mode, expected);
+                bool same = expected == reference;
+                result    = same ? "same as CoordinateUtil" : "MISMATCH with CoordinateUtil";
+                passed    = passed && same;
+            }
+            printf("%-7s | %-15s | %-7s | %7d | %-11s | %s\n", mode.name, format_name(format), "scalar", 1, "organized", result);
+
+            // the expected valid points
+            std::vector<uint8_t> expected_valid;
+            for(size_t i = 0; i < data.depth.size(); i++) {
+                uint16_t d = data.depth[i];
+                if(d != 0 && d != 65535 && !std::isnan(tables[m]->xTable[i])) {
+                    expected_valid.insert(expected_valid.end(), reference.begin() + i * point_size, reference.begin() + (i + 1) * point_size);
+                }
+            }
+
+            for(auto kernel: get_available_kernels<PointCloudImpl>()) {
+                for(int thread_count: { 1, 3 }) {
+                    for(int valid_points_only = 0; valid_points_only <= 1; valid_points_only++) {
+                        PointCloudImpl impl;
+                        impl.setKernel(kernel);
+                        impl.setThreadCount(thread_count);
+                        std::vector<uint8_t> out;
+                        size_t               count = run_point_cloud(impl, data, mode, format, valid_points_only != 0, out);
+                        out.resize(count * point_size);
+                        bool same = out == (valid_points_only ? expected_valid : reference);
+                        passed    = passed && same;
+                        printf("%-7s | %-15s | %-7s | %7d | %-11s | %s\n", mode.name, format_name(format), kernel_name(kernel), thread_count,
+                               valid_points_only ? "valid only" : "organized", same ? "identical" : "MISMATCH");
+                    }
+                }
+            }
+        }
+    }
+
+    // the color mapped as the points are computed gives the same points as the color aligned first, on a width of whole SIMD blocks of the alignment
+    {
+        TestData    mapped_data;
+        ColorCamera camera;
+        make_test_data(640, 400, mapped_data);
+        make_color_camera(1280, 720, camera);
+        AlignImpl align;
+        init_align(align, mapped_data, camera);
+        for(auto format: mode_formats(modes[1])) {
+            for(int valid_points_only = 0; valid_points_only <= 1; valid_points_only++) {
+                PointCloudImpl       impl;
+                std::vector<uint8_t> expected, aligned_color, out;
+                size_t               expected_count = run_aligned_point_cloud(impl, align, mapped_data, camera, format, valid_points_only != 0, aligned_color, expected);
+                for(int thread_count: { 1, 3 }) {
+                    impl.setThreadCount(thread_count);
+                    size_t count = run_mapped_point_cloud(impl, align, mapped_data, camera, format, valid_points_only != 0, out);
+                    bool   same  = count == expected_count && out == expected
+                                && std::any_of(aligned_color.begin(), aligned_color.end(), [](uint8_t c) { return c != 0; });
+                    passed       = passed && same;
+                    printf("%-7s | %-15s | %-7s | %7d | %-11s | %s\n", "mapped", format_name(format), kernel_name(impl.getKernel()), thread_count,
+                           valid_points_only ? "valid only" : "organized", same ? "same as aligned first" : "MISMATCH with aligned first");
+                }
+            }
+        }
+    }
+
+    // the tables of CoordinateTablesCache are the same as computed, and shared
+    OBXYTables xy_tables, uv_tables, xy_tables2;
+    auto       xy_data  = CoordinateUtil::getCachedXYTables(data.intrinsic, data.distortion, &xy_tables);
+    auto       uv_data  = CoordinateUtil::getCachedAddDistortionUVTables(data.intrinsic, data.distortion, &uv_tables);
+    auto       xy_data2 = CoordinateUtil::getCachedXYTables(data.intrinsic, data.distortion, &xy_tables2);
+    size_t     size     = data.depth.size() * 2 * sizeof(float);
+    bool       same     = xy_data && uv_data && memcmp(xy_data.get(), data.xy_tables_data.data(), size) == 0
+                && memcmp(uv_data.get(), data.uv_tables_data.data(), size) == 0 && xy_data2 == xy_data;
+    passed = passed && same;
+    printf("cached tables: %s\n", same ? "identical and shared" : "MISMATCH");
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+// Measures the time and output size of each format on 1280x800 depth, against CoordinateUtil
+static int run_benchmark(int frame_count) {
+    TestData data;
+    make_test_data(1280, 800, data);
+
+    std::vector<int> thread_counts = get_benchmark_thread_counts();
+
+    // computing the xy tables against getting them from CoordinateTablesCache, the first time computed (or loaded from the cache directory)
+    {
+        std::vector<float> tables_data(data.depth.size() * 2);
+        uint32_t           tables_size = static_cast<uint32_t>(tables_data.size());
+        OBXYTables         tables;
+        auto               start = std::chrono::steady_clock::now();
+        CoordinateUtil::transformationInitXYTables(data.intrinsic, data.distortion, tables_data.data(), &tables_size, &tables);
+        double compute_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        OBCameraDistortion distortion = data.distortion;
+        distortion.k3 += 0.001f;  // not the tables of the check
+        start                = std::chrono::steady_clock::now();
+        auto   first         = CoordinateUtil::getCachedXYTables(data.intrinsic, distortion, &tables);
+        double first_ms      = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        start                = std::chrono::steady_clock::now();
+        auto   second        = CoordinateUtil::getCachedXYTables(data.intrinsic, distortion, &tables);
+        double second_ms     = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        printf("xy tables: computed %.2f ms, cached first use %.2f ms, cached next use %.4f ms\n", compute_ms, first_ms, second_ms);
+    }
+
+    // the color frame mapped as the points are computed, against aligned to the depth frame first: the aligned color frame is not written and read again
+    {
+        ColorCamera camera;
+        make_color_camera(1920, 1080, camera);
+        AlignImpl align;
+        init_align(align, data, camera);
+        printf("%-26s | %7s | %10s | %8s | %s\n", "rgbd of 1920x1080 color", "threads", "ms/frame", "fps", "MB/frame of intermediate data");
+        for(int thread_count: thread_counts) {
+            PointCloudImpl impl;
+            impl.setThreadCount(thread_count);
+            align.setThreadCount(thread_count);
+            std::vector<uint8_t> aligned_color, out;
+            double               aligned_ms =
+                measure(frame_count, [&]() { run_aligned_point_cloud(impl, align, data, camera, OB_FORMAT_RGB_POINT, false, aligned_color, out); });
+            double mapped_ms = measure(frame_count, [&]() { run_mapped_point_cloud(impl, align, data, camera, OB_FORMAT_RGB_POINT, false, out); });
+            // the pixel map of C2D and the aligned color frame written then read again
+            double intermediate_mb = data.depth.size() * (2 * sizeof(int) + 2 * 3) / 1e6;
+            printf("%-26s | %7d | %10.2f | %8.1f | %.2f\n", "aligned first (C2D)", thread_count, aligned_ms, 1000.0 / aligned_ms, intermediate_mb);
+            printf("%-26s | %7d | %10.2f | %8.1f | %.2f\n", "mapped", thread_count, mapped_ms, 1000.0 / mapped_ms, 0.0);
+        }
+    }
+
+    PointCloudImpl default_impl;
+    printf("kernel: %s\n", kernel_name(default_impl.getKernel()));
+    printf("%-7s | %-15s | %-11s | %7s | %10s | %8s | %8s\n", "mode", "format", "points", "threads", "ms/frame", "fps", "MB/frame");
+    for(int m = 0; m < 2; m++) {
+        const Mode          &mode = modes[m];
+        std::vector<uint8_t> out;
+        double               ms = measure(frame_count, [&]() { run_reference(data, mode, out); });
+        printf("%-7s | %-15s | %-11s | %7d | %10.2f | %8.1f | %8.2f\n", mode.name, "CoordinateUtil", "organized", 1, ms, 1000.0 / ms, out.size() / 1e6);
+
+        for(auto format: mode_formats(mode)) {
+            for(int valid_points_only = 0; valid_points_only <= 1; valid_points_only++) {
+                for(int thread_count: thread_counts) {
+                    PointCloudImpl impl;
+                    impl.setThreadCount(thread_count);
+                    size_t count = 0;
+                    ms           = measure(frame_count, [&]() { count = run_point_cloud(impl, data, mode, format, valid_points_only != 0, out); });
+                    printf("%-7s | %-15s | %-11s | %7d | %10.2f | %8.1f | %8.2f\n", mode.name, format_name(format),
+                           valid_points_only ? "valid only" : "organized", thread_count, ms, 1000.0 / ms, count * PointCloudImpl::getPointSize(format) / 1e6);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    return run_kernel_test(argc, argv, run_check, run_benchmark, 30);
+}
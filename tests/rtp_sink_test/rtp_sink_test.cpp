@@ -0,0 +1,50 @@
+#include "ethernet/rtsp/ObRTPSink.hpp"
+
+#include <cstdio>
+
+using namespace libobsensor;
+
+// Checks the size of the RTP buffers the access units are received into: the exact frame size for raw frames, and room for a key frame of
+// 3 bytes per pixel, at least as much as before the buffers were sized per stream, for compressed streams.
+
+static const uint32_t HEADER_SIZE          = 100;
+static const uint32_t BASELINE_BUFFER_SIZE = 3 * 3840 * 2160;
+
+struct SizeCase {
+    const char *name;
+    OBFormat    format;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    expected;  // 0 for a compressed stream
+};
+
+int main() {
+    const SizeCase cases[] = {
+        { "Y16 640x576", OB_FORMAT_Y16, 640, 576, 640 * 576 * 2 },
+        { "Y8 1280x800", OB_FORMAT_Y8, 1280, 800, 1280 * 800 },
+        { "RGB 1920x1080", OB_FORMAT_RGB, 1920, 1080, 1920 * 1080 * 3 },
+        { "H264 640x480", OB_FORMAT_H264, 640, 480, 0 },
+        { "H264 1920x1080", OB_FORMAT_H264, 1920, 1080, 0 },
+        { "H265 3840x2160", OB_FORMAT_H265, 3840, 2160, 0 },
+        { "HEVC 7680x4320", OB_FORMAT_HEVC, 7680, 4320, 0 },
+        { "MJPG 1920x1080", OB_FORMAT_MJPG, 1920, 1080, 0 },
+        { "RVL 640x576", OB_FORMAT_RVL, 640, 576, 0 },
+    };
+
+    bool passed = true;
+    for(auto &c: cases) {
+        uint32_t size = ObRTPSink::calcRTPBufferSize(c.format, c.width, c.height, HEADER_SIZE);
+        bool     ok   = false;
+        if(c.expected) {
+            ok = size == c.expected + HEADER_SIZE;
+        }
+        else {
+            ok = size >= BASELINE_BUFFER_SIZE + HEADER_SIZE && size >= c.width * c.height * 3 + HEADER_SIZE;
+        }
+        printf("%-15s | %10u bytes | %s\n", c.name, size, ok ? "ok" : "WRONG SIZE");
+        passed = passed && ok;
+    }
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
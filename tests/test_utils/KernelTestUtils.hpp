@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Helpers of the tests of the filters with SIMD kernels
+
+// The kernel enums of the filters (AlignKernel, PointCloudKernel, ...) all list the scalar, SSE, AVX2, AVX-512 and NEON kernels, in this order
+#define TEST_KERNEL_COUNT 5
+
+template <typename Kernel> const char *kernel_name(Kernel kernel) {
+    static const char *const names[TEST_KERNEL_COUNT] = { "scalar", "SSE", "AVX2", "AVX-512", "NEON" };
+    int                      index                    = static_cast<int>(kernel);
+    return index >= 0 && index < TEST_KERNEL_COUNT ? names[index] : "unknown";
+}
+
+// Checks that the kernel enum of the given prefix lists its kernels in that order, e.g. CHECK_KERNEL_ORDER(libobsensor::ALIGN_KERNEL_)
+#define CHECK_KERNEL_ORDER(PREFIX)                                                                                                  \
+    static_assert(PREFIX##SCALAR == 0 && PREFIX##SSE == 1 && PREFIX##AVX2 == 2 && PREFIX##AVX512 == 3 && PREFIX##NEON == 4, \
+                  "the kernels of " #PREFIX " are not in the order of kernel_name()")
+
+// The kernels of Impl built for this architecture and supported by the cpu, scalar first
+template <typename Impl> auto get_available_kernels() -> std::vector<decltype(std::declval<Impl>().getKernel())> {
+    typedef decltype(std::declval<Impl>().getKernel()) Kernel;
+    std::vector<Kernel>                                kernels;
+    for(int i = 0; i < TEST_KERNEL_COUNT; i++) {
+        if(Impl::isKernelAvailable(static_cast<Kernel>(i))) {
+            kernels.push_back(static_cast<Kernel>(i));
+        }
+    }
+    return kernels;
+}
+
+// The thread counts to benchmark: 1, 2, 4, and every core if there are more
+inline std::vector<int> get_benchmark_thread_counts() {
+    std::vector<int> thread_counts = { 1, 2, 4 };
+    int              cores         = static_cast<int>(std::thread::hardware_concurrency());
+    if(cores > 4) {
+        thread_counts.push_back(cores);
+    }
+    return thread_counts;
+}
+
+// The time of the fastest of frame_count runs after a warm up run, in ms by default (Period std::micro for us): the fastest, as the other processes of
+// the machine add noise to the average
+template <typename Period = std::milli> double measure(int frame_count, const std::function<void()> &run) {
+    run();  // warm up
+    double best = 1e9;
+    for(int i = 0; i < frame_count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, Period>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// The main of a kernel test: --check, --benchmark [frame_count], or both without arguments
+inline int run_kernel_test(int argc, char *argv[], int (*run_check)(), int (*run_benchmark)(int), int default_frame_count) {
+    if(argc >= 2 && std::string(argv[1]) == "--check") {
+        return run_check();
+    }
+    if(argc >= 2 && std::string(argv[1]) == "--benchmark") {
+        return run_benchmark(argc >= 3 ? std::atoi(argv[2]) : default_frame_count);
+    }
+    if(argc >= 2) {
+        printf("Usage: %s [--check | --benchmark [frame_count]]\n", argv[0]);
+        return -1;
+    }
+    int result = run_check();
+    run_benchmark(default_frame_count);
+    return result;
+}
@@ -0,0 +1,147 @@
+#include "publicfilters/VideoDecoderProcess.hpp"
+#include "frame/FrameFactory.hpp"
+#include "frame/FrameMemoryPool.hpp"
+#include "stream/StreamProfileFactory.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace libobsensor;
+
+// Decodes a recorded H.264/H.265 Annex-B bitstream (as received from the device, e.g. dumped from the frames of an RTSP color stream) with the
+// VideoDecoder filter, one access unit per frame, and measures the decode rate with a single thread and with frame threading on all cores.
+//
+// Usage: video_decoder_test <stream.h264|stream.h265> [width height]
+
+static const int OUTPUT_FORMATS[] = { OB_FORMAT_NV12, OB_FORMAT_RGB };
+
+static bool isH265File(const std::string &path) {
+    auto ext = path.substr(path.find_last_of('.') + 1);
+    return ext == "h265" || ext == "265" || ext == "hevc";
+}
+
+// Splits the bitstream into access units: a new one starts at the first slice of a picture, or at the parameter sets, SEI or access unit
+// delimiter sent ahead of it
+static std::vector<std::vector<uint8_t>> splitAccessUnits(const std::vector<uint8_t> &stream, bool h265) {
+    std::vector<size_t> nalStarts;  // offsets of the start codes
+    for(size_t i = 0; i + 3 < stream.size(); i++) {
+        if(stream[i] == 0 && stream[i + 1] == 0 && stream[i + 2] == 1) {
+            nalStarts.push_back(i > 0 && stream[i - 1] == 0 ? i - 1 : i);
+            i += 2;
+        }
+    }
+    nalStarts.push_back(stream.size());
+
+    std::vector<std::vector<uint8_t>> accessUnits;
+    size_t                            auStart = nalStarts.front();
+    bool                              hasVcl  = false;
+    for(size_t n = 0; n + 1 < nalStarts.size(); n++) {
+        auto nal = stream.data() + nalStarts[n] + (stream[nalStarts[n] + 2] == 1 ? 3 : 4);
+        if(nal + 3 > stream.data() + nalStarts[n + 1]) {
+            continue;
+        }
+        bool vcl, firstSlice, prefix;
+        if(h265) {
+            int type   = (nal[0] >> 1) & 0x3f;
+            vcl        = type < 32;
+            firstSlice = vcl && (nal[2] & 0x80);
+            prefix     = type >= 32 && type <= 39;
+        }
+        else {
+            int type   = nal[0] & 0x1f;
+            vcl        = type >= 1 && type <= 5;
+            firstSlice = vcl && (nal[1] & 0x80);  // first_mb_in_slice == 0
+            prefix     = type >= 6 && type <= 9;
+        }
+        if(hasVcl && (firstSlice || prefix)) {
+            accessUnits.emplace_back(stream.begin() + auStart, stream.begin() + nalStarts[n]);
+            auStart = nalStarts[n];
+            hasVcl  = false;
+        }
+        hasVcl = hasVcl || vcl;
+    }
+    if(hasVcl) {
+        accessUnits.emplace_back(stream.begin() + auStart, stream.end());
+    }
+    return accessUnits;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        printf("Usage: %s <stream.h264|stream.h265> [width height]\n", argv[0]);
+        return 0;
+    }
+    if(!VideoDecoder::isAvailable()) {
+        printf("SKIPPED: FFmpeg libraries not found\n");
+        return 0;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if(!file) {
+        printf("SKIPPED: can not open %s\n", argv[1]);
+        return 0;
+    }
+    std::vector<uint8_t> stream((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    bool                 h265        = isH265File(argv[1]);
+    auto                 accessUnits = splitAccessUnits(stream, h265);
+    uint32_t             width       = argc >= 4 ? std::stoi(argv[2]) : 0;
+    uint32_t             height      = argc >= 4 ? std::stoi(argv[3]) : 0;
+    printf("%s: %s, %zu access units\n", argv[1], h265 ? "H.265" : "H.264", accessUnits.size());
+
+    // Held by the context in the SDK, otherwise every frame would create and destroy the pool
+    auto memoryPool    = FrameMemoryPool::getInstance();
+    auto codecFormat   = h265 ? OB_FORMAT_H265 : OB_FORMAT_H264;
+    auto streamProfile = StreamProfileFactory::createVideoStreamProfile(OB_STREAM_COLOR, codecFormat, width, height, 30);
+    std::vector<std::shared_ptr<const Frame>> frames;
+    for(size_t i = 0; i < accessUnits.size(); i++) {
+        auto frame = FrameFactory::createFrame(OB_FRAME_COLOR, codecFormat, static_cast<uint32_t>(accessUnits[i].size()));
+        memcpy(frame->getDataMutable(), accessUnits[i].data(), accessUnits[i].size());
+        frame->setNumber(i);
+        frame->setStreamProfile(streamProfile);
+        frames.push_back(frame);
+    }
+
+    bool passed = true;
+    printf("%-6s | %8s | %8s | %8s | %10s\n", "format", "threads", "decoded", "delay", "fps");
+    for(auto outputFormat: OUTPUT_FORMATS) {
+        for(int threadCount: { 1, 0 }) {
+            VideoDecoder             decoder;
+            std::vector<std::string> params = { std::to_string(outputFormat), std::to_string(threadCount) };
+            decoder.updateConfig(params);
+
+            uint32_t decoded    = 0;
+            int64_t  firstDelay = -1;
+            int64_t  lastNumber = -1;
+            bool     inOrder    = true;
+            auto     start      = std::chrono::steady_clock::now();
+            for(size_t i = 0; i < frames.size(); i++) {
+                // Take all frames completed by this access unit, as VideoSensor does
+                for(auto outFrame = decoder.process(frames[i]); outFrame; outFrame = decoder.popDecodedFrame()) {
+                    // Decoded frames come out in order, each with the info of the access unit it was decoded from
+                    auto number = static_cast<int64_t>(outFrame->getNumber());
+                    if(firstDelay < 0) {
+                        firstDelay = static_cast<int64_t>(i) - number;
+                    }
+                    inOrder    = inOrder && number > lastNumber && number <= static_cast<int64_t>(i);
+                    inOrder    = inOrder && outFrame->getFormat() == static_cast<OBFormat>(outputFormat);
+                    lastNumber = number;
+                    decoded++;
+                }
+            }
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%-6s | %8s | %8u | %8lld | %10.1f\n", outputFormat == OB_FORMAT_NV12 ? "NV12" : "RGB", threadCount ? "1" : "auto", decoded,
+                   (long long)firstDelay, sec > 0 ? decoded / sec : 0);
+            if(decoded == 0 || !inOrder) {
+                passed = false;
+            }
+        }
+    }
+
+    printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}